@@ -43,7 +43,18 @@ endmacro()
 
 
 # Shader compilation
+# Shaders can include any of shader_header_files by name: each header's directory is on the include path.
+# Headers shared with Pikzel's own shaders are in PikzelShaderDir.
+set(PikzelShaderDir "${CMAKE_CURRENT_LIST_DIR}/Pikzel/src/Pikzel/Renderer/Shaders")
+
 macro(compile_shaders shader_src_files shader_header_files dir_name compiled_shaders)
+   set(include_flags)
+   foreach(header ${${shader_header_files}})
+      get_filename_component(header_dir ${header} ABSOLUTE)
+      get_filename_component(header_dir ${header_dir} DIRECTORY)
+      list(APPEND include_flags "-I${header_dir}")
+   endforeach()
+   list(REMOVE_DUPLICATES include_flags)
    set(${compiled_shaders})
    set(${compiled_shaders} PARENT_SCOPE)
    foreach(shader ${${shader_src_files}})
@@ -58,18 +69,35 @@ macro(compile_shaders shader_src_files shader_header_files dir_name compiled_sha
       set(output_file ${output_dir}/${file_name}.spv)
       set(${compiled_shaders} ${${compiled_shaders}} ${output_file})
       set(${compiled_shaders} ${${compiled_shaders}} PARENT_SCOPE)
+
+      # Where the shader came from (compiler, source, and headers that it may include), so that it can be recompiled at runtime.
+      # See Pikzel/Renderer/ShaderReloader.h
+      set(source_info "${Vulkan_GLSLANG_VALIDATOR}\n${full_path}\n")
+      foreach(header ${${shader_header_files}})
+         get_filename_component(full_header_path ${header} ABSOLUTE)
+         string(APPEND source_info "${full_header_path}\n")
+      endforeach()
+      set(existing_source_info "")
+      if(EXISTS ${output_file}.source)
+         file(READ ${output_file}.source existing_source_info)
+      endif()
+      if(NOT "${existing_source_info}" STREQUAL "${source_info}")
+         file(WRITE ${output_file}.source "${source_info}")
+      endif()
+      set(${compiled_shaders} ${${compiled_shaders}} ${output_file}.source)
+      set(${compiled_shaders} ${${compiled_shaders}} PARENT_SCOPE)
       set_source_files_properties(${shader} PROPERTIES HEADER_FILE_ONLY TRUE)
       if (WIN32)
          add_custom_command(
             OUTPUT ${output_file}
-            COMMAND ${Vulkan_GLSLANG_VALIDATOR} --target-env vulkan1.2 ${full_path} -o ${output_file}
+            COMMAND ${Vulkan_GLSLANG_VALIDATOR} --target-env vulkan1.2 ${include_flags} ${full_path} -o ${output_file}
             DEPENDS ${full_path}
             DEPENDS ${${shader_header_files}}  # this makes all shaders depend on all shader_header_files... but I cant think of a better way
          )
       else()
          add_custom_command(
             OUTPUT ${output_file}
-            COMMAND mkdir --parents ${output_dir} && ${Vulkan_GLSLANG_VALIDATOR} --target-env vulkan1.2 ${full_path} -o ${output_file}
+            COMMAND mkdir --parents ${output_dir} && ${Vulkan_GLSLANG_VALIDATOR} --target-env vulkan1.2 ${include_flags} ${full_path} -o ${output_file}
             DEPENDS ${full_path}
          )
       endif()
@@ -15,7 +15,7 @@ public:
       CreateVertexBuffers();
       CreateUniformBuffers();
       CreateTextures();
-      CreateFramebuffers();
+      CreateRenderGraph();
       CreatePipelines();
 
       m_Camera.projection = glm::perspective(m_Camera.fovRadians, static_cast<float>(GetWindow().GetWidth()) / static_cast<float>(GetWindow().GetHeight()), nearPlane, farPlane);
@@ -42,169 +42,34 @@ protected:
    virtual void Render() override {
       PKZL_PROFILE_FUNCTION();
 
-      static float lightRadius = 25.0f;
-      static glm::mat4 lightProjection = glm::perspective(glm::radians(90.0f), 1.0f, lightRadius, 0.1f); // note: Pikzel uses reverse-Z so near and far planes are swapped
-
-
       // update buffers
-      Matrices matrices;
-      matrices.viewProjection = m_Camera.projection * glm::lookAt(m_Camera.position, m_Camera.position + m_Camera.direction, m_Camera.upVector);
-      matrices.lightSpace = m_LightSpace;
-      matrices.eyePosition = m_Camera.position;
-      m_BufferMatrices->CopyFromHost(0, sizeof(Matrices), &matrices);
+      m_Matrices.viewProjection = m_Camera.projection * glm::lookAt(m_Camera.position, m_Camera.position + m_Camera.direction, m_Camera.upVector);
+      m_Matrices.lightSpace = m_LightSpace;
+      m_Matrices.eyePosition = m_Camera.position;
+      m_BufferMatrices->CopyFromHost(0, sizeof(Matrices), &m_Matrices);
       m_BufferPointLights->CopyFromHost(0, sizeof(Pikzel::PointLight) * m_PointLights.size(), m_PointLights.data());
 
-      // render to directional light shadow map
-      if(m_ShowDirectionalLight) {
-         Pikzel::GraphicsContext& gc = m_FramebufferDirShadow->GetGraphicsContext();
-         gc.BeginFrame();
-         gc.Bind(*m_PipelineDirShadow);
-
-         // floor
-         glm::mat4 model = glm::identity<glm::mat4>();
-         gc.PushConstant("constants.mvp"_hs, m_LightSpace * model);
-         gc.DrawTriangles(*m_VertexBuffer, 6, 36);
-
-         // cubes
-         for (int i = 0; i < m_CubePositions.size(); ++i) {
-            glm::mat4 model = glm::rotate(glm::translate(glm::identity<glm::mat4>(), m_CubePositions[i]), glm::radians(20.0f * i), glm::vec3 {1.0f, 0.3f, 0.5f});
-            gc.PushConstant("constants.mvp"_hs, m_LightSpace * model);
-            gc.DrawTriangles(*m_VertexBuffer, 36);
-         }
-
-         gc.EndFrame();
-         gc.SwapBuffers();
-      }
-
-      // render to point light shadow map
-      if(m_ShowPointLights) {
-         Pikzel::GraphicsContext& gc = m_FramebufferPtShadow->GetGraphicsContext();
-
-         for (int i = 0; i < m_PointLights.size(); ++i) {
-            auto& light = m_PointLights[i];
-
-            std::array<glm::mat4, 6> lightViews = {
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {1.0f,  0.0f,  0.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {-1.0f,  0.0f,  0.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {0.0f,  1.0f,  0.0f}, glm::vec3 {0.0f,  0.0f,  1.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {0.0f, -1.0f,  0.0f}, glm::vec3 {0.0f,  0.0f, -1.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {0.0f,  0.0f,  1.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {0.0f,  0.0f, -1.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
-            };
-            m_BufferLightViews->CopyFromHost(0, sizeof(glm::mat4) * lightViews.size(), lightViews.data());
-
-            gc.BeginFrame(i == 0? Pikzel::BeginFrameOp::ClearAll : Pikzel::BeginFrameOp::ClearNone);
-            gc.Bind(*m_PipelinePtShadow);
-            gc.PushConstant("constants.lightIndex"_hs, i);
-            gc.PushConstant("constants.lightRadius"_hs, lightRadius);
-            gc.Bind("UBOLightViews"_hs, *m_BufferLightViews);
-            gc.Bind("UBOPointLights"_hs, *m_BufferPointLights);
-
-            // floor
-            glm::mat4 model = glm::identity<glm::mat4>();
-            gc.PushConstant("constants.model"_hs, model);
-            gc.DrawTriangles(*m_VertexBuffer, 6, 36);
-
-            // cubes
-            for (int i = 0; i < m_CubePositions.size(); ++i) {
-               glm::mat4 model = glm::rotate(glm::translate(glm::identity<glm::mat4>(), m_CubePositions[i]), glm::radians(20.0f * i), glm::vec3 {1.0f, 0.3f, 0.5f});
-               gc.PushConstant("constants.model"_hs, model);
-               gc.DrawTriangles(*m_VertexBuffer, 36);
-            }
-
-            gc.EndFrame();
-            gc.SwapBuffers();
-         }
-      }
-
-      // render scene
-      {
-
-         Pikzel::GraphicsContext& gc = m_FramebufferScene->GetGraphicsContext();
-         gc.BeginFrame();
-
-         if (m_ShowPointLights) {
-            gc.Bind(*m_PipelineColoredModel);
-            for (const auto& pointLight : m_PointLights) {
-               glm::mat4 model = glm::scale(glm::translate(glm::identity<glm::mat4>(), pointLight.position), {pointLight.size,pointLight.size,pointLight.size});
-               gc.PushConstant("constants.mvp"_hs, matrices.viewProjection * model);
-               gc.PushConstant("constants.color"_hs, pointLight.color * pointLight.power);
-               gc.DrawTriangles(*m_VertexBuffer, 36);
-            }
-         }
-
-         gc.Bind(*m_PipelineLitModel);
-         gc.PushConstant("constants.lightRadius"_hs, lightRadius);
-         gc.PushConstant("constants.numPointLights"_hs, static_cast<uint32_t>(m_PointLights.size()));
-         gc.PushConstant("constants.showDirectionalLight"_hs, m_ShowDirectionalLight? 1u : 0u);
-         gc.PushConstant("constants.showPointLights"_hs, m_ShowPointLights ? 1u : 0u);
-         gc.PushConstant("constants.useNormalMaps"_hs, m_UseNormalMaps ? 1u : 0u);
-         gc.PushConstant("constants.useDisplacementMaps"_hs, m_UseDisplacementMaps ? 1u : 0u);
-         gc.Bind("UBOMatrices"_hs, * m_BufferMatrices);
-         gc.Bind("UBODirectionalLight"_hs, *m_BufferDirectionalLight);
-         gc.Bind("UBOPointLights"_hs, *m_BufferPointLights);
-         gc.Bind("dirShadowMap"_hs, m_FramebufferDirShadow->GetDepthTexture());
-         gc.Bind("ptShadowMap"_hs, m_FramebufferPtShadow->GetDepthTexture());
-
-         // floor
-         glm::mat4 model = glm::identity<glm::mat4>();
-         gc.Bind("diffuseMap"_hs, *m_TextureFloor);
-         gc.Bind("specularMap"_hs, *m_TextureFloorSpecular);
-         gc.Bind("normalMap"_hs, *m_TextureFloorNormal);
-         gc.Bind("displacementMap"_hs, *m_TextureFloorDisplacement);
-         gc.PushConstant("constants.model"_hs, model);
-         gc.DrawTriangles(*m_VertexBuffer, 6, 36);
-
-         // cubes
-         gc.Bind("diffuseMap"_hs, *m_TextureContainer);
-         gc.Bind("specularMap"_hs, *m_TextureContainerSpecular);
-         gc.Bind("normalMap"_hs, *m_TextureContainerNormal);
-         gc.Bind("displacementMap"_hs, *m_TextureContainerDisplacement);
-         for (int i = 0; i < m_CubePositions.size(); ++i) {
-            glm::mat4 model = glm::rotate(glm::translate(glm::identity<glm::mat4>(), m_CubePositions[i]), glm::radians(20.0f * i), glm::vec3 {1.0f, 0.3f, 0.5f});
-            gc.PushConstant("constants.model"_hs, model);
-            gc.DrawTriangles(*m_VertexBuffer, 36);
-         }
-
-         gc.EndFrame();
-         gc.SwapBuffers();
-      }
+      // shadow maps and scene
+      m_RenderGraph.Execute();
 
       // bloom post processing
-      bool horizontal = true;
+      // The brightness color buffer is already thresholded (only the lights are written to it), so there is no need for
+      // the bloom effect to threshold it again.
       if(m_Bloom) {
-         bool firstIteration = true;
-         uint32_t blurIterations = 10;
-
-         for (uint32_t i = 0; i < blurIterations; ++i) {
-            Pikzel::GraphicsContext& gc = m_FramebufferBlur[horizontal]->GetGraphicsContext();
-            gc.BeginFrame();
-
-            gc.Bind(*m_PipelineBlur);
-
-            gc.PushConstant("constants.horizontal"_hs, horizontal ? 1u : 0u);
-            if (firstIteration) {
-               gc.Bind("uTexture"_hs, m_FramebufferScene->GetColorTexture(1));
-               firstIteration = false;
-            } else {
-               gc.Bind("uTexture"_hs, m_FramebufferBlur[!horizontal]->GetColorTexture(0));
-            }
-            gc.DrawTriangles(*m_QuadVertexBuffer, 6);
-
-            gc.EndFrame();
-            gc.SwapBuffers();
-            horizontal = !horizontal;
-         }
+         m_BloomEffect->GetComputeContext().WaitFor(m_RenderGraph.GetFramebuffer(m_TargetScene).GetGraphicsContext());
+         m_BloomEffect->GetComputeContext().WaitFor(GetWindow().GetGraphicsContext());   // previous frame may still be reading the bloom texture
+         m_BloomEffect->Apply(m_RenderGraph.GetFramebuffer(m_TargetScene).GetColorTexture(1), {.threshold = 0.0f, .knee = 0.0f, .intensity = m_BloomIntensity, .radius = m_BloomRadius});
       }
 
       GetWindow().BeginFrame();
       Pikzel::GraphicsContext& gc = GetWindow().GetGraphicsContext();
+      gc.WaitFor(m_BloomEffect->GetComputeContext());
       gc.Bind(*m_PipelineScreenQuad);
       gc.PushConstant("constants.bloom"_hs, m_Bloom ? 1 : 0);
       gc.PushConstant("constants.tonemap"_hs, m_ToneMap);
       gc.PushConstant("constants.exposure"_hs, m_Exposure);
-      gc.Bind("uTexture"_hs, m_FramebufferScene->GetColorTexture(0));
-      gc.Bind("uBloom"_hs, m_FramebufferBlur[!horizontal]->GetColorTexture(0));
+      gc.Bind("uTexture"_hs, m_RenderGraph.GetFramebuffer(m_TargetScene).GetColorTexture(0));
+      gc.Bind("uBloom"_hs, m_BloomEffect->GetTexture());
       gc.DrawTriangles(*m_QuadVertexBuffer, 6);
 
       GetWindow().BeginImGuiFrame();
@@ -212,6 +77,8 @@ protected:
          ImGui::Begin("Lighting");
          ImGui::Text("Frame time: %.3fms (%.0f FPS)", m_DeltaTime.count() * 1000.0f, 1.0f / m_DeltaTime.count());
          ImGui::Checkbox("Bloom", &m_Bloom);
+         ImGui::SliderFloat("Bloom intensity", &m_BloomIntensity, 0.0f, 4.0f);
+         ImGui::SliderFloat("Bloom radius", &m_BloomRadius, 0.5f, 4.0f);
          ImGui::Text("Tone mapping:");
          ImGui::RadioButton("None", &m_ToneMap, 0);
          ImGui::RadioButton("Reinhard", &m_ToneMap, 1);
@@ -222,12 +89,15 @@ protected:
          ImGui::Checkbox("Displacement mapping", &m_UseDisplacementMaps);
          ImGui::Checkbox("Ambient Light", &m_ShowDirectionalLight);
          ImGui::Checkbox("Point Lights", &m_ShowPointLights);
+         const auto& stats = m_RenderGraph.GetStats();
+         ImGui::Text("Render graph: %u passes (%u culled), %u targets in %u framebuffers", stats.Passes, stats.PassesCulled, stats.TransientTargets, stats.Framebuffers);
+         ImGui::Text("Transient memory: %.1f MB (%.1f MB without aliasing)", stats.TransientBytesAliased / (1024.0 * 1024.0), stats.TransientBytes / (1024.0 * 1024.0));
          for (size_t i = 0; i < m_PointLights.size(); ++i) {
             ImGuiDrawPointLight(fmt::format("light {0}", i).c_str(), m_PointLights[i]);
          }
          //ImGui::Text("Brightness color buffer:");
          //ImVec2 size = ImGui::GetContentRegionAvail();
-         //ImGui::Image(m_FramebufferScene->GetImGuiColorTextureId(1), size, ImVec2 {0, 1}, ImVec2 {1, 0});
+         //ImGui::Image(m_RenderGraph.GetFramebuffer(m_TargetScene).GetImGuiColorTextureId(1), size, ImVec2 {0, 1}, ImVec2 {1, 0});
          ImGui::End();
       }
       GetWindow().EndImGuiFrame();
@@ -242,8 +112,8 @@ protected:
       super::OnWindowResize(event);
       m_Camera.projection = glm::perspective(m_Camera.fovRadians, static_cast<float>(GetWindow().GetWidth()) / static_cast<float>(GetWindow().GetHeight()), nearPlane, farPlane);
 
-      // recreate framebuffer with new size
-      CreateFramebuffers();
+      // recreate render graph with new size
+      CreateRenderGraph();
    }
 
 
@@ -375,69 +245,164 @@ private:
    }
 
 
-   void CreateFramebuffers() {
+   // The render graph draws the shadow maps and the scene.  The scene is an output of the graph, as it is used afterwards
+   // by the bloom effect and drawn to the window.
+   void CreateRenderGraph() {
       const uint32_t shadowMapWidth = 2048;
       const uint32_t shadowMapHeight = 2048;
 
-      m_FramebufferScene = Pikzel::RenderCore::CreateFramebuffer({
+      m_RenderGraph.Reset();
+
+      m_TargetDirShadow = m_RenderGraph.CreateTarget("directional light shadow map", {
+         .width = shadowMapWidth,
+         .height = shadowMapHeight,
+         .attachments = {{Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F}}
+      });
+
+      m_TargetPtShadow = m_RenderGraph.CreateTarget("point light shadow maps", {
+         .width = shadowMapWidth,
+         .height = shadowMapHeight,
+         .layers = static_cast<uint32_t>(m_PointLights.size()),
+         .attachments = {{Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F, Pikzel::TextureType::TextureCubeArray}}
+      });
+
+      m_TargetScene = m_RenderGraph.CreateTarget("scene", {
          .width = GetWindow().GetWidth(),
          .height = GetWindow().GetHeight(),
          .msaaNumSamples = 4,
          .clearColorValue = GetWindow().GetClearColor(),
          .attachments = {
-            {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA16F},
-            {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA16F},
+            {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::R11G11B10F},  // HDR color.  No alpha needed, so pack into 32-bits rather than 64
+            {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::R11G11B10F},  // brightness (for bloom)
             {Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F}
          }
       });
+      m_RenderGraph.SetOutput(m_TargetScene);
 
-
-      m_FramebufferBlur[0] = Pikzel::RenderCore::CreateFramebuffer({
-         .width = GetWindow().GetWidth(),
-         .height = GetWindow().GetHeight(),
-         .clearColorValue = GetWindow().GetClearColor(),
-         .attachments = {
-            {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA16F},
+      // render to directional light shadow map
+      m_RenderGraph.AddPass("directional light shadow", {.target = m_TargetDirShadow}, [this] (Pikzel::GraphicsContext& gc) {
+         if (!m_ShowDirectionalLight) {
+            return;
          }
-      });
+         gc.Bind(*m_PipelineDirShadow);
 
-      m_FramebufferBlur[1] = Pikzel::RenderCore::CreateFramebuffer({
-         .width = GetWindow().GetWidth(),
-         .height = GetWindow().GetHeight(),
-         .clearColorValue = GetWindow().GetClearColor(),
-         .attachments = {
-            {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA16F},
+         // floor
+         glm::mat4 model = glm::identity<glm::mat4>();
+         gc.PushConstant("constants.mvp"_hs, m_LightSpace * model);
+         gc.DrawTriangles(*m_VertexBuffer, 6, 36);
+
+         // cubes
+         for (int i = 0; i < m_CubePositions.size(); ++i) {
+            glm::mat4 model = glm::rotate(glm::translate(glm::identity<glm::mat4>(), m_CubePositions[i]), glm::radians(20.0f * i), glm::vec3 {1.0f, 0.3f, 0.5f});
+            gc.PushConstant("constants.mvp"_hs, m_LightSpace * model);
+            gc.DrawTriangles(*m_VertexBuffer, 36);
          }
       });
 
-      if (!m_FramebufferDirShadow) {
-         m_FramebufferDirShadow = Pikzel::RenderCore::CreateFramebuffer({
-            .width = shadowMapWidth,
-            .height = shadowMapHeight,
-            .attachments = {{Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F}}
+      // render to point light shadow map, one pass per light
+      for (int i = 0; i < m_PointLights.size(); ++i) {
+         m_RenderGraph.AddPass(fmt::format("point light {0} shadow", i), {.target = m_TargetPtShadow, .beginFrameOp = i == 0 ? Pikzel::BeginFrameOp::ClearAll : Pikzel::BeginFrameOp::ClearNone}, [this, i] (Pikzel::GraphicsContext& gc) {
+            if (!m_ShowPointLights) {
+               return;
+            }
+            const glm::mat4 lightProjection = glm::perspective(glm::radians(90.0f), 1.0f, m_LightRadius, 0.1f); // note: Pikzel uses reverse-Z so near and far planes are swapped
+            const auto& light = m_PointLights[i];
+
+            std::array<glm::mat4, 6> lightViews = {
+               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {1.0f,  0.0f,  0.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
+               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {-1.0f,  0.0f,  0.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
+               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {0.0f,  1.0f,  0.0f}, glm::vec3 {0.0f,  0.0f,  1.0f}),
+               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {0.0f, -1.0f,  0.0f}, glm::vec3 {0.0f,  0.0f, -1.0f}),
+               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {0.0f,  0.0f,  1.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
+               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {0.0f,  0.0f, -1.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
+            };
+            m_BufferLightViews->CopyFromHost(0, sizeof(glm::mat4) * lightViews.size(), lightViews.data());
+
+            gc.Bind(*m_PipelinePtShadow);
+            gc.PushConstant("constants.lightIndex"_hs, i);
+            gc.PushConstant("constants.lightRadius"_hs, m_LightRadius);
+            gc.Bind("UBOLightViews"_hs, *m_BufferLightViews);
+            gc.Bind("UBOPointLights"_hs, *m_BufferPointLights);
+
+            // floor
+            glm::mat4 model = glm::identity<glm::mat4>();
+            gc.PushConstant("constants.model"_hs, model);
+            gc.DrawTriangles(*m_VertexBuffer, 6, 36);
+
+            // cubes
+            for (int i = 0; i < m_CubePositions.size(); ++i) {
+               glm::mat4 model = glm::rotate(glm::translate(glm::identity<glm::mat4>(), m_CubePositions[i]), glm::radians(20.0f * i), glm::vec3 {1.0f, 0.3f, 0.5f});
+               gc.PushConstant("constants.model"_hs, model);
+               gc.DrawTriangles(*m_VertexBuffer, 36);
+            }
          });
       }
 
-      if (!m_FramebufferPtShadow) {
-         m_FramebufferPtShadow = Pikzel::RenderCore::CreateFramebuffer({
-            .width = shadowMapWidth,
-            .height = shadowMapHeight,
-            .layers = static_cast<uint32_t>(m_PointLights.size()),
-            .attachments = {{Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F, Pikzel::TextureType::TextureCubeArray}}
-         });
+      // render scene
+      m_RenderGraph.AddPass("scene", {.target = m_TargetScene, .reads = {m_TargetDirShadow, m_TargetPtShadow}}, [this] (Pikzel::GraphicsContext& gc) {
+         if (m_ShowPointLights) {
+            gc.Bind(*m_PipelineColoredModel);
+            for (const auto& pointLight : m_PointLights) {
+               glm::mat4 model = glm::scale(glm::translate(glm::identity<glm::mat4>(), pointLight.position), {pointLight.size,pointLight.size,pointLight.size});
+               gc.PushConstant("constants.mvp"_hs, m_Matrices.viewProjection * model);
+               gc.PushConstant("constants.color"_hs, pointLight.color * pointLight.power);
+               gc.DrawTriangles(*m_VertexBuffer, 36);
+            }
+         }
+
+         gc.Bind(*m_PipelineLitModel);
+         gc.PushConstant("constants.lightRadius"_hs, m_LightRadius);
+         gc.PushConstant("constants.numPointLights"_hs, static_cast<uint32_t>(m_PointLights.size()));
+         gc.PushConstant("constants.showDirectionalLight"_hs, m_ShowDirectionalLight? 1u : 0u);
+         gc.PushConstant("constants.showPointLights"_hs, m_ShowPointLights ? 1u : 0u);
+         gc.PushConstant("constants.useNormalMaps"_hs, m_UseNormalMaps ? 1u : 0u);
+         gc.PushConstant("constants.useDisplacementMaps"_hs, m_UseDisplacementMaps ? 1u : 0u);
+         gc.Bind("UBOMatrices"_hs, * m_BufferMatrices);
+         gc.Bind("UBODirectionalLight"_hs, *m_BufferDirectionalLight);
+         gc.Bind("UBOPointLights"_hs, *m_BufferPointLights);
+         gc.Bind("dirShadowMap"_hs, m_RenderGraph.GetFramebuffer(m_TargetDirShadow).GetDepthTexture());
+         gc.Bind("ptShadowMap"_hs, m_RenderGraph.GetFramebuffer(m_TargetPtShadow).GetDepthTexture());
+
+         // floor
+         glm::mat4 model = glm::identity<glm::mat4>();
+         gc.Bind("diffuseMap"_hs, *m_TextureFloor);
+         gc.Bind("specularMap"_hs, *m_TextureFloorSpecular);
+         gc.Bind("normalMap"_hs, *m_TextureFloorNormal);
+         gc.Bind("displacementMap"_hs, *m_TextureFloorDisplacement);
+         gc.PushConstant("constants.model"_hs, model);
+         gc.DrawTriangles(*m_VertexBuffer, 6, 36);
+
+         // cubes
+         gc.Bind("diffuseMap"_hs, *m_TextureContainer);
+         gc.Bind("specularMap"_hs, *m_TextureContainerSpecular);
+         gc.Bind("normalMap"_hs, *m_TextureContainerNormal);
+         gc.Bind("displacementMap"_hs, *m_TextureContainerDisplacement);
+         for (int i = 0; i < m_CubePositions.size(); ++i) {
+            glm::mat4 model = glm::rotate(glm::translate(glm::identity<glm::mat4>(), m_CubePositions[i]), glm::radians(20.0f * i), glm::vec3 {1.0f, 0.3f, 0.5f});
+            gc.PushConstant("constants.model"_hs, model);
+            gc.DrawTriangles(*m_VertexBuffer, 36);
+         }
+      });
+
+      m_RenderGraph.Compile();
+
+      if (m_BloomEffect) {
+         m_BloomEffect->Resize(GetWindow().GetWidth(), GetWindow().GetHeight());
+      } else {
+         m_BloomEffect = std::make_unique<Pikzel::Bloom>(GetWindow().GetWidth(), GetWindow().GetHeight());
       }
    }
 
 
    void CreatePipelines() {
-      m_PipelineDirShadow = m_FramebufferDirShadow->GetGraphicsContext().CreatePipeline({
+      m_PipelineDirShadow = m_RenderGraph.GetFramebuffer(m_TargetDirShadow).GetGraphicsContext().CreatePipeline({
          .shaders = {
             { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/Depth.vert.spv" },
             { Pikzel::ShaderType::Fragment, "Assets/" APP_NAME "/Shaders/Depth.frag.spv" }
          },
          .bufferLayout = m_VertexBuffer->GetLayout()
       });
-      m_PipelinePtShadow = m_FramebufferPtShadow->GetGraphicsContext().CreatePipeline({
+      m_PipelinePtShadow = m_RenderGraph.GetFramebuffer(m_TargetPtShadow).GetGraphicsContext().CreatePipeline({
          .shaders = {
             { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/DepthCube.vert.spv" },
             { Pikzel::ShaderType::Geometry, "Assets/" APP_NAME "/Shaders/DepthCube.geom.spv" },
@@ -445,27 +410,20 @@ private:
          },
          .bufferLayout = m_VertexBuffer->GetLayout()
       });
-      m_PipelineColoredModel = m_FramebufferScene->GetGraphicsContext().CreatePipeline({
+      m_PipelineColoredModel = m_RenderGraph.GetFramebuffer(m_TargetScene).GetGraphicsContext().CreatePipeline({
          .shaders = {
             { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/ColoredModel.vert.spv" },
             { Pikzel::ShaderType::Fragment, "Assets/" APP_NAME "/Shaders/ColoredModel.frag.spv" }
          },
          .bufferLayout = m_VertexBuffer->GetLayout()
       });
-      m_PipelineLitModel = m_FramebufferScene->GetGraphicsContext().CreatePipeline({
+      m_PipelineLitModel = m_RenderGraph.GetFramebuffer(m_TargetScene).GetGraphicsContext().CreatePipeline({
          .shaders = {
             { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/LitModel.vert.spv" },
             { Pikzel::ShaderType::Fragment, "Assets/" APP_NAME "/Shaders/LitModel.frag.spv" }
          },
          .bufferLayout = m_VertexBuffer->GetLayout()
       });
-      m_PipelineBlur = m_FramebufferBlur[0]->GetGraphicsContext().CreatePipeline({
-         .shaders = {
-            { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/Quad.vert.spv" },
-            { Pikzel::ShaderType::Fragment, "Assets/" APP_NAME "/Shaders/QuadGaussianBlur.frag.spv" }
-         },
-         .bufferLayout = m_QuadVertexBuffer->GetLayout()
-      });
       m_PipelineScreenQuad = GetWindow().GetGraphicsContext().CreatePipeline({
          .shaders = {
             { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/Quad.vert.spv" },
@@ -549,6 +507,8 @@ private:
    };
 
    glm::mat4 m_LightSpace;
+   Matrices m_Matrices;
+   float m_LightRadius = 25.0f;
 
    std::unique_ptr<Pikzel::VertexBuffer> m_VertexBuffer;
    std::unique_ptr<Pikzel::VertexBuffer> m_QuadVertexBuffer;
@@ -564,20 +524,22 @@ private:
    std::unique_ptr<Pikzel::Texture> m_TextureFloorSpecular;
    std::unique_ptr<Pikzel::Texture> m_TextureFloorNormal;
    std::unique_ptr<Pikzel::Texture> m_TextureFloorDisplacement;
-   std::unique_ptr<Pikzel::Framebuffer> m_FramebufferDirShadow;
-   std::unique_ptr<Pikzel::Framebuffer> m_FramebufferPtShadow;
-   std::array<std::unique_ptr<Pikzel::Framebuffer>, 2> m_FramebufferBlur;
-   std::unique_ptr<Pikzel::Framebuffer> m_FramebufferScene;
+   Pikzel::RenderGraph m_RenderGraph;
+   Pikzel::RenderGraphTarget m_TargetDirShadow = {};
+   Pikzel::RenderGraphTarget m_TargetPtShadow = {};
+   Pikzel::RenderGraphTarget m_TargetScene = {};
    std::unique_ptr<Pikzel::Pipeline> m_PipelineDirShadow;
    std::unique_ptr<Pikzel::Pipeline> m_PipelinePtShadow;
    std::unique_ptr<Pikzel::Pipeline> m_PipelineColoredModel;
    std::unique_ptr<Pikzel::Pipeline> m_PipelineLitModel;
    std::unique_ptr<Pikzel::Pipeline> m_PipelineScreenQuad;
-   std::unique_ptr<Pikzel::Pipeline> m_PipelineBlur;
+   std::unique_ptr<Pikzel::Bloom> m_BloomEffect;
 
    Pikzel::DeltaTime m_DeltaTime = {};
    float m_Exposure = 1.0;
    int m_ToneMap = 0;
+   float m_BloomIntensity = 1.0f;
+   float m_BloomRadius = 1.0f;
    bool m_Bloom = true;
    bool m_ShowDirectionalLight = true;
    bool m_ShowPointLights = true;
@@ -0,0 +1,30 @@
+// Packing and unpacking of G-buffer contents.
+//
+// Normals are stored octahedral encoded in two 16-bit signed normalized components.
+// Positions are not stored at all.  They are reconstructed from the depth buffer and the inverse view-projection matrix.
+
+
+// Encode a unit vector as a point in [-1, 1]^2 by projecting it onto an octahedron, and unfolding the lower half
+vec2 EncodeOctahedral(const vec3 v) {
+   const vec3 n = v / (abs(v.x) + abs(v.y) + abs(v.z));
+   if (n.z >= 0.0) {
+      return n.xy;
+   }
+   return (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+}
+
+
+// Decode an octahedral encoded unit vector
+vec3 DecodeOctahedral(const vec2 e) {
+   vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+   const float t = max(-v.z, 0.0);
+   v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+   return normalize(v);
+}
+
+
+// World space position of the fragment at texCoords, given the depth buffer value there
+vec3 ReconstructPosition(const vec2 texCoords, const float depth, const mat4 inverseViewProjection) {
+   const vec4 position = inverseViewProjection * vec4((texCoords * 2.0) - 1.0, depth, 1.0);
+   return position.xyz / position.w;
+}
@@ -1,19 +1,19 @@
 #version 450 core
+#extension GL_GOOGLE_include_directive: require
 
-layout(location = 0) in vec3 inFragPos;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec2 inTexCoords;
+#include "GBuffer.glsl"
 
-layout (location = 0) out vec4 outPosition;
-layout (location = 1) out vec4 outNormal;
-layout (location = 2) out vec4 outDiffuseSpecular;
+layout(location = 0) in vec3 inNormal;
+layout(location = 1) in vec2 inTexCoords;
+
+layout (location = 0) out vec2 outNormal;
+layout (location = 1) out vec4 outDiffuseSpecular;
 
 layout(set = 1, binding = 0) uniform sampler2D diffuseMap;
 layout(set = 1, binding = 1) uniform sampler2D specularMap;
 
 void main() {
-    outPosition = vec4(inFragPos, 1.0);
-    outNormal = vec4(normalize(inNormal), 1.0);
+    outNormal = EncodeOctahedral(normalize(inNormal));
     outDiffuseSpecular.rgb = texture(diffuseMap, inTexCoords).rgb;
     outDiffuseSpecular.a = texture(specularMap, inTexCoords).r;
 }
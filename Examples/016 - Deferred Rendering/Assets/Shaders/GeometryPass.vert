@@ -16,14 +16,12 @@ layout(set = 0, binding = 0) uniform UBOMatrices {
    Matrices matrices;
 } uboMatrices;
 
-layout(location = 0) out vec3 outFragPos;
-layout(location = 1) out vec3 outNormal;
-layout(location = 2) out vec2 outTexCoords;
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) out vec2 outTexCoords;
 
 
 void main() {
    const vec4 worldPos = constants.model * vec4(inPos, 1.0);
-   outFragPos = worldPos.xyz;
    outNormal = vec3(constants.model * vec4(inNormal, 0.0));
    outTexCoords = inTexCoords;
 
@@ -1,6 +1,7 @@
 #version 450 core
 #extension GL_GOOGLE_include_directive: require
 
+#include "GBuffer.glsl"
 #include "Lights.glsl"
 #include "Matrices.glsl"
 
@@ -28,9 +29,9 @@ layout(set = 1, binding = 1) uniform UBOPointLights {
    PointLight light[MAX_POINT_LIGHTS];
 } pointLights;
 
-layout(set = 2, binding = 0) uniform sampler2D uPosition;
-layout(set = 2, binding = 1) uniform sampler2D uNormal;
-layout(set = 2, binding = 2) uniform sampler2D uDiffuseSpecular;
+layout(set = 2, binding = 0) uniform sampler2D uNormal;
+layout(set = 2, binding = 1) uniform sampler2D uDiffuseSpecular;
+layout(set = 2, binding = 2) uniform sampler2D uDepth;
 
 layout(location = 0) out vec4 outFragColor;
 
@@ -79,8 +80,14 @@ vec3 CalculatePointLight(const uint lightIndex, const vec3 fragPos, const vec3 v
 
 
 void main() {
-   const vec3 fragPos = texture(uPosition, inTexCoords).xyz;
-   const vec3 normal = texture(uNormal, inTexCoords).xyz;
+   // nothing was drawn here (depth buffer is cleared to 0, which is the far plane with reverse-Z)
+   const float depth = texture(uDepth, inTexCoords).r;
+   if (depth == 0.0) {
+      discard;
+   }
+
+   const vec3 fragPos = ReconstructPosition(inTexCoords, depth, uboMatrices.matrices.inverseViewProjection);
+   const vec3 normal = DecodeOctahedral(texture(uNormal, inTexCoords).xy);
    const vec3 diffuseColor = texture(uDiffuseSpecular, inTexCoords).rgb;
    const vec3 specularColor = vec3(texture(uDiffuseSpecular, inTexCoords).a, 0.125, 0.0);
 
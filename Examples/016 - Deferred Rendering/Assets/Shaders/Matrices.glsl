@@ -1,5 +1,6 @@
 struct Matrices {
    mat4 viewProjection;
+   mat4 inverseViewProjection;
    mat4 lightSpace;
    vec3 eyePosition;
 };
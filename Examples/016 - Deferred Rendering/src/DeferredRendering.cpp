@@ -3,9 +3,10 @@
 
 // Deferred rendering demonstration
 // The scene is first rendered to an off-screen "G-buffer" consisting of:
-// - position information
-// - normals
+// - normals (octahedral encoded into two 16-bit components)
 // - diffuse color (rgb) and specular amount (a) (packed into one vec4)
+// - depth
+// Positions are not stored.  They are reconstructed from depth in the lighting pass.
 //
 // Then later (i.e deferred), a full screen quad is rendered to the screen and this one does the (expensive) lighting calculations
 // using the information from G-buffer.
@@ -62,6 +63,7 @@ protected:
       // update buffers
       Matrices matrices;
       matrices.viewProjection = m_Camera.projection * glm::lookAt(m_Camera.position, m_Camera.position + m_Camera.direction, m_Camera.upVector);
+      matrices.inverseViewProjection = glm::inverse(matrices.viewProjection);
       matrices.lightSpace = m_LightSpace;
       matrices.eyePosition = m_Camera.position;
       m_BufferMatrices->CopyFromHost(0, sizeof(Matrices), &matrices);
@@ -106,9 +108,9 @@ protected:
       gc.Bind("UBOMatrices"_hs, *m_BufferMatrices);
       gc.Bind("UBODirectionalLight"_hs, *m_BufferDirectionalLight);
       gc.Bind("UBOPointLights"_hs, *m_BufferPointLights);
-      gc.Bind("uPosition"_hs, m_GBuffer->GetColorTexture(0));
-      gc.Bind("uNormal"_hs, m_GBuffer->GetColorTexture(1));
-      gc.Bind("uDiffuseSpecular"_hs, m_GBuffer->GetColorTexture(2));
+      gc.Bind("uNormal"_hs, m_GBuffer->GetColorTexture(0));
+      gc.Bind("uDiffuseSpecular"_hs, m_GBuffer->GetColorTexture(1));
+      gc.Bind("uDepth"_hs, m_GBuffer->GetDepthTexture());
       gc.DrawTriangles(*m_QuadVertexBuffer, 6);
 
       GetWindow().BeginImGuiFrame();
@@ -122,18 +124,18 @@ protected:
          ImGui::Text("Frame time: %.3fms (%.0f FPS)", m_DeltaTime.count() * 1000.0f, 1.0f / m_DeltaTime.count());
 
          // POI: We can also visualize what's in the G-buffer by drawing the attached textures in ImGui image.
-         //      Note that some of the images won't look quite right (as we have numbers outside of the 0-1 range in the G-buffer,
+         //      Note that some of the images won't look quite right (as we have encoded normals in the G-buffer,
          //      and in the case of the DiffuseSpecular texture, we're using the alpha channel for specular amount, not transparency!)
          //      but this visualization gives you the general idea of what's going on.
-         ImGui::Text("G-Buffer:");
+         // POI: The packed G-buffer writes far fewer bytes per pixel than a "straightforward" one with 16-bit floating point
+         //      positions and normals.  At high resolutions, the geometry pass is limited by this bandwidth.
+         ImGui::Text("G-Buffer: %d bytes/pixel (unpacked layout would be %d bytes/pixel)", Pikzel::GetBytesPerPixel(GBufferSettings(GBufferAttachments)), Pikzel::GetBytesPerPixel(GBufferSettings(GBufferAttachmentsUnpacked)));
          ImVec2 size = ImGui::GetContentRegionAvail();
          size.x /= 2.0f;
          size.y /= 2.0f;
          ImGui::Image(m_GBuffer->GetImGuiColorTextureId(0), size, ImVec2 {0, 1}, ImVec2 {1, 0});
          ImGui::SameLine();
          ImGui::Image(m_GBuffer->GetImGuiColorTextureId(1), size, ImVec2 {0, 1}, ImVec2 {1, 0});
-         ImGui::Image(m_GBuffer->GetImGuiColorTextureId(2), size, ImVec2 {0, 1}, ImVec2 {1, 0});
-         ImGui::SameLine();
          ImGui::Image(m_GBuffer->GetImGuiDepthTextureId(), size, ImVec2 {0, 1}, ImVec2 {1, 0});
 
          ImGui::End();
@@ -253,6 +255,7 @@ private:
 
    struct Matrices {
       glm::mat4 viewProjection;
+      glm::mat4 inverseViewProjection;
       glm::mat4 lightSpace;
       glm::vec3 eyePosition;
    };
@@ -277,21 +280,35 @@ private:
    }
 
 
-   void CreateFramebuffers() {
-      m_GBuffer = Pikzel::RenderCore::CreateFramebuffer({
+   // POI: G-buffer layout.
+   inline static const std::vector<Pikzel::FramebufferAttachmentSettings> GBufferAttachments = {
+      {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RG16S},                    // POI: normals, octahedral encoded into two 16-bit signed normalized components
+      {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA8},                    // POI: diffuse color + specular.  This can go in an RGBA 8-bit buffer
+      {Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F}                      // POI: depth.  Positions are reconstructed from this, so there is no position buffer
+   };
+
+   // The layout we would have if positions and normals were stored as they are.  (just for comparison of bytes per pixel)
+   inline static const std::vector<Pikzel::FramebufferAttachmentSettings> GBufferAttachmentsUnpacked = {
+      {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA16F},                  // position
+      {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA16F},                  // normals
+      {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA8},                    // diffuse color + specular
+      {Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F}
+   };
+
+
+   Pikzel::FramebufferSettings GBufferSettings(const std::vector<Pikzel::FramebufferAttachmentSettings>& attachments) {
+      return {
          .width = GetWindow().GetWidth(),
          .height = GetWindow().GetHeight(),
-         .msaaNumSamples = 1,                                                              // POI: no MSAA with deferred rendering
+         .msaaNumSamples = 1,                                                           // POI: no MSAA with deferred rendering
          .clearColorValue = GetWindow().GetClearColor(),
-         .attachments = {
-            {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA16F},               // POI: position color buffer. 16 bit floating point
-            {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA16F},               // POI: normals color buffer. 16 bit floating point
-            {Pikzel::AttachmentType::Color, Pikzel::TextureFormat::RGBA8},                 // POI: diffuse color + specular.  This can go in an RGBA 8-bit buffer
-            {Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F}
-         }
-      });
+         .attachments = attachments
+      };
+   }
 
 
+   void CreateFramebuffers() {
+      m_GBuffer = Pikzel::RenderCore::CreateFramebuffer(GBufferSettings(GBufferAttachments));
    }
 
 
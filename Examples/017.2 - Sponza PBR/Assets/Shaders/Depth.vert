@@ -3,6 +3,7 @@ layout (location = 0) in vec3 inPos;
 
 layout(push_constant) uniform PC {
    mat4 mvp;
+   int cascade;
 } constants;
 
 void main() {
@@ -9,10 +9,11 @@ layout(push_constant) uniform PC {
    mat4 model;
    float lightRadius;
    int lightIndex;
+   int face;
 } constants;
 
-layout(set = 1, binding = 0) uniform UBOPointLights {
-   PointLight light[MAX_POINT_LIGHTS];
+layout(set = 1, binding = 0) readonly buffer PointLights {
+   PointLight light[];
 } pointLights;
 
 void main() {
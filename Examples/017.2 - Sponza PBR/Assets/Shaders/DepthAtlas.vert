@@ -0,0 +1,20 @@
+#version 450 core
+layout (location = 0) in vec3 inPos;
+
+layout(push_constant) uniform PC {
+   mat4 model;
+   float lightRadius;
+   int lightIndex;
+   int face;
+} constants;
+
+layout(set = 0, binding = 0) uniform UBOLightViews {
+   mat4 view[6];
+} lightViews;
+
+layout (location = 0) out vec4 outFragPos;
+
+void main() {
+   outFragPos = constants.model * vec4(inPos.xyz, 1.0);
+   gl_Position = lightViews.view[constants.face] * outFragPos;
+}
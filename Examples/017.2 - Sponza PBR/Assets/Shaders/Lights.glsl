@@ -1,5 +1,3 @@
-#define MAX_POINT_LIGHTS 16
-
 struct DirectionalLight {
    vec3 direction;
    vec3 color;
@@ -13,3 +11,40 @@ struct PointLight {
    float size;
    float power;
 };
+
+// Cascaded shadow map for the directional light.
+// Must match the ShadowCascades struct in SponzaPBR.cpp
+const int MAX_SHADOW_CASCADES = 4;
+
+struct ShadowCascades {
+   mat4 lightSpace[MAX_SHADOW_CASCADES];
+   vec4 splits;          // view depth at the far end of each cascade
+   vec4 invWidth;        // 1 / width (in world units) of each cascade
+   vec3 viewDirection;
+   int count;
+};
+
+// Point light shadows are rendered into tiles of a shadow atlas, one tile for each cube face.
+// Must match the PointLightShadow struct in SponzaPBR.cpp
+struct PointLightShadow {
+   vec4 face[6];   // xy = offset, z = size, w = size of one texel.  All in atlas texture coordinates.  z = 0 means the light has no shadow
+};
+
+// Cube face orientation, in the same order (and with the same "up" vectors) as the point light shadow face views in SponzaPBR.cpp
+const vec3 cubeFaceForward[6] = vec3[](vec3( 1.0,  0.0,  0.0), vec3(-1.0,  0.0,  0.0), vec3( 0.0,  1.0,  0.0), vec3( 0.0, -1.0,  0.0), vec3( 0.0,  0.0,  1.0), vec3( 0.0,  0.0, -1.0));
+const vec3 cubeFaceUp[6]      = vec3[](vec3( 0.0, -1.0,  0.0), vec3( 0.0, -1.0,  0.0), vec3( 0.0,  0.0,  1.0), vec3( 0.0,  0.0, -1.0), vec3( 0.0, -1.0,  0.0), vec3( 0.0, -1.0,  0.0));
+
+
+// Returns atlas texture coordinates for given direction from light, by picking the cube face that it points at
+vec2 PointShadowAtlasCoords(const PointLightShadow shadow, const vec3 direction) {
+   const vec3 a = abs(direction);
+   const int face = (a.x >= a.y) && (a.x >= a.z) ? (direction.x > 0.0 ? 0 : 1) : (a.y >= a.z) ? (direction.y > 0.0 ? 2 : 3) : (direction.z > 0.0 ? 4 : 5);
+   const vec3 forward = cubeFaceForward[face];
+   const vec3 up = cubeFaceUp[face];
+   const vec3 right = cross(forward, up);
+   const vec2 uv = (vec2(dot(direction, right), dot(direction, up)) / dot(direction, forward)) * 0.5 + 0.5;
+
+   // keep away from the edges of the tile, so that filtering does not pick up neighbouring tiles
+   const vec4 tile = shadow.face[face];
+   return tile.xy + clamp(uv * tile.z, vec2(tile.w * 0.5), vec2(tile.z - tile.w * 0.5));
+}
@@ -1,5 +1,4 @@
 struct Matrices {
    mat4 viewProjection;
-   mat4 lightSpace;
    vec3 eyePosition;
 };
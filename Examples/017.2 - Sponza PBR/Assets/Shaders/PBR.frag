@@ -2,6 +2,7 @@
 #extension GL_GOOGLE_include_directive: require
 
 #include "Lights.glsl"
+#include "Clusters.glsl"
 #include "Matrices.glsl"
 
 const float pi = 3.14159265;
@@ -9,9 +10,8 @@ const int numPCSSSamples = 64;
 const int numPCFSamples = 64;
 
 layout(location = 0) in vec3 inFragPos;
-layout(location = 1) in vec4 inFragPosLightSpace;
-layout(location = 2) in vec2 inTexCoords;
-layout(location = 3) in mat3 inTangentBasis;
+layout(location = 1) in vec2 inTexCoords;
+layout(location = 2) in mat3 inTangentBasis;
 
 
 layout(push_constant) uniform PC {
@@ -19,7 +19,6 @@ layout(push_constant) uniform PC {
    vec2 textureRepeat;
    float heightScale;
    float lightRadius;
-   uint numPointLights;
 } constants;
 
 
@@ -31,17 +30,38 @@ layout(set = 1, binding = 0) uniform UBODirectionalLight {
    DirectionalLight light;
 } directionalLight;
 
-layout(set = 1, binding = 1) uniform UBOPointLights {
-   PointLight light[MAX_POINT_LIGHTS];
+layout(set = 0, binding = 1) uniform UBOClusters {
+   Clusters clusters;
+} uboClusters;
+
+layout(set = 0, binding = 2) uniform UBOShadowCascades {
+   ShadowCascades cascades;
+} uboShadowCascades;
+
+layout(set = 1, binding = 1) readonly buffer PointLights {
+   PointLight light[];
 } pointLights;
 
 
-layout(set = 1, binding = 2) uniform sampler2D uDirShadowMap;
-layout(set = 1, binding = 3) uniform samplerCubeArray uPtShadowMap;
+layout(set = 1, binding = 2) uniform sampler2DArray uDirShadowMap;
+layout(set = 1, binding = 3) uniform sampler2D uPtShadowAtlas;
 layout(set = 1, binding = 4) uniform samplerCube uIrradiance;
 layout(set = 1, binding = 5) uniform samplerCube uSpecularIrradiance;
 layout(set = 1, binding = 6) uniform sampler2D uSpecularBRDF_LUT;
 
+layout(set = 1, binding = 7) readonly buffer ClusterLightGrid {
+   uvec2 cluster[];  // x = offset into ClusterLightIndices, y = number of lights
+} clusterLightGrid;
+
+layout(set = 1, binding = 8) readonly buffer ClusterLightIndices {
+   uint count;
+   uint index[];
+} clusterLightIndices;
+
+layout(set = 1, binding = 9) readonly buffer PointLightShadows {
+   PointLightShadow shadow[];
+} pointLightShadows;
+
 layout(set = 2, binding = 0) uniform sampler2D uAlbedo;
 layout(set = 2, binding = 1) uniform sampler2D uMetallicRoughness;  // Metallic in B, Roughness in G
 layout(set = 2, binding = 2) uniform sampler2D uNormals;
@@ -186,11 +206,11 @@ const vec3 poissonSphere[64] = vec3[](
 );
 
 
-float BlockerDepth(vec3 shadowCoords, float bias, float lightSize) {
+float BlockerDepth(vec3 shadowCoords, int cascade, float bias, float lightSize) {
    float numBlockers = 0.0;
    float sumBlockers = 0.0;
    for (int i = 0; i < numPCSSSamples; ++i) {
-      float z = texture(uDirShadowMap, shadowCoords.xy + poissonDisk[i] * lightSize).r;
+      float z = texture(uDirShadowMap, vec3(shadowCoords.xy + poissonDisk[i] * lightSize, cascade)).r;
       if(z > shadowCoords.z + bias) {
          numBlockers += 1.0;
          sumBlockers += z;
@@ -200,10 +220,10 @@ float BlockerDepth(vec3 shadowCoords, float bias, float lightSize) {
 }
 
 
-float PCFDirectionalShadow(vec3 shadowCoords, float bias, float radius) {
+float PCFDirectionalShadow(vec3 shadowCoords, int cascade, float bias, float radius) {
    float sum = 0;
    for (int i = 0; i < numPCFSamples; ++i) {
-      float z = texture(uDirShadowMap, shadowCoords.xy + poissonDisk[i] * radius).r;
+      float z = texture(uDirShadowMap, vec3(shadowCoords.xy + poissonDisk[i] * radius, cascade)).r;
       if(z > shadowCoords.z + bias) {
          ++sum;
       }
@@ -212,7 +232,25 @@ float PCFDirectionalShadow(vec3 shadowCoords, float bias, float radius) {
 }
 
 
-float CalculateDirectionalShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
+// Returns index of the shadow cascade covering given world space position, or -1 if it is beyond the last cascade
+int ShadowCascade(vec3 fragPos) {
+   const float viewDepth = dot(fragPos - uboMatrices.matrices.eyePosition, uboShadowCascades.cascades.viewDirection);
+   for (int i = 0; i < uboShadowCascades.cascades.count; ++i) {
+      if (viewDepth < uboShadowCascades.cascades.splits[i]) {
+         return i;
+      }
+   }
+   return -1;
+}
+
+
+float CalculateDirectionalShadow(vec3 fragPos, vec3 normal, vec3 lightDir) {
+   const int cascade = ShadowCascade(fragPos);
+   if (cascade < 0) {
+      return 0.0;
+   }
+
+   vec4 fragPosLightSpace = uboShadowCascades.cascades.lightSpace[cascade] * vec4(fragPos, 1.0);
    vec3 shadowCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
 
    // note: Pikzel uses the Vulkan convention where NDC is -1 to 1 for x and y, and 0 to 1 for z
@@ -221,11 +259,13 @@ float CalculateDirectionalShadow(vec4 fragPosLightSpace, vec3 normal, vec3 light
 
    float shadow = 0.0;
    float bias = 0.001 * (1.0 - dot(-normal, lightDir));
-   float lightSize = directionalLight.light.size;
-   float blockerDepth = BlockerDepth(shadowCoords, bias, lightSize);
+
+   // light size is in world units.  Convert to shadow map texture coordinates for this cascade
+   float lightSize = directionalLight.light.size * uboShadowCascades.cascades.invWidth[cascade];
+   float blockerDepth = BlockerDepth(shadowCoords, cascade, bias, lightSize);
    if (blockerDepth > 0.0) {
       float penumbraWidth = lightSize * (blockerDepth - shadowCoords.z) / (1.0 - blockerDepth);
-      shadow = PCFDirectionalShadow(shadowCoords, bias, penumbraWidth);
+      shadow = PCFDirectionalShadow(shadowCoords, cascade, bias, penumbraWidth);
    }
    return shadow;
 }
@@ -236,7 +276,7 @@ float BlockerDepthPt(const uint lightIndex, const vec3 fragPos, const float frag
    float sumBlockers = 0.0;
    for (int i = 0; i < numPCSSSamples; ++i) {
       const vec3 fragToLight = (fragPos + poissonSphere[i] * lightSize) - lightPos;
-      const float z = texture(uPtShadowMap, vec4(fragToLight, lightIndex)).r;
+      const float z = texture(uPtShadowAtlas, PointShadowAtlasCoords(pointLightShadows.shadow[lightIndex], fragToLight)).r;
       if(z > fragDepth + bias) {
          numBlockers += 1.0;
          sumBlockers += z;
@@ -250,7 +290,7 @@ float PCFPointShadow(const uint lightIndex, const vec3 fragPos, const float frag
    float sum = 0;
    for (int i = 0; i < numPCFSamples; ++i) {
       const vec3 fragToLight = (fragPos + poissonSphere[i] * radius) - lightPos;
-      const float z = texture(uPtShadowMap, vec4(fragToLight, lightIndex)).r;
+      const float z = texture(uPtShadowAtlas, PointShadowAtlasCoords(pointLightShadows.shadow[lightIndex], fragToLight)).r;
       if(z > fragDepth + bias) {
          ++sum;
       }
@@ -260,6 +300,10 @@ float PCFPointShadow(const uint lightIndex, const vec3 fragPos, const float frag
 
 
 float CalculatePointShadow(const uint lightIndex, const vec3 fragPos, const vec3 lightPos) {
+   if (pointLightShadows.shadow[lightIndex].face[0].z == 0.0) {
+      return 0.0;
+   }
+
    const float bias = 0.0005;
    const float lightSize = pointLights.light[lightIndex].size;
    const vec3 fragToLight = fragPos - lightPos;
@@ -327,7 +371,7 @@ vec3 CalculateDirectionalLight(vec3 viewDir, vec3 normal, vec3 albedo, vec3 F0,
    // Lambertian diffuse term not scaled by 1/pi. See: https://seblagarde.wordpress.com/2012/01/08/pi-or-not-to-pi-in-game-lighting-equation/
    vec3 diffuseBRDF = Kd * albedo.rgb;
 
-   vec3 radiance = directionalLight.light.color * (1.0 - CalculateDirectionalShadow(inFragPosLightSpace, normal, lightDir));
+   vec3 radiance = directionalLight.light.color * (1.0 - CalculateDirectionalShadow(inFragPos, normal, lightDir));
 
    return (diffuseBRDF + specularBRDF) * radiance * NdotL;
 }
@@ -353,6 +397,7 @@ vec3 CalculatePointLight(uint lightIndex, vec3 viewDir, vec3 normal, vec3 albedo
    float notShadowed = 1.0 - CalculatePointShadow(lightIndex, inFragPos, lightPos);
    float distance = max(length(lightPos - inFragPos), 0.01);
    float attenuation = pointLights.light[lightIndex].power / (distance * distance);
+   attenuation *= RangeWindow(distance, LightRange(uboClusters.clusters, pointLights.light[lightIndex]));
    vec3 radiance = pointLights.light[lightIndex].color * attenuation * notShadowed;
    return (diffuseBRDF + specularBRDF) * radiance * NdotL;
 }
@@ -384,8 +429,9 @@ void main() {
 
    // Direct lighting from scene lights
    vec3 directLight = CalculateDirectionalLight(viewDir, normal, albedo.rgb, F0, metalness, roughness, NdotV);
-   for(uint i = 0; i < constants.numPointLights; ++i) {
-      directLight += CalculatePointLight(i, viewDir, normal, albedo.rgb, F0, metalness, roughness, NdotV);
+   const uvec2 cluster = clusterLightGrid.cluster[ClusterIndex(uboClusters.clusters, inFragPos)];
+   for(uint i = 0; i < cluster.y; ++i) {
+      directLight += CalculatePointLight(clusterLightIndices.index[cluster.x + i], viewDir, normal, albedo.rgb, F0, metalness, roughness, NdotV);
    }
 
    // Ambient lighting from environment maps
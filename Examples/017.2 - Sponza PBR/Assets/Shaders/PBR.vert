@@ -14,7 +14,6 @@ layout(push_constant) uniform PC {
    vec2 textureRepeat;
    float heightScale;
    float lightRadius;
-   uint numPointLights;
 } constants;
 
 layout(set = 0, binding = 0) uniform UBOMatrices {
@@ -27,13 +26,11 @@ layout(set = 1, binding = 0) uniform UBODirectionalLight {
 
 
 layout(location = 0) out vec3 outFragPos;
-layout(location = 1) out vec4 outFragPosLightSpace;
-layout(location = 2) out vec2 outTexCoords;
-layout(location = 3) out mat3 outTangentBasis;
+layout(location = 1) out vec2 outTexCoords;
+layout(location = 2) out mat3 outTangentBasis;
 
 void main() {
    outFragPos = vec3(constants.model * vec4(inPos, 1.0));
-   outFragPosLightSpace = uboMatrices.matrices.lightSpace * vec4(outFragPos, 1.0);
    outTexCoords = inTexCoords * constants.textureRepeat;
 
    vec3 T = normalize(vec3(constants.model * vec4(inTangent,   0.0)));
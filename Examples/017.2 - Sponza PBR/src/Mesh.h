@@ -31,6 +31,7 @@ namespace SponzaPBR {
       std::shared_ptr<Pikzel::Texture> AmbientOcclusionTexture;
       std::shared_ptr<Pikzel::Texture> NormalTexture;
       std::shared_ptr<Pikzel::Texture> HeightTexture;
+      float UVDensity = 0.0f;  // texture coordinate units per mesh space unit.  See Pikzel::CalculateUVDensity()
       uint32_t Index;
    };
 
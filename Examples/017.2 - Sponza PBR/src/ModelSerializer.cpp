@@ -1,6 +1,9 @@
 #include "ModelSerializer.h"
 
+#include "Pikzel/Renderer/ContentCache.h"
 #include "Pikzel/Renderer/RenderCore.h"
+#include "Pikzel/Scene/Mesh.h"
+#include "Pikzel/Scene/MeshOptimizer.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -12,6 +15,7 @@ namespace SponzaPBR {
    namespace ModelSerializer {
 
       std::unordered_map<std::string, std::shared_ptr<Pikzel::Texture>> g_TextureCache;
+      Pikzel::TextureStreamer* g_TextureStreamer = nullptr;
 
       const uint32_t g_AssimpProcessFlags =
          aiProcess_Triangulate |
@@ -44,7 +48,17 @@ namespace SponzaPBR {
             std::filesystem::path texturePath = modelDir / str.C_Str();
             if (g_TextureCache.find(texturePath.string()) == g_TextureCache.end()) {
                bool isSRGB = (type == aiTextureType_DIFFUSE);
-               g_TextureCache[texturePath.string()] = Pikzel::RenderCore::CreateTexture({ .path = texturePath, .format = (type == aiTextureType_DIFFUSE ? Pikzel::TextureFormat::SRGBA8 : Pikzel::TextureFormat::RGBA8) });
+               const Pikzel::TextureSettings settings = { .path = texturePath, .format = (type == aiTextureType_DIFFUSE ? Pikzel::TextureFormat::SRGBA8 : Pikzel::TextureFormat::RGBA8) };
+               if (g_TextureStreamer) {
+                  // POI: The texture is usable straight away (as a flat placeholder color), and its mip levels are streamed in over the next few frames
+                  const glm::vec4 placeholder =
+                     type == aiTextureType_NORMALS ? glm::vec4{ 0.5f, 0.5f, 1.0f, 1.0f } :  // unit Z
+                     type == aiTextureType_UNKNOWN ? glm::vec4{ 0.0f, 1.0f, 0.0f, 1.0f } :  // metallic-roughness: rough, not metal
+                     glm::vec4{ 0.5f, 0.5f, 0.5f, 1.0f };
+                  g_TextureCache[texturePath.string()] = g_TextureStreamer->CreateTexture(settings, placeholder);
+               } else {
+                  g_TextureCache[texturePath.string()] = Pikzel::ContentCache::CreateTexture(settings);
+               }
             }
             return g_TextureCache[texturePath.string()];
          }
@@ -96,9 +110,14 @@ namespace SponzaPBR {
             }
          }
 
+         // POI: Reorder triangles and vertices for better vertex cache, overdraw, and vertex fetch behaviour
+         const auto [before, after] = Pikzel::OptimizeMesh(vertices, indices);
+         PKZL_CORE_LOG_TRACE("   Mesh '{0}': ACMR {1:.3f} => {2:.3f}, ATVR {3:.3f} => {4:.3f}", pmesh->mName.C_Str(), before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+
          Mesh mesh;
          mesh.Transform = AssimpMat4ToGLMMat4(transform);
-         mesh.VertexBuffer = Pikzel::RenderCore::CreateVertexBuffer(
+         // POI: Buffers go through the content cache, so meshes with identical vertex (or index) data share one GPU buffer
+         mesh.VertexBuffer = Pikzel::ContentCache::CreateVertexBuffer(
             {
                { "inPos",     Pikzel::DataType::Vec3 },
                { "inNormal",  Pikzel::DataType::Vec3 },
@@ -109,7 +128,8 @@ namespace SponzaPBR {
             vertices.data()
          );
 
-         mesh.IndexBuffer = Pikzel::RenderCore::CreateIndexBuffer(indices.size(), indices.data());
+         mesh.IndexBuffer = Pikzel::ContentCache::CreateIndexBuffer(indices.size(), indices.data());
+         mesh.UVDensity = Pikzel::CalculateUVDensity(vertices, indices);
 
          if (pmesh->mMaterialIndex >= 0) {
             aiMaterial* material = pscene->mMaterials[pmesh->mMaterialIndex];
@@ -195,7 +215,7 @@ namespace SponzaPBR {
       }
 
 
-      std::unique_ptr<Model> Import(const std::filesystem::path& path) {
+      std::unique_ptr<Model> Import(const std::filesystem::path& path, Pikzel::TextureStreamer* textureStreamer) {
          std::unique_ptr model = std::make_unique<Model>();
 
          Assimp::Importer importer;
@@ -232,7 +252,9 @@ namespace SponzaPBR {
 
          std::filesystem::path modelDir = path;
          modelDir.remove_filename();
+         g_TextureStreamer = textureStreamer;
          ProcessNode(*model, mat , scene->mRootNode, scene, modelDir);
+         g_TextureStreamer = nullptr;
 
          return model;
       }
@@ -2,6 +2,8 @@
 
 #include "Model.h"
 
+#include "Pikzel/Renderer/TextureStreamer.h"
+
 #include <filesystem>
 #include <memory>
 
@@ -10,7 +12,8 @@ namespace SponzaPBR {
    // Eventually, the Pikzel engine will have its own model serializer.
    // In the meantime, this demo uses this one
    namespace ModelSerializer {
-      std::unique_ptr<Model> Import(const std::filesystem::path& path);
+      // If textureStreamer is given, then the model's textures are streamed in by it (rather than loaded before Import() returns)
+      std::unique_ptr<Model> Import(const std::filesystem::path& path, Pikzel::TextureStreamer* textureStreamer = nullptr);
       void ClearTextureCache();
    }
 
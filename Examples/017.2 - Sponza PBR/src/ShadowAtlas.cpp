@@ -0,0 +1,115 @@
+#include "ShadowAtlas.h"
+
+#include "Pikzel/Core/Core.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace SponzaPBR {
+
+   ShadowAtlas::ShadowAtlas(const uint32_t size, const uint32_t minTileSize)
+   : m_Size {size}
+   , m_MinTileSize {minTileSize}
+   {
+      PKZL_CORE_ASSERT(std::has_single_bit(size) && std::has_single_bit(minTileSize) && (minTileSize <= size), "ShadowAtlas size and minimum tile size must be powers of two!");
+      m_FreeTiles.resize(GetLevel(minTileSize) + 1);
+      m_FreeTiles[0].emplace_back(0, 0);
+   }
+
+
+   uint32_t ShadowAtlas::GetSize() const {
+      return m_Size;
+   }
+
+
+   uint32_t ShadowAtlas::GetMinTileSize() const {
+      return m_MinTileSize;
+   }
+
+
+   uint32_t ShadowAtlas::GetMaxTileSize() const {
+      return m_Size;
+   }
+
+
+   uint32_t ShadowAtlas::GetTileSize(const uint32_t size) const {
+      return std::clamp(std::bit_ceil(size), m_MinTileSize, m_Size);
+   }
+
+
+   std::optional<ShadowAtlas::Tile> ShadowAtlas::Allocate(const uint32_t size) {
+      const uint32_t tileSize = GetTileSize(size);
+      const uint32_t level = GetLevel(tileSize);
+
+      // find the smallest free tile that is big enough...
+      uint32_t freeLevel = level + 1;
+      while ((freeLevel > 0) && m_FreeTiles[freeLevel - 1].empty()) {
+         --freeLevel;
+      }
+      if (freeLevel == 0) {
+         return {};
+      }
+      --freeLevel;
+
+      glm::uvec2 offset = m_FreeTiles[freeLevel].back();
+      m_FreeTiles[freeLevel].pop_back();
+
+      // ...and split it down to the requested size.  Each split leaves three free "buddies" at the next level down
+      for (uint32_t splitSize = (m_Size >> freeLevel) / 2; freeLevel < level; splitSize /= 2) {
+         ++freeLevel;
+         m_FreeTiles[freeLevel].emplace_back(offset.x + splitSize, offset.y);
+         m_FreeTiles[freeLevel].emplace_back(offset.x, offset.y + splitSize);
+         m_FreeTiles[freeLevel].emplace_back(offset.x + splitSize, offset.y + splitSize);
+      }
+      return Tile {offset, tileSize};
+   }
+
+
+   void ShadowAtlas::Free(const Tile& tile) {
+      PKZL_CORE_ASSERT(tile.size >= m_MinTileSize, "Attempted to free invalid ShadowAtlas tile!");
+      glm::uvec2 offset = tile.offset;
+      uint32_t size = tile.size;
+      uint32_t level = GetLevel(size);
+
+      // merge with buddies for as long as all four are free
+      while (level > 0) {
+         const glm::uvec2 parent = offset - (offset % (size * 2));
+         const glm::uvec2 buddies[4] = {
+            parent,
+            {parent.x + size, parent.y},
+            {parent.x, parent.y + size},
+            {parent.x + size, parent.y + size}
+         };
+         auto& freeTiles = m_FreeTiles[level];
+         const bool allBuddiesFree = std::all_of(std::begin(buddies), std::end(buddies), [&](const glm::uvec2& buddy) {
+            return (buddy == offset) || (std::find(freeTiles.begin(), freeTiles.end(), buddy) != freeTiles.end());
+         });
+         if (!allBuddiesFree) {
+            break;
+         }
+         freeTiles.erase(std::remove_if(freeTiles.begin(), freeTiles.end(), [&](const glm::uvec2& freeTile) {
+            return std::find(std::begin(buddies), std::end(buddies), freeTile) != std::end(buddies);
+         }), freeTiles.end());
+         offset = parent;
+         size *= 2;
+         --level;
+      }
+      m_FreeTiles[level].emplace_back(offset);
+   }
+
+
+   uint64_t ShadowAtlas::GetFreeArea() const {
+      uint64_t area = 0;
+      for (uint32_t level = 0; level < m_FreeTiles.size(); ++level) {
+         const uint64_t tileSize = m_Size >> level;
+         area += m_FreeTiles[level].size() * tileSize * tileSize;
+      }
+      return area;
+   }
+
+
+   uint32_t ShadowAtlas::GetLevel(const uint32_t tileSize) const {
+      return std::countr_zero(m_Size) - std::countr_zero(tileSize);
+   }
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace SponzaPBR {
+
+   // Eventually, the Pikzel engine will have its own shadow system.
+   // In the meantime, this demo uses this allocator to share one big shadow map texture between many lights.
+   //
+   // Allocates square tiles, with power-of-two sizes, from a square (power-of-two sized) atlas.
+   // This is a two dimensional "buddy" allocator: a free tile is split into four half-size tiles as required, and
+   // when all four of those have been freed again they are merged back into the original tile.
+   class ShadowAtlas {
+   public:
+
+      struct Tile {
+         glm::uvec2 offset = {};  // in texels, from bottom-left of atlas
+         uint32_t size = 0;       // width (and height) in texels
+      };
+
+      ShadowAtlas(const uint32_t size, const uint32_t minTileSize);
+
+      uint32_t GetSize() const;
+      uint32_t GetMinTileSize() const;
+      uint32_t GetMaxTileSize() const;
+
+      // Returns the size of tile that Allocate() would actually give you if you asked for given size.
+      // (i.e. the given size rounded up to a power of two, and clamped to min and max tile sizes)
+      uint32_t GetTileSize(const uint32_t size) const;
+
+      // Allocate a tile of at least given size.  Returns empty if there is no space left for it
+      std::optional<Tile> Allocate(const uint32_t size);
+
+      void Free(const Tile& tile);
+
+      // Number of texels not currently allocated
+      uint64_t GetFreeArea() const;
+
+   private:
+      uint32_t GetLevel(const uint32_t tileSize) const;
+
+   private:
+      std::vector<std::vector<glm::uvec2>> m_FreeTiles;  // offsets of free tiles, indexed by level.  Level 0 is the whole atlas, each level after that is half the size of the one before
+      uint32_t m_Size;
+      uint32_t m_MinTileSize;
+   };
+
+}
@@ -1,4 +1,5 @@
 #include "ModelSerializer.h"
+#include "ShadowAtlas.h"
 
 #include "Pikzel/Pikzel.h"
 #include "Pikzel/Core/EntryPoint.h"
@@ -7,6 +8,19 @@
 constexpr float nearPlane = 100.0f;
 constexpr float farPlane = 0.01f;
 
+// Depth range over which the light cluster slices are distributed
+constexpr float clusterNear = 0.1f;
+constexpr float clusterFar = 100.0f;
+
+// Point light shadows are rendered into tiles of a shadow atlas.  Tile size is chosen for each light, between these limits
+constexpr uint32_t shadowAtlasSize = 8192;
+constexpr uint32_t minShadowTileSize = 64;
+constexpr uint32_t maxShadowTileSize = 1024;
+
+// Image based lighting is baked from this environment.  The baked textures are cached next to the source image.
+// Run with --bake-environment to (re)bake the cache offline, without starting the app.
+static const Pikzel::EnvironmentMapSettings environmentSettings = {.path = "Assets/Skyboxes/dikhololo_night_4k.hdr"};
+
 class SponzaPBRApp final : public Pikzel::Application {
 using super = Pikzel::Application;
 public:
@@ -14,11 +28,13 @@ public:
    : Pikzel::Application {{.title = APP_DESCRIPTION, .clearColor = Pikzel::sRGB{0.01f, 0.01f, 0.01f}, .isVSync = true}}
    , m_Input {GetWindow()}
    {
+      m_TextureStreamer = std::make_unique<Pikzel::TextureStreamer>();
       CreateVertexBuffers();
       CreateUniformBuffers();
       CreateTextures();
       CreateFramebuffers();
       CreatePipelines();
+      CreateShadowCache();
 
       m_Camera.projection = glm::perspective(m_Camera.fovRadians, static_cast<float>(GetWindow().GetWidth()) / static_cast<float>(GetWindow().GetHeight()), nearPlane, farPlane);
 
@@ -48,98 +64,97 @@ protected:
 
    virtual void Render() override {
       static float lightRadius = 10.0f; // TODO: set light radius appropriately
-      static glm::mat4 lightProjection = glm::perspective(glm::radians(90.0f), 1.0f, lightRadius, 0.01f);  // note: Pikzel uses reverse-Z so near and far planes are swapped
       static int skyboxLod = 1;
 
       PKZL_PROFILE_FUNCTION();
 
+      // POI: Upload the next few mip levels of the model's textures (within a per-frame budget)
+      m_TextureStreamer->Update();
+
       // update buffers
       glm::mat4 view = glm::lookAt(m_Camera.position, m_Camera.position + m_Camera.direction, m_Camera.upVector);
 
       Matrices matrices;
       matrices.viewProjection = m_Camera.projection * view;
-      matrices.lightSpace = m_LightSpace;
       matrices.eyePosition = m_Camera.position;
       m_BufferMatrices->CopyFromHost(0, sizeof(Matrices), &matrices);
       m_BufferDirectionalLight->CopyFromHost(0, sizeof(Pikzel::DirectionalLight) * m_DirectionalLights.size(), m_DirectionalLights.data());
       m_BufferPointLights->CopyFromHost(0, sizeof(Pikzel::PointLight) * m_PointLights.size(), m_PointLights.data());
 
-      // render to directional light shadow map
-      {
-         Pikzel::GraphicsContext& gc = m_FramebufferDirShadow->GetGraphicsContext();
-         gc.BeginFrame();
-         gc.Bind(*m_PipelineDirShadow);
-
-         // Model
-         glm::mat4 transform = glm::identity<glm::mat4>();
-         gc.PushConstant("constants.mvp"_hs, m_LightSpace * transform);
-         for (const auto& mesh : m_Model->Meshes) {
-            gc.PushConstant("constants.mvp"_hs, m_LightSpace * transform * mesh.Transform);
-            gc.DrawIndexed(*mesh.VertexBuffer, *mesh.IndexBuffer);
-         }
-
-         gc.EndFrame();
-         gc.SwapBuffers();
-      }
+      // POI: Fit the directional light's shadow cascades to the camera frustum
+      UpdateShadowCascades();
+      m_BufferShadowCascades->CopyFromHost(0, sizeof(ShadowCascades), &m_ShadowCascades);
+
+      Clusters clusters;
+      clusters.view = view;
+      clusters.projection = m_Camera.projection;
+      clusters.inverseProjection = glm::inverse(m_Camera.projection);
+      clusters.size = {Pikzel::RenderCore::LightClustersX, Pikzel::RenderCore::LightClustersY, Pikzel::RenderCore::LightClustersZ, static_cast<uint32_t>(m_PointLights.size())};
+      clusters.depthParams = {
+         clusterNear,
+         clusterFar,
+         static_cast<float>(Pikzel::RenderCore::LightClustersZ) / glm::log(clusterFar / clusterNear),
+         -static_cast<float>(Pikzel::RenderCore::LightClustersZ) * glm::log(clusterNear) / glm::log(clusterFar / clusterNear)
+      };
+      clusters.lightThreshold = 1.0f / (lightRadius * lightRadius); // range of a unit power white light is lightRadius
+      m_BufferClusters->CopyFromHost(0, sizeof(Clusters), &clusters);
 
-      // render to point light shadow map
+      // POI: Assign point lights to clusters.  The PBR shader then only needs to consider the lights in each fragment's cluster
       {
-         Pikzel::GraphicsContext& gcPtShadows = m_FramebufferPtShadow->GetGraphicsContext();
-         for (int i = 0; i < m_PointLights.size(); ++i) {
-            auto& light = m_PointLights[i];
-            std::array<glm::mat4, 6> lightViews = {
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 1.0f,  0.0f,  0.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {-1.0f,  0.0f,  0.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 0.0f,  1.0f,  0.0f}, glm::vec3 {0.0f,  0.0f,  1.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 0.0f, -1.0f,  0.0f}, glm::vec3 {0.0f,  0.0f, -1.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 0.0f,  0.0f,  1.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
-               lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 0.0f,  0.0f, -1.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
-            };
-            m_BufferLightViews->CopyFromHost(0, sizeof(glm::mat4) * lightViews.size(), lightViews.data());
-
-            gcPtShadows.BeginFrame(i == 0 ? Pikzel::BeginFrameOp::ClearAll : Pikzel::BeginFrameOp::ClearNone);
-            gcPtShadows.Bind(*m_PipelinePtShadow);
-            gcPtShadows.PushConstant("constants.lightIndex"_hs, i);
-            gcPtShadows.PushConstant("constants.lightRadius"_hs, lightRadius);
-            gcPtShadows.Bind("UBOLightViews"_hs, *m_BufferLightViews);
-            gcPtShadows.Bind("UBOPointLights"_hs, *m_BufferPointLights);
-
-            glm::mat4 transform = glm::identity<glm::mat4>();
-            gcPtShadows.PushConstant("constants.model"_hs, transform);
-            for (const auto& mesh : m_Model->Meshes) {
-               gcPtShadows.PushConstant("constants.model"_hs, transform * mesh.Transform);
-               gcPtShadows.DrawIndexed(*mesh.VertexBuffer, *mesh.IndexBuffer);
-            }
-
-            gcPtShadows.EndFrame();
-            gcPtShadows.SwapBuffers();
-         }
+         m_ComputeContext->Begin();
+         m_ComputeContext->Fill(*m_BufferClusterLightIndices, 0, 0, sizeof(uint32_t));
+         m_ComputeContext->Bind(*m_PipelineLightClusters);
+         m_ComputeContext->Bind("UBOClusters"_hs, *m_BufferClusters);
+         m_ComputeContext->Bind("PointLights"_hs, *m_BufferPointLights);
+         m_ComputeContext->Bind("ClusterLightGrid"_hs, *m_BufferClusterLightGrid);
+         m_ComputeContext->Bind("ClusterLightIndices"_hs, *m_BufferClusterLightIndices);
+         m_ComputeContext->Dispatch((Pikzel::RenderCore::NumLightClusters + 127) / 128, 1, 1);  // POI: the shader works in groups of 128 clusters
+         m_ComputeContext->WaitFor(m_FramebufferScene->GetGraphicsContext());  // POI: the previous frame's scene render may still be reading the cluster light lists
+         m_ComputeContext->End();
       }
 
+      // POI: Shadow maps are cached.  The light clustering (above) does not wait for them, so with a separate compute queue
+      //      the two run at the same time on the GPU.  A light's shadow map is only re-rendered when the light, or a shadow caster within
+      //      range of the light, changes.  For a static scene, this means shadows cost (almost) nothing.
+      UpdateShadowCache(lightRadius);
+      UpdateShadowAtlas(lightRadius, matrices.viewProjection);
+      RenderShadows(lightRadius);
+      m_BufferPointLightShadows->CopyFromHost(0, sizeof(PointLightShadow) * m_PointLightShadows.size(), m_PointLightShadows.data());
+
       // render scene
       {
 
          Pikzel::GraphicsContext& gc = m_FramebufferScene->GetGraphicsContext();
          gc.BeginFrame();
+         gc.WaitFor(*m_ComputeContext);  // POI: only the scene render needs the cluster light lists
 
          gc.Bind(*m_PipelinePBR);
          gc.PushConstant("constants.textureRepeat"_hs, glm::vec2{ 1.0, 1.0 });
          gc.PushConstant("constants.heightScale"_hs, 0.05f);
          gc.PushConstant("constants.lightRadius"_hs, lightRadius);
-         gc.PushConstant("constants.numPointLights"_hs, static_cast<uint32_t>(m_PointLights.size()));
          gc.Bind("UBOMatrices"_hs, *m_BufferMatrices);
+         gc.Bind("UBOClusters"_hs, *m_BufferClusters);
+         gc.Bind("UBOShadowCascades"_hs, *m_BufferShadowCascades);
          gc.Bind("UBODirectionalLight"_hs, *m_BufferDirectionalLight);
-         gc.Bind("UBOPointLights"_hs, *m_BufferPointLights);
-         gc.Bind("uDirShadowMap"_hs, m_FramebufferDirShadow->GetDepthTexture());
+         gc.Bind("PointLights"_hs, *m_BufferPointLights);
+         gc.Bind("ClusterLightGrid"_hs, *m_BufferClusterLightGrid);
+         gc.Bind("ClusterLightIndices"_hs, *m_BufferClusterLightIndices);
          gc.Bind("uDirShadowMap"_hs, m_FramebufferDirShadow->GetDepthTexture());
-         gc.Bind("uPtShadowMap"_hs, m_FramebufferPtShadow->GetDepthTexture());
-         gc.Bind("uIrradiance"_hs, *m_Irradiance);
-         gc.Bind("uSpecularIrradiance"_hs, *m_SpecularIrradiance);
-         gc.Bind("uSpecularBRDF_LUT"_hs, *m_SpecularBRDF_LUT);
+         gc.Bind("uPtShadowAtlas"_hs, m_FramebufferShadowAtlas->GetDepthTexture());
+         gc.Bind("PointLightShadows"_hs, *m_BufferPointLightShadows);
+         gc.Bind("uIrradiance"_hs, m_Environment->GetIrradiance());
+         gc.Bind("uSpecularIrradiance"_hs, m_Environment->GetSpecularIrradiance());
+         gc.Bind("uSpecularBRDF_LUT"_hs, m_Environment->GetSpecularBRDF_LUT());
 
          glm::mat4 transform = glm::identity<glm::mat4>();
          gc.PushConstant("constants.model"_hs, transform);
          for (const auto& mesh : m_Model->Meshes) {
+            // POI: Tell the texture streamer how big this mesh's textures are on screen, so that it can stream the ones that need it most first
+            const float pixelsPerUV = Pikzel::SceneRenderer::GetPixelsPerUV(m_Camera, GetWindow().GetHeight(), transform * mesh.Transform, mesh.AABB, mesh.UVDensity);
+            for (const Pikzel::Texture* texture : {mesh.AlbedoTexture.get(), mesh.MetallicRoughnessTexture.get(), mesh.NormalTexture.get(), mesh.AmbientOcclusionTexture.get(), mesh.HeightTexture.get()}) {
+               m_TextureStreamer->ReportPixelsPerUV(*texture, pixelsPerUV);
+            }
+
             gc.PushConstant("constants.model"_hs, transform * mesh.Transform);
             gc.Bind("uAlbedo"_hs, *mesh.AlbedoTexture);
             gc.Bind("uMetallicRoughness"_hs, *mesh.MetallicRoughnessTexture);
@@ -161,7 +176,7 @@ protected:
          // Skybox
          view = glm::mat3(view);
          gc.Bind(*m_PipelineSkybox);
-         gc.Bind("uSkybox"_hs, *m_Skybox);
+         gc.Bind("uSkybox"_hs, m_Environment->GetSkybox());
          gc.PushConstant("constants.vp"_hs, m_Camera.projection * view);
          gc.PushConstant("constants.lod"_hs, skyboxLod);
          gc.DrawTriangles(*m_VertexBuffer, 36, 6);
@@ -186,6 +201,23 @@ protected:
             ImGuiDrawPointLight(fmt::format("light {0}", i).c_str(), m_PointLights[i]);
          }
          ImGui::Text("Frame time: %.3fms (%.0f FPS)", m_DeltaTime.count() * 1000.0f, 1.0f / m_DeltaTime.count());
+         ImGui::Text("Environment map: %.1fms (%s)", m_Environment->GetLoadMilliseconds(), m_Environment->IsFromCache() ? "cached" : "baked");
+         const auto& streamStats = m_TextureStreamer->GetStats();
+         ImGui::Text("Textures streaming: %d (%d decoding), %.1f MiB uploaded this frame, %.1f MiB pending", streamStats.TexturesStreaming, streamStats.TexturesDecoding, streamStats.BytesUploaded / (1024.0f * 1024.0f), streamStats.BytesPending / (1024.0f * 1024.0f));
+         const auto contentStats = Pikzel::ContentCache::GetStats();
+         ImGui::Text("Shared resources: %d of %d, %.1f MiB saved by sharing (%.1f MiB used)", contentStats.SharedResources, contentStats.Resources, contentStats.BytesSaved / (1024.0f * 1024.0f), contentStats.Bytes / (1024.0f * 1024.0f));
+         ImGui::Text("Shadow maps rendered: %d (%d casters)", m_ShadowMapsRendered, m_ShadowCastersDrawn);
+         ImGui::SliderFloat("Shadow budget (ms)", &m_ShadowBudgetMs, 0.0f, 10.0f);
+         ImGui::Text("Shadow atlas: %.1f%% used", 100.0f * (1.0f - static_cast<float>(m_ShadowAtlas.GetFreeArea()) / (static_cast<float>(shadowAtlasSize) * static_cast<float>(shadowAtlasSize))));
+         ImGui::SliderFloat("Shadow resolution scale", &m_ShadowResolutionScale, 0.25f, 4.0f);
+         bool refitCascades = false;
+         refitCascades |= ImGui::SliderInt("Shadow cascades", &m_NumCascades, 1, static_cast<int>(Pikzel::RenderCore::MaxShadowCascades));
+         refitCascades |= ImGui::SliderInt("Dynamic cascades", &m_NumDynamicCascades, 0, m_NumCascades);
+         refitCascades |= ImGui::SliderFloat("Shadow distance", &m_ShadowDistance, 1.0f, 100.0f);
+         refitCascades |= ImGui::SliderFloat("Cascade split lambda", &m_CascadeSplitLambda, 0.0f, 1.0f);
+         if (refitCascades) {
+            InvalidateShadowCascades();
+         }
          ImGui::Text("Tone mapping:");
          ImGui::RadioButton("None", &m_ToneMap, 0);
          ImGui::RadioButton("Reinhard", &m_ToneMap, 1);
@@ -193,11 +225,13 @@ protected:
          ImGui::SameLine();
          ImGui::DragFloat("", &m_Exposure, 0.1f, 0, 10);
          ImGui::InputInt("Lod", &skyboxLod, 1.0f);
-
-         ImGui::Text("Depth buffer:");
-         ImVec2 size = ImGui::GetContentRegionAvail();
-         ImGui::Image(m_FramebufferDirShadow->GetImGuiDepthTextureId(), size, ImVec2 {0, 1}, ImVec2 {1, 0});
+         for (int i = 0; i < m_NumCascades; ++i) {
+            ImGui::Text("Cascade %d: %.1fm (%s)", i, m_ShadowCascades.splits[i], i < m_NumDynamicCascades ? "dynamic" : "cached");
+         }
          ImGui::End();
+
+         // POI: Edit a shader while this is running, and it is recompiled and swapped in.  Compile errors are shown here
+         Pikzel::ImGuiEx::ShaderErrors();
       }
       GetWindow().EndImGuiFrame();
       GetWindow().EndFrame();
@@ -352,124 +386,61 @@ private:
 
 
       // POI: load model
-      m_Model = SponzaPBR::ModelSerializer::Import("Assets/Models/Sponza/Sponza.gltf");
+      m_Model = SponzaPBR::ModelSerializer::Import("Assets/Models/Sponza/Sponza.gltf", m_TextureStreamer.get());
    }
 
 
    struct Matrices {
       glm::mat4 viewProjection;
-      glm::mat4 lightSpace;
       glm::vec3 eyePosition;
    };
 
-   void CreateUniformBuffers() {
-      glm::mat4 lightProjection = glm::ortho(-21.0f, 21.0f, -20.0f, 20.0f, 20.0f, -10.0f);  // TODO: need to automatically determine correct parameters here (+ cascades...)
-      glm::mat4 lightView = glm::lookAt(-m_DirectionalLights[0].direction, glm::vec3 {0.0f, 0.0f, 0.0f}, glm::vec3 {0.0f, 1.0f, 0.0f});
-      m_LightSpace = lightProjection * lightView;
+   // note: must match PointLightShadow struct in Lights.glsl
+   struct PointLightShadow {
+      glm::vec4 face[6];
+   };
+
+   // note: must match ShadowCascades struct in Lights.glsl
+   struct ShadowCascades {
+      glm::mat4 lightSpace[Pikzel::RenderCore::MaxShadowCascades];
+      glm::vec4 splits;
+      glm::vec4 invWidth;
+      alignas(16) glm::vec3 viewDirection;
+      int count;
+   };
+
+   // note: must match Clusters struct in Pikzel's Renderer/Shaders/Clusters.glsl
+   struct Clusters {
+      glm::mat4 view;
+      glm::mat4 projection;
+      glm::mat4 inverseProjection;
+      glm::uvec4 size;
+      glm::vec4 depthParams;
+      float lightThreshold;
+   };
 
+   void CreateUniformBuffers() {
       m_BufferMatrices = Pikzel::RenderCore::CreateUniformBuffer(sizeof(Matrices));
       m_BufferDirectionalLight = Pikzel::RenderCore::CreateUniformBuffer(sizeof(Pikzel::DirectionalLight) * m_DirectionalLights.size());
       m_BufferLightViews = Pikzel::RenderCore::CreateUniformBuffer(sizeof(glm::mat4) * m_PointLights.size() * 6);
-      m_BufferPointLights = Pikzel::RenderCore::CreateUniformBuffer(sizeof(Pikzel::PointLight) * m_PointLights.size());
+      m_BufferPointLights = Pikzel::RenderCore::CreateStorageBuffer(sizeof(Pikzel::PointLight) * m_PointLights.size());
+      m_BufferPointLightShadows = Pikzel::RenderCore::CreateStorageBuffer(sizeof(PointLightShadow) * m_PointLights.size());
+      m_BufferShadowCascades = Pikzel::RenderCore::CreateUniformBuffer(sizeof(ShadowCascades));
+      m_BufferClusters = Pikzel::RenderCore::CreateUniformBuffer(sizeof(Clusters));
+      m_BufferClusterLightGrid = Pikzel::RenderCore::CreateStorageBuffer(sizeof(glm::uvec2) * Pikzel::RenderCore::NumLightClusters);
+      m_BufferClusterLightIndices = Pikzel::RenderCore::CreateStorageBuffer(sizeof(uint32_t) * (1 + Pikzel::RenderCore::MaxLightIndices));
    }
 
 
    void CreateTextures() {
-      m_Skybox = Pikzel::RenderCore::CreateTexture({.textureType = Pikzel::TextureType::TextureCube, .path = "Assets/Skyboxes/dikhololo_night_4k.hdr"});
-
-      // POI: We use compute shaders to bake lighting from the skybox image into diffuse and specular "Irradiance maps"
-
-      // diffuse irradiance
-      m_Irradiance = Pikzel::RenderCore::CreateTexture({
-         .textureType = Pikzel::TextureType::TextureCube,
-         .width = 32,                                // POI: The diffuse irradiance map does not need to be very big
-         .height = 32,
-         .format = Pikzel::TextureFormat::RGBA16F,
-         .imageStorage = true                        // POI: Textures that will be written to in a shader need this flag set (because Vulkan), and also need to be Commit()'d before you use them in shader
-      });
-      std::unique_ptr<Pikzel::ComputeContext> compute = Pikzel::RenderCore::CreateComputeContext();
-      std::unique_ptr<Pikzel::Pipeline> pipelineIrradiance = compute->CreatePipeline({
-         .shaders = {
-            { Pikzel::ShaderType::Compute, "Renderer/EnvironmentIrradiance.comp.spv"}
-         }
-      });
- 
-      compute->Begin();
-      compute->Bind(*pipelineIrradiance);
-      compute->Bind("inputTexture"_hs, *m_Skybox);
-      compute->Bind("outputTexture"_hs, *m_Irradiance);
-      compute->Dispatch(m_Irradiance->GetWidth() / 32, m_Irradiance->GetHeight() / 32, 6);  // POI: width and height divided by 32 because the shader works in 32x32 blocks.  z is 6 for the six faces of the cube
-      compute->End();
-      m_Irradiance->Commit(0);
-
-      // specular irradiance
-      m_SpecularIrradiance = Pikzel::RenderCore::CreateTexture({
-         .textureType = Pikzel::TextureType::TextureCube,
-         .width = m_Skybox->GetWidth(),                              // POI: The specular irradiance map cannot be as small as the diffuse one, otherwise details will be lost in reflections off highly reflective materials.
-         .height = m_Skybox->GetHeight(),
-         .format = Pikzel::TextureFormat::RGBA16F,
-         .imageStorage = true
-      });
-
-      // POI: specular irradiance mip level 0 is a straight copy of the skybox.
-      //      this level is used for perfectly reflective materials
-      m_SpecularIrradiance->CopyFrom(*m_Skybox);
-
-      // POI: specular irradiance mip levels 1..N are computed by pre-filtering the skybox
-      //      per Epic Games split sum approximation.
-      std::unique_ptr<Pikzel::Pipeline> pipelinePrefilter = compute->CreatePipeline({
-         .shaders = {
-            { Pikzel::ShaderType::Compute, "Renderer/EnvironmentPrefilter.comp.spv"}
-         }
-      });
-      const float deltaRoughness = 0.5f / static_cast<float>(m_SpecularIrradiance->GetMIPLevels() - 1);
-      for (uint32_t level = 1; level < m_SpecularIrradiance->GetMIPLevels(); ++level) {
-         compute->Begin();
-         compute->Bind(*pipelinePrefilter);
-         compute->PushConstant("constants.roughness"_hs, level * deltaRoughness);
-         compute->Bind("inputTexture"_hs, *m_Skybox);
-         compute->Bind("outputTexture"_hs, *m_SpecularIrradiance, level);
-         compute->Dispatch(
-            std::max(1u, m_SpecularIrradiance->GetWidth() / (1 << level) / 32),
-            std::max(1u, m_SpecularIrradiance->GetHeight() / (1 << level) / 32),
-            6
-         );
-         compute->End();
-      }
-      m_SpecularIrradiance->Commit(/*generateMipmap = */false);
-
-      // POI: We also use a compute shader to pre-calculate the specular BRDF values and store them in a lookup table (packed into a texture)
-      //      These values do not depend on the skybox and could just be loaded from a texture stored on disk.
-      //      However, its just as fast to compute them as it is to load a texture from disk, and precomputing has a couple of advantages:
-      //      * don't need to distribute yet another texture with the compiled binaries
-      //      * can easily vary the parameters (in particular the size of the texture) here
-      m_SpecularBRDF_LUT = Pikzel::RenderCore::CreateTexture({
-         .width = 512,
-         .height = 512,
-         .format = Pikzel::TextureFormat::RG16F,      // POI: The lookup table only needs two dimensions. Which we store as 16-bit floats in the Red and Green channels.
-         .wrapU = Pikzel::TextureWrap::ClampToEdge,   // POI: The lookup table must clamp to edge, otherwise there will be artefacts when looking up the table for values near the edges
-         .wrapV = Pikzel::TextureWrap::ClampToEdge,
-         .mipLevels = 1,
-         .imageStorage = true
-      });
-      std::unique_ptr<Pikzel::Pipeline> pipelineSpecularBRDF = compute->CreatePipeline({
-         .shaders = {
-            { Pikzel::ShaderType::Compute, "Renderer/EnvironmentSpecularBRDF.comp.spv"}
-         }
-      });
-      compute->Begin();
-      compute->Bind(*pipelineSpecularBRDF);
-      compute->Bind("LUT"_hs, *m_SpecularBRDF_LUT);
-      compute->Dispatch(m_SpecularBRDF_LUT->GetWidth() / 32, m_SpecularBRDF_LUT->GetHeight() / 32, 1);
-      compute->End();
-      m_SpecularBRDF_LUT->Commit(0);
+      // POI: The skybox cubemap, diffuse and specular "irradiance maps", and specular BRDF lookup table are baked from the
+      //      environment image with compute shaders.  See 017.1 - PBR for how that is done.
+      //      Baking is slow, so EnvironmentMap caches the results on disk, and loads them directly from there next time.
+      m_Environment = std::make_unique<Pikzel::EnvironmentMap>(environmentSettings);
    }
 
 
    void CreateFramebuffers() {
-      const uint32_t shadowMapWidth = 4096;
-      const uint32_t shadowMapHeight = 4096;
-
       m_FramebufferScene = Pikzel::RenderCore::CreateFramebuffer({
          .width = GetWindow().GetWidth(),
          .height = GetWindow().GetHeight(),
@@ -481,26 +452,40 @@ private:
          }
       });
 
+      // POI: The directional light shadow map is an array, with one layer for each cascade
       if (!m_FramebufferDirShadow) {
          m_FramebufferDirShadow = Pikzel::RenderCore::CreateFramebuffer({
-            .width = shadowMapWidth,
-            .height = shadowMapHeight,
-            .attachments = {{Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F}}
+            .width = Pikzel::RenderCore::ShadowCascadeSize,
+            .height = Pikzel::RenderCore::ShadowCascadeSize,
+            .layers = Pikzel::RenderCore::MaxShadowCascades,
+            .attachments = {{Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F, Pikzel::TextureType::Texture2DArray}}
          });
       }
 
-       if (!m_FramebufferPtShadow) {
-         m_FramebufferPtShadow = Pikzel::RenderCore::CreateFramebuffer({
-            .width = shadowMapWidth / 2,
-            .height = shadowMapHeight / 2,
-            .layers = 4,
-            .attachments = {{Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F, Pikzel::TextureType::TextureCubeArray}}
+      // POI: All point light shadows share one big depth texture (the shadow atlas)
+      if (!m_FramebufferShadowAtlas) {
+         m_FramebufferShadowAtlas = Pikzel::RenderCore::CreateFramebuffer({
+            .width = shadowAtlasSize,
+            .height = shadowAtlasSize,
+            .attachments = {{Pikzel::AttachmentType::Depth, Pikzel::TextureFormat::D32F}}
          });
+
+         Pikzel::GraphicsContext& gc = m_FramebufferShadowAtlas->GetGraphicsContext();
+         gc.BeginFrame(Pikzel::BeginFrameOp::ClearAll);
+         gc.EndFrame();
+         gc.SwapBuffers();
       }
    }
 
 
    void CreatePipelines() {
+      m_ComputeContext = Pikzel::RenderCore::CreateComputeContext();
+      m_PipelineLightClusters = m_ComputeContext->CreatePipeline({
+         .shaders = {
+            { Pikzel::ShaderType::Compute, "Renderer/LightClusters.comp.spv" }
+         }
+      });
+
       m_PipelineSkybox = m_FramebufferScene->GetGraphicsContext().CreatePipeline({
          .shaders = {
             { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/Skybox.vert.spv" },
@@ -527,16 +512,16 @@ private:
       m_PipelineDirShadow = m_FramebufferDirShadow->GetGraphicsContext().CreatePipeline({
          .shaders = {
             { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/Depth.vert.spv" },
+            { Pikzel::ShaderType::Geometry, "Assets/" APP_NAME "/Shaders/Depth.geom.spv" },
             { Pikzel::ShaderType::Fragment, "Assets/" APP_NAME "/Shaders/Depth.frag.spv" }
          },
          .bufferLayout = layout
       });
 
-      m_PipelinePtShadow = m_FramebufferPtShadow->GetGraphicsContext().CreatePipeline({
+      m_PipelinePtShadow = m_FramebufferShadowAtlas->GetGraphicsContext().CreatePipeline({
          .shaders = {
-            { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/DepthCube.vert.spv" },
-            { Pikzel::ShaderType::Geometry, "Assets/" APP_NAME "/Shaders/DepthCube.geom.spv" },
-            { Pikzel::ShaderType::Fragment, "Assets/" APP_NAME "/Shaders/DepthCube.frag.spv" }
+            { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/DepthAtlas.vert.spv" },
+            { Pikzel::ShaderType::Fragment, "Assets/" APP_NAME "/Shaders/DepthAtlas.frag.spv" }
          },
          .bufferLayout = layout,
       });
@@ -560,6 +545,425 @@ private:
    }
 
 
+   // Force all shadow cascades to be re-fitted (and hence re-rendered) next frame
+   void InvalidateShadowCascades() {
+      for (auto& cascade : m_Cascades) {
+         cascade.radius = 0.0f;
+         cascade.isDirty = true;
+      }
+   }
+
+
+   // POI: Cascaded shadow maps.
+   //      The camera frustum (out to m_ShadowDistance) is split into slices, and each slice gets its own shadow map (cascade).
+   //      Near cascades cover a small area at high resolution, far ones cover a large area at lower resolution.
+   //      To avoid shimmering edges as the camera moves, each cascade is fitted to a bounding sphere of its slice (so its size
+   //      does not change as the camera turns) and its position is snapped to whole shadow map texels.
+   //      Near ("dynamic") cascades are re-fitted every frame.  Far ("cached") cascades are fitted to a larger region, and left
+   //      alone until the camera moves far enough that the slice no longer fits.  Since the snapped fit only changes when the
+   //      camera moves, a cascade is only re-rendered when the fit changes, or a caster in it moves (see UpdateShadowCache())
+   void UpdateShadowCascades() {
+      PKZL_PROFILE_FUNCTION();
+
+      const float cachedCascadePadding = 1.5f;
+      const float cascadeSize = static_cast<float>(Pikzel::RenderCore::ShadowCascadeSize);
+
+      const glm::vec3 lightDir = glm::normalize(m_DirectionalLights[0].direction);
+      if (lightDir != m_CachedLightDirection) {
+         m_CachedLightDirection = lightDir;
+         InvalidateShadowCascades();
+      }
+      const glm::mat4 lightView = glm::lookAt(glm::vec3 {0.0f}, lightDir, glm::abs(lightDir.y) > 0.99f ? glm::vec3 {0.0f, 0.0f, 1.0f} : glm::vec3 {0.0f, 1.0f, 0.0f});
+
+      // Depth range of each cascade covers the whole model (rounded to whole units, so that it does not change as the camera moves).
+      // This makes sure that casters between the light and the slice are included.
+      const auto modelAABB = WorldAABB(m_Model->AABB, lightView);
+      const float zMin = glm::floor(modelAABB.first.z);
+      const float zMax = glm::ceil(modelAABB.second.z);
+
+      const float aspect = static_cast<float>(GetWindow().GetWidth()) / static_cast<float>(GetWindow().GetHeight());
+      const float tanHalfFovY = glm::tan(m_Camera.fovRadians * 0.5f);
+      const float tanHalfFovX = tanHalfFovY * aspect;
+      const glm::vec3 right = glm::normalize(glm::cross(m_Camera.direction, m_Camera.upVector));
+      const glm::vec3 up = glm::cross(right, m_Camera.direction);
+
+      float splitNear = farPlane;  // note: Pikzel uses reverse-Z so near and far planes are swapped
+      for (int i = 0; i < m_NumCascades; ++i) {
+         // split distances are a blend of logarithmic and uniform distributions
+         const float t = static_cast<float>(i + 1) / static_cast<float>(m_NumCascades);
+         const float logSplit = farPlane * glm::pow(m_ShadowDistance / farPlane, t);
+         const float uniformSplit = farPlane + (m_ShadowDistance - farPlane) * t;
+         const float splitFar = glm::mix(uniformSplit, logSplit, m_CascadeSplitLambda);
+
+         // bounding sphere of the slice
+         glm::vec3 sphereCentre = {};
+         std::array<glm::vec3, 8> corners;
+         for (int j = 0; j < 8; ++j) {
+            const float depth = (j & 4) ? splitFar : splitNear;
+            corners[j] = m_Camera.position + (m_Camera.direction * depth) + (right * (((j & 1) ? 1.0f : -1.0f) * depth * tanHalfFovX)) + (up * (((j & 2) ? 1.0f : -1.0f) * depth * tanHalfFovY));
+            sphereCentre += corners[j] / 8.0f;
+         }
+         float sphereRadius = 0.0f;
+         for (const auto& corner : corners) {
+            sphereRadius = glm::max(sphereRadius, glm::length(corner - sphereCentre));
+         }
+         sphereRadius = glm::ceil(sphereRadius * 16.0f) / 16.0f;
+         const glm::vec2 centre = glm::vec2 {lightView * glm::vec4 {sphereCentre, 1.0f}};
+
+         Cascade& cascade = m_Cascades[i];
+         const bool isCached = i >= m_NumDynamicCascades;
+         const bool isCovered = glm::all(glm::lessThanEqual(glm::abs(centre - cascade.centre) + sphereRadius, glm::vec2 {cascade.radius}));
+         if (!isCached || !isCovered) {
+            const float radius = isCached ? sphereRadius * cachedCascadePadding : sphereRadius;
+            const float texelSize = 2.0f * radius / cascadeSize;
+            const glm::vec2 snappedCentre = glm::floor(centre / texelSize) * texelSize;
+            const glm::mat4 lightProjection = glm::ortho(snappedCentre.x - radius, snappedCentre.x + radius, snappedCentre.y - radius, snappedCentre.y + radius, -zMin, -zMax); // note: Pikzel uses reverse-Z so near and far planes are swapped
+            const glm::mat4 lightSpace = lightProjection * lightView;
+            if (lightSpace != cascade.lightSpace) {
+               cascade.lightSpace = lightSpace;
+               cascade.isDirty = true;
+            }
+            cascade.centre = snappedCentre;
+            cascade.radius = radius;
+         }
+
+         m_ShadowCascades.lightSpace[i] = cascade.lightSpace;
+         m_ShadowCascades.splits[i] = splitFar;
+         m_ShadowCascades.invWidth[i] = 1.0f / (2.0f * cascade.radius);
+         splitNear = splitFar;
+      }
+      m_ShadowCascades.viewDirection = m_Camera.direction;
+      m_ShadowCascades.count = m_NumCascades;
+   }
+
+
+   // POI: Each shadow map is kept until something that affects it changes.
+   //      Here we remember what each shadow map was rendered with, so that we can tell when that happens.
+   void CreateShadowCache() {
+      InvalidateShadowCascades();
+
+      m_CachedPointLightPositions.clear();
+      for (const auto& pointLight : m_PointLights) {
+         m_CachedPointLightPositions.emplace_back(pointLight.position);
+      }
+      m_PtShadowDirty.assign(m_PointLights.size(), true);
+      m_PtShadowTiles.assign(m_PointLights.size(), {});
+      m_PointLightShadows.assign(m_PointLights.size(), {});
+      m_NextPtShadow = 0;
+
+      m_CachedMeshTransforms.clear();
+      m_MeshWorldAABBs.clear();
+      for (const auto& mesh : m_Model->Meshes) {
+         m_CachedMeshTransforms.emplace_back(mesh.Transform);
+         m_MeshWorldAABBs.emplace_back(WorldAABB(mesh.AABB, mesh.Transform));
+      }
+   }
+
+
+   // Compare lights and shadow casters against what the cached shadow maps were rendered with, and mark
+   // shadow maps that are out of date as dirty
+   void UpdateShadowCache(const float lightRadius) {
+      PKZL_PROFILE_FUNCTION();
+
+      for (size_t i = 0; i < m_PointLights.size(); ++i) {
+         if (m_PointLights[i].position != m_CachedPointLightPositions[i]) {
+            m_CachedPointLightPositions[i] = m_PointLights[i].position;
+            m_PtShadowDirty[i] = true;
+         }
+      }
+
+      // POI: A caster that moves invalidates only the lights whose range it was in, or is now in.
+      for (const auto& mesh : m_Model->Meshes) {
+         if (mesh.Transform != m_CachedMeshTransforms[mesh.Index]) {
+            const auto oldAABB = m_MeshWorldAABBs[mesh.Index];
+            const auto newAABB = WorldAABB(mesh.AABB, mesh.Transform);
+            for (int i = 0; i < m_NumCascades; ++i) {
+               if (AABBIntersectsLightSpace(oldAABB, m_Cascades[i].lightSpace) || AABBIntersectsLightSpace(newAABB, m_Cascades[i].lightSpace)) {
+                  m_Cascades[i].isDirty = true;
+               }
+            }
+            for (size_t i = 0; i < m_PointLights.size(); ++i) {
+               if (SphereIntersectsAABB(m_PointLights[i].position, lightRadius, oldAABB) || SphereIntersectsAABB(m_PointLights[i].position, lightRadius, newAABB)) {
+                  m_PtShadowDirty[i] = true;
+               }
+            }
+            m_CachedMeshTransforms[mesh.Index] = mesh.Transform;
+            m_MeshWorldAABBs[mesh.Index] = newAABB;
+         }
+      }
+   }
+
+
+   // Re-render dirty shadow maps.
+   // Point light shadow maps are refreshed round-robin until the time budget is used up, so that if many lights change
+   // at once, the cost is spread over several frames.  At least one is refreshed per frame so that they all get there eventually.
+   void RenderShadows(const float lightRadius) {
+      PKZL_PROFILE_FUNCTION();
+
+      const auto startTime = std::chrono::steady_clock::now();
+      const auto budget = std::chrono::duration<float, std::milli>{m_ShadowBudgetMs};
+      m_ShadowMapsRendered = 0;
+      m_ShadowCastersDrawn = 0;
+
+      for (int i = 0; i < m_NumCascades; ++i) {
+         if (m_Cascades[i].isDirty) {
+            RenderDirShadow(i);
+            m_Cascades[i].isDirty = false;
+            ++m_ShadowMapsRendered;
+         }
+      }
+
+      uint32_t numPtShadowsRendered = 0;
+      for (size_t n = 0; n < m_PointLights.size(); ++n) {
+         const size_t i = (m_NextPtShadow + n) % m_PointLights.size();
+         if (m_PtShadowDirty[i]) {
+            if ((numPtShadowsRendered > 0) && (std::chrono::steady_clock::now() - startTime > budget)) {
+               m_NextPtShadow = i;
+               break;
+            }
+            if (m_PtShadowTiles[i][0].size == 0) {
+               // no space in shadow atlas for this light
+               m_PtShadowDirty[i] = false;
+               continue;
+            }
+            RenderPtShadow(i, lightRadius);
+            m_PtShadowDirty[i] = false;
+            ++numPtShadowsRendered;
+            ++m_ShadowMapsRendered;
+         }
+      }
+   }
+
+
+   void RenderDirShadow(const int cascadeIndex) {
+      PKZL_PROFILE_FUNCTION();
+
+      // POI: Each cascade is a layer of the shadow map array.  Clear (and then render to) just that layer.
+      const Cascade& cascade = m_Cascades[cascadeIndex];
+      Pikzel::GraphicsContext& gc = m_FramebufferDirShadow->GetGraphicsContext();
+      gc.BeginFrame(Pikzel::BeginFrameOp::ClearNone);
+      gc.ClearDepth({0, 0}, {m_FramebufferDirShadow->GetWidth(), m_FramebufferDirShadow->GetHeight()}, static_cast<uint32_t>(cascadeIndex), 1);
+      gc.Bind(*m_PipelineDirShadow);
+      gc.PushConstant("constants.cascade"_hs, cascadeIndex);
+
+      // POI: only draw casters that are inside the cascade's view volume
+      for (const auto& mesh : m_Model->Meshes) {
+         if (AABBIntersectsLightSpace(m_MeshWorldAABBs[mesh.Index], cascade.lightSpace)) {
+            gc.PushConstant("constants.mvp"_hs, cascade.lightSpace * mesh.Transform);
+            gc.DrawIndexed(*mesh.VertexBuffer, *mesh.IndexBuffer);
+            ++m_ShadowCastersDrawn;
+         }
+      }
+
+      gc.EndFrame();
+      gc.SwapBuffers();
+   }
+
+
+   void RenderPtShadow(const size_t lightIndex, const float lightRadius) {
+      PKZL_PROFILE_FUNCTION();
+
+      const glm::mat4 lightProjection = glm::perspective(glm::radians(90.0f), 1.0f, lightRadius, 0.01f);  // note: Pikzel uses reverse-Z so near and far planes are swapped
+      const auto& light = m_PointLights[lightIndex];
+      std::array<glm::mat4, 6> lightViews = {
+         lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 1.0f,  0.0f,  0.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
+         lightProjection * glm::lookAt(light.position, light.position + glm::vec3 {-1.0f,  0.0f,  0.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
+         lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 0.0f,  1.0f,  0.0f}, glm::vec3 {0.0f,  0.0f,  1.0f}),
+         lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 0.0f, -1.0f,  0.0f}, glm::vec3 {0.0f,  0.0f, -1.0f}),
+         lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 0.0f,  0.0f,  1.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
+         lightProjection * glm::lookAt(light.position, light.position + glm::vec3 { 0.0f,  0.0f, -1.0f}, glm::vec3 {0.0f, -1.0f,  0.0f}),
+      };
+      m_BufferLightViews->CopyFromHost(0, sizeof(glm::mat4) * lightViews.size(), lightViews.data());
+
+      // POI: Other lights' shadow maps are still valid, so we must not clear the whole atlas.
+      //      Instead, each face is rendered into (and clears) just its own tile.
+      Pikzel::GraphicsContext& gc = m_FramebufferShadowAtlas->GetGraphicsContext();
+      gc.BeginFrame(Pikzel::BeginFrameOp::ClearNone);
+      gc.Bind(*m_PipelinePtShadow);
+      gc.PushConstant("constants.lightIndex"_hs, static_cast<int>(lightIndex));
+      gc.PushConstant("constants.lightRadius"_hs, lightRadius);
+      gc.Bind("UBOLightViews"_hs, *m_BufferLightViews);
+      gc.Bind("PointLights"_hs, *m_BufferPointLights);
+
+      const float atlasSize = static_cast<float>(shadowAtlasSize);
+      for (int face = 0; face < 6; ++face) {
+         const auto& tile = m_PtShadowTiles[lightIndex][face];
+         gc.SetViewport(tile.offset, {tile.size, tile.size});
+         gc.ClearDepth(tile.offset, {tile.size, tile.size});
+         gc.PushConstant("constants.face"_hs, face);
+
+         // POI: only draw casters that are within range of the light
+         for (const auto& mesh : m_Model->Meshes) {
+            if (SphereIntersectsAABB(light.position, lightRadius, m_MeshWorldAABBs[mesh.Index])) {
+               gc.PushConstant("constants.model"_hs, mesh.Transform);
+               gc.DrawIndexed(*mesh.VertexBuffer, *mesh.IndexBuffer);
+               ++m_ShadowCastersDrawn;
+            }
+         }
+         m_PointLightShadows[lightIndex].face[face] = {glm::vec2 {tile.offset} / atlasSize, static_cast<float>(tile.size) / atlasSize, 1.0f / atlasSize};
+      }
+
+      gc.EndFrame();
+      gc.SwapBuffers();
+   }
+
+
+   // POI: Shadow atlas.
+   //      Each point light gets six tiles (one for each cube face) from the shadow atlas.  The size of the tiles depends on how big
+   //      the light's range appears on screen, so lights that are far away, dim, or out of view use less of the atlas.
+   //      As lights (or the camera) move, lights are given new tiles, a few at a time.
+   void UpdateShadowAtlas(const float lightRadius, const glm::mat4& viewProjection) {
+      PKZL_PROFILE_FUNCTION();
+
+      const uint32_t maxReallocationsPerFrame = 2;
+
+      // Work out what size of tile each light would like.  The most important (biggest) go first
+      std::vector<std::pair<uint32_t, size_t>> wantedSizes;
+      for (size_t i = 0; i < m_PointLights.size(); ++i) {
+         wantedSizes.emplace_back(WantedShadowTileSize(m_PointLights[i], lightRadius, viewProjection), i);
+      }
+      std::sort(wantedSizes.begin(), wantedSizes.end(), std::greater {});
+
+      // Shrink first (to make room), then grow.
+      // Lights only shrink when they want a quarter (or less) of what they have, so they do not flip back and forth between sizes.
+      uint32_t numReallocations = 0;
+      for (const auto& [wantedSize, i] : wantedSizes) {
+         const uint32_t currentSize = m_PtShadowTiles[i][0].size;
+         if ((numReallocations < maxReallocationsPerFrame) && (currentSize > 0) && (wantedSize * 4 <= currentSize)) {
+            for (auto& tile : m_PtShadowTiles[i]) {
+               m_ShadowAtlas.Free(tile);
+               tile = {};
+            }
+            if (wantedSize > 0) {
+               AllocateShadowTiles(m_PtShadowTiles[i], wantedSize);
+            }
+            InvalidatePointLightShadow(i);
+            ++numReallocations;
+         }
+      }
+      for (const auto& [wantedSize, i] : wantedSizes) {
+         const uint32_t currentSize = m_PtShadowTiles[i][0].size;
+         if ((numReallocations < maxReallocationsPerFrame) && (wantedSize > currentSize)) {
+            // Allocate new tiles before freeing the old ones.  If the atlas is too full, settle for something smaller (but
+            // still bigger than what the light has now), otherwise leave the light as it is.
+            std::array<SponzaPBR::ShadowAtlas::Tile, 6> tiles;
+            for (uint32_t size = wantedSize; size > currentSize; size /= 2) {
+               if (AllocateShadowTiles(tiles, size)) {
+                  for (const auto& tile : m_PtShadowTiles[i]) {
+                     if (tile.size > 0) {
+                        m_ShadowAtlas.Free(tile);
+                     }
+                  }
+                  m_PtShadowTiles[i] = tiles;
+                  InvalidatePointLightShadow(i);
+                  ++numReallocations;
+                  break;
+               }
+            }
+         }
+      }
+   }
+
+
+   // Returns size of shadow atlas tile (for each cube face) that given light should have, or 0 if it does not need a shadow
+   uint32_t WantedShadowTileSize(const Pikzel::PointLight& light, const float lightRadius, const glm::mat4& viewProjection) const {
+      // importance: a light that is off does not need a shadow at all, and dim lights reach less far (and so look smaller)
+      const float brightness = light.power * glm::max(light.color.r, glm::max(light.color.g, light.color.b));
+      if (brightness <= 0.0f) {
+         return 0;
+      }
+      const float range = lightRadius * glm::min(glm::sqrt(brightness), 1.0f);
+
+      const float distance = glm::length(light.position - m_Camera.position);
+      if (distance <= range) {
+         return maxShadowTileSize;
+      }
+      if (!SphereIntersectsFrustum(light.position, range, viewProjection)) {
+         return minShadowTileSize;
+      }
+
+      // approximate radius (in pixels) of the light's range on screen
+      const float projectedRadius = (range / glm::sqrt((distance * distance) - (range * range))) * (0.5f * static_cast<float>(GetWindow().GetHeight()) / glm::tan(m_Camera.fovRadians * 0.5f));
+      return m_ShadowAtlas.GetTileSize(static_cast<uint32_t>(glm::min(projectedRadius * m_ShadowResolutionScale, static_cast<float>(maxShadowTileSize))));
+   }
+
+
+   // Allocate six tiles (one for each cube face) of given size.  Either all of them are allocated, or none are.
+   bool AllocateShadowTiles(std::array<SponzaPBR::ShadowAtlas::Tile, 6>& tiles, const uint32_t size) {
+      for (size_t face = 0; face < tiles.size(); ++face) {
+         const auto tile = m_ShadowAtlas.Allocate(size);
+         if (!tile) {
+            for (size_t i = 0; i < face; ++i) {
+               m_ShadowAtlas.Free(tiles[i]);
+               tiles[i] = {};
+            }
+            return false;
+         }
+         tiles[face] = *tile;
+      }
+      return true;
+   }
+
+
+   // Light's tiles have changed.  It has no shadow until it is re-rendered into the new ones.
+   void InvalidatePointLightShadow(const size_t lightIndex) {
+      m_PointLightShadows[lightIndex] = {};
+      m_PtShadowDirty[lightIndex] = true;
+   }
+
+
+   static glm::vec3 AABBCorner(const std::pair<glm::vec3, glm::vec3>& aabb, const int corner) {
+      return {
+         (corner & 1) ? aabb.second.x : aabb.first.x,
+         (corner & 2) ? aabb.second.y : aabb.first.y,
+         (corner & 4) ? aabb.second.z : aabb.first.z
+      };
+   }
+
+
+   // Returns axis aligned bounding box of given (mesh space) AABB after transforming it by given transform
+   static std::pair<glm::vec3, glm::vec3> WorldAABB(const std::pair<glm::vec3, glm::vec3>& aabb, const glm::mat4& transform) {
+      std::pair<glm::vec3, glm::vec3> worldAABB = { glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX} };
+      for (int i = 0; i < 8; ++i) {
+         const glm::vec3 corner = transform * glm::vec4{AABBCorner(aabb, i), 1.0f};
+         worldAABB = { glm::min(worldAABB.first, corner), glm::max(worldAABB.second, corner) };
+      }
+      return worldAABB;
+   }
+
+
+   // Tests sphere against the sides of the view frustum (but not near and far planes)
+   static bool SphereIntersectsFrustum(const glm::vec3& centre, const float radius, const glm::mat4& viewProjection) {
+      const auto row = [&viewProjection](const int i) { return glm::vec4 {viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]}; };
+      const glm::vec4 row0 = row(0);
+      const glm::vec4 row1 = row(1);
+      const glm::vec4 row3 = row(3);
+      const glm::vec4 planes[4] = {row3 + row0, row3 - row0, row3 + row1, row3 - row1};
+      for (const auto& plane : planes) {
+         if (glm::dot(glm::vec3 {plane}, centre) + plane.w < -radius * glm::length(glm::vec3 {plane})) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+
+   static bool SphereIntersectsAABB(const glm::vec3& centre, const float radius, const std::pair<glm::vec3, glm::vec3>& aabb) {
+      const glm::vec3 d = glm::clamp(centre, aabb.first, aabb.second) - centre;
+      return glm::dot(d, d) <= radius * radius;
+   }
+
+
+   // Returns whether given world space AABB is (at least partly) inside the view volume of given (orthographic) light space matrix
+   static bool AABBIntersectsLightSpace(const std::pair<glm::vec3, glm::vec3>& aabb, const glm::mat4& lightSpace) {
+      const auto lightSpaceAABB = WorldAABB(aabb, lightSpace);
+      return
+         (lightSpaceAABB.second.x >= -1.0f) && (lightSpaceAABB.first.x <= 1.0f) &&
+         (lightSpaceAABB.second.y >= -1.0f) && (lightSpaceAABB.first.y <= 1.0f) &&
+         (lightSpaceAABB.second.z >= 0.0f) && (lightSpaceAABB.first.z <= 1.0f);
+   }
+
+
 private:
    Pikzel::Input m_Input;
 
@@ -578,14 +982,12 @@ private:
          .direction = {5.00f, -13.5f, 7.00f},
          .color = {1.0f, 1.0f, 1.0f},           // POI: The PBR pipeline is HDR, so there is no reason why we need to limit ourselves to light intensities in range 0 to 1
          .ambient = {1.0, 1.0, 1.0},            // POI: The ambient light (from environment map) is multiplied by this amount.  This allows us to tone down what might otherwise be too bright environments
-         .size = 0.002f
+         .size = 0.08f                          // POI: In this demo, directional light size is in world units (it is scaled to each shadow cascade in the shader)
       }
    };
 
-   glm::mat4 m_LightSpace;
 
-   // note: currently shader supports between 1 and 32 point lights
-   // for zero points lights, pass in one, with power set to 0
+   // note: point light shadows are allocated from the shadow atlas as required, so you can add more lights here
    std::vector<Pikzel::PointLight> m_PointLights = {
       {
          .position = {-4.96f, 1.1f, -1.76f},
@@ -614,22 +1016,27 @@ private:
    };
 
 
+   std::unique_ptr<Pikzel::TextureStreamer> m_TextureStreamer;
    std::unique_ptr<SponzaPBR::Model> m_Model;
    std::unique_ptr<Pikzel::VertexBuffer> m_VertexBuffer;
    std::unique_ptr<Pikzel::VertexBuffer> m_VertexBufferCube;
    std::unique_ptr<Pikzel::UniformBuffer> m_BufferMatrices;
    std::unique_ptr<Pikzel::UniformBuffer> m_BufferDirectionalLight;
    std::unique_ptr<Pikzel::UniformBuffer> m_BufferLightViews;
-   std::unique_ptr<Pikzel::UniformBuffer> m_BufferPointLights;
+   std::unique_ptr<Pikzel::StorageBuffer> m_BufferPointLights;
+   std::unique_ptr<Pikzel::StorageBuffer> m_BufferPointLightShadows;
+   std::unique_ptr<Pikzel::UniformBuffer> m_BufferShadowCascades;
+   std::unique_ptr<Pikzel::UniformBuffer> m_BufferClusters;
+   std::unique_ptr<Pikzel::StorageBuffer> m_BufferClusterLightGrid;
+   std::unique_ptr<Pikzel::StorageBuffer> m_BufferClusterLightIndices;
    std::vector<std::unique_ptr<Pikzel::Texture>> m_Textures;
-   std::unique_ptr<Pikzel::Texture> m_Skybox;
-   std::unique_ptr<Pikzel::Texture> m_Irradiance;
-   std::unique_ptr<Pikzel::Texture> m_SpecularIrradiance;
-   std::unique_ptr<Pikzel::Texture> m_SpecularBRDF_LUT;
+   std::unique_ptr<Pikzel::EnvironmentMap> m_Environment;
    std::unique_ptr<Pikzel::Framebuffer> m_FramebufferDirShadow;
-   std::unique_ptr<Pikzel::Framebuffer> m_FramebufferPtShadow;
+   std::unique_ptr<Pikzel::Framebuffer> m_FramebufferShadowAtlas;
    std::unique_ptr<Pikzel::Framebuffer> m_FramebufferScene;
 
+   std::unique_ptr<Pikzel::ComputeContext> m_ComputeContext;
+   std::unique_ptr<Pikzel::Pipeline> m_PipelineLightClusters;
    std::unique_ptr<Pikzel::Pipeline> m_PipelineLight;
    std::unique_ptr<Pikzel::Pipeline> m_PipelineSkybox;
    std::unique_ptr<Pikzel::Pipeline> m_PipelineDirShadow;
@@ -637,12 +1044,59 @@ private:
    std::unique_ptr<Pikzel::Pipeline> m_PipelinePBR;
    std::unique_ptr<Pikzel::Pipeline> m_PipelinePostProcess;
 
+   // shadow map cache
+   std::vector<glm::vec3> m_CachedPointLightPositions;
+   std::vector<glm::mat4> m_CachedMeshTransforms;
+   std::vector<std::pair<glm::vec3, glm::vec3>> m_MeshWorldAABBs;
+   std::vector<bool> m_PtShadowDirty;
+   size_t m_NextPtShadow = 0;
+   SponzaPBR::ShadowAtlas m_ShadowAtlas = {shadowAtlasSize, minShadowTileSize};
+   std::vector<std::array<SponzaPBR::ShadowAtlas::Tile, 6>> m_PtShadowTiles;
+   std::vector<PointLightShadow> m_PointLightShadows;
+   float m_ShadowResolutionScale = 1.0f;
+   float m_ShadowBudgetMs = 1.0f;
+   uint32_t m_ShadowMapsRendered = 0;
+   uint32_t m_ShadowCastersDrawn = 0;
+
+   // directional light shadow cascades
+   struct Cascade {
+      glm::mat4 lightSpace = glm::identity<glm::mat4>();
+      glm::vec2 centre = {};   // centre of the region covered by the cascade, in light view space
+      float radius = 0.0f;     // half the width of the region covered by the cascade
+      bool isDirty = true;
+   };
+   std::array<Cascade, Pikzel::RenderCore::MaxShadowCascades> m_Cascades;
+   ShadowCascades m_ShadowCascades = {};
+   glm::vec3 m_CachedLightDirection = {};
+   int m_NumCascades = static_cast<int>(Pikzel::RenderCore::MaxShadowCascades);
+   int m_NumDynamicCascades = 2;     // cascades nearer than this are re-fitted every frame, the rest are cached
+   float m_ShadowDistance = 40.0f;
+   float m_CascadeSplitLambda = 0.8f;
+
    Pikzel::DeltaTime m_DeltaTime = {};
    float m_Exposure = 1.0;
    int m_ToneMap = 2;
 };
 
 
+// Bakes the environment map cache, and then exits
+class BakeEnvironmentApp final : public Pikzel::Application {
+public:
+   BakeEnvironmentApp()
+   : Pikzel::Application {{.title = APP_DESCRIPTION}}
+   {}
+
+   virtual void Run() override {
+      Pikzel::EnvironmentMap::Bake(environmentSettings);
+   }
+};
+
+
 std::unique_ptr<Pikzel::Application> CreateApplication(int argc, const char* argv[]) {
+   for (int i = 1; i < argc; ++i) {
+      if (std::string_view {argv[i]} == "--bake-environment") {
+         return std::make_unique<BakeEnvironmentApp>();
+      }
+   }
    return std::make_unique<SponzaPBRApp>();
 }
@@ -0,0 +1,79 @@
+#version 450 core
+#extension GL_GOOGLE_include_directive: require
+
+#include "Lights.glsl"
+#include "Clusters.glsl"
+#include "Matrices.glsl"
+
+const vec3 ambient = vec3(0.02);
+const uint heatMapMaxLights = 32;
+
+layout(location = 0) in vec3 inFragPos;
+layout(location = 1) in vec3 inNormal;
+
+layout(push_constant) uniform PC {
+   mat4 model;
+   vec3 albedo;
+   uint showHeatMap;
+} constants;
+
+layout(set = 0, binding = 0) uniform UBOMatrices {
+   Matrices matrices;
+} uboMatrices;
+
+layout(set = 0, binding = 1) uniform UBOClusters {
+   Clusters clusters;
+} uboClusters;
+
+layout(set = 1, binding = 0) readonly buffer PointLights {
+   PointLight light[];
+} pointLights;
+
+layout(set = 1, binding = 1) readonly buffer ClusterLightGrid {
+   uvec2 cluster[];  // x = offset into ClusterLightIndices, y = number of lights
+} clusterLightGrid;
+
+layout(set = 1, binding = 2) readonly buffer ClusterLightIndices {
+   uint count;
+   uint index[];
+} clusterLightIndices;
+
+layout(location = 0) out vec4 outFragColor;
+
+
+vec3 CalculatePointLight(const PointLight light, const vec3 viewDir, const vec3 normal) {
+   const vec3 toLight = light.position - inFragPos;
+   const float distance = max(length(toLight), 0.01);
+   const vec3 lightDir = toLight / distance;
+   const vec3 halfwayDir = normalize(lightDir + viewDir);
+
+   const float diffuse = max(dot(normal, lightDir), 0.0);
+   const float specular = pow(max(dot(normal, halfwayDir), 0.0), 32.0) * 0.25;
+
+   // POI: the range window brings attenuation smoothly to zero at the light's range (which is what the clusters were built with)
+   const float attenuation = (light.power / (distance * distance)) * RangeWindow(distance, LightRange(uboClusters.clusters, light));
+   return ((constants.albedo * diffuse) + specular) * light.color * attenuation;
+}
+
+
+void main() {
+   // POI: Find which cluster this fragment is in, and then loop over only the lights in that cluster
+   const uvec2 cluster = clusterLightGrid.cluster[ClusterIndex(uboClusters.clusters, inFragPos)];
+
+   if (constants.showHeatMap != 0) {
+      outFragColor = vec4(ClusterHeatMap(cluster.y, heatMapMaxLights), 1.0);
+      return;
+   }
+
+   const vec3 normal = normalize(inNormal);
+   const vec3 viewDir = normalize(uboMatrices.matrices.eyePosition - inFragPos);
+
+   vec3 color = constants.albedo * ambient;
+   for (uint i = 0; i < cluster.y; ++i) {
+      color += CalculatePointLight(pointLights.light[clusterLightIndices.index[cluster.x + i]], viewDir, normal);
+   }
+
+   // reinhard tone mapping
+   // note: no need for gamma correction as we are using sRGB framebuffers
+   outFragColor = vec4(color / (color + vec3(1.0)), 1.0);
+}
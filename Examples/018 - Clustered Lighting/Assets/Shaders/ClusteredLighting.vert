@@ -0,0 +1,28 @@
+#version 450 core
+#extension GL_GOOGLE_include_directive: require
+
+#include "Matrices.glsl"
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inNormal;
+
+layout(push_constant) uniform PC {
+   mat4 model;
+   vec3 albedo;
+   uint showHeatMap;
+} constants;
+
+layout(set = 0, binding = 0) uniform UBOMatrices {
+   Matrices matrices;
+} uboMatrices;
+
+layout(location = 0) out vec3 outFragPos;
+layout(location = 1) out vec3 outNormal;
+
+
+void main() {
+   const vec4 worldPos = constants.model * vec4(inPos, 1.0);
+   outFragPos = worldPos.xyz;
+   outNormal = vec3(constants.model * vec4(inNormal, 0.0));
+   gl_Position = uboMatrices.matrices.viewProjection * worldPos;
+}
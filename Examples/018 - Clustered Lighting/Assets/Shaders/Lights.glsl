@@ -0,0 +1,6 @@
+struct PointLight {
+   vec3 position;
+   vec3 color;
+   float size;
+   float power;
+};
@@ -0,0 +1,4 @@
+struct Matrices {
+   mat4 viewProjection;
+   vec3 eyePosition;
+};
@@ -0,0 +1,353 @@
+#include "Pikzel/Pikzel.h"
+#include "Pikzel/Core/EntryPoint.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <random>
+
+// Clustered forward lighting demonstration (and stress test)
+// The view frustum is divided into a grid of clusters ("froxels"): tiles in screen space, and exponentially distributed slices in depth.
+// Each frame, a compute shader (Pikzel's Renderer/LightClusters.comp) works out which point lights affect each cluster, and writes
+// a list of light indices per cluster into storage buffers.
+// The fragment shader then finds which cluster the fragment is in, and loops over just the lights in that cluster.
+// Per-fragment lighting cost is therefore (roughly) independent of the total number of lights in the scene.
+//
+// Use the ImGui window to change the number of lights, and to show a "heat map" of the number of lights in each cluster.
+//
+// Points of interest in the code are marked with "POI" in the code comments.
+
+// note: Pikzel uses reverse-Z so near and far planes are swapped
+constexpr float nearPlane = 150.0f;
+constexpr float farPlane = 0.1f;
+
+// Depth range over which the light cluster slices are distributed
+constexpr float clusterNear = 0.1f;
+constexpr float clusterFar = 150.0f;
+
+class ClusteredLighting final : public Pikzel::Application {
+using super = Pikzel::Application;
+public:
+   ClusteredLighting()
+   : Pikzel::Application {{.title = APP_DESCRIPTION, .clearColor = Pikzel::sRGB{0.01f, 0.01f, 0.01f}, .isVSync = false}}
+   , m_Input {GetWindow()}
+   {
+      CreatePointLights();
+      CreateVertexBuffers();
+      CreateUniformBuffers();
+      CreatePipelines();
+
+      m_Camera.projection = glm::perspective(m_Camera.fovRadians, static_cast<float>(GetWindow().GetWidth()) / static_cast<float>(GetWindow().GetHeight()), nearPlane, farPlane);
+
+      Pikzel::ImGuiEx::Init(GetWindow());
+   }
+
+
+protected:
+
+   virtual void Update(const Pikzel::DeltaTime deltaTime) override {
+      PKZL_PROFILE_FUNCTION();
+      m_DeltaTime = deltaTime;
+      if (m_Input.IsKeyPressed(Pikzel::KeyCode::Escape)) {
+         Exit();
+      }
+      m_Camera.Update(m_Input, deltaTime);
+
+      // POI: the lights are all dynamic.  They each move in a little circle
+      if (m_Animate) {
+         m_Time += deltaTime.count();
+      }
+      for (int i = 0; i < m_NumPointLights; ++i) {
+         const LightAnimation& animation = m_LightAnimations[i];
+         const float angle = (animation.speed * m_Time) + animation.phase;
+         m_PointLights[i].position = animation.centre + glm::vec3 {animation.radius * glm::cos(angle), 0.0f, animation.radius * glm::sin(angle)};
+      }
+   }
+
+
+   virtual void RenderBegin() override {}
+
+
+   virtual void Render() override {
+      PKZL_PROFILE_FUNCTION();
+
+      // update buffers
+      glm::mat4 view = glm::lookAt(m_Camera.position, m_Camera.position + m_Camera.direction, m_Camera.upVector);
+
+      Matrices matrices;
+      matrices.viewProjection = m_Camera.projection * view;
+      matrices.eyePosition = m_Camera.position;
+      m_BufferMatrices->CopyFromHost(0, sizeof(Matrices), &matrices);
+      m_BufferPointLights->CopyFromHost(0, sizeof(Pikzel::PointLight) * m_NumPointLights, m_PointLights.data());
+
+      Clusters clusters;
+      clusters.view = view;
+      clusters.projection = m_Camera.projection;
+      clusters.inverseProjection = glm::inverse(m_Camera.projection);
+      clusters.size = {Pikzel::RenderCore::LightClustersX, Pikzel::RenderCore::LightClustersY, Pikzel::RenderCore::LightClustersZ, static_cast<uint32_t>(m_NumPointLights)};
+      clusters.depthParams = {
+         clusterNear,
+         clusterFar,
+         static_cast<float>(Pikzel::RenderCore::LightClustersZ) / glm::log(clusterFar / clusterNear),
+         -static_cast<float>(Pikzel::RenderCore::LightClustersZ) * glm::log(clusterNear) / glm::log(clusterFar / clusterNear)
+      };
+      clusters.lightThreshold = m_LightThreshold;
+      m_BufferClusters->CopyFromHost(0, sizeof(Clusters), &clusters);
+
+      // POI: Assign point lights to clusters
+      {
+         m_ComputeContext->Begin();
+         m_ComputeContext->Fill(*m_BufferClusterLightIndices, 0, 0, sizeof(uint32_t));
+         m_ComputeContext->Bind(*m_PipelineLightClusters);
+         m_ComputeContext->Bind("UBOClusters"_hs, *m_BufferClusters);
+         m_ComputeContext->Bind("PointLights"_hs, *m_BufferPointLights);
+         m_ComputeContext->Bind("ClusterLightGrid"_hs, *m_BufferClusterLightGrid);
+         m_ComputeContext->Bind("ClusterLightIndices"_hs, *m_BufferClusterLightIndices);
+         m_ComputeContext->Dispatch((Pikzel::RenderCore::NumLightClusters + 127) / 128, 1, 1);  // POI: the shader works in groups of 128 clusters
+         m_ComputeContext->WaitFor(GetWindow().GetGraphicsContext());  // POI: the previous frame may still be reading the cluster light lists
+         m_ComputeContext->End();
+      }
+
+      // POI: Render the scene.  Fragment shader uses the cluster light lists, so must wait for the compute work that assigns them
+      GetWindow().BeginFrame();
+      Pikzel::GraphicsContext& gc = GetWindow().GetGraphicsContext();
+      gc.WaitFor(*m_ComputeContext);
+      gc.Bind(*m_PipelineScene);
+      gc.PushConstant("constants.showHeatMap"_hs, m_ShowHeatMap ? 1u : 0u);
+      gc.Bind("UBOMatrices"_hs, *m_BufferMatrices);
+      gc.Bind("UBOClusters"_hs, *m_BufferClusters);
+      gc.Bind("PointLights"_hs, *m_BufferPointLights);
+      gc.Bind("ClusterLightGrid"_hs, *m_BufferClusterLightGrid);
+      gc.Bind("ClusterLightIndices"_hs, *m_BufferClusterLightIndices);
+
+      // floor
+      glm::mat4 model = glm::scale(glm::identity<glm::mat4>(), glm::vec3 {4.0f, 1.0f, 4.0f});
+      gc.PushConstant("constants.model"_hs, model);
+      gc.PushConstant("constants.albedo"_hs, glm::vec3 {0.8f, 0.8f, 0.8f});
+      gc.DrawTriangles(*m_VertexBuffer, 6, 36);
+
+      // cubes
+      gc.PushConstant("constants.albedo"_hs, glm::vec3 {0.5f, 0.5f, 0.6f});
+      for (const auto& cubePosition : m_CubePositions) {
+         model = glm::scale(glm::translate(glm::identity<glm::mat4>(), cubePosition), glm::vec3 {1.0f, 2.0f, 1.0f});
+         gc.PushConstant("constants.model"_hs, model);
+         gc.DrawTriangles(*m_VertexBuffer, 36);
+      }
+
+      GetWindow().BeginImGuiFrame();
+      {
+         ImGui::Begin("Clustered Lighting");
+         ImGui::Text("Frame time: %.3fms (%.0f FPS)", m_DeltaTime.count() * 1000.0f, 1.0f / m_DeltaTime.count());
+         ImGui::Text("Clusters: %d x %d x %d", Pikzel::RenderCore::LightClustersX, Pikzel::RenderCore::LightClustersY, Pikzel::RenderCore::LightClustersZ);
+         ImGui::SliderInt("Point lights", &m_NumPointLights, 1, static_cast<int>(Pikzel::RenderCore::MaxPointLights));
+         ImGui::DragFloat("Light threshold", &m_LightThreshold, 0.001f, 0.001f, 1.0f);
+         ImGui::Checkbox("Animate", &m_Animate);
+         ImGui::Checkbox("Heat map", &m_ShowHeatMap);  // POI: blue = few lights in cluster, red = many
+         ImGui::End();
+      }
+      GetWindow().EndImGuiFrame();
+      GetWindow().EndFrame();
+   }
+
+
+   virtual void RenderEnd() override {}
+
+
+   virtual void OnWindowResize(const Pikzel::WindowResizeEvent& event) override {
+      super::OnWindowResize(event);
+      m_Camera.projection = glm::perspective(m_Camera.fovRadians, static_cast<float>(GetWindow().GetWidth()) / static_cast<float>(GetWindow().GetHeight()), nearPlane, farPlane);
+   }
+
+
+private:
+
+   struct Vertex {
+      glm::vec3 Pos;
+      glm::vec3 Normal;
+   };
+
+   struct LightAnimation {
+      glm::vec3 centre;
+      float radius;
+      float speed;
+      float phase;
+   };
+
+   void CreatePointLights() {
+      std::mt19937 generator {42};
+      std::uniform_real_distribution<float> position {-38.0f, 38.0f};
+      std::uniform_real_distribution<float> height {0.2f, 3.0f};
+      std::uniform_real_distribution<float> unit {0.0f, 1.0f};
+
+      m_PointLights.resize(Pikzel::RenderCore::MaxPointLights);
+      m_LightAnimations.resize(Pikzel::RenderCore::MaxPointLights);
+      for (uint32_t i = 0; i < Pikzel::RenderCore::MaxPointLights; ++i) {
+         glm::vec3 color = {unit(generator), unit(generator), unit(generator)};
+         color /= glm::max(glm::max(color.r, color.g), glm::max(color.b, 0.001f));  // brightest component = 1
+         m_PointLights[i] = {
+            .color = color,
+            .size = 0.02f,
+            .power = 0.05f + 0.15f * unit(generator)
+         };
+         m_LightAnimations[i] = {
+            .centre = {position(generator), height(generator), position(generator)},
+            .radius = 0.5f + 2.0f * unit(generator),
+            .speed = 0.2f + unit(generator),
+            .phase = glm::two_pi<float>() * unit(generator)
+         };
+      }
+
+      for (int i = -8; i < 8; ++i) {
+         for (int j = -8; j < 8; ++j) {
+            m_CubePositions.emplace_back(2.5f + (5.0f * i), 1.0f, 2.5f + (5.0f * j));
+         }
+      }
+   }
+
+
+   void CreateVertexBuffers() {
+      Vertex vertices[] = {
+         // Cube
+         {.Pos{-0.5f, -0.5f, -0.5f}, .Normal{ 0.0f,  0.0f, -1.0f}},
+         {.Pos{ 0.5f,  0.5f, -0.5f}, .Normal{ 0.0f,  0.0f, -1.0f}},
+         {.Pos{ 0.5f, -0.5f, -0.5f}, .Normal{ 0.0f,  0.0f, -1.0f}},
+         {.Pos{ 0.5f,  0.5f, -0.5f}, .Normal{ 0.0f,  0.0f, -1.0f}},
+         {.Pos{-0.5f, -0.5f, -0.5f}, .Normal{ 0.0f,  0.0f, -1.0f}},
+         {.Pos{-0.5f,  0.5f, -0.5f}, .Normal{ 0.0f,  0.0f, -1.0f}},
+
+         {.Pos{-0.5f, -0.5f,  0.5f}, .Normal{ 0.0f,  0.0f,  1.0f}},
+         {.Pos{ 0.5f, -0.5f,  0.5f}, .Normal{ 0.0f,  0.0f,  1.0f}},
+         {.Pos{ 0.5f,  0.5f,  0.5f}, .Normal{ 0.0f,  0.0f,  1.0f}},
+         {.Pos{ 0.5f,  0.5f,  0.5f}, .Normal{ 0.0f,  0.0f,  1.0f}},
+         {.Pos{-0.5f,  0.5f,  0.5f}, .Normal{ 0.0f,  0.0f,  1.0f}},
+         {.Pos{-0.5f, -0.5f,  0.5f}, .Normal{ 0.0f,  0.0f,  1.0f}},
+
+         {.Pos{-0.5f, -0.5f,  0.5f}, .Normal{-1.0f,  0.0f,  0.0f}},
+         {.Pos{-0.5f,  0.5f, -0.5f}, .Normal{-1.0f,  0.0f,  0.0f}},
+         {.Pos{-0.5f, -0.5f, -0.5f}, .Normal{-1.0f,  0.0f,  0.0f}},
+         {.Pos{-0.5f,  0.5f, -0.5f}, .Normal{-1.0f,  0.0f,  0.0f}},
+         {.Pos{-0.5f, -0.5f,  0.5f}, .Normal{-1.0f,  0.0f,  0.0f}},
+         {.Pos{-0.5f,  0.5f,  0.5f}, .Normal{-1.0f,  0.0f,  0.0f}},
+
+         {.Pos{ 0.5f,  0.5f,  0.5f}, .Normal{ 1.0f,  0.0f,  0.0f}},
+         {.Pos{ 0.5f, -0.5f, -0.5f}, .Normal{ 1.0f,  0.0f,  0.0f}},
+         {.Pos{ 0.5f,  0.5f, -0.5f}, .Normal{ 1.0f,  0.0f,  0.0f}},
+         {.Pos{ 0.5f, -0.5f, -0.5f}, .Normal{ 1.0f,  0.0f,  0.0f}},
+         {.Pos{ 0.5f,  0.5f,  0.5f}, .Normal{ 1.0f,  0.0f,  0.0f}},
+         {.Pos{ 0.5f, -0.5f,  0.5f}, .Normal{ 1.0f,  0.0f,  0.0f}},
+
+         {.Pos{-0.5f, -0.5f, -0.5f}, .Normal{ 0.0f, -1.0f,  0.0f}},
+         {.Pos{ 0.5f, -0.5f, -0.5f}, .Normal{ 0.0f, -1.0f,  0.0f}},
+         {.Pos{ 0.5f, -0.5f,  0.5f}, .Normal{ 0.0f, -1.0f,  0.0f}},
+         {.Pos{ 0.5f, -0.5f,  0.5f}, .Normal{ 0.0f, -1.0f,  0.0f}},
+         {.Pos{-0.5f, -0.5f,  0.5f}, .Normal{ 0.0f, -1.0f,  0.0f}},
+         {.Pos{-0.5f, -0.5f, -0.5f}, .Normal{ 0.0f, -1.0f,  0.0f}},
+
+         {.Pos{-0.5f,  0.5f, -0.5f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+         {.Pos{ 0.5f,  0.5f,  0.5f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+         {.Pos{ 0.5f,  0.5f, -0.5f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+         {.Pos{ 0.5f,  0.5f,  0.5f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+         {.Pos{-0.5f,  0.5f, -0.5f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+         {.Pos{-0.5f,  0.5f,  0.5f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+
+         // Plane
+         {.Pos{-10.0f,  0.0f, -10.0f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+         {.Pos{ 10.0f,  0.0f,  10.0f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+         {.Pos{ 10.0f,  0.0f, -10.0f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+
+         {.Pos{ 10.0f,  0.0f,  10.0f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+         {.Pos{-10.0f,  0.0f, -10.0f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+         {.Pos{-10.0f,  0.0f,  10.0f}, .Normal{ 0.0f,  1.0f,  0.0f}},
+      };
+
+      Pikzel::BufferLayout layout = {
+         {"inPos",    Pikzel::DataType::Vec3},
+         {"inNormal", Pikzel::DataType::Vec3},
+      };
+      m_VertexBuffer = Pikzel::RenderCore::CreateVertexBuffer(layout, sizeof(vertices), vertices);
+   }
+
+
+   struct Matrices {
+      glm::mat4 viewProjection;
+      glm::vec3 eyePosition;
+   };
+
+   // note: must match Clusters struct in Pikzel's Renderer/Shaders/Clusters.glsl
+   struct Clusters {
+      glm::mat4 view;
+      glm::mat4 projection;
+      glm::mat4 inverseProjection;
+      glm::uvec4 size;
+      glm::vec4 depthParams;
+      float lightThreshold;
+   };
+
+   void CreateUniformBuffers() {
+      m_BufferMatrices = Pikzel::RenderCore::CreateUniformBuffer(sizeof(Matrices));
+      m_BufferClusters = Pikzel::RenderCore::CreateUniformBuffer(sizeof(Clusters));
+
+      // POI: Point lights, and the per-cluster light lists, are in storage buffers.
+      //      Unlike uniform buffers, these can be large, and can be written to by shaders.
+      m_BufferPointLights = Pikzel::RenderCore::CreateStorageBuffer(sizeof(Pikzel::PointLight) * Pikzel::RenderCore::MaxPointLights);
+      m_BufferClusterLightGrid = Pikzel::RenderCore::CreateStorageBuffer(sizeof(glm::uvec2) * Pikzel::RenderCore::NumLightClusters);
+      m_BufferClusterLightIndices = Pikzel::RenderCore::CreateStorageBuffer(sizeof(uint32_t) * (1 + Pikzel::RenderCore::MaxLightIndices));
+   }
+
+
+   void CreatePipelines() {
+      m_ComputeContext = Pikzel::RenderCore::CreateComputeContext();
+      m_PipelineLightClusters = m_ComputeContext->CreatePipeline({
+         .shaders = {
+            { Pikzel::ShaderType::Compute, "Renderer/LightClusters.comp.spv" }
+         }
+      });
+
+      m_PipelineScene = GetWindow().GetGraphicsContext().CreatePipeline({
+         .shaders = {
+            { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/ClusteredLighting.vert.spv" },
+            { Pikzel::ShaderType::Fragment, "Assets/" APP_NAME "/Shaders/ClusteredLighting.frag.spv" }
+         },
+         .bufferLayout = m_VertexBuffer->GetLayout()
+      });
+   }
+
+
+private:
+   Pikzel::Input m_Input;
+
+   Camera m_Camera = {
+      .position = {-45.0f, 15.0f, 0.0f},
+      .direction = glm::normalize(glm::vec3{1.0f, -0.4f, 0.0f}),
+      .upVector = {0.0f, 1.0f, 0.0f},
+      .fovRadians = glm::radians(45.f),
+      .moveSpeed = 10.0f,
+      .rotateSpeed = 20.0f
+   };
+
+   std::vector<Pikzel::PointLight> m_PointLights;
+   std::vector<LightAnimation> m_LightAnimations;
+   std::vector<glm::vec3> m_CubePositions;
+
+   std::unique_ptr<Pikzel::VertexBuffer> m_VertexBuffer;
+   std::unique_ptr<Pikzel::UniformBuffer> m_BufferMatrices;
+   std::unique_ptr<Pikzel::UniformBuffer> m_BufferClusters;
+   std::unique_ptr<Pikzel::StorageBuffer> m_BufferPointLights;
+   std::unique_ptr<Pikzel::StorageBuffer> m_BufferClusterLightGrid;
+   std::unique_ptr<Pikzel::StorageBuffer> m_BufferClusterLightIndices;
+
+   std::unique_ptr<Pikzel::ComputeContext> m_ComputeContext;
+   std::unique_ptr<Pikzel::Pipeline> m_PipelineLightClusters;
+   std::unique_ptr<Pikzel::Pipeline> m_PipelineScene;
+
+   Pikzel::DeltaTime m_DeltaTime = {};
+   float m_Time = 0.0f;
+   float m_LightThreshold = 0.01f;
+   int m_NumPointLights = 1024;
+   bool m_Animate = true;
+   bool m_ShowHeatMap = false;
+};
+
+
+std::unique_ptr<Pikzel::Application> CreateApplication(int argc, const char* argv[]) {
+   return std::make_unique<ClusteredLighting>();
+}
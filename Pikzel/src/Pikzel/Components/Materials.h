@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Pikzel/Scene/Material.h"
+
+#include <memory>
+#include <vector>
+
+namespace Pikzel {
+
+   // The materials that an object's model is drawn with.
+   // Instances[i] is for the model's i'th mesh.  Meshes beyond the end of Instances use the last one.
+   // Objects without this component (or with no instances) are drawn with the SceneRenderer's default material.
+   struct PKZL_API Materials {
+      std::vector<std::shared_ptr<MaterialInstance>> Instances;
+   };
+
+}
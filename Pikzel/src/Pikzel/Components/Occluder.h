@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+namespace Pikzel {
+
+   // Objects with this component hide whatever is behind them, for the purposes of software occlusion culling.
+   // The object's model is rasterized into the occlusion depth buffer at full resolution (a simplified mesh can stick out in front of
+   // the real surface, and would then hide things that are visible).
+   // Good occluders are large, solid and simple (walls, floors).  See Pikzel/Scene/OcclusionCuller.h
+   struct PKZL_API Occluder {
+      bool IsEnabled = true;
+   };
+
+}
@@ -1,6 +1,10 @@
 #include "Application.h"
 #include "Log.h"
 #include "Pikzel/Events/EventDispatcher.h"
+#include "Pikzel/Renderer/FramebufferPool.h"
+#include "Pikzel/Renderer/PipelineCompiler.h"
+#include "Pikzel/Renderer/Readback.h"
+#include "Pikzel/Renderer/ShaderReloader.h"
 #include "Pikzel/Scene/AssetCache.h"
 
 namespace Pikzel {
@@ -30,15 +34,24 @@ namespace Pikzel {
       // A workaround for applications that just want to do "offline" rendering is
       // to create the window and then immediately hide it.
       m_Window = Pikzel::Window::Create(settings);
+      FramebufferPool::SetFramesInFlight(m_Window->GetFramesInFlight());
       EventDispatcher::Connect<WindowCloseEvent, &Application::OnWindowClose>(*this);
       EventDispatcher::Connect<WindowResizeEvent, &Application::OnWindowResize>(*this);
+
+#ifdef PKZL_DEBUG
+      ShaderReloader::SetEnabled(true);
+#endif
    }
 
 
    Application::~Application() {
       EventDispatcher::Disconnect<WindowCloseEvent, &Application::OnWindowClose>(*this);
       EventDispatcher::Disconnect<WindowResizeEvent, &Application::OnWindowResize>(*this);
+      ShaderReloader::SetEnabled(false);
+      PipelineCompiler::Shutdown();
+      ImageWriter::Shutdown();
       AssetCache::Clear();
+      FramebufferPool::Clear();
    }
 
 
@@ -63,6 +76,12 @@ namespace Pikzel {
          RenderBegin();
          Render();
          RenderEnd();
+
+         AssetCache::Update();
+         FramebufferPool::Update();
+         ShaderReloader::Update();
+         PipelineCompiler::Update();
+         ImageWriter::Update();
       }
    }
 
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pikzel {
+
+   // 64-bit xxHash (XXH64) of size bytes at data.
+   // Fast enough to hash whole images and meshes at load time, for identifying resources by their content.
+   // Hashes can be chained by passing the result of one call as the seed of the next.
+   PKZL_API uint64_t Hash64(const void* data, const size_t size, const uint64_t seed = 0);
+
+}
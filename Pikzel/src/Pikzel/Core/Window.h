@@ -25,6 +25,7 @@ namespace Pikzel {
          uint32_t maxWidth = 0;
          uint32_t maxHeight = 0;
          uint32_t msaaNumSamples = 1;
+         uint32_t framesInFlight = 2;     // how many frames the CPU may get ahead of the GPU.  More gives better throughput, fewer gives lower latency.  (Vulkan only: OpenGL leaves this to the driver)
       };
 
       virtual ~Window() = default;
@@ -36,6 +37,8 @@ namespace Pikzel {
 
       virtual uint32_t GetMSAANumSamples() const = 0;
 
+      virtual uint32_t GetFramesInFlight() const = 0;
+
       virtual glm::vec4 GetClearColor() const = 0;
 
       virtual void SetVSync(bool enabled) = 0;
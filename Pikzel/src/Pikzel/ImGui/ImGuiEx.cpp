@@ -1,6 +1,7 @@
 #include "ImGuiEx.h"
 
 #include "Pikzel/Renderer/RenderCore.h"
+#include "Pikzel/Renderer/ShaderReloader.h"
 
 #include <imgui_internal.h>
 
@@ -157,5 +158,19 @@ namespace Pikzel {
          ImGui::PopID();
       }
 
+      void ShaderErrors() {
+         const auto errors = ShaderReloader::GetErrors();
+         if (errors.empty()) {
+            return;
+         }
+         ImGui::Begin("Shader Errors");
+         for (const auto& error : errors) {
+            ImGui::TextColored(ImVec4 {1.0f, 0.4f, 0.4f, 1.0f}, "%s", error.Path.string().c_str());
+            ImGui::TextUnformatted(error.Message.c_str());
+            ImGui::Separator();
+         }
+         ImGui::End();
+      }
+
    }
 }
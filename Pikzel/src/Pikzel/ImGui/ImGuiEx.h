@@ -14,5 +14,8 @@ namespace Pikzel {
       void EditVec3(const char* label, glm::vec3* value, const float resetValue = 0.0f, const float labelWidth = 100.0f);
       void EditVec3Color(const char* label, glm::vec3* value, const float labelWidth = 100.0f);
       void EditFloat(const char* label, float* value, const float labelWidth = 100.0f, const char* format = "%.3f", ImGuiInputTextFlags flags = 0);
+
+      // A window listing shaders that have failed to hot reload (see ShaderReloader), if there are any
+      void ShaderErrors();
    }
 }
@@ -4,10 +4,13 @@
 // If you prefer, you can bring in just the bits that you know you will use.
 // (for possibly faster compile times - your mileage may vary)
 
+#include "Pikzel/Components/Materials.h"
 #include "Pikzel/Components/Model.h"
+#include "Pikzel/Components/Occluder.h"
 #include "Pikzel/Components/Transform.h"
 
 #include "Pikzel/Core/Application.h"
+#include "Pikzel/Core/Hash.h"
 #include "Pikzel/Core/PlatformUtility.h"
 #include "Pikzel/Core/Utility.h"
 
@@ -22,19 +25,32 @@
 #include "Pikzel/Input/KeyCodes.h"
 #include "Pikzel/Input/MouseButtons.h"
 
+#include "Pikzel/Renderer/Bloom.h"
 #include "Pikzel/Renderer/Buffer.h"
 #include "Pikzel/Renderer/ComputeContext.h"
+#include "Pikzel/Renderer/ContentCache.h"
+#include "Pikzel/Renderer/EnvironmentMap.h"
 #include "Pikzel/Renderer/Framebuffer.h"
+#include "Pikzel/Renderer/FramebufferPool.h"
 #include "Pikzel/Renderer/GraphicsContext.h"
 #include "Pikzel/Renderer/Pipeline.h"
+#include "Pikzel/Renderer/PipelineCompiler.h"
+#include "Pikzel/Renderer/Readback.h"
 #include "Pikzel/Renderer/RenderCore.h"
+#include "Pikzel/Renderer/RenderGraph.h"
+#include "Pikzel/Renderer/ShaderReloader.h"
 #include "Pikzel/Renderer/sRGB.h"
 #include "Pikzel/Renderer/Texture.h"
+#include "Pikzel/Renderer/TextureStreamer.h"
 
 #include "Pikzel/Scene/Camera.h"
 #include "Pikzel/Scene/Light.h"
+#include "Pikzel/Scene/Material.h"
 #include "Pikzel/Scene/Mesh.h"
+#include "Pikzel/Scene/MeshOptimizer.h"
+#include "Pikzel/Scene/Meshlets.h"
 #include "Pikzel/Scene/ModelResource.h"
+#include "Pikzel/Scene/OcclusionCuller.h"
 #include "Pikzel/Scene/Scene.h"
 #include "Pikzel/Scene/SceneRenderer.h"
 #include "Pikzel/Scene/SceneSerializer.h"
@@ -8,6 +8,8 @@
 
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+
 namespace Pikzel {
 
    std::unique_ptr<Window> Window::Create() {
@@ -176,6 +178,11 @@ namespace Pikzel {
    }
 
 
+   uint32_t GLFWWindow::GetFramesInFlight() const {
+      return std::max(m_Settings.framesInFlight, 1u);
+   }
+
+
    glm::vec4 GLFWWindow::GetClearColor() const {
       return m_Settings.clearColor;
    }
@@ -20,6 +20,8 @@ namespace Pikzel {
 
       virtual uint32_t GetMSAANumSamples() const override;
 
+      virtual uint32_t GetFramesInFlight() const override;
+
       virtual glm::vec4 GetClearColor() const override;
 
       virtual void SetVSync(bool enabled) override;
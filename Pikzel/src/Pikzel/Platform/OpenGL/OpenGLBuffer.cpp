@@ -47,6 +47,7 @@ namespace Pikzel {
 
    OpenGLIndexBuffer::OpenGLIndexBuffer(const uint32_t count, const uint32_t* indices)
    : m_Count(count)
+   , m_IndexType(IndexType::UInt32)
    {
       glCreateBuffers(1, &m_RendererID);
 
@@ -57,6 +58,16 @@ namespace Pikzel {
    }
 
 
+   OpenGLIndexBuffer::OpenGLIndexBuffer(const uint32_t count, const uint16_t* indices)
+   : m_Count(count)
+   , m_IndexType(IndexType::UInt16)
+   {
+      glCreateBuffers(1, &m_RendererID);
+      glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+      glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint16_t), indices, GL_STATIC_DRAW);
+   }
+
+
    OpenGLIndexBuffer::~OpenGLIndexBuffer() {
       glDeleteBuffers(1, &m_RendererID);
    }
@@ -77,6 +88,11 @@ namespace Pikzel {
    }
 
 
+   IndexType OpenGLIndexBuffer::GetIndexType() const {
+      return m_IndexType;
+   }
+
+
    OpenGLUniformBuffer::OpenGLUniformBuffer(const uint32_t size) {
       glCreateBuffers(1, &m_RendererID);
       glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
@@ -107,4 +123,34 @@ namespace Pikzel {
       return m_RendererID;
    }
 
+
+   OpenGLStorageBuffer::OpenGLStorageBuffer(const uint32_t size) {
+      glCreateBuffers(1, &m_RendererID);
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
+      glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+   }
+
+
+   OpenGLStorageBuffer::OpenGLStorageBuffer(const uint32_t size, const void* data) {
+      glCreateBuffers(1, &m_RendererID);
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
+      glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_DRAW);
+   }
+
+
+   OpenGLStorageBuffer::~OpenGLStorageBuffer() {
+      glDeleteBuffers(1, &m_RendererID);
+   }
+
+
+   void OpenGLStorageBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
+      glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, pData);
+   }
+
+
+   GLuint OpenGLStorageBuffer::GetRendererId() const {
+      return m_RendererID;
+   }
+
 }
@@ -26,17 +26,20 @@ namespace Pikzel {
    class OpenGLIndexBuffer : public IndexBuffer {
    public:
       OpenGLIndexBuffer(const uint32_t count, const uint32_t* indices);
+      OpenGLIndexBuffer(const uint32_t count, const uint16_t* indices);
       virtual ~OpenGLIndexBuffer();
 
       virtual void CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) override;
 
       virtual uint32_t GetCount() const override;
+      virtual IndexType GetIndexType() const override;
 
       GLuint GetRendererId() const;
 
    private:
       GLuint m_RendererID;
       uint32_t m_Count;
+      IndexType m_IndexType;
    };
 
 
@@ -53,4 +56,19 @@ namespace Pikzel {
    private:
       GLuint m_RendererID;
    };
+
+
+   class OpenGLStorageBuffer : public StorageBuffer {
+   public:
+      OpenGLStorageBuffer(const uint32_t size);
+      OpenGLStorageBuffer(const uint32_t size, const void* data);
+      virtual ~OpenGLStorageBuffer();
+
+      virtual void CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) override;
+
+      GLuint GetRendererId() const;
+
+   private:
+      GLuint m_RendererID;
+   };
 }
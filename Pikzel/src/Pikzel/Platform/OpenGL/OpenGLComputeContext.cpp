@@ -4,6 +4,8 @@
 #include "OpenGLPipeline.h"
 #include "OpenGLTexture.h"
 
+#include "Pikzel/Renderer/PipelineCompiler.h"
+
 namespace Pikzel {
 
    OpenGLComputeContext::OpenGLComputeContext()
@@ -25,10 +27,21 @@ namespace Pikzel {
    void OpenGLComputeContext::Unbind(const UniformBuffer&) {}
 
 
+   void OpenGLComputeContext::Bind(const Id resourceId, const StorageBuffer& buffer) {
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Pipeline->GetStorageBufferBinding(resourceId), static_cast<const OpenGLStorageBuffer&>(buffer).GetRendererId());
+   }
+
+
+   void OpenGLComputeContext::Unbind(const StorageBuffer&) {}
+
+
    void OpenGLComputeContext::Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel) {
       GLuint samplerBinding = m_Pipeline->GetSamplerBinding(resourceId, false);
       if (samplerBinding != ~0) {
-         glBindTextureUnit(samplerBinding, static_cast<const OpenGLTexture&>(texture).GetRendererId());
+         // mip level 0 binds the whole texture.  Other levels bind a view of just that level (so the shader sees it as level 0)
+         glBindTextureUnit(samplerBinding, mipLevel == 0 ? static_cast<const OpenGLTexture&>(texture).GetRendererId() : static_cast<const OpenGLTexture&>(texture).GetRendererId(mipLevel));
+         // mip level views use their own sampling parameters (see OpenGLTexture::GetRendererId())
+         glBindSampler(samplerBinding, mipLevel == 0 ? static_cast<const OpenGLTexture&>(texture).GetSamplerId() : 0);
       } else {
          GLuint storageImageBinding = m_Pipeline->GetStorageImageBinding(resourceId, false);
          if (storageImageBinding != ~0) {
@@ -58,10 +71,24 @@ namespace Pikzel {
 
 
    std::unique_ptr<Pikzel::Pipeline> OpenGLComputeContext::CreatePipeline(const PipelineSettings& settings) {
+      if (auto pipeline = PipelineCompiler::TakeWarmedUp(nullptr, settings)) {
+         return pipeline;
+      }
       return std::make_unique<OpenGLPipeline>(settings);
    }
 
 
+   std::shared_ptr<PipelineFuture> OpenGLComputeContext::CreatePipelineAsync(const PipelineSettings& settings) {
+      // See OpenGLGraphicsContext::CreatePipelineAsync()
+      return PipelineCompiler::Submit(
+         nullptr,
+         settings,
+         [](const PipelineSettings& pipelineSettings) { return std::make_unique<OpenGLPipeline>(pipelineSettings, true); },
+         [](Pipeline& pipeline) { static_cast<OpenGLPipeline&>(pipeline).CreateGLObjects(); }
+      );
+   }
+
+
    void OpenGLComputeContext::PushConstant(const Id id, bool value) {
       PKZL_CORE_ASSERT(m_Pipeline, "Attempted to access null pipeline!");
       m_Pipeline->PushConstant(id, value);
@@ -293,6 +320,18 @@ namespace Pikzel {
    void OpenGLComputeContext::Dispatch(const uint32_t x, const uint32_t y, const uint32_t z) {
       PKZL_PROFILE_FUNCTION();
       glDispatchCompute(x, y, z);
+
+      // Make shader storage and image writes visible to subsequent dispatches and draws (including indirect draw parameters,
+      // and sampling of images that were written, e.g. one mip level being read to compute the next).
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+   }
+
+
+   void OpenGLComputeContext::Fill(const StorageBuffer& buffer, const uint32_t value, const uint64_t offset, const uint64_t size) {
+      PKZL_PROFILE_FUNCTION();
+      // the driver orders the clear after earlier reads of the buffer, but shader writes (by earlier dispatches) need a barrier
+      glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+      glClearNamedBufferSubData(static_cast<const OpenGLStorageBuffer&>(buffer).GetRendererId(), GL_R32UI, offset, size, GL_RED_INTEGER, GL_UNSIGNED_INT, &value);
    }
 
 }
@@ -21,6 +21,9 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) override;
       virtual void Unbind(const UniformBuffer& buffer) override;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) override;
+      virtual void Unbind(const StorageBuffer& buffer) override;
+
       virtual void Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel = 0) override;
       virtual void Unbind(const Texture& texture) override;
 
@@ -28,6 +31,7 @@ namespace Pikzel {
       virtual void Unbind(const Pipeline& pipeline) override;
 
       virtual std::unique_ptr<Pipeline> CreatePipeline(const PipelineSettings& settings) override;
+      virtual std::shared_ptr<PipelineFuture> CreatePipelineAsync(const PipelineSettings& settings) override;
 
       virtual void PushConstant(const Id id, bool value) override;
       virtual void PushConstant(const Id id, int value) override;
@@ -70,6 +74,8 @@ namespace Pikzel {
 
       virtual void Dispatch(const uint32_t x, const uint32_t y, const uint32_t z) override;
 
+      virtual void Fill(const StorageBuffer& buffer, const uint32_t value, const uint64_t offset, const uint64_t size) override;
+
    private:
       OpenGLPipeline* m_Pipeline;
    };
@@ -6,6 +6,7 @@
 #include "OpenGLTexture.h"
 
 #include "Pikzel/Events/EventDispatcher.h"
+#include "Pikzel/Renderer/PipelineCompiler.h"
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -75,8 +76,18 @@ namespace Pikzel {
    void OpenGLGraphicsContext::Unbind(const UniformBuffer&) {}
 
 
+   void OpenGLGraphicsContext::Bind(const Id resourceId, const StorageBuffer& buffer) {
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Pipeline->GetStorageBufferBinding(resourceId), static_cast<const OpenGLStorageBuffer&>(buffer).GetRendererId());
+   }
+
+
+   void OpenGLGraphicsContext::Unbind(const StorageBuffer&) {}
+
+
    void OpenGLGraphicsContext::Bind(const Id resourceId, const Texture& texture) {
-      glBindTextureUnit(m_Pipeline->GetSamplerBinding(resourceId), static_cast<const OpenGLTexture&>(texture).GetRendererId());
+      const GLuint binding = m_Pipeline->GetSamplerBinding(resourceId);
+      glBindTextureUnit(binding, static_cast<const OpenGLTexture&>(texture).GetRendererId());
+      glBindSampler(binding, static_cast<const OpenGLTexture&>(texture).GetSamplerId());
    }
 
 
@@ -98,10 +109,24 @@ namespace Pikzel {
 
 
    std::unique_ptr<Pikzel::Pipeline> OpenGLGraphicsContext::CreatePipeline(const PipelineSettings& settings) const {
+      if (auto pipeline = PipelineCompiler::TakeWarmedUp(this, settings)) {
+         return pipeline;
+      }
       return std::make_unique<OpenGLPipeline>(settings);
    }
 
 
+   std::shared_ptr<PipelineFuture> OpenGLGraphicsContext::CreatePipelineAsync(const PipelineSettings& settings) const {
+      // The shaders are translated on a worker thread, but compiling them needs the GL context, so that is left for the render thread
+      return PipelineCompiler::Submit(
+         this,
+         settings,
+         [](const PipelineSettings& pipelineSettings) { return std::make_unique<OpenGLPipeline>(pipelineSettings, true); },
+         [](Pipeline& pipeline) { static_cast<OpenGLPipeline&>(pipeline).CreateGLObjects(); }
+      );
+   }
+
+
    void OpenGLGraphicsContext::PushConstant(const Id id, bool value) {
       PKZL_CORE_ASSERT(m_Pipeline, "Attempted to access null pipeline!");
       m_Pipeline->PushConstant(id, value);
@@ -337,12 +362,25 @@ namespace Pikzel {
    }
 
 
-   void OpenGLGraphicsContext::DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount/*= 0*/, const uint32_t vertexOffset/*= 0*/) {
+   void OpenGLGraphicsContext::DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount/*= 0*/, const uint32_t vertexOffset/*= 0*/, const uint32_t firstIndex/*= 0*/) {
       PKZL_PROFILE_FUNCTION();
       uint32_t count = indexCount ? indexCount : indexBuffer.GetCount();
+      const bool isUInt16 = indexBuffer.GetIndexType() == IndexType::UInt16;
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      glDrawElementsBaseVertex(GL_TRIANGLES, count, isUInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, reinterpret_cast<const void*>(static_cast<uintptr_t>(firstIndex) * (isUInt16 ? sizeof(uint16_t) : sizeof(uint32_t))), vertexOffset);
+   }
+
+
+   void OpenGLGraphicsContext::DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const StorageBuffer& commands, const uint64_t commandsOffset, const StorageBuffer& count, const uint64_t countOffset, const uint32_t maxDrawCount) {
+      PKZL_PROFILE_FUNCTION();
       Bind(vertexBuffer);
       Bind(indexBuffer);
-      glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr, vertexOffset);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, static_cast<const OpenGLStorageBuffer&>(commands).GetRendererId());
+      glBindBuffer(GL_PARAMETER_BUFFER, static_cast<const OpenGLStorageBuffer&>(count).GetRendererId());
+      glMultiDrawElementsIndirectCount(GL_TRIANGLES, indexBuffer.GetIndexType() == IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, reinterpret_cast<const void*>(static_cast<uintptr_t>(commandsOffset)), static_cast<GLintptr>(countOffset), maxDrawCount, sizeof(DrawIndexedIndirectCommand));
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+      glBindBuffer(GL_PARAMETER_BUFFER, 0);
    }
 
 
@@ -445,6 +483,22 @@ namespace Pikzel {
    }
 
 
+   void OpenGLWindowGC::ClearDepth(const glm::uvec2& offset, const glm::uvec2& extent, const uint32_t baseLayer, const uint32_t layerCount) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT((baseLayer == 0) && (layerCount == 1), "Window depth buffer has only one layer!");
+      glEnable(GL_SCISSOR_TEST);
+      glScissor(offset.x, offset.y, extent.x, extent.y);
+      glClearDepth(GetClearDepthValue());
+      glClear(GL_DEPTH_BUFFER_BIT);
+      glDisable(GL_SCISSOR_TEST);
+   }
+
+
+   void OpenGLWindowGC::SetViewport(const glm::uvec2& offset, const glm::uvec2& extent) {
+      glViewport(offset.x, offset.y, extent.x, extent.y);
+   }
+
+
    void OpenGLWindowGC::EndFrame() {}
 
 
@@ -503,10 +557,34 @@ namespace Pikzel {
    }
 
 
-   void OpenGLFramebufferGC::EndFrame() {}
+   void OpenGLFramebufferGC::ClearDepth(const glm::uvec2& offset, const glm::uvec2& extent, const uint32_t baseLayer, const uint32_t layerCount) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(m_Framebuffer->HasDepthAttachment(), "Attempted to clear depth of a framebuffer that does not have a depth attachment!");
+      if (m_Framebuffer->GetMSAANumSamples() > 1) {
+         // multisampled depth is a renderbuffer (and cannot be layered), so scissored clear is good enough
+         PKZL_CORE_ASSERT((baseLayer == 0) && (layerCount == 1), "Multisampled framebuffer depth has only one layer!");
+         glEnable(GL_SCISSOR_TEST);
+         glScissor(offset.x, offset.y, extent.x, extent.y);
+         glClearDepth(GetClearDepthValue());
+         glClear(GL_DEPTH_BUFFER_BIT);
+         glDisable(GL_SCISSOR_TEST);
+      } else {
+         // glClear() would clear every layer of a layered attachment, so clear the texture directly instead
+         const float depth = static_cast<float>(GetClearDepthValue());
+         glClearTexSubImage(static_cast<const OpenGLTexture&>(m_Framebuffer->GetDepthTexture()).GetRendererId(), 0, offset.x, offset.y, baseLayer, extent.x, extent.y, layerCount, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
+      }
+   }
 
 
-   void OpenGLFramebufferGC::SwapBuffers() {
+   void OpenGLFramebufferGC::SetViewport(const glm::uvec2& offset, const glm::uvec2& extent) {
+      glViewport(offset.x, offset.y, extent.x, extent.y);
+   }
+
+
+   // Multisampled attachments are resolved here (rather than in SwapBuffers()), so that the frame can be sampled by whatever is
+   // submitted after it without waiting for anything (see RenderGraph::Execute()).  This matches the Vulkan backend, which resolves
+   // at the end of the render pass.
+   void OpenGLFramebufferGC::EndFrame() {
       PKZL_PROFILE_FUNCTION();
 
       {
@@ -552,4 +630,8 @@ namespace Pikzel {
          glBindFramebuffer(GL_FRAMEBUFFER, 0);
       }
    }
+
+
+   // OpenGL executes commands in the order they were issued, so there is nothing to wait for
+   void OpenGLFramebufferGC::SwapBuffers() {}
 }
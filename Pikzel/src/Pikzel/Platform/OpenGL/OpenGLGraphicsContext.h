@@ -41,6 +41,9 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) override;
       virtual void Unbind(const UniformBuffer& buffer) override;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) override;
+      virtual void Unbind(const StorageBuffer& buffer) override;
+
       virtual void Bind(const Id resourceId, const Texture& texture) override;
       virtual void Unbind(const Texture& texture) override;
 
@@ -48,6 +51,7 @@ namespace Pikzel {
       virtual void Unbind(const Pipeline& pipeline) override;
 
       virtual std::unique_ptr<Pipeline> CreatePipeline(const PipelineSettings& settings) const override;
+      virtual std::shared_ptr<PipelineFuture> CreatePipelineAsync(const PipelineSettings& settings) const override;
 
       virtual void PushConstant(const Id id, bool value) override;
       virtual void PushConstant(const Id id, int value) override;
@@ -89,7 +93,8 @@ namespace Pikzel {
       virtual void PushConstant(const Id id, const glm::dmat4& value) override;
 
       virtual void DrawTriangles(const VertexBuffer& vertexBuffer, const uint32_t vertexCount, const uint32_t vertexOffset = 0) override;
-      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0) override;
+      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0, const uint32_t firstIndex = 0) override;
+      virtual void DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const StorageBuffer& commands, const uint64_t commandsOffset, const StorageBuffer& count, const uint64_t countOffset, const uint32_t maxDrawCount) override;
 
    private:
       OpenGLPipeline* m_Pipeline;
@@ -111,6 +116,9 @@ namespace Pikzel {
       virtual void BeginFrame(const BeginFrameOp operation = BeginFrameOp::ClearAll) override;
       virtual void EndFrame() override;
 
+      virtual void ClearDepth(const glm::uvec2& offset, const glm::uvec2& extent, const uint32_t baseLayer = 0, const uint32_t layerCount = 1) override;
+      virtual void SetViewport(const glm::uvec2& offset, const glm::uvec2& extent) override;
+
       virtual void SwapBuffers() override;
 
    private:
@@ -130,6 +138,9 @@ namespace Pikzel {
       virtual void BeginFrame(const BeginFrameOp operation = BeginFrameOp::ClearAll) override;
       virtual void EndFrame() override;
 
+      virtual void ClearDepth(const glm::uvec2& offset, const glm::uvec2& extent, const uint32_t baseLayer = 0, const uint32_t layerCount = 1) override;
+      virtual void SetViewport(const glm::uvec2& offset, const glm::uvec2& extent) override;
+
       virtual void SwapBuffers() override;
 
    private:
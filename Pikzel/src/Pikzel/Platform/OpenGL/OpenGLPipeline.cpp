@@ -2,6 +2,7 @@
 #include "OpenGLBuffer.h"
 
 #include "Pikzel/Core/Utility.h"
+#include "Pikzel/Renderer/ShaderReloader.h"
 
 #include <glm/gtc/type_ptr.hpp>
 #include <spirv_glsl.hpp>
@@ -30,6 +31,9 @@ namespace Pikzel {
          case DataType::DVec2:    return GL_DOUBLE;
          case DataType::DVec3:    return GL_DOUBLE;
          case DataType::DVec4:    return GL_DOUBLE;
+         case DataType::UNorm16Vec4: return GL_UNSIGNED_SHORT;
+         case DataType::SNorm16Vec2: return GL_SHORT;
+         case DataType::HVec2:    return GL_HALF_FLOAT;
       }
 
       PKZL_CORE_ASSERT(false, "Unknown DataType!");
@@ -135,9 +139,10 @@ namespace Pikzel {
 
    void OpenGLPipeline::ParseResourceBindings(spirv_cross::Compiler& compiler) {
       spirv_cross::ShaderResources resources = compiler.get_shader_resources();
-      ParseResourceBindings_Internal("uniform buffer", compiler, m_UniformBufferBindingMap, m_UniformBufferResources, {&m_SamplerResources, &m_StorageImageResources}, resources.uniform_buffers);
-      ParseResourceBindings_Internal("sampler", compiler, m_SamplerBindingMap, m_SamplerResources, {&m_UniformBufferResources, &m_StorageImageResources}, resources.sampled_images);
-      ParseResourceBindings_Internal("storage image", compiler, m_StorageImageBindingMap, m_StorageImageResources, {&m_UniformBufferResources, &m_SamplerResources}, resources.storage_images);
+      ParseResourceBindings_Internal("uniform buffer", compiler, m_UniformBufferBindingMap, m_UniformBufferResources, {&m_SamplerResources, &m_StorageImageResources, &m_StorageBufferResources}, resources.uniform_buffers);
+      ParseResourceBindings_Internal("sampler", compiler, m_SamplerBindingMap, m_SamplerResources, {&m_UniformBufferResources, &m_StorageImageResources, &m_StorageBufferResources}, resources.sampled_images);
+      ParseResourceBindings_Internal("storage image", compiler, m_StorageImageBindingMap, m_StorageImageResources, {&m_UniformBufferResources, &m_SamplerResources, &m_StorageBufferResources}, resources.storage_images);
+      ParseResourceBindings_Internal("storage buffer", compiler, m_StorageBufferBindingMap, m_StorageBufferResources, {&m_UniformBufferResources, &m_SamplerResources, &m_StorageImageResources}, resources.storage_buffers);
    }
 
 
@@ -173,12 +178,32 @@ namespace Pikzel {
 
 
    OpenGLPipeline::OpenGLPipeline(const PipelineSettings& settings)
-   : m_EnableBlend {settings.enableBlend}
+   : OpenGLPipeline {settings, false}
+   {}
+
+
+   OpenGLPipeline::OpenGLPipeline(const PipelineSettings& settings, const bool deferGLObjects)
+   : Pipeline {settings}
+   , m_EnableBlend {settings.enableBlend}
    {
-      std::vector<GLuint> shaders;
       for (const auto& [shaderType, src] : settings.shaders) {
-         AppendShader(shaderType, src, settings.specializationConstants);
+         TranslateShader(shaderType, src, settings.specializationConstants);
       }
+      if (!deferGLObjects) {
+         CreateGLObjects();
+      }
+   }
+
+
+   void OpenGLPipeline::CreateGLObjects() {
+      if (m_RendererId != 0) {
+         return;
+      }
+
+      for (const auto& [shaderType, glsl] : m_GLSL) {
+         CompileShader(shaderType, glsl);
+      }
+      m_GLSL.clear();
 
       LinkShaderProgram();
       DeleteShaders();
@@ -187,6 +212,7 @@ namespace Pikzel {
       glCreateVertexArrays(1, &m_VAORendererId);
       glBindVertexArray(m_VAORendererId);
 
+      const PipelineSettings settings = GetSettings();
       GLuint vertexAttributeIndex = 0;
       for (const auto& element : settings.bufferLayout) {
          switch (element.dataType) {
@@ -210,6 +236,9 @@ namespace Pikzel {
             case DataType::DVec2:
             case DataType::DVec3:
             case DataType::DVec4:
+            case DataType::UNorm16Vec4:
+            case DataType::SNorm16Vec2:
+            case DataType::HVec2:
             {
                glEnableVertexAttribArray(vertexAttributeIndex);
                glVertexAttribFormat(vertexAttributeIndex, element.GetComponentCount(), DataTypeToOpenGLType(element.dataType), element.normalized ? GL_TRUE : GL_FALSE, element.offset);
@@ -254,8 +283,31 @@ namespace Pikzel {
 
 
    OpenGLPipeline::~OpenGLPipeline() {
-      glDeleteVertexArrays(1, &m_VAORendererId);
-      glDeleteProgram(m_RendererId);
+      // a pipeline whose GL objects were never created may be destroyed on a thread that does not have the GL context
+      if (m_RendererId != 0) {
+         glDeleteVertexArrays(1, &m_VAORendererId);
+         glDeleteProgram(m_RendererId);
+      }
+   }
+
+
+   void OpenGLPipeline::Reload() {
+      // Build the new program completely before touching this one, so that if it fails this one is unchanged.
+      // The old program is then deleted with the temporary
+      OpenGLPipeline reloaded {GetSettings()};
+      std::swap(m_ShaderSrcs, reloaded.m_ShaderSrcs);
+      std::swap(m_ShaderIds, reloaded.m_ShaderIds);
+      std::swap(m_PushConstants, reloaded.m_PushConstants);
+      std::swap(m_UniformBufferBindingMap, reloaded.m_UniformBufferBindingMap);
+      std::swap(m_UniformBufferResources, reloaded.m_UniformBufferResources);
+      std::swap(m_SamplerBindingMap, reloaded.m_SamplerBindingMap);
+      std::swap(m_SamplerResources, reloaded.m_SamplerResources);
+      std::swap(m_StorageImageBindingMap, reloaded.m_StorageImageBindingMap);
+      std::swap(m_StorageImageResources, reloaded.m_StorageImageResources);
+      std::swap(m_StorageBufferBindingMap, reloaded.m_StorageBufferBindingMap);
+      std::swap(m_StorageBufferResources, reloaded.m_StorageBufferResources);
+      std::swap(m_RendererId, reloaded.m_RendererId);
+      std::swap(m_VAORendererId, reloaded.m_VAORendererId);
    }
 
 
@@ -518,6 +570,16 @@ namespace Pikzel {
    }
 
 
+   GLuint OpenGLPipeline::GetStorageBufferBinding(const Id resourceId, bool exceptionIfNotFound) const {
+      const auto resource = m_StorageBufferResources.find(resourceId);
+      GLuint retVal = (resource == m_StorageBufferResources.end()) ? ~0 : resource->second.Binding;
+      if (exceptionIfNotFound && retVal == ~0) {
+         throw std::invalid_argument {fmt::format("OpenGLPipeline::GetStorageBufferBinding() failed to find resource with id {0}!", resourceId)};
+      }
+      return retVal;
+   }
+
+
    GLuint OpenGLPipeline::GetUniformBufferBinding(const Id resourceId, bool exceptionIfNotFound) const {
       const auto resource = m_UniformBufferResources.find(resourceId);
       GLuint retVal = (resource == m_UniformBufferResources.end()) ? ~0 : resource->second.Binding;
@@ -539,17 +601,20 @@ namespace Pikzel {
    }
 
 
-   void OpenGLPipeline::AppendShader(ShaderType type, const std::filesystem::path path, const SpecializationConstantsMap& specializationConstants) {
+   void OpenGLPipeline::TranslateShader(ShaderType type, const std::filesystem::path path, const SpecializationConstantsMap& specializationConstants) {
       PKZL_CORE_LOG_TRACE("Appending shader '{0}'", path.string());
 
-      std::vector<uint32_t> src = ReadFile<uint32_t>(path);
+      std::vector<uint32_t> src = ShaderReloader::ReadSPIRV(path);
 
       spirv_cross::CompilerGLSL compiler(src);
       ParsePushConstants(compiler);
       ParseResourceBindings(compiler);
       SetSpecializationConstants(compiler, specializationConstants);
-      std::string glsl = compiler.compile();
+      m_GLSL.emplace_back(type, compiler.compile());
+   }
+
 
+   void OpenGLPipeline::CompileShader(ShaderType type, const std::string& glsl) {
       GLuint shader = glCreateShader(ShaderTypeToOpenGLType(type));
       const GLchar* srcC = glsl.data();
       glShaderSource(shader, 1, &srcC, nullptr);
@@ -597,9 +662,11 @@ namespace Pikzel {
          glGetProgramInfoLog(m_RendererId, maxLength, &maxLength, &infoLog[0]);
 
          glDeleteProgram(m_RendererId);
+         m_RendererId = 0;
          for (const auto shaderId : m_ShaderIds) {
             glDeleteShader(shaderId);
          }
+         m_ShaderIds.clear();
 
          PKZL_CORE_LOG_ERROR("{0}", infoLog.data());
          throw std::runtime_error {"Shader link failure!"};
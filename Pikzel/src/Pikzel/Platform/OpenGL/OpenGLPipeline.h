@@ -35,8 +35,18 @@ namespace Pikzel {
    class OpenGLPipeline : public Pipeline {
    public:
       OpenGLPipeline(const PipelineSettings& settings);
+
+      // Translate the shaders to glsl, but do not create any OpenGL objects yet.  CreateGLObjects() must then be called before the pipeline is
+      // used.  This is so that the translation can be done on a worker thread, which does not have the GL context (see CreatePipelineAsync())
+      OpenGLPipeline(const PipelineSettings& settings, const bool deferGLObjects);
+
       virtual ~OpenGLPipeline();
 
+      // Compile and link the translated shaders.  Must be called from the thread that has the GL context
+      void CreateGLObjects();
+
+      virtual void Reload() override;
+
       GLuint GetRendererId() const;
       GLuint GetVAORendererId() const;
 
@@ -81,12 +91,14 @@ namespace Pikzel {
 
       GLuint GetSamplerBinding(const Id resourceId, const bool exceptionIfNotFound = true) const;
       GLuint GetStorageImageBinding(const Id resourceId, const bool exceptionIfNotFound = true) const;
+      GLuint GetStorageBufferBinding(const Id resourceId, const bool exceptionIfNotFound = true) const;
       GLuint GetUniformBufferBinding(const Id resourceId, const bool exceptionIfNotFound = true) const;
 
       void SetGLState() const;
 
    private:
-      void AppendShader(ShaderType type, const std::filesystem::path path, const SpecializationConstantsMap& specializationConstants);
+      void TranslateShader(ShaderType type, const std::filesystem::path path, const SpecializationConstantsMap& specializationConstants);
+      void CompileShader(ShaderType type, const std::string& glsl);
       void ParsePushConstants(spirv_cross::Compiler& compiler);
       void ParseResourceBindings(spirv_cross::Compiler& compiler);
       void SetSpecializationConstants(spirv_cross::Compiler& compiler, const SpecializationConstantsMap& specializationConstants);
@@ -96,6 +108,7 @@ namespace Pikzel {
 
    private:
       std::vector<std::vector<uint32_t>> m_ShaderSrcs;
+      std::vector<std::pair<ShaderType, std::string>> m_GLSL;      // translated, but not yet compiled
       std::vector<uint32_t> m_ShaderIds;
       OpenGLUniformMap m_PushConstants;                            // push constants in the Vulkan glsl get turned into uniforms for OpenGL
       OpenGLBindingMap m_UniformBufferBindingMap;
@@ -104,6 +117,8 @@ namespace Pikzel {
       OpenGLResourceMap m_SamplerResources;                        // maps resource id (essentially the name of the resource) -> its opengl binding
       OpenGLBindingMap m_StorageImageBindingMap;
       OpenGLResourceMap m_StorageImageResources;                   // maps resource id (essentially the name of the resource) -> its opengl binding
+      OpenGLBindingMap m_StorageBufferBindingMap;
+      OpenGLResourceMap m_StorageBufferResources;                  // maps resource id (essentially the name of the resource) -> its opengl binding
 
       uint32_t m_RendererId = 0;
       uint32_t m_VAORendererId = 0;
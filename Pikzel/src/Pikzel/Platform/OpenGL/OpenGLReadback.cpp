@@ -0,0 +1,110 @@
+#include "OpenGLReadback.h"
+
+#include <algorithm>
+
+namespace Pikzel {
+
+   OpenGLReadback::Slot::~Slot() {
+      if (Sync) {
+         glDeleteSync(Sync);
+      }
+      glDeleteBuffers(1, &Buffer);
+   }
+
+
+   bool OpenGLReadback::Slot::IsCopied() const {
+      if (!Sync) {
+         return true;
+      }
+      const GLenum result = glClientWaitSync(Sync, 0, 0);
+      return (result == GL_ALREADY_SIGNALED) || (result == GL_CONDITION_SATISFIED);
+   }
+
+
+   std::shared_ptr<ReadbackFuture> OpenGLReadback::ReadbackAsync(const OpenGLTexture& texture, const uint32_t mipLevel) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(mipLevel < texture.GetMIPLevels(), "RenderCore::ReadbackAsync() texture does not have requested mip level!");
+      const uint32_t width = std::max(texture.GetWidth() >> mipLevel, 1u);
+      const uint32_t height = std::max(texture.GetHeight() >> mipLevel, 1u);
+      uint32_t depthFactor = 1;
+      if (
+         (texture.GetType() == TextureType::TextureCube) ||
+         (texture.GetType() == TextureType::TextureCubeArray)
+      ) {
+         depthFactor = 6;
+      }
+      const GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * texture.GetLayers() * depthFactor * Texture::BPP(texture.GetFormat());
+
+      auto slot = AcquireSlot(size);
+
+      // make sure any writes from compute shaders have landed before reading back.
+      // With a pack buffer bound, glGetTextureImage() writes to it (the "pixels" are an offset into it) and returns straight away
+      glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+      glPixelStorei(GL_PACK_ALIGNMENT, 1);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->Buffer);
+      glGetTextureImage(texture.GetRendererId(), mipLevel, TextureFormatToDataFormat(texture.GetFormat()), TextureFormatToDataType(texture.GetFormat()), static_cast<GLsizei>(size), nullptr);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+      return Submit(std::move(slot), size, texture.GetFormat(), width, height);
+   }
+
+
+   std::shared_ptr<ReadbackFuture> OpenGLReadback::ReadbackAsync(const GLuint buffer, const uint64_t offset, const uint64_t size) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(size > 0, "RenderCore::ReadbackAsync() size is zero!");
+      auto slot = AcquireSlot(static_cast<GLsizeiptr>(size));
+
+      // make sure any writes from compute shaders have landed before copying
+      glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+      glCopyNamedBufferSubData(buffer, slot->Buffer, static_cast<GLintptr>(offset), 0, static_cast<GLsizeiptr>(size));
+
+      return Submit(std::move(slot), static_cast<GLsizeiptr>(size));
+   }
+
+
+   std::shared_ptr<OpenGLReadback::Slot> OpenGLReadback::AcquireSlot(const GLsizeiptr size) {
+      // the smallest free pack buffer that is big enough.  Failing that, any free slot (whose buffer is then replaced)
+      std::shared_ptr<Slot> found;
+      std::shared_ptr<Slot> free;
+      for (const auto& slot : m_Slots) {
+         if ((slot.use_count() == 1) && slot->IsCopied()) {
+            if ((slot->Size >= size) && (!found || (slot->Size < found->Size))) {
+               found = slot;
+            }
+            free = slot;
+         }
+      }
+      if (!found) {
+         found = free ? free : m_Slots.emplace_back(std::make_shared<Slot>());
+         glDeleteBuffers(1, &found->Buffer);
+         glCreateBuffers(1, &found->Buffer);
+         glNamedBufferStorage(found->Buffer, size, nullptr, GL_MAP_READ_BIT | GL_CLIENT_STORAGE_BIT);
+         found->Size = size;
+      }
+      if (found->Sync) {
+         glDeleteSync(found->Sync);
+         found->Sync = nullptr;
+      }
+      return found;
+   }
+
+
+   std::shared_ptr<ReadbackFuture> OpenGLReadback::Submit(std::shared_ptr<Slot> slot, const GLsizeiptr size, const TextureFormat format, const uint32_t width, const uint32_t height) {
+      slot->Sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glFlush();  // so that the fence is sure to be signalled eventually, even if nothing else is submitted
+
+      // the callbacks hold on to the slot (so it is not reused) until the future has read it
+      return std::make_shared<ReadbackFuture>(
+         [slot] { return slot->IsCopied(); },
+         [slot] { static_cast<void>(glClientWaitSync(slot->Sync, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX)); },
+         [slot, size] (std::vector<uint8_t>& data) {
+            data.resize(static_cast<size_t>(size));
+            glGetNamedBufferSubData(slot->Buffer, 0, size, data.data());
+         },
+         format,
+         width,
+         height
+      );
+   }
+
+}
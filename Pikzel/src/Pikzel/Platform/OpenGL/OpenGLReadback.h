@@ -0,0 +1,46 @@
+#pragma once
+
+#include "OpenGLTexture.h"
+
+#include "Pikzel/Renderer/Readback.h"
+
+#include <memory>
+#include <vector>
+
+namespace Pikzel {
+
+   // Copies textures and buffers into pixel pack buffers, with a sync object to tell when the copy has finished, without waiting for it.
+   // Pack buffers are kept in a pool, and a buffer goes back into the pool once the ReadbackFuture that it was handed out with has
+   // read it (or been thrown away) and the GPU has finished copying into it.
+   class OpenGLReadback final {
+   public:
+      OpenGLReadback() = default;
+      PKZL_NO_COPYMOVE(OpenGLReadback);
+
+      std::shared_ptr<ReadbackFuture> ReadbackAsync(const OpenGLTexture& texture, const uint32_t mipLevel);
+      std::shared_ptr<ReadbackFuture> ReadbackAsync(const GLuint buffer, const uint64_t offset, const uint64_t size);
+
+   private:
+      struct Slot {
+         Slot() = default;
+         PKZL_NO_COPYMOVE(Slot);
+         ~Slot();
+
+         bool IsCopied() const;
+
+         GLuint Buffer = 0;
+         GLsizeiptr Size = 0;
+         GLsync Sync = nullptr;           // signalled when the copy into Buffer has finished
+      };
+
+      // A slot that is not in use, with a pack buffer of at least size bytes
+      std::shared_ptr<Slot> AcquireSlot(const GLsizeiptr size);
+
+      // Fence the copy that has just been issued into the slot's buffer, and wrap it in a future that reads size bytes from that buffer
+      std::shared_ptr<ReadbackFuture> Submit(std::shared_ptr<Slot> slot, const GLsizeiptr size, const TextureFormat format = TextureFormat::Undefined, const uint32_t width = 0, const uint32_t height = 0);
+
+   private:
+      std::vector<std::shared_ptr<Slot>> m_Slots;  // a slot is in use while a future still refers to it
+   };
+
+}
@@ -3,16 +3,24 @@
 #include "OpenGLComputeContext.h"
 #include "OpenGLGraphicsContext.h"
 #include "OpenGLPipeline.h"
+#include "OpenGLSamplerCache.h"
 #include "OpenGLTexture.h"
 
 #include <glm/ext/matrix_transform.hpp>
 
+#include <algorithm>
+
 #if defined(PKZL_PLATFORM_WINDOWS)
    #define PLATFORM_API __declspec(dllexport)
 #else
    #define PLATFORM_API
 #endif
 
+// GL_NVX_gpu_memory_info and GL_ATI_meminfo (values are in kilobytes)
+#define PKZL_GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define PKZL_GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_MEMORY_NVX 0x9049
+#define PKZL_GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+
 namespace Pikzel {
 
    extern "C" PLATFORM_API IRenderCore* CDECL CreateRenderCore(const Window* window) {
@@ -93,10 +101,24 @@ namespace Pikzel {
 
       glEnable(GL_MULTISAMPLE);
       glEnable(GL_FRAMEBUFFER_SRGB);
+
+      m_HasNVXMemoryInfo = glfwExtensionSupported("GL_NVX_gpu_memory_info");
+      m_HasATIMemInfo = glfwExtensionSupported("GL_ATI_meminfo");
+      if (m_HasATIMemInfo) {
+         // GL_ATI_meminfo only says how much memory is free.  Take whatever is free at startup as the budget
+         GLint freeMemory[4] = {};
+         glGetIntegerv(PKZL_GL_TEXTURE_FREE_MEMORY_ATI, freeMemory);
+         m_ATIInitialFreeMemory = static_cast<uint64_t>(freeMemory[0]) * 1024;
+      }
+
+      m_Readback = std::make_unique<OpenGLReadback>();
    }
 
 
-   OpenGLRenderCore::~OpenGLRenderCore() {}
+   OpenGLRenderCore::~OpenGLRenderCore() {
+      m_Readback = nullptr;
+      OpenGLSamplerCache::Clear();
+   }
 
 
    void OpenGLRenderCore::UploadImGuiFonts() {
@@ -133,6 +155,11 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<IndexBuffer> OpenGLRenderCore::CreateIndexBuffer(const uint32_t count, const uint16_t* indices) {
+      return std::make_unique<OpenGLIndexBuffer>(count, indices);
+   }
+
+
    std::unique_ptr<UniformBuffer> OpenGLRenderCore::CreateUniformBuffer(const uint32_t size) {
       return std::make_unique<OpenGLUniformBuffer>(size);
    }
@@ -143,6 +170,16 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<StorageBuffer> OpenGLRenderCore::CreateStorageBuffer(const uint32_t size) {
+      return std::make_unique<OpenGLStorageBuffer>(size);
+   }
+
+
+   std::unique_ptr<StorageBuffer> OpenGLRenderCore::CreateStorageBuffer(const uint32_t size, const void* data) {
+      return std::make_unique<OpenGLStorageBuffer>(size, data);
+   }
+
+
    std::unique_ptr<Framebuffer> OpenGLRenderCore::CreateFramebuffer(const FramebufferSettings& settings) {
       return std::make_unique<OpenGLFramebuffer>(settings);
    }
@@ -159,4 +196,34 @@ namespace Pikzel {
       return nullptr;
    }
 
+
+
+   MemoryBudget OpenGLRenderCore::GetMemoryBudget() const {
+      MemoryBudget budget;
+      if (m_HasNVXMemoryInfo) {
+         GLint total = 0;
+         GLint available = 0;
+         glGetIntegerv(PKZL_GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+         glGetIntegerv(PKZL_GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_MEMORY_NVX, &available);
+         budget.Budget = static_cast<uint64_t>(total) * 1024;
+         budget.Usage = static_cast<uint64_t>(std::max(total - available, 0)) * 1024;
+      } else if (m_HasATIMemInfo) {
+         GLint freeMemory[4] = {};
+         glGetIntegerv(PKZL_GL_TEXTURE_FREE_MEMORY_ATI, freeMemory);
+         budget.Budget = m_ATIInitialFreeMemory;
+         budget.Usage = m_ATIInitialFreeMemory - std::min(m_ATIInitialFreeMemory, static_cast<uint64_t>(freeMemory[0]) * 1024);
+      }
+      return budget;
+   }
+
+
+   std::shared_ptr<ReadbackFuture> OpenGLRenderCore::ReadbackAsync(const Texture& texture, const uint32_t mipLevel) {
+      return m_Readback->ReadbackAsync(static_cast<const OpenGLTexture&>(texture), mipLevel);
+   }
+
+
+   std::shared_ptr<ReadbackFuture> OpenGLRenderCore::ReadbackAsync(const StorageBuffer& buffer, const uint64_t offset, const uint64_t size) {
+      return m_Readback->ReadbackAsync(static_cast<const OpenGLStorageBuffer&>(buffer).GetRendererId(), offset, size);
+   }
+
 }
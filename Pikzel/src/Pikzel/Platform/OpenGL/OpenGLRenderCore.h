@@ -1,5 +1,7 @@
 #pragma once
 
+#include "OpenGLReadback.h"
+
 #include "Pikzel/Renderer/RenderCore.h"
 
 namespace Pikzel {
@@ -20,14 +22,29 @@ namespace Pikzel {
       virtual std::unique_ptr<VertexBuffer> CreateVertexBuffer(const BufferLayout& layout, const uint32_t size, const void* data) override;
 
       virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint32_t* indices) override;
+      virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint16_t* indices) override;
 
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size) override;
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size, const void* data) override;
 
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size) override;
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size, const void* data) override;
+
       virtual std::unique_ptr<Framebuffer> CreateFramebuffer(const FramebufferSettings& settings) override;
 
       virtual std::unique_ptr<Texture> CreateTexture(const TextureSettings& settings) override;
 
+      virtual MemoryBudget GetMemoryBudget() const override;
+
+      virtual std::shared_ptr<ReadbackFuture> ReadbackAsync(const Texture& texture, const uint32_t mipLevel) override;
+      virtual std::shared_ptr<ReadbackFuture> ReadbackAsync(const StorageBuffer& buffer, const uint64_t offset, const uint64_t size) override;
+
+   private:
+      std::unique_ptr<OpenGLReadback> m_Readback;
+      uint64_t m_ATIInitialFreeMemory = 0;
+      bool m_HasNVXMemoryInfo = false;
+      bool m_HasATIMemInfo = false;
+
    };
 
 }
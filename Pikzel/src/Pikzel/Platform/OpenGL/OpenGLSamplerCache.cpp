@@ -0,0 +1,41 @@
+#include "OpenGLSamplerCache.h"
+
+namespace Pikzel {
+
+   GLuint OpenGLSamplerCache::GetSampler(const OpenGLSamplerSettings& settings) {
+      auto sampler = m_Samplers.find(settings);
+      if (sampler == m_Samplers.end()) {
+         GLuint samplerId = 0;
+         glCreateSamplers(1, &samplerId);
+         glSamplerParameteri(samplerId, GL_TEXTURE_MIN_FILTER, settings.minFilter);
+         glSamplerParameteri(samplerId, GL_TEXTURE_MAG_FILTER, settings.magFilter);
+         glSamplerParameteri(samplerId, GL_TEXTURE_WRAP_S, settings.wrapS);
+         glSamplerParameteri(samplerId, GL_TEXTURE_WRAP_T, settings.wrapT);
+         glSamplerParameteri(samplerId, GL_TEXTURE_WRAP_R, settings.wrapR);
+         glSamplerParameterf(samplerId, GL_TEXTURE_MIN_LOD, settings.minLod);
+         if (settings.maxAnisotropy > 1.0f) {
+            glSamplerParameterf(samplerId, GL_TEXTURE_MAX_ANISOTROPY, settings.maxAnisotropy);
+         }
+         glSamplerParameteri(samplerId, GL_TEXTURE_COMPARE_MODE, settings.compareMode);
+         glSamplerParameteri(samplerId, GL_TEXTURE_COMPARE_FUNC, settings.compareFunc);
+         const float borderColor[] = {0.0f, 0.0f, 0.0f, 1.0f};
+         glSamplerParameterfv(samplerId, GL_TEXTURE_BORDER_COLOR, borderColor);
+         sampler = m_Samplers.emplace(settings, samplerId).first;
+      }
+      return sampler->second;
+   }
+
+
+   size_t OpenGLSamplerCache::GetSamplerCount() {
+      return m_Samplers.size();
+   }
+
+
+   void OpenGLSamplerCache::Clear() {
+      for (const auto& [settings, samplerId] : m_Samplers) {
+         glDeleteSamplers(1, &samplerId);
+      }
+      m_Samplers.clear();
+   }
+
+}
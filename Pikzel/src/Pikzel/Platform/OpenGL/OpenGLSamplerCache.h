@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+#include <compare>
+#include <map>
+
+namespace Pikzel {
+
+   struct OpenGLSamplerSettings {
+      GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+      GLenum magFilter = GL_LINEAR;
+      GLenum wrapS = GL_REPEAT;
+      GLenum wrapT = GL_REPEAT;
+      GLenum wrapR = GL_REPEAT;
+      float minLod = 0.0f;
+      float maxAnisotropy = 1.0f;
+      GLenum compareMode = GL_NONE;
+      GLenum compareFunc = GL_LEQUAL;
+
+      auto operator<=>(const OpenGLSamplerSettings&) const = default;
+   };
+
+
+   // Sampler objects shared by all textures.
+   // A texture's sampler object is bound alongside it (see OpenGLGraphicsContext::Bind()), and overrides the texture's own
+   // sampling parameters.  The texture's own parameters are still set (to the same values), for things that bind the texture
+   // without a sampler object (e.g. ImGui).
+   // Sampler objects are owned by the cache.  Do not delete the ones returned by GetSampler()
+   class OpenGLSamplerCache {
+      OpenGLSamplerCache() = delete;
+
+   public:
+      // Returns a sampler object with the given settings, creating it if there is not one already
+      static GLuint GetSampler(const OpenGLSamplerSettings& settings);
+
+      static size_t GetSamplerCount();
+
+      // Delete all of the sampler objects.  Call before the OpenGL context is destroyed.
+      static void Clear();
+
+   private:
+      inline static std::map<OpenGLSamplerSettings, GLuint> m_Samplers;
+   };
+
+}
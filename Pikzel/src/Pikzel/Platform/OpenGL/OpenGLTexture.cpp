@@ -31,6 +31,8 @@ namespace Pikzel {
          case TextureFormat::RG32F:     return GL_RG32F;
          case TextureFormat::RGB32F:    return GL_RGB32F;
          case TextureFormat::RGBA32F:   return GL_RGBA32F;
+         case TextureFormat::R11G11B10F: return GL_R11F_G11F_B10F;
+         case TextureFormat::RG16S:     return GL_RG16_SNORM;
          case TextureFormat::R8:        return GL_R8;
          case TextureFormat::R32F:      return GL_R32F;
          case TextureFormat::D32F:      return GL_DEPTH_COMPONENT32F;
@@ -64,6 +66,8 @@ namespace Pikzel {
          case TextureFormat::RG32F: return GL_RG;
          case TextureFormat::RGB32F: return GL_RGB;
          case TextureFormat::RGBA32F: return GL_RGBA;
+         case TextureFormat::R11G11B10F: return GL_RGB;
+         case TextureFormat::RG16S: return GL_RG;
          case TextureFormat::R8: return GL_RED;
          case TextureFormat::R32F: return GL_RED;
             // no need (yet) to set depth data yourself, so no depth formats here
@@ -86,6 +90,8 @@ namespace Pikzel {
          case TextureFormat::RG32F: return GL_FLOAT;
          case TextureFormat::RGB32F: return GL_FLOAT;
          case TextureFormat::RGBA32F: return GL_FLOAT;
+         case TextureFormat::R11G11B10F: return GL_UNSIGNED_INT_10F_11F_11F_REV;
+         case TextureFormat::RG16S: return GL_SHORT;
          case TextureFormat::R8: return GL_UNSIGNED_BYTE;
          case TextureFormat::R32F: return GL_FLOAT;
             // no need to set depth data yourself, so no depth formats here
@@ -123,6 +129,11 @@ namespace Pikzel {
 
 
    OpenGLTexture::~OpenGLTexture() {
+      for (const auto viewId : m_MIPViewIds) {
+         if (viewId) {
+            glDeleteTextures(1, &viewId);
+         }
+      }
       glDeleteTextures(1, &m_RendererId);
    }
 
@@ -337,11 +348,90 @@ namespace Pikzel {
    }
 
 
+   std::vector<uint8_t> OpenGLTexture::GetData(const uint32_t mipLevel) const {
+      PKZL_CORE_ASSERT(mipLevel < GetMIPLevels(), "OpenGLTexture::GetData() texture does not have requested mip level!");
+      const uint32_t width = std::max(GetWidth() >> mipLevel, 1u);
+      const uint32_t height = std::max(GetHeight() >> mipLevel, 1u);
+      uint32_t depthFactor = 1;
+      if (
+         (GetType() == TextureType::TextureCube) ||
+         (GetType() == TextureType::TextureCubeArray)
+      ) {
+         depthFactor = 6;
+      }
+      std::vector<uint8_t> data(static_cast<size_t>(width) * height * GetLayers() * depthFactor * BPP(GetFormat()));
+
+      // make sure any writes from compute shaders have landed before reading back
+      glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+      glPixelStorei(GL_PACK_ALIGNMENT, 1);
+      glGetTextureImage(m_RendererId, mipLevel, TextureFormatToDataFormat(GetFormat()), TextureFormatToDataType(GetFormat()), static_cast<GLsizei>(data.size()), data.data());
+      return data;
+   }
+
+
+   void OpenGLTexture::SetMIPData(const uint32_t mipLevel, const void* data, const uint32_t size) {
+      PKZL_CORE_ASSERT(GetType() == TextureType::Texture2D, "OpenGLTexture::SetMIPData() is only supported for 2D textures!");
+      PKZL_CORE_ASSERT(mipLevel < m_MIPLevels, "OpenGLTexture::SetMIPData() texture does not have requested mip level!");
+      PKZL_CORE_ASSERT(size == std::max(m_Width >> mipLevel, 1u) * std::max(m_Height >> mipLevel, 1u) * BPP(m_Format), "Data must be entire mip level!");
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      GLTextureSubImage(0, 0, mipLevel, 0, 0, data);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+   }
+
+
+   void OpenGLTexture::SetMinMIPLevel(const uint32_t mipLevel) {
+      PKZL_CORE_ASSERT(mipLevel < m_MIPLevels, "OpenGLTexture::SetMinMIPLevel() texture does not have requested mip level!");
+      m_MinMIPLevel = mipLevel;
+      glTextureParameterf(m_RendererId, GL_TEXTURE_MIN_LOD, static_cast<float>(mipLevel));
+      m_SamplerSettings.minLod = static_cast<float>(mipLevel);
+      m_SamplerId = OpenGLSamplerCache::GetSampler(m_SamplerSettings);
+   }
+
+
+   uint32_t OpenGLTexture::GetMinMIPLevel() const {
+      return m_MinMIPLevel;
+   }
+
+
    uint32_t OpenGLTexture::GetRendererId() const {
       return m_RendererId;
    }
 
 
+   uint32_t OpenGLTexture::GetSamplerId() const {
+      return m_SamplerId;
+   }
+
+
+   uint32_t OpenGLTexture::GetRendererId(const uint32_t mipLevel) const {
+      PKZL_CORE_ASSERT(mipLevel < m_MIPLevels, "Attempted to access view of invalid mip level!");
+      if (m_MIPViewIds.empty()) {
+         m_MIPViewIds.resize(m_MIPLevels, 0);
+      }
+      if (!m_MIPViewIds[mipLevel]) {
+         GLuint numLayers = 1;
+         switch (GetType()) {
+            case TextureType::Texture2DArray:   numLayers = m_Layers; break;
+            case TextureType::TextureCube:      numLayers = 6; break;
+            case TextureType::TextureCubeArray: numLayers = 6 * m_Layers; break;
+         }
+         glGenTextures(1, &m_MIPViewIds[mipLevel]);
+         glTextureView(m_MIPViewIds[mipLevel], TextureTypeToGLTarget(GetType()), m_RendererId, TextureFormatToInternalFormat(m_Format), mipLevel, 1, 0, numLayers);
+
+         // view has its own sampling parameters.  Same as the texture, except there are no mipmaps to filter between
+         GLint param;
+         glGetTextureParameteriv(m_RendererId, GL_TEXTURE_MAG_FILTER, &param);
+         glTextureParameteri(m_MIPViewIds[mipLevel], GL_TEXTURE_MIN_FILTER, param);
+         glTextureParameteri(m_MIPViewIds[mipLevel], GL_TEXTURE_MAG_FILTER, param);
+         for (const GLenum name : {GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T, GL_TEXTURE_WRAP_R}) {
+            glGetTextureParameteriv(m_RendererId, name, &param);
+            glTextureParameteri(m_MIPViewIds[mipLevel], name, param);
+         }
+      }
+      return m_MIPViewIds[mipLevel];
+   }
+
+
    void OpenGLTexture::SetTextureParameters(const TextureSettings& settings) {
       static glm::vec4 borderColor = {0.0f, 0.0f, 0.0f, 1.0f};
       TextureFilter minFilter = settings.minFilter;
@@ -367,12 +457,22 @@ namespace Pikzel {
          wrapW = IsDepthFormat(m_Format) ? TextureWrap::ClampToEdge : TextureWrap::Repeat;
       }
 
+      m_SamplerSettings = {
+         .minFilter = TextureFilterToGLTextureFilter(minFilter),
+         .magFilter = TextureFilterToGLTextureFilter(magFilter),
+         .wrapS = TextureWrapToGLTextureWrap(wrapU),
+         .wrapT = TextureWrapToGLTextureWrap(wrapV),
+         .wrapR = TextureWrapToGLTextureWrap(wrapW)
+      };
+      m_SamplerId = OpenGLSamplerCache::GetSampler(m_SamplerSettings);
+
+      // The texture's own parameters are used when it is bound without a sampler object (e.g. by ImGui)
       GLenum target = TextureTypeToGLTarget(GetType());
-      glTextureParameteri(m_RendererId, GL_TEXTURE_MIN_FILTER, TextureFilterToGLTextureFilter(minFilter));
-      glTextureParameteri(m_RendererId, GL_TEXTURE_MAG_FILTER, TextureFilterToGLTextureFilter(magFilter));
-      glTextureParameteri(m_RendererId, GL_TEXTURE_WRAP_S, TextureWrapToGLTextureWrap(wrapU));
-      glTextureParameteri(m_RendererId, GL_TEXTURE_WRAP_T, TextureWrapToGLTextureWrap(wrapV));
-      glTextureParameteri(m_RendererId, GL_TEXTURE_WRAP_R, TextureWrapToGLTextureWrap(wrapW));
+      glTextureParameteri(m_RendererId, GL_TEXTURE_MIN_FILTER, m_SamplerSettings.minFilter);
+      glTextureParameteri(m_RendererId, GL_TEXTURE_MAG_FILTER, m_SamplerSettings.magFilter);
+      glTextureParameteri(m_RendererId, GL_TEXTURE_WRAP_S, m_SamplerSettings.wrapS);
+      glTextureParameteri(m_RendererId, GL_TEXTURE_WRAP_T, m_SamplerSettings.wrapT);
+      glTextureParameteri(m_RendererId, GL_TEXTURE_WRAP_R, m_SamplerSettings.wrapR);
       glTextureParameterfv(m_RendererId, GL_TEXTURE_BORDER_COLOR, glm::value_ptr(borderColor));
    }
 
@@ -424,8 +524,8 @@ namespace Pikzel {
 
 
    void OpenGLTexture2D::GLTextureSubImage(const uint32_t /*layer*/, const uint32_t /*slice*/, const int mipLevel, const int xOffset, const int yOffset, const void* data) {
-      const uint32_t width = m_Width >> mipLevel;
-      const uint32_t height = m_Height >> mipLevel;
+      const uint32_t width = std::max(m_Width >> mipLevel, 1u);
+      const uint32_t height = std::max(m_Height >> mipLevel, 1u);
       glTextureSubImage2D(m_RendererId, mipLevel, xOffset, yOffset, width, height, TextureFormatToDataFormat(m_Format), TextureFormatToDataType(m_Format), data);
    }
 
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "OpenGLSamplerCache.h"
 #include "Pikzel/Renderer/Texture.h"
 
 #include <filesystem>
+#include <vector>
 
 namespace Pikzel {
 
@@ -28,11 +30,24 @@ namespace Pikzel {
 
       virtual void Commit(const uint32_t generateMipmapAfterLevel) override;
 
+      virtual std::vector<uint8_t> GetData(const uint32_t mipLevel) const override;
+
+      virtual void SetMIPData(const uint32_t mipLevel, const void* data, const uint32_t size) override;
+
+      virtual void SetMinMIPLevel(const uint32_t mipLevel) override;
+      virtual uint32_t GetMinMIPLevel() const override;
+
       bool operator==(const Texture& that) override;
 
    public:
       uint32_t GetRendererId() const;
 
+      // A view of just one mip level of the texture (created on first use)
+      uint32_t GetRendererId(const uint32_t mipLevel) const;
+
+      // Sampler object to bind along with the texture (owned by OpenGLSamplerCache)
+      uint32_t GetSamplerId() const;
+
    protected:
       void Init(const TextureSettings& settings);
       void SetTextureParameters(const TextureSettings& settings);
@@ -53,7 +68,11 @@ namespace Pikzel {
       uint32_t m_Depth = {};
       uint32_t m_Layers = {};
       uint32_t m_MIPLevels = {};
+      uint32_t m_MinMIPLevel = {};
       uint32_t m_RendererId = {};
+      mutable std::vector<uint32_t> m_MIPViewIds;
+      OpenGLSamplerSettings m_SamplerSettings;
+      uint32_t m_SamplerId = {};
    };
 
 
@@ -12,6 +12,14 @@ namespace Pikzel {
       bufferInfo.size = size;
       bufferInfo.usage = usage;
 
+      // shared by the graphics and compute queue families (if they differ), rather than having its ownership transferred back and forth
+      const auto& sharedQueueFamilyIndices = m_Device->GetSharedQueueFamilyIndices();
+      if (!sharedQueueFamilyIndices.empty()) {
+         bufferInfo.sharingMode = vk::SharingMode::eConcurrent;
+         bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharedQueueFamilyIndices.size());
+         bufferInfo.pQueueFamilyIndices = sharedQueueFamilyIndices.data();
+      }
+
       vma::AllocationCreateInfo allocInfo = {};
       allocInfo.usage = memoryUsage;
 
@@ -51,7 +59,10 @@ namespace Pikzel {
 
    VulkanBuffer::~VulkanBuffer() {
       if (m_Device && m_Buffer) {
-         VulkanMemoryAllocator::Get().destroyBuffer(m_Buffer, m_Allocation);
+         // the GPU may still be using the buffer
+         m_Device->DeferDestroy([buffer = m_Buffer, allocation = m_Allocation] {
+            VulkanMemoryAllocator::Get().destroyBuffer(buffer, allocation);
+         });
          m_Buffer = nullptr;
          m_Allocation = nullptr;
       }
@@ -59,8 +70,18 @@ namespace Pikzel {
 
 
    void VulkanBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
+      PKZL_CORE_ASSERT(offset + size <= m_Size, "VulkanBuffer::CopyFromHost() buffer overrun!");
       void* pDataDst = VulkanMemoryAllocator::Get().mapMemory(m_Allocation);
-      memcpy(pDataDst, pData, static_cast<size_t>(size));
+      memcpy(static_cast<std::byte*>(pDataDst) + offset, pData, static_cast<size_t>(size));
+      VulkanMemoryAllocator::Get().unmapMemory(m_Allocation);
+   }
+
+
+   void VulkanBuffer::CopyToHost(const uint64_t offset, const uint64_t size, void* pData) const {
+      PKZL_CORE_ASSERT(offset + size <= m_Size, "VulkanBuffer::CopyToHost() buffer overrun!");
+      void* pDataSrc = VulkanMemoryAllocator::Get().mapMemory(m_Allocation);
+      VulkanMemoryAllocator::Get().invalidateAllocation(m_Allocation, offset, size);
+      memcpy(pData, static_cast<const std::byte*>(pDataSrc) + offset, static_cast<size_t>(size));
       VulkanMemoryAllocator::Get().unmapMemory(m_Allocation);
    }
 
@@ -118,11 +139,21 @@ namespace Pikzel {
    VulkanIndexBuffer::VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const uint32_t* indices)
    : m_Buffer {device, sizeof(uint32_t) * count, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer, vma::MemoryUsage::eGpuOnly}
    , m_Count {count}
+   , m_IndexType {IndexType::UInt32}
    {
       CopyFromHost(0, sizeof(uint32_t) * count, indices);
    }
 
 
+   VulkanIndexBuffer::VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const uint16_t* indices)
+   : m_Buffer {device, sizeof(uint16_t) * count, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer, vma::MemoryUsage::eGpuOnly}
+   , m_Count {count}
+   , m_IndexType {IndexType::UInt16}
+   {
+      CopyFromHost(0, sizeof(uint16_t) * count, indices);
+   }
+
+
    void VulkanIndexBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
       VulkanBuffer stagingBuffer(m_Buffer.m_Device, size, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu);
       stagingBuffer.CopyFromHost(0, size, pData);
@@ -135,11 +166,21 @@ namespace Pikzel {
    }
 
 
+   IndexType VulkanIndexBuffer::GetIndexType() const {
+      return m_IndexType;
+   }
+
+
    vk::Buffer VulkanIndexBuffer::GetVkBuffer() const {
       return m_Buffer.m_Buffer;
    }
 
 
+   vk::IndexType VulkanIndexBuffer::GetVkIndexType() const {
+      return m_IndexType == IndexType::UInt16 ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+   }
+
+
    VulkanUniformBuffer::VulkanUniformBuffer(std::shared_ptr<VulkanDevice> device, uint32_t size)
    : m_Buffer {device, size, vk::BufferUsageFlagBits::eUniformBuffer, vma::MemoryUsage::eCpuToGpu}
    {}
@@ -153,7 +194,7 @@ namespace Pikzel {
 
 
    void VulkanUniformBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
-      m_Buffer.CopyFromHost(0, size, pData);
+      m_Buffer.CopyFromHost(offset, size, pData);
    }
 
 
@@ -161,4 +202,31 @@ namespace Pikzel {
       return m_Buffer.m_Buffer;
    }
 
+
+   // Storage buffers are typically re-written by the host every frame (e.g. light lists), and so live in host visible memory
+   // in the same way as uniform buffers.
+   // They can also be the source of indirect draw parameters (see GraphicsContext::DrawIndexedIndirect()), and of readbacks (see RenderCore::ReadbackAsync())
+   // Buffers that only the GPU writes to are no different: eCpuToGpu prefers memory that is device local as well as host visible,
+   // and CopyFromHost() then needs no staging copy (and no waiting for one).
+   VulkanStorageBuffer::VulkanStorageBuffer(std::shared_ptr<VulkanDevice> device, uint32_t size)
+   : m_Buffer {device, size, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eCpuToGpu}
+   {}
+
+
+   VulkanStorageBuffer::VulkanStorageBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t size, const void* data)
+   : m_Buffer {device, size, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eCpuToGpu}
+   {
+      CopyFromHost(0, size, data);
+   }
+
+
+   void VulkanStorageBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
+      m_Buffer.CopyFromHost(offset, size, pData);
+   }
+
+
+   vk::Buffer VulkanStorageBuffer::GetVkBuffer() const {
+      return m_Buffer.m_Buffer;
+   }
+
 }
@@ -22,6 +22,10 @@ namespace Pikzel {
       // You can do this only if buffer was created with memory usage = eCpuToGpu
       void CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData);
 
+      // Copy memory from the GPU buffer to host (pData)
+      // You can do this only if buffer was created with memory usage = eGpuToCpu
+      void CopyToHost(const uint64_t offset, const uint64_t size, void* pData) const;
+
    public:
 
       // Copy memory from GPU buffer
@@ -61,16 +65,20 @@ namespace Pikzel {
 
       // TODO: support 64 bit indices (?)
       VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const uint32_t* indices);
+      VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const uint16_t* indices);
 
       virtual void CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) override;
 
       virtual uint32_t GetCount() const override;
+      virtual IndexType GetIndexType() const override;
 
       vk::Buffer GetVkBuffer() const;
+      vk::IndexType GetVkIndexType() const;
 
    private:
       VulkanBuffer m_Buffer;
       uint32_t m_Count;
+      IndexType m_IndexType;
    };
 
 
@@ -88,4 +96,19 @@ namespace Pikzel {
       VulkanBuffer m_Buffer;
    };
 
+
+   class VulkanStorageBuffer : public StorageBuffer {
+   public:
+
+      VulkanStorageBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t size);
+      VulkanStorageBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t size, const void* data);
+
+      virtual void CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) override;
+
+      vk::Buffer GetVkBuffer() const;
+
+   private:
+      VulkanBuffer m_Buffer;
+   };
+
 }
@@ -1,17 +1,23 @@
 #include "VulkanComputeContext.h"
 
 #include "VulkanBuffer.h"
+#include "VulkanGraphicsContext.h"
 #include "VulkanPipeline.h"
 #include "VulkanTexture.h"
 #include "VulkanUtility.h"
 
+#include "Pikzel/Renderer/PipelineCompiler.h"
+
 namespace Pikzel {
 
    VulkanComputeContext::VulkanComputeContext(std::shared_ptr<VulkanDevice> device)
    : m_Device {device}
    {
+      if (!m_Device->IsComputeQueueSeparate()) {
+         m_GraphicsStages = vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader;
+      }
       CreateCommandPool();
-      CreateCommandBuffers(1);
+      CreateCommandBuffers(m_Device->GetFramesInFlight());
       CreateSyncObjects();
       CreatePipelineCache();
    }
@@ -19,7 +25,7 @@ namespace Pikzel {
 
    VulkanComputeContext::~VulkanComputeContext() {
       if (m_Device) {
-         m_Device->GetVkDevice().waitIdle();
+         // Vulkan objects are destroyed once the GPU has finished with them, so there is no need to wait here
          if (m_Pipeline) {
             Unbind(*m_Pipeline);
          }
@@ -32,19 +38,37 @@ namespace Pikzel {
 
 
    void VulkanComputeContext::Begin() {
-      auto result = m_Device->GetVkDevice().waitForFences(GetFence()->GetVkFence(), true, UINT64_MAX);
+      // Only need to wait for the GPU to finish with the command buffer we are about to re-record, not for the work most recently
+      // submitted (so compute work can be queued up while the GPU is still busy with earlier work)
+      m_CurrentCommandBuffer = (m_CurrentCommandBuffer + 1) % static_cast<uint32_t>(m_CommandBuffers.size());
+      GetFence()->Wait(m_CommandBufferValues[m_CurrentCommandBuffer]);
       GetVkCommandBuffer().begin({vk::CommandBufferUsageFlagBits::eSimultaneousUse});
+
+      // Do not overwrite storage buffers that previously submitted graphics work may still be reading
+      // (on a queue of its own, that is up to WaitFor())
+      if (m_GraphicsStages) {
+         GetVkCommandBuffer().pipelineBarrier(
+            m_GraphicsStages,
+            vk::PipelineStageFlagBits::eComputeShader,
+            {},
+            nullptr,
+            nullptr,
+            nullptr
+         );
+      }
    }
 
 
    void VulkanComputeContext::End() {
       GetVkCommandBuffer().end();
+      m_CommandBufferValues[m_CurrentCommandBuffer] = m_Device->Submit(m_Device->GetComputeQueue(), GetVkCommandBuffer(), GetFence(), {}, {}, {}, m_Waits);
+      m_Waits.clear();
+   }
 
-      vk::SubmitInfo si;
-      si.commandBufferCount = 1;
-      si.pCommandBuffers = m_CommandBuffers.data();
-      m_Device->GetVkDevice().resetFences(GetFence()->GetVkFence());
-      m_Device->GetComputeQueue().submit(si, GetFence()->GetVkFence());
+
+   void VulkanComputeContext::WaitFor(GraphicsContext& gc) {
+      std::shared_ptr<VulkanFence> fence = static_cast<VulkanGraphicsContext&>(gc).GetFence();
+      m_Waits.push_back({fence, fence->GetValue()});
    }
 
 
@@ -75,15 +99,57 @@ namespace Pikzel {
    void VulkanComputeContext::Unbind(const UniformBuffer&) {}
 
 
+   void VulkanComputeContext::Bind(const Id resourceId, const StorageBuffer& buffer) {
+      const VulkanResource& resource = m_Pipeline->GetResource(resourceId);
+
+      vk::DescriptorBufferInfo storageBufferDescriptor = {
+         static_cast<const VulkanStorageBuffer&>(buffer).GetVkBuffer() /*buffer*/,
+         0                                                             /*offset*/,
+         VK_WHOLE_SIZE                                                 /*range*/
+      };
+
+      vk::WriteDescriptorSet storageBufferWrite = {
+         m_Pipeline->GetVkDescriptorSet(resource.DescriptorSet)  /*dstSet*/,
+         resource.Binding                                        /*dstBinding*/,
+         0                                                       /*dstArrayElement*/,
+         resource.GetCount()                                     /*descriptorCount*/,
+         resource.Type                                           /*descriptorType*/,
+         nullptr                                                 /*pImageInfo*/,
+         &storageBufferDescriptor                                /*pBufferInfo*/,
+         nullptr                                                 /*pTexelBufferView*/
+      };
+
+      m_Device->GetVkDevice().updateDescriptorSets(storageBufferWrite, nullptr);
+   }
+
+
+   void VulkanComputeContext::Unbind(const StorageBuffer&) {}
+
+
    void VulkanComputeContext::Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel) {
       const VulkanResource& resource = m_Pipeline->GetResource(resourceId);
+      const VulkanTexture& vulkanTexture = static_cast<const VulkanTexture&>(texture);
+
+      // A storage image that has been committed (and so may since have been read by shaders) is being written again
+      if ((resource.Type == vk::DescriptorType::eStorageImage) && (vulkanTexture.GetVkImageLayout() == vk::ImageLayout::eShaderReadOnlyOptimal)) {
+         GetVkCommandBuffer().pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader | m_GraphicsStages,
+            vk::PipelineStageFlagBits::eComputeShader,
+            {},
+            nullptr,
+            nullptr,
+            vulkanTexture.GetImage().Barrier(vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eGeneral, 0, 0, 0, 0)
+         );
+         const_cast<VulkanTexture&>(vulkanTexture).SetVkImageLayout(vk::ImageLayout::eGeneral);
+      }
 
-      vk::Sampler sampler = static_cast<const VulkanTexture&>(texture).GetVkSampler();
-      vk::ImageView imageView = static_cast<const VulkanTexture&>(texture).GetVkImageView(mipLevel);
+      // Storage images that have not been committed yet can also be sampled (e.g. to read one mip level while writing the next)
+      vk::Sampler sampler = vulkanTexture.GetVkSampler();
+      vk::ImageView imageView = vulkanTexture.GetVkImageView(mipLevel);
       vk::DescriptorImageInfo textureImageDescriptor = {
          sampler,
          imageView,
-         resource.Type == vk::DescriptorType::eStorageImage? vk::ImageLayout::eGeneral : vk::ImageLayout::eShaderReadOnlyOptimal
+         ((resource.Type == vk::DescriptorType::eStorageImage) || (vulkanTexture.GetVkImageLayout() == vk::ImageLayout::eGeneral)) ? vk::ImageLayout::eGeneral : vk::ImageLayout::eShaderReadOnlyOptimal
       };
 
       vk::WriteDescriptorSet textureSamplersWrite = {
@@ -118,10 +184,21 @@ namespace Pikzel {
 
 
    std::unique_ptr<Pikzel::Pipeline> VulkanComputeContext::CreatePipeline(const PipelineSettings& settings) {
+      if (auto pipeline = PipelineCompiler::TakeWarmedUp(nullptr, settings)) {
+         return pipeline;
+      }
       return std::make_unique<VulkanPipeline>(m_Device, settings);
    }
 
 
+   std::shared_ptr<PipelineFuture> VulkanComputeContext::CreatePipelineAsync(const PipelineSettings& settings) {
+      // Compute pipelines depend only on the device, so this context need not outlive the pipeline's creation
+      return PipelineCompiler::Submit(nullptr, settings, [device = m_Device](const PipelineSettings& pipelineSettings) {
+         return std::make_unique<VulkanPipeline>(device, pipelineSettings);
+      });
+   }
+
+
    void VulkanComputeContext::PushConstant(const Id id, bool value) {
       PKZL_CORE_ASSERT(m_Pipeline, "Attempted to access null pipeline!");
       const VulkanPushConstant& constant = m_Pipeline->GetPushConstant(id);
@@ -429,6 +506,61 @@ namespace Pikzel {
    void VulkanComputeContext::Dispatch(const uint32_t x, const uint32_t y, const uint32_t z) {
       BindDescriptorSets();
       GetVkCommandBuffer().dispatch(x, y, z);
+
+      // Make shader writes (e.g. to storage buffers) visible to subsequent dispatches, and to subsequent graphics work
+      // (including indirect draw parameters).
+      // (textures are instead transitioned when they are Commit()ted.  Graphics work on another queue sees the writes once the
+      // semaphore it waits on is signalled)
+      vk::AccessFlags dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+      if (m_GraphicsStages) {
+         dstAccessMask |= vk::AccessFlagBits::eIndirectCommandRead;
+      }
+      vk::MemoryBarrier barrier = {
+         vk::AccessFlagBits::eShaderWrite   /*srcAccessMask*/,
+         dstAccessMask                      /*dstAccessMask*/
+      };
+      GetVkCommandBuffer().pipelineBarrier(
+         vk::PipelineStageFlagBits::eComputeShader,
+         vk::PipelineStageFlagBits::eComputeShader | m_GraphicsStages,
+         {},
+         barrier,
+         nullptr,
+         nullptr
+      );
+   }
+
+
+   void VulkanComputeContext::Fill(const StorageBuffer& buffer, const uint32_t value, const uint64_t offset, const uint64_t size) {
+      // Do not overwrite what earlier dispatches (or, on the same queue, earlier graphics work) are still reading or writing.
+      // (graphics work on another queue is waited for by the semaphore wait that WaitFor() sets up, which covers transfers)
+      vk::MemoryBarrier beforeFillBarrier = {
+         vk::AccessFlagBits::eShaderWrite     /*srcAccessMask*/,
+         vk::AccessFlagBits::eTransferWrite   /*dstAccessMask*/
+      };
+      GetVkCommandBuffer().pipelineBarrier(
+         vk::PipelineStageFlagBits::eComputeShader | m_GraphicsStages,
+         vk::PipelineStageFlagBits::eTransfer,
+         {},
+         beforeFillBarrier,
+         nullptr,
+         nullptr
+      );
+
+      GetVkCommandBuffer().fillBuffer(static_cast<const VulkanStorageBuffer&>(buffer).GetVkBuffer(), offset, size, value);
+
+      // and make the fill visible to subsequent dispatches
+      vk::MemoryBarrier afterFillBarrier = {
+         vk::AccessFlagBits::eTransferWrite                                  /*srcAccessMask*/,
+         vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite  /*dstAccessMask*/
+      };
+      GetVkCommandBuffer().pipelineBarrier(
+         vk::PipelineStageFlagBits::eTransfer,
+         vk::PipelineStageFlagBits::eComputeShader,
+         {},
+         afterFillBarrier,
+         nullptr,
+         nullptr
+      );
    }
 
 
@@ -438,7 +570,7 @@ namespace Pikzel {
 
 
    vk::CommandBuffer VulkanComputeContext::GetVkCommandBuffer() {
-      return m_CommandBuffers.front();
+      return m_CommandBuffers[m_CurrentCommandBuffer];
    }
 
 
@@ -468,8 +600,9 @@ namespace Pikzel {
    void VulkanComputeContext::DestroyDescriptorPool(vk::DescriptorPool descriptorPool) {
       if (m_Device) {
          if (descriptorPool) {
-            m_Device->GetVkDevice().destroy(descriptorPool);
-            descriptorPool = nullptr;
+            m_Device->DeferDestroy([device = m_Device->GetVkDevice(), descriptorPool] {
+               device.destroy(descriptorPool);
+            });
          }
       }
    }
@@ -478,14 +611,16 @@ namespace Pikzel {
    void VulkanComputeContext::CreateCommandPool() {
       m_CommandPool = m_Device->GetVkDevice().createCommandPool({
          vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-         m_Device->GetGraphicsQueueFamilyIndex()
+         m_Device->GetComputeQueueFamilyIndex()
       });
    }
 
 
    void VulkanComputeContext::DestroyCommandPool() {
       if (m_Device && m_CommandPool) {
-         m_Device->GetVkDevice().destroy(m_CommandPool);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), commandPool = m_CommandPool] {
+            device.destroy(commandPool);
+         });
          m_CommandPool = nullptr;
       }
    }
@@ -497,12 +632,15 @@ namespace Pikzel {
          vk::CommandBufferLevel::ePrimary   /*level*/,
          commandBufferCount                 /*commandBufferCount*/
          });
+      m_CommandBufferValues.assign(commandBufferCount, 0);
    }
 
 
    void VulkanComputeContext::DestroyCommandBuffers() {
       if (m_Device && m_CommandPool) {
-         m_Device->GetVkDevice().freeCommandBuffers(m_CommandPool, m_CommandBuffers);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), commandPool = m_CommandPool, commandBuffers = std::move(m_CommandBuffers)] {
+            device.freeCommandBuffers(commandPool, commandBuffers);
+         });
          m_CommandBuffers.clear();
       }
    }
@@ -515,18 +653,22 @@ namespace Pikzel {
 
    void VulkanComputeContext::DestroyPipelineCache() {
       if (m_Device && m_PipelineCache) {
-         m_Device->GetVkDevice().destroy(m_PipelineCache);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), pipelineCache = m_PipelineCache] {
+            device.destroy(pipelineCache);
+         });
       }
    }
 
 
    void VulkanComputeContext::CreateSyncObjects() {
-      m_InFlightFence = std::make_shared<VulkanFence>(m_Device->GetVkDevice());
+      m_InFlightFence = m_Device->CreateFence();
    }
 
 
    void VulkanComputeContext::DestroySyncObjects() {
       if (m_Device && m_InFlightFence) {
+         // the fence must outlive the work that was submitted with it
+         m_Device->DeferDestroy([fence = std::move(m_InFlightFence)] {});
          m_InFlightFence = nullptr;
       }
    }
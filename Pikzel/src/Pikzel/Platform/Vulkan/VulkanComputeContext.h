@@ -21,9 +21,14 @@ namespace Pikzel {
       virtual void Begin() override;
       virtual void End() override;
 
+      virtual void WaitFor(GraphicsContext& gc) override;
+
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) override;
       virtual void Unbind(const UniformBuffer& buffer) override;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) override;
+      virtual void Unbind(const StorageBuffer& buffer) override;
+
       virtual void Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel) override;
       virtual void Unbind(const Texture& texture) override;
 
@@ -31,6 +36,7 @@ namespace Pikzel {
       virtual void Unbind(const Pipeline& pipeline) override;
 
       virtual std::unique_ptr<Pipeline> CreatePipeline(const PipelineSettings& settings) override;
+      virtual std::shared_ptr<PipelineFuture> CreatePipelineAsync(const PipelineSettings& settings) override;
 
       virtual void PushConstant(const Id id, bool value) override;
       virtual void PushConstant(const Id id, int value) override;
@@ -73,6 +79,8 @@ namespace Pikzel {
 
       virtual void Dispatch(const uint32_t x, const uint32_t y, const uint32_t z) override;
 
+      virtual void Fill(const StorageBuffer& buffer, const uint32_t value, const uint64_t offset, const uint64_t size) override;
+
    public:
       vk::PipelineCache GetVkPipelineCache() const;
 
@@ -102,8 +110,15 @@ namespace Pikzel {
       std::shared_ptr<VulkanDevice> m_Device;
 
       vk::CommandPool m_CommandPool;
-      std::vector<vk::CommandBuffer> m_CommandBuffers;
+      std::vector<vk::CommandBuffer> m_CommandBuffers;     // used in turn, so that Begin() need not wait for the work just submitted by End()
+      std::vector<uint64_t> m_CommandBufferValues;         // m_CommandBufferValues[i] = value of m_InFlightFence signalled by the most recent submission of m_CommandBuffers[i]
+      uint32_t m_CurrentCommandBuffer = 0;
       std::shared_ptr<VulkanFence> m_InFlightFence;
+      std::vector<VulkanFenceValue> m_Waits;               // graphics work that the next End() must wait for
+
+      // Graphics stages that barriers in the command buffers synchronise with.  None if compute has a queue of its own (then
+      // graphics work is synchronised with semaphores instead, see WaitFor() and GraphicsContext::WaitFor())
+      vk::PipelineStageFlags m_GraphicsStages;
 
       vk::PipelineCache m_PipelineCache;
       VulkanPipeline* m_Pipeline = nullptr;       // currently bound pipeline  (TODO: should be a shared_ptr?)
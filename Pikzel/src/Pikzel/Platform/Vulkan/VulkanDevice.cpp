@@ -1,20 +1,31 @@
 #include "VulkanDevice.h"
 #include "VulkanUtility.h"
 
+#include <algorithm>
+#include <iterator>
 #include <set>
 
 namespace Pikzel {
 
-   VulkanDevice::VulkanDevice(vk::Instance instance, vk::SurfaceKHR surface)
+   VulkanDevice::VulkanDevice(vk::Instance instance, vk::SurfaceKHR surface, const uint32_t framesInFlight)
    : m_Instance {instance}
+   , m_FramesInFlight {std::max(framesInFlight, 1u)}
    {
       SelectPhysicalDevice(surface);
       CreateDevice();
       CreateCommandPool();
+      m_SamplerCache = std::make_unique<VulkanSamplerCache>(m_Device);
+      m_FrameTimeline = CreateFence();
+      m_AsyncCommandsFence = CreateFence();
    }
 
 
    VulkanDevice::~VulkanDevice() {
+      FlushDeferred();
+      m_LastComputeSubmission = {};
+      m_FrameTimeline.reset();
+      m_AsyncCommandsFence.reset();
+      m_SamplerCache.reset();
       DestroyCommandPool();
       DestroyDevice();
    }
@@ -61,8 +72,16 @@ namespace Pikzel {
    }
 
 
-   void* VulkanDevice::GetRequiredPhysicalDeviceFeaturesEXT() const {
-      return nullptr;
+   void* VulkanDevice::GetRequiredPhysicalDeviceFeaturesEXT() {
+      m_EnabledPhysicalDeviceFeatures12 = vk::PhysicalDeviceVulkan12Features {};
+      if (m_PhysicalDeviceFeatures12.drawIndirectCount) {
+         m_EnabledPhysicalDeviceFeatures12.setDrawIndirectCount(true);   // for GraphicsContext::DrawIndexedIndirect()
+      }
+      if (!m_PhysicalDeviceFeatures12.timelineSemaphore) {
+         throw std::runtime_error {"GPU does not support timeline semaphores!"};
+      }
+      m_EnabledPhysicalDeviceFeatures12.setTimelineSemaphore(true);      // for VulkanFence
+      return &m_EnabledPhysicalDeviceFeatures12;
    }
 
 
@@ -74,6 +93,7 @@ namespace Pikzel {
             m_PhysicalDevice = physicalDevice;
             m_PhysicalDeviceProperties = m_PhysicalDevice.getProperties();
             m_PhysicalDeviceFeatures = m_PhysicalDevice.getFeatures();
+            m_PhysicalDeviceFeatures12 = m_PhysicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>().get<vk::PhysicalDeviceVulkan12Features>();
             m_QueueFamilyIndices = FindQueueFamilies(m_PhysicalDevice, surface);
             break;
          }
@@ -112,6 +132,12 @@ namespace Pikzel {
 
       std::vector<const char*> deviceExtensions = GetRequiredDeviceExtensions();
 
+      // optional: lets the memory allocator report how much video memory the driver is prepared to give us (see RenderCore::GetMemoryBudget())
+      m_IsMemoryBudgetSupported = CheckDeviceExtensionSupport(m_PhysicalDevice, {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME});
+      if (m_IsMemoryBudgetSupported) {
+         deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+      }
+
       m_EnabledPhysicalDeviceFeatures = GetRequiredPhysicalDeviceFeatures(m_PhysicalDeviceFeatures);
 
       vk::DeviceCreateInfo ci = {
@@ -144,7 +170,12 @@ namespace Pikzel {
          m_ComputeQueue = m_Device.getQueue(m_QueueFamilyIndices.ComputeFamily.value(), 0);
       }
       if (m_QueueFamilyIndices.TransferFamily.has_value()) {
-         m_TransferQueue = m_Device.getQueue(m_QueueFamilyIndices.ComputeFamily.value(), 0);
+         m_TransferQueue = m_Device.getQueue(m_QueueFamilyIndices.TransferFamily.value(), 0);
+      }
+
+      m_SharedQueueFamilyIndices.clear();
+      if (m_QueueFamilyIndices.GraphicsFamily.value() != m_QueueFamilyIndices.ComputeFamily.value()) {
+         m_SharedQueueFamilyIndices = {m_QueueFamilyIndices.GraphicsFamily.value(), m_QueueFamilyIndices.ComputeFamily.value()};
       }
    }
 
@@ -249,6 +280,16 @@ namespace Pikzel {
    }
 
 
+   bool VulkanDevice::IsMemoryBudgetSupported() const {
+      return m_IsMemoryBudgetSupported;
+   }
+
+
+   VulkanSamplerCache& VulkanDevice::GetSamplerCache() {
+      return *m_SamplerCache;
+   }
+
+
    void VulkanDevice::SubmitSingleTimeCommands(vk::Queue queue, const std::function<void(vk::CommandBuffer)>& action) {
       std::vector<vk::CommandBuffer> commandBuffers = m_Device.allocateCommandBuffers({
          m_CommandPool                    /*commandPool*/,
@@ -263,16 +304,224 @@ namespace Pikzel {
       vk::SubmitInfo si;
       si.commandBufferCount = 1;
       si.pCommandBuffers = commandBuffers.data();
+
+      std::vector<vk::Semaphore> waitSemaphores;
+      std::vector<uint64_t> waitValues;
+      std::vector<vk::PipelineStageFlags> waitStages;
+      vk::TimelineSemaphoreSubmitInfo timelineSI;
+      std::scoped_lock lock {m_SubmitMutex};
+      if (IsComputeQueueSeparate() && m_LastComputeSubmission.Fence && !m_LastComputeSubmission.Fence->IsSignalled(m_LastComputeSubmission.Value)) {
+         waitSemaphores.emplace_back(m_LastComputeSubmission.Fence->GetVkSemaphore());
+         waitValues.emplace_back(m_LastComputeSubmission.Value);
+         waitStages.emplace_back(GetCrossQueueWaitStages(queue));
+      }
+      if (!waitSemaphores.empty()) {
+         timelineSI.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+         timelineSI.pWaitSemaphoreValues = waitValues.data();
+         si.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+         si.pWaitSemaphores = waitSemaphores.data();
+         si.pWaitDstStageMask = waitStages.data();
+         si.pNext = &timelineSI;
+      }
       queue.submit(si, nullptr);
       queue.waitIdle();
       m_Device.freeCommandBuffers(m_CommandPool, commandBuffers);
    }
 
 
+   void VulkanDevice::SubmitAsyncCommands(const std::function<void(vk::CommandBuffer)>& action) {
+      vk::CommandBuffer commandBuffer = m_Device.allocateCommandBuffers({
+         m_CommandPool                    /*commandPool*/,
+         vk::CommandBufferLevel::ePrimary /*level*/,
+         1                                /*commandBufferCount*/
+      }).front();
+
+      commandBuffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+      action(commandBuffer);
+      commandBuffer.end();
+
+      // The submission is tracked by m_AsyncCommandsFence, so the deferred free (and that of anything else released now) waits for it
+      Submit(m_GraphicsQueue, commandBuffer, m_AsyncCommandsFence, {}, {}, {}, {GetLastComputeSubmission()});
+      DeferDestroy([device = m_Device, commandPool = m_CommandPool, commandBuffer] {
+         device.freeCommandBuffers(commandPool, commandBuffer);
+      });
+   }
+
+
    void VulkanDevice::PipelineBarrier(vk::PipelineStageFlags srcStageMask, vk::PipelineStageFlags dstStageMask, const vk::ArrayProxy<const vk::ImageMemoryBarrier>& barriers) {
       // TODO: which queue should this be?
       SubmitSingleTimeCommands(m_GraphicsQueue, [this, srcStageMask, dstStageMask, &barriers] (vk::CommandBuffer cmd) {
          cmd.pipelineBarrier(srcStageMask, dstStageMask, {}, nullptr, nullptr, barriers);
       });
    }
+
+
+   uint64_t VulkanDevice::Submit(vk::Queue queue, vk::CommandBuffer commandBuffer, const std::shared_ptr<VulkanFence>& fence, vk::Semaphore waitSemaphore, vk::PipelineStageFlags waitStage, vk::Semaphore signalSemaphore, const std::vector<VulkanFenceValue>& waits) {
+      // binary semaphores are in the same arrays as the timeline semaphores.  Their values are ignored
+      std::vector<vk::Semaphore> waitSemaphores;
+      std::vector<uint64_t> waitValues;
+      std::vector<vk::PipelineStageFlags> waitStages;
+      if (waitSemaphore) {
+         waitSemaphores.emplace_back(waitSemaphore);
+         waitValues.emplace_back(0);
+         waitStages.emplace_back(waitStage);
+      }
+      if (IsComputeQueueSeparate()) {
+         for (const auto& wait : waits) {
+            if (wait.Fence && !wait.Fence->IsSignalled(wait.Value)) {
+               waitSemaphores.emplace_back(wait.Fence->GetVkSemaphore());
+               waitValues.emplace_back(wait.Value);
+               waitStages.emplace_back(GetCrossQueueWaitStages(queue));
+            }
+         }
+      }
+
+      std::vector<vk::Semaphore> signalSemaphores = {fence->GetVkSemaphore()};
+      std::vector<uint64_t> signalValues = {0};
+      if (signalSemaphore) {
+         signalSemaphores.emplace_back(signalSemaphore);
+         signalValues.emplace_back(0);
+      }
+
+      std::scoped_lock lock {m_SubmitMutex};
+      const uint64_t value = fence->Next();
+      signalValues.front() = value;
+
+      vk::TimelineSemaphoreSubmitInfo timelineSI = {
+         static_cast<uint32_t>(waitValues.size())         /*waitSemaphoreValueCount*/,
+         waitValues.data()                                /*pWaitSemaphoreValues*/,
+         static_cast<uint32_t>(signalValues.size())       /*signalSemaphoreValueCount*/,
+         signalValues.data()                              /*pSignalSemaphoreValues*/
+      };
+
+      vk::SubmitInfo si = {
+         static_cast<uint32_t>(waitSemaphores.size())     /*waitSemaphoreCount*/,
+         waitSemaphores.data()                            /*pWaitSemaphores*/,
+         waitStages.data()                                /*pWaitDstStageMask*/,
+         1                                                /*commandBufferCount*/,
+         &commandBuffer                                   /*pCommandBuffers*/,
+         static_cast<uint32_t>(signalSemaphores.size())   /*signalSemaphoreCount*/,
+         signalSemaphores.data()                          /*pSignalSemaphores*/
+      };
+      si.pNext = &timelineSI;
+      queue.submit(si, nullptr);
+
+      if (queue == m_ComputeQueue) {
+         m_LastComputeSubmission = {fence, value};
+      }
+      return value;
+   }
+
+
+   bool VulkanDevice::IsComputeQueueSeparate() const {
+      return m_GraphicsQueue != m_ComputeQueue;
+   }
+
+
+   VulkanFenceValue VulkanDevice::GetLastComputeSubmission() {
+      std::scoped_lock lock {m_SubmitMutex};
+      return m_LastComputeSubmission;
+   }
+
+
+   const std::vector<uint32_t>& VulkanDevice::GetSharedQueueFamilyIndices() const {
+      return m_SharedQueueFamilyIndices;
+   }
+
+
+   vk::PipelineStageFlags VulkanDevice::GetCrossQueueWaitStages(vk::Queue queue) const {
+      if (queue == m_ComputeQueue) {
+         return vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer;
+      }
+      return vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer;
+   }
+
+
+   uint32_t VulkanDevice::GetFramesInFlight() const {
+      return m_FramesInFlight;
+   }
+
+
+   std::shared_ptr<VulkanFence> VulkanDevice::GetFrameTimeline() const {
+      return m_FrameTimeline;
+   }
+
+
+   std::shared_ptr<VulkanFence> VulkanDevice::CreateFence() {
+      auto fence = std::make_shared<VulkanFence>(m_Device);
+      std::scoped_lock lock {m_DeferredMutex};
+      m_Fences.emplace_back(fence);
+      return fence;
+   }
+
+
+   void VulkanDevice::DeferDestroy(std::function<void()> destroy) {
+      std::scoped_lock lock {m_DeferredMutex};
+      m_DeferredDestroys.push_back({std::move(destroy)});
+   }
+
+
+   void VulkanDevice::CollectDeferred() {
+      PKZL_PROFILE_FUNCTION();
+      std::vector<DeferredDestroy> retired;
+      {
+         std::scoped_lock lock {m_DeferredMutex};
+         std::erase_if(m_Fences, [] (const std::weak_ptr<VulkanFence>& fence) { return fence.expired(); });
+
+         // Work that was submitted before the resource was released has finished once each fence has reached the value that it
+         // had been submitted up to at the time (or has been destroyed since).
+         // Fences are noted here rather than in DeferDestroy(), as the resource may have been released while a command buffer that
+         // uses it was still being recorded, and that work is only in flight now.
+         std::vector<std::pair<std::weak_ptr<VulkanFence>, uint64_t>> inFlight;
+         for (const auto& weakFence : m_Fences) {
+            if (auto fence = weakFence.lock(); fence && !fence->IsSignalled()) {
+               inFlight.emplace_back(fence, fence->GetValue());
+            }
+         }
+
+         auto isRetired = [] (const DeferredDestroy& deferred) {
+            return !deferred.IsPending && std::all_of(deferred.Fences.begin(), deferred.Fences.end(), [] (const auto& entry) {
+               auto fence = entry.first.lock();
+               return !fence || fence->IsSignalled(entry.second);
+            });
+         };
+
+         for (auto& deferred : m_DeferredDestroys) {
+            if (deferred.IsPending) {
+               deferred.Fences = inFlight;
+               deferred.IsPending = false;
+            }
+         }
+         auto first = std::stable_partition(m_DeferredDestroys.begin(), m_DeferredDestroys.end(), [&isRetired] (const DeferredDestroy& deferred) { return !isRetired(deferred); });
+         std::move(first, m_DeferredDestroys.end(), std::back_inserter(retired));
+         m_DeferredDestroys.erase(first, m_DeferredDestroys.end());
+      }
+
+      // outside of the lock, in case destroying something releases something else
+      for (auto& deferred : retired) {
+         deferred.Destroy();
+      }
+   }
+
+
+   void VulkanDevice::FlushDeferred() {
+      if (!m_Device) {
+         return;
+      }
+      m_Device.waitIdle();
+      for (;;) {
+         std::vector<DeferredDestroy> deferredDestroys;
+         {
+            std::scoped_lock lock {m_DeferredMutex};
+            deferredDestroys.swap(m_DeferredDestroys);
+         }
+         if (deferredDestroys.empty()) {
+            break;
+         }
+         for (auto& deferred : deferredDestroys) {
+            deferred.Destroy();
+         }
+      }
+   }
+
 }
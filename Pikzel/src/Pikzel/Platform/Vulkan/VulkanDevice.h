@@ -1,12 +1,20 @@
 #pragma once
 
 #include "QueueFamilyIndices.h"
+#include "VulkanFence.h"
+#include "VulkanSamplerCache.h"
 #include <vulkan/vulkan.hpp>
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 namespace Pikzel {
    class VulkanDevice {
    public:
-      VulkanDevice(vk::Instance instance, vk::SurfaceKHR surface);
+      VulkanDevice(vk::Instance instance, vk::SurfaceKHR surface, const uint32_t framesInFlight);
       virtual ~VulkanDevice();
 
       vk::Instance GetVkInstance() const;
@@ -27,15 +35,67 @@ namespace Pikzel {
 
       vk::PhysicalDeviceFeatures GetEnabledPhysicalDeviceFeatures() const;
 
+      // true if VK_EXT_memory_budget is enabled
+      bool IsMemoryBudgetSupported() const;
+
+      VulkanSamplerCache& GetSamplerCache();
+
+      // Record action into a one-off command buffer, submit it to queue and wait for it to finish.
+      // queue must be the graphics (or transfer) queue.  The work waits for compute work that has been submitted to finish first.
       void SubmitSingleTimeCommands(vk::Queue queue, const std::function<void(vk::CommandBuffer)>& action);
 
+      // Record action into a one-off command buffer and submit it to the graphics queue, without waiting for it to finish.
+      // Work that is submitted to the graphics queue later is ordered after it by the pipeline barriers that action records.
+      // Buffers that the commands use may be released as soon as this returns (their destruction is deferred, see DeferDestroy())
+      void SubmitAsyncCommands(const std::function<void(vk::CommandBuffer)>& action);
+
       void PipelineBarrier(vk::PipelineStageFlags srcStageMask, vk::PipelineStageFlags dstStageMask, const vk::ArrayProxy<const vk::ImageMemoryBarrier>& barriers);
 
+      // Submit commandBuffer to queue, signalling the next value of fence.  Returns that value.
+      // waitSemaphore and signalSemaphore are optional binary semaphores (e.g. for the swap chain).
+      // waits are work on the other queue (graphics or compute) that commandBuffer depends on (see GraphicsContext::WaitFor() and
+      // ComputeContext::WaitFor()).  They are ignored if the graphics and compute queues are the same: then pipeline barriers suffice.
+      uint64_t Submit(vk::Queue queue, vk::CommandBuffer commandBuffer, const std::shared_ptr<VulkanFence>& fence, vk::Semaphore waitSemaphore = {}, vk::PipelineStageFlags waitStage = {}, vk::Semaphore signalSemaphore = {}, const std::vector<VulkanFenceValue>& waits = {});
+
+      // Whether compute work goes to a queue of its own (and so can run at the same time as graphics work)
+      bool IsComputeQueueSeparate() const;
+
+      // The most recent compute work that has been submitted, for work on the graphics queue that must see its results
+      VulkanFenceValue GetLastComputeSubmission();
+
+      // Queue families that buffers and images that both graphics and compute work use must be shared between (empty if there is only one).
+      // Such resources are created with vk::SharingMode::eConcurrent, so that they need no queue family ownership transfers.
+      const std::vector<uint32_t>& GetSharedQueueFamilyIndices() const;
+
+      // How many frames the CPU may get ahead of the GPU (see Window::Settings::framesInFlight)
+      uint32_t GetFramesInFlight() const;
+
+      // The frame counter.  The window signals value N when the GPU has finished frame N (counting from 1).
+      // Anything that needs to wait for a frame to finish can wait on this
+      std::shared_ptr<VulkanFence> GetFrameTimeline() const;
+
+      // A fence that the device keeps track of, so that it knows what work is in flight (see DeferDestroy()).
+      // All fences that work is submitted with should be created here
+      std::shared_ptr<VulkanFence> CreateFence();
+
+      // Call destroy once the GPU has finished with whatever it destroys.
+      // Rather than waiting for the device to be idle, or tracking which command buffers use what, this waits for all of the work
+      // that was in flight when the resource was released: at the next CollectDeferred(), the value most recently submitted with
+      // each fence is noted, and destroy is called once each fence has reached its value.
+      // destroy must not capture a std::shared_ptr to the device.  May be called from any thread.
+      void DeferDestroy(std::function<void()> destroy);
+
+      // Destroy what the GPU has finished with.  Called once per frame, after the frame's work has been submitted
+      void CollectDeferred();
+
+      // Wait for the device to be idle, and destroy everything that is waiting to be destroyed
+      void FlushDeferred();
+
    private:
       bool IsPhysicalDeviceSuitable(vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface);
       std::vector<const char*> GetRequiredDeviceExtensions() const;
       vk::PhysicalDeviceFeatures GetRequiredPhysicalDeviceFeatures(vk::PhysicalDeviceFeatures availableFeatures) const;
-      void* GetRequiredPhysicalDeviceFeaturesEXT() const;
+      void* GetRequiredPhysicalDeviceFeaturesEXT();
       void SelectPhysicalDevice(vk::SurfaceKHR surface);
 
       void CreateDevice();
@@ -44,12 +104,23 @@ namespace Pikzel {
       void CreateCommandPool();
       void DestroyCommandPool();
 
+      // The stages of work submitted to queue that must wait for work on the other queue
+      vk::PipelineStageFlags GetCrossQueueWaitStages(vk::Queue queue) const;
+
    private:
+      struct DeferredDestroy {
+         std::function<void()> Destroy;
+         std::vector<std::pair<std::weak_ptr<VulkanFence>, uint64_t>> Fences;   // that were in flight, and the value that must be reached
+         bool IsPending = true;                                                 // fences not yet noted
+      };
+
       vk::Instance m_Instance;
       vk::PhysicalDevice m_PhysicalDevice;
       vk::PhysicalDeviceProperties m_PhysicalDeviceProperties;
       vk::PhysicalDeviceFeatures m_PhysicalDeviceFeatures;                 // features that are available on the selected physical device
       vk::PhysicalDeviceFeatures m_EnabledPhysicalDeviceFeatures;          // features that have been enabled
+      vk::PhysicalDeviceVulkan12Features m_PhysicalDeviceFeatures12;       // Vulkan 1.2 features that are available on the selected physical device
+      vk::PhysicalDeviceVulkan12Features m_EnabledPhysicalDeviceFeatures12;// Vulkan 1.2 features that have been enabled
       QueueFamilyIndices m_QueueFamilyIndices;
 
       vk::Device m_Device;
@@ -58,9 +129,24 @@ namespace Pikzel {
       vk::Queue m_PresentQueue;
       vk::Queue m_ComputeQueue;
       vk::Queue m_TransferQueue;
+      std::vector<uint32_t> m_SharedQueueFamilyIndices;
 
       vk::CommandPool m_CommandPool;
 
+      std::unique_ptr<VulkanSamplerCache> m_SamplerCache;
+
+      uint32_t m_FramesInFlight = 2;
+      std::shared_ptr<VulkanFence> m_FrameTimeline;
+      VulkanFenceValue m_LastComputeSubmission;    // for SubmitSingleTimeCommands() (and readbacks) to wait on
+      std::shared_ptr<VulkanFence> m_AsyncCommandsFence;
+      std::mutex m_SubmitMutex;
+
+      std::vector<std::weak_ptr<VulkanFence>> m_Fences;
+      std::vector<DeferredDestroy> m_DeferredDestroys;
+      std::mutex m_DeferredMutex;
+
+      bool m_IsMemoryBudgetSupported = false;
+
    };
 
 }
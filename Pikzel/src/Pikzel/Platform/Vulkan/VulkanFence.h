@@ -4,10 +4,13 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <atomic>
+#include <memory>
+
 namespace Pikzel {
 
    class VulkanFence final {
-      // Manages construction and desctruction of a vk::Fence so that we can
+      // Manages construction and desctruction of a (timeline) vk::Semaphore so that we can
       // bung these things into a std::shared_ptr<>
 
       // Why on earth would we want a std::shared_ptr<Fence>?
@@ -20,25 +23,88 @@ namespace Pikzel {
       // If ownership of the fence is not shared, then there is a chance that the graphics context could 
       // get destroyed (destroying the fence with it), leaving the pipeline with a dangling pointer
 
+      // The fence is a timeline semaphore.  Every submission made with it signals the next value of the semaphore (see Next()).
+      // So, whether the GPU has finished with something is a matter of whether the semaphore has reached the value signalled by the
+      // submission that used it.  Unlike a binary fence, one fence can track any number of submissions that are in flight at once,
+      // can be waited on by other queues, and never needs resetting.
+
    public:
       VulkanFence(vk::Device device)
       : m_Device {device}
       {
          PKZL_CORE_ASSERT(device, "null device");
-         m_Fence = device.createFence({vk::FenceCreateFlagBits::eSignaled});
+         vk::SemaphoreTypeCreateInfo typeCI = {
+            vk::SemaphoreType::eTimeline   /*semaphoreType*/,
+            0                              /*initialValue*/
+         };
+         vk::SemaphoreCreateInfo ci;
+         ci.pNext = &typeCI;
+         m_Semaphore = device.createSemaphore(ci);
       }
 
       ~VulkanFence() {
-         m_Device.destroy(m_Fence);
+         m_Device.destroy(m_Semaphore);
+      }
+
+      vk::Semaphore GetVkSemaphore() const {
+         return m_Semaphore;
+      }
+
+      // The value signalled by the most recent submission
+      uint64_t GetValue() const {
+         return m_Value;
       }
 
-      vk::Fence GetVkFence() const {
-         return m_Fence;
+      // The value that the work being recorded now will signal, once it is submitted
+      uint64_t GetPendingValue() const {
+         return m_Value + 1;
+      }
+
+      // Advance to the next value, and return it.  Call this when submitting, and have the submission signal the returned value
+      uint64_t Next() {
+         return ++m_Value;
+      }
+
+      // The value the GPU has reached
+      uint64_t GetCompletedValue() const {
+         return m_Device.getSemaphoreCounterValue(m_Semaphore);
+      }
+
+      bool IsSignalled(const uint64_t value) const {
+         return GetCompletedValue() >= value;
+      }
+
+      // Whether all work submitted with this fence has finished
+      bool IsSignalled() const {
+         return IsSignalled(m_Value);
+      }
+
+      void Wait(const uint64_t value) const {
+         vk::SemaphoreWaitInfo waitInfo = {
+            {}              /*flags*/,
+            1               /*semaphoreCount*/,
+            &m_Semaphore    /*pSemaphores*/,
+            &value          /*pValues*/
+         };
+         static_cast<void>(m_Device.waitSemaphores(waitInfo, UINT64_MAX));
+      }
+
+      // Wait for all work submitted with this fence to finish
+      void Wait() const {
+         Wait(m_Value);
       }
 
    private:
       vk::Device m_Device;
-      vk::Fence m_Fence;
+      vk::Semaphore m_Semaphore;
+      std::atomic<uint64_t> m_Value = 0;
+   };
+
+
+   // A point on a fence's timeline, e.g. for a submission to wait on (see VulkanDevice::Submit())
+   struct VulkanFenceValue {
+      std::shared_ptr<VulkanFence> Fence;
+      uint64_t Value = 0;
    };
 
 }
@@ -20,7 +20,7 @@ namespace Pikzel {
 
    VulkanFramebuffer::~VulkanFramebuffer() {
       if (m_Device) {
-         m_Device->GetVkDevice().waitIdle();
+         // attachments and framebuffer are destroyed once the GPU has finished with them, so there is no need to wait here
          DestroyAttachments();
          DestroyFramebuffer();
       }
@@ -44,8 +44,7 @@ namespace Pikzel {
 
 
    void VulkanFramebuffer::Resize(const uint32_t width, const uint32_t height) {
-      m_Context->SwapBuffers();   // The idea here is to make sure the GPU isnt still rendering to the attachments we are about to destroy
-                                  // but is "swapbuffers" on the graphics context sufficient to ensure that?
+      // The GPU may still be rendering to the attachments, but they are not actually destroyed until it has finished with them
       DestroyAttachments();
       DestroyFramebuffer();
 
@@ -53,6 +52,7 @@ namespace Pikzel {
       m_Settings.height = height;
 
       CreateAttachments();
+      m_Context = std::make_unique<VulkanFramebufferGC>(m_Device, this);   // DestroyAttachments() destroyed the old one, and its extent would be wrong anyway
       CreateFramebuffer();
    }
 
@@ -265,14 +265,19 @@ namespace Pikzel {
 
 
    void VulkanFramebuffer::DestroyAttachments() {
-      for (auto& descriptorSet : m_ColorDescriptorSets) {
-         ImGui_ImplVulkan_DestroyTexture(reinterpret_cast<ImTextureID>(descriptorSet));
+      // ImGui may have drawn these in a frame that is still in flight
+      if (!m_ColorDescriptorSets.empty() || m_DepthDescriptorSet) {
+         m_Device->DeferDestroy([colorDescriptorSets = std::move(m_ColorDescriptorSets), depthDescriptorSet = m_DepthDescriptorSet] {
+            for (auto& descriptorSet : colorDescriptorSets) {
+               ImGui_ImplVulkan_DestroyTexture(reinterpret_cast<ImTextureID>(descriptorSet));
+            }
+            if (depthDescriptorSet) {
+               ImGui_ImplVulkan_DestroyTexture(reinterpret_cast<ImTextureID>(depthDescriptorSet));
+            }
+         });
       }
       m_ColorDescriptorSets.clear();
-      if (m_DepthDescriptorSet) {
-         ImGui_ImplVulkan_DestroyTexture(reinterpret_cast<ImTextureID>(m_DepthDescriptorSet));
-         m_DepthDescriptorSet = VK_NULL_HANDLE;
-      }
+      m_DepthDescriptorSet = VK_NULL_HANDLE;
       m_Context.reset();
       m_MSAADepthImage.reset();
       m_DepthTexture.reset();
@@ -297,7 +302,9 @@ namespace Pikzel {
 
    void VulkanFramebuffer::DestroyFramebuffer() {
       if (m_Framebuffer) {
-         m_Device->GetVkDevice().destroy(m_Framebuffer);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), framebuffer = m_Framebuffer] {
+            device.destroy(framebuffer);
+         });
          m_Framebuffer = nullptr;
       }
    }
@@ -2,11 +2,13 @@
 
 #include "SwapChainSupportDetails.h"
 #include "VulkanBuffer.h"
+#include "VulkanComputeContext.h"
 #include "VulkanPipeline.h"
 #include "VulkanTexture.h"
 #include "VulkanUtility.h"
 
 #include "Pikzel/Events/EventDispatcher.h"
+#include "Pikzel/Renderer/PipelineCompiler.h"
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -15,6 +17,51 @@
 
 namespace Pikzel {
 
+   VulkanPipelineTarget::VulkanPipelineTarget(std::shared_ptr<VulkanDevice> device, const std::unordered_map<BeginFrameOp, vk::RenderPass>& renderPasses, const vk::SampleCountFlagBits sampleCount, const uint32_t numColorAttachments)
+   : m_Device {device}
+   , m_SampleCount {sampleCount}
+   , m_NumColorAttachments {numColorAttachments}
+   {
+      PKZL_CORE_ASSERT(renderPasses.contains(BeginFrameOp::ClearAll), "VulkanPipelineTarget needs a ClearAll render pass!");
+      for (const auto& [beginFrameOp, renderPass] : renderPasses) {
+         m_RenderPasses.emplace_back(renderPass);
+      }
+      m_RenderPass = renderPasses.find(BeginFrameOp::ClearAll)->second;
+      m_PipelineCache = m_Device->GetVkDevice().createPipelineCache({});
+   }
+
+
+   VulkanPipelineTarget::~VulkanPipelineTarget() {
+      // the last pipeline built against this may have only just been released, and still be in use by the GPU
+      m_Device->DeferDestroy([device = m_Device->GetVkDevice(), renderPasses = std::move(m_RenderPasses), pipelineCache = m_PipelineCache] {
+         for (auto renderPass : renderPasses) {
+            device.destroy(renderPass);
+         }
+         device.destroy(pipelineCache);
+      });
+   }
+
+
+   vk::RenderPass VulkanPipelineTarget::GetVkRenderPass() const {
+      return m_RenderPass;
+   }
+
+
+   vk::PipelineCache VulkanPipelineTarget::GetVkPipelineCache() const {
+      return m_PipelineCache;
+   }
+
+
+   vk::SampleCountFlagBits VulkanPipelineTarget::GetNumSamples() const {
+      return m_SampleCount;
+   }
+
+
+   uint32_t VulkanPipelineTarget::GetNumColorAttachments() const {
+      return m_NumColorAttachments;
+   }
+
+
    VulkanGraphicsContext::VulkanGraphicsContext(std::shared_ptr<VulkanDevice> device) : m_Device {device} {}
 
 
@@ -35,6 +82,12 @@ namespace Pikzel {
    void VulkanGraphicsContext::EndImGuiFrame() {}
 
 
+   void VulkanGraphicsContext::WaitFor(ComputeContext& compute) {
+      std::shared_ptr<VulkanFence> fence = static_cast<VulkanComputeContext&>(compute).GetFence();
+      m_Waits.push_back({fence, fence->GetValue()});
+   }
+
+
    void VulkanGraphicsContext::Bind(const VertexBuffer& buffer) {
       const VulkanVertexBuffer& vulkanVertexBuffer = static_cast<const VulkanVertexBuffer&>(buffer);
       GetVkCommandBuffer().bindVertexBuffers(0, vulkanVertexBuffer.GetVkBuffer(), {0});
@@ -46,7 +99,7 @@ namespace Pikzel {
 
    void VulkanGraphicsContext::Bind(const IndexBuffer& buffer) {
       const VulkanIndexBuffer& vulkanIndexBuffer = static_cast<const VulkanIndexBuffer&>(buffer);
-      GetVkCommandBuffer().bindIndexBuffer(vulkanIndexBuffer.GetVkBuffer(), 0, vk::IndexType::eUint32);
+      GetVkCommandBuffer().bindIndexBuffer(vulkanIndexBuffer.GetVkBuffer(), 0, vulkanIndexBuffer.GetVkIndexType());
    }
 
 
@@ -80,6 +133,33 @@ namespace Pikzel {
    void VulkanGraphicsContext::Unbind(const UniformBuffer&) {}
 
 
+   void VulkanGraphicsContext::Bind(const Id resourceId, const StorageBuffer& buffer) {
+      const VulkanResource& resource = m_Pipeline->GetResource(resourceId);
+
+      vk::DescriptorBufferInfo storageBufferDescriptor = {
+         static_cast<const VulkanStorageBuffer&>(buffer).GetVkBuffer() /*buffer*/,
+         0                                                             /*offset*/,
+         VK_WHOLE_SIZE                                                 /*range*/
+      };
+
+      vk::WriteDescriptorSet storageBufferWrite = {
+         m_Pipeline->GetVkDescriptorSet(resource.DescriptorSet)  /*dstSet*/,
+         resource.Binding                                        /*dstBinding*/,
+         0                                                       /*dstArrayElement*/,
+         resource.GetCount()                                     /*descriptorCount*/,
+         resource.Type                                           /*descriptorType*/,
+         nullptr                                                 /*pImageInfo*/,
+         &storageBufferDescriptor                                /*pBufferInfo*/,
+         nullptr                                                 /*pTexelBufferView*/
+      };
+
+      m_Device->GetVkDevice().updateDescriptorSets(storageBufferWrite, nullptr);
+   }
+
+
+   void VulkanGraphicsContext::Unbind(const StorageBuffer&) {}
+
+
    void VulkanGraphicsContext::Bind(const Id resourceId, const Texture& texture) {
       const VulkanResource& resource = m_Pipeline->GetResource(resourceId);
 
@@ -110,7 +190,19 @@ namespace Pikzel {
 
 
    std::unique_ptr<Pikzel::Pipeline> VulkanGraphicsContext::CreatePipeline(const PipelineSettings& settings) const {
-      return std::make_unique<VulkanPipeline>(m_Device, *this, settings);
+      if (auto pipeline = PipelineCompiler::TakeWarmedUp(this, settings)) {
+         return pipeline;
+      }
+      return std::make_unique<VulkanPipeline>(m_Device, m_PipelineTarget, settings);
+   }
+
+
+   std::shared_ptr<PipelineFuture> VulkanGraphicsContext::CreatePipelineAsync(const PipelineSettings& settings) const {
+      // Pipeline creation (including the pipeline cache) is thread safe, so all of it can be done on a worker thread.
+      // The worker only touches the pipeline target, so this context may be destroyed while the pipeline is being created.
+      return PipelineCompiler::Submit(this, settings, [device = m_Device, target = m_PipelineTarget](const PipelineSettings& pipelineSettings) {
+         return std::make_unique<VulkanPipeline>(device, target, pipelineSettings);
+      });
    }
 
 
@@ -425,12 +517,27 @@ namespace Pikzel {
    }
 
 
-   void VulkanGraphicsContext::DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount, const uint32_t vertexOffset/*= 0*/) {
+   void VulkanGraphicsContext::DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount, const uint32_t vertexOffset/*= 0*/, const uint32_t firstIndex/*= 0*/) {
       uint32_t count = indexCount ? indexCount : indexBuffer.GetCount();
       BindDescriptorSets();
       Bind(vertexBuffer);
       Bind(indexBuffer);
-      GetVkCommandBuffer().drawIndexed(count, 1, 0, vertexOffset, 0);
+      GetVkCommandBuffer().drawIndexed(count, 1, firstIndex, vertexOffset, 0);
+   }
+
+
+   void VulkanGraphicsContext::DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const StorageBuffer& commands, const uint64_t commandsOffset, const StorageBuffer& count, const uint64_t countOffset, const uint32_t maxDrawCount) {
+      BindDescriptorSets();
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      GetVkCommandBuffer().drawIndexedIndirectCount(
+         static_cast<const VulkanStorageBuffer&>(commands).GetVkBuffer(),
+         commandsOffset,
+         static_cast<const VulkanStorageBuffer&>(count).GetVkBuffer(),
+         countOffset,
+         maxDrawCount,
+         sizeof(DrawIndexedIndirectCommand)
+      );
    }
 
 
@@ -440,7 +547,12 @@ namespace Pikzel {
 
 
    vk::PipelineCache VulkanGraphicsContext::GetVkPipelineCache() const {
-      return m_PipelineCache;
+      return m_PipelineTarget->GetVkPipelineCache();
+   }
+
+
+   const std::shared_ptr<VulkanPipelineTarget>& VulkanGraphicsContext::GetPipelineTarget() const {
+      return m_PipelineTarget;
    }
 
 
@@ -497,27 +609,34 @@ namespace Pikzel {
          subpass.pNext = &depthResolve;
       }
 
-      // Use subpass dependencies for layout transitions
+      // Use subpass dependencies for layout transitions, and for ordering against other work on the queue.
+      // On the way in, the attachments are not drawn over until earlier work has finished sampling (or drawing to) them.
+      // On the way out, what was drawn is made visible to later work that samples it.
+      // These are what order one framebuffer's frames against another's (see RenderGraph::Execute()), so they cannot be by region:
+      // later passes sample anywhere in the attachments, not just at the fragment they are shading.
       std::array<vk::SubpassDependency2, 2> dependencies = {
          vk::SubpassDependency2 {
-            VK_SUBPASS_EXTERNAL                                /*srcSubpass*/,
-            0                                                  /*dstSubpass*/,
-            vk::PipelineStageFlagBits::eFragmentShader         /*srcStageMask*/,
-            vk::PipelineStageFlagBits::eEarlyFragmentTests     /*dstStageMask*/,
-            vk::AccessFlagBits::eShaderRead                    /*srcAccessMask*/,
-            vk::AccessFlagBits::eDepthStencilAttachmentWrite   /*dstAccessMask*/,
-            vk::DependencyFlagBits::eByRegion                  /*dependencyFlags*/,
-            0                                                  /*viewOffset*/
-         }, 
+            VK_SUBPASS_EXTERNAL                                                                                        /*srcSubpass*/,
+            0                                                                                                          /*dstSubpass*/,
+            vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader |
+            vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests          /*srcStageMask*/,
+            vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests |
+            vk::PipelineStageFlagBits::eLateFragmentTests                                                              /*dstStageMask*/,
+            vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite               /*srcAccessMask*/,
+            vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite |
+            vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite         /*dstAccessMask*/,
+            {}                                                                                                         /*dependencyFlags*/,
+            0                                                                                                          /*viewOffset*/
+         },
          vk::SubpassDependency2 {
-            0                                                  /*srcSubpass*/,
-            VK_SUBPASS_EXTERNAL                                /*dstSubpass*/,
-            vk::PipelineStageFlagBits::eLateFragmentTests      /*srcStageMask*/,
-            vk::PipelineStageFlagBits::eFragmentShader         /*dstStageMask*/,
-            vk::AccessFlagBits::eDepthStencilAttachmentWrite   /*srcAccessMask*/,
-            vk::AccessFlagBits::eShaderRead                    /*dstAccessMask*/,
-            vk::DependencyFlagBits::eByRegion                  /*dependencyFlags*/,
-            0                                                  /*viewOffset*/
+            0                                                                                                          /*srcSubpass*/,
+            VK_SUBPASS_EXTERNAL                                                                                        /*dstSubpass*/,
+            vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests          /*srcStageMask*/,
+            vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader                     /*dstStageMask*/,
+            vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite               /*srcAccessMask*/,
+            vk::AccessFlagBits::eShaderRead                                                                            /*dstAccessMask*/,
+            {}                                                                                                         /*dependencyFlags*/,
+            0                                                                                                          /*viewOffset*/
          }
       };
 
@@ -538,8 +657,9 @@ namespace Pikzel {
    void VulkanGraphicsContext::DestroyRenderPass(vk::RenderPass renderPass) {
       if (m_Device) {
          if (renderPass) {
-            m_Device->GetVkDevice().destroy(renderPass);
-            renderPass = nullptr;
+            m_Device->DeferDestroy([device = m_Device->GetVkDevice(), renderPass] {
+               device.destroy(renderPass);
+            });
          }
       }
    }
@@ -566,8 +686,9 @@ namespace Pikzel {
    void VulkanGraphicsContext::DestroyDescriptorPool(vk::DescriptorPool descriptorPool) {
       if (m_Device) {
          if (descriptorPool) {
-            m_Device->GetVkDevice().destroy(descriptorPool);
-            descriptorPool = nullptr;
+            m_Device->DeferDestroy([device = m_Device->GetVkDevice(), descriptorPool] {
+               device.destroy(descriptorPool);
+            });
          }
       }
    }
@@ -583,7 +704,9 @@ namespace Pikzel {
 
    void VulkanGraphicsContext::DestroyCommandPool() {
       if (m_Device && m_CommandPool) {
-         m_Device->GetVkDevice().destroy(m_CommandPool);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), commandPool = m_CommandPool] {
+            device.destroy(commandPool);
+         });
          m_CommandPool = nullptr;
       }
    }
@@ -600,21 +723,23 @@ namespace Pikzel {
 
    void VulkanGraphicsContext::DestroyCommandBuffers() {
       if (m_Device && m_CommandPool) {
-         m_Device->GetVkDevice().freeCommandBuffers(m_CommandPool, m_CommandBuffers);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), commandPool = m_CommandPool, commandBuffers = std::move(m_CommandBuffers)] {
+            device.freeCommandBuffers(commandPool, commandBuffers);
+         });
          m_CommandBuffers.clear();
       }
    }
 
 
-   void VulkanGraphicsContext::CreatePipelineCache() {
-      m_PipelineCache = m_Device->GetVkDevice().createPipelineCache({});
+   void VulkanGraphicsContext::CreatePipelineTarget() {
+      m_PipelineTarget = std::make_shared<VulkanPipelineTarget>(m_Device, m_RenderPasses, m_SampleCount, GetNumColorAttachments());
    }
 
 
-   void VulkanGraphicsContext::DestroyPipelineCache() {
-      if (m_Device && m_PipelineCache) {
-         m_Device->GetVkDevice().destroy(m_PipelineCache);
-      }
+   void VulkanGraphicsContext::DestroyPipelineTarget() {
+      // the render passes (and pipeline cache) live on for as long as pipelines that were built against them
+      m_PipelineTarget = nullptr;
+      m_RenderPasses.clear();
    }
 
 
@@ -631,6 +756,7 @@ namespace Pikzel {
    VulkanWindowGC::VulkanWindowGC(std::shared_ptr<VulkanDevice> device, const Window& window)
    : VulkanGraphicsContext {device}
    , m_Window {static_cast<GLFWwindow*>(window.GetNativeWindow())}
+   , m_MaxFramesInFlight {device->GetFramesInFlight()}
    , m_IsVSync(window.IsVSync())
    {
       m_SampleCount = static_cast<vk::SampleCountFlagBits>(window.GetMSAANumSamples());
@@ -724,9 +850,9 @@ namespace Pikzel {
       CreateFramebuffers();
 
       CreateCommandPool();
-      CreateCommandBuffers(static_cast<uint32_t>(m_SwapChainImages.size()));
+      CreateCommandBuffers(m_MaxFramesInFlight);
       CreateSyncObjects();
-      CreatePipelineCache();
+      CreatePipelineTarget();
 
       EventDispatcher::Connect<WindowResizeEvent, &VulkanWindowGC::OnWindowResize>(*this);
       EventDispatcher::Connect<WindowVSyncChangedEvent, &VulkanWindowGC::OnWindowVSyncChanged>(*this);
@@ -756,18 +882,15 @@ namespace Pikzel {
             DestroyRenderPass(m_RenderPassImGui);
             DestroyDescriptorPool(m_DescriptorPoolImGui);
          }
-         DestroyPipelineCache();
          DestroySyncObjects();
          DestroyCommandBuffers();
          DestroyCommandPool();
          DestroyFramebuffers();
-         for (auto& [beginFrameOp, renderPass] : m_RenderPasses) {
-            DestroyRenderPass(renderPass);
-         }
-         m_RenderPasses.clear();
+         DestroyPipelineTarget();
          DestroyDepthStencil();
          DestroyImageViews();
          DestroySwapChain(m_SwapChain);
+         m_Device->FlushDeferred();  // the swap chain must be gone before the surface
          DestroySurface();
       }
    }
@@ -775,6 +898,17 @@ namespace Pikzel {
 
    void VulkanWindowGC::BeginFrame(const BeginFrameOp operation) {
       PKZL_PROFILE_FUNCTION();
+
+      // Wait until the GPU has finished the frame that last used this frame's command buffer and semaphores.
+      // That is the frame m_MaxFramesInFlight ago, so this is what limits how far the CPU can get ahead.
+      {
+         PKZL_PROFILE_SCOPE("WaitForFrame");
+         const uint64_t frame = m_FrameTimeline->GetPendingValue();
+         if (frame > m_MaxFramesInFlight) {
+            m_FrameTimeline->Wait(frame - m_MaxFramesInFlight);
+         }
+      }
+
       {
          PKZL_PROFILE_SCOPE("AquireNextImageKHR");
          auto rv = m_Device->GetVkDevice().acquireNextImageKHR(m_SwapChain, UINT64_MAX, m_ImageAvailableSemaphores[m_CurrentFrame], nullptr);
@@ -790,15 +924,10 @@ namespace Pikzel {
          PKZL_PROFILE_SETVALUE(m_CurrentImage);
       }
 
-      // Wait until we know GPU has finished with the command buffer we are about to use...
-      // Note that m_CurrentFrame and m_CurrentImage are not necessarily equal (particularly if we have, say, 3 swap chain images, and 2 frames-in-flight)
-      // However, we know that the GPU has finished with m_CurrentImage'th command buffer so long as the m_CurrentFrame'th fence is signaled
-      vk::Result result = m_Device->GetVkDevice().waitForFences(m_InFlightFences[m_CurrentFrame]->GetVkFence(), true, UINT64_MAX);
-
       vk::CommandBufferBeginInfo commandBufferBI = {
          vk::CommandBufferUsageFlagBits::eSimultaneousUse
       };
-      m_CommandBuffers[m_CurrentImage].begin(commandBufferBI);
+      m_CommandBuffers[m_CurrentFrame].begin(commandBufferBI);
 
       // TODO: Not sure that this is the best place to begin render pass.
       //       What if you need/want multiple render passes?  How will the client control this?
@@ -810,7 +939,7 @@ namespace Pikzel {
          static_cast<uint32_t>(m_ClearValues.size())  /*clearValueCount*/,
          m_ClearValues.data()                         /*pClearValues*/
       };
-      m_CommandBuffers[m_CurrentImage].beginRenderPass(renderPassBI, vk::SubpassContents::eInline);
+      m_CommandBuffers[m_CurrentFrame].beginRenderPass(renderPassBI, vk::SubpassContents::eInline);
 
       // Update dynamic state
 
@@ -827,19 +956,57 @@ namespace Pikzel {
          static_cast<float>(m_Extent.width), -1.0f * static_cast<float>(m_Extent.height),
          0.0f, 1.0f
       };
-      m_CommandBuffers[m_CurrentImage].setViewport(0, viewportFlipped);
+      m_CommandBuffers[m_CurrentFrame].setViewport(0, viewportFlipped);
 
       vk::Rect2D scissor = {
          {0, 0},
          m_Extent
       };
-      m_CommandBuffers[m_CurrentImage].setScissor(0, scissor);
+      m_CommandBuffers[m_CurrentFrame].setScissor(0, scissor);
+   }
+
+
+   void VulkanWindowGC::ClearDepth(const glm::uvec2& offset, const glm::uvec2& extent, const uint32_t baseLayer, const uint32_t layerCount) {
+      PKZL_PROFILE_FUNCTION();
+      vk::ClearAttachment clearAttachment = {
+         vk::ImageAspectFlagBits::eDepth  /*aspectMask*/,
+         0                                /*colorAttachment*/,
+         m_ClearValues[1]                 /*clearValue*/
+      };
+
+      // Flip y.  Pikzel uses 0,0 as bottom-left
+      vk::ClearRect clearRect = {
+         {
+            {static_cast<int32_t>(offset.x), static_cast<int32_t>(m_Extent.height - offset.y - extent.y)},
+            {extent.x, extent.y}
+         }                                /*rect*/,
+         baseLayer                        /*baseArrayLayer*/,
+         layerCount                       /*layerCount*/
+      };
+      m_CommandBuffers[m_CurrentFrame].clearAttachments(clearAttachment, clearRect);
+   }
+
+
+   void VulkanWindowGC::SetViewport(const glm::uvec2& offset, const glm::uvec2& extent) {
+      // Flip viewport. Pikzel uses 0,0 as bottom-left
+      vk::Viewport viewportFlipped = {
+         static_cast<float>(offset.x), static_cast<float>(m_Extent.height - offset.y),
+         static_cast<float>(extent.x), -1.0f * static_cast<float>(extent.y),
+         0.0f, 1.0f
+      };
+      m_CommandBuffers[m_CurrentFrame].setViewport(0, viewportFlipped);
+
+      vk::Rect2D scissor = {
+         {static_cast<int32_t>(offset.x), static_cast<int32_t>(m_Extent.height - offset.y - extent.y)},
+         {extent.x, extent.y}
+      };
+      m_CommandBuffers[m_CurrentFrame].setScissor(0, scissor);
    }
 
 
    void VulkanWindowGC::EndFrame() {
       PKZL_PROFILE_FUNCTION();
-      vk::CommandBuffer commandBuffer = m_CommandBuffers[m_CurrentImage];
+      vk::CommandBuffer commandBuffer = m_CommandBuffers[m_CurrentFrame];
       commandBuffer.endRenderPass();  // TODO: think about where render passes should begin/end
 
       if (m_ImGuiFrameStarted) {
@@ -857,19 +1024,13 @@ namespace Pikzel {
       }
 
       commandBuffer.end();
-      vk::PipelineStageFlags waitStages[] = {{vk::PipelineStageFlagBits::eColorAttachmentOutput}};
-      vk::SubmitInfo si = {
-         1                                             /*waitSemaphoreCount*/,
-         &m_ImageAvailableSemaphores[m_CurrentFrame]   /*pWaitSemaphores*/,
-         waitStages                                    /*pWaitDstStageMask*/,
-         1                                             /*commandBufferCount*/,
-         &commandBuffer                                /*pCommandBuffers*/,
-         1                                             /*signalSemaphoreCount*/,
-         &m_RenderFinishedSemaphores[m_CurrentFrame]   /*pSignalSemaphores*/
-      };
 
-      m_Device->GetVkDevice().resetFences(m_InFlightFences[m_CurrentFrame]->GetVkFence());
-      m_Device->GetGraphicsQueue().submit(si, m_InFlightFences[m_CurrentFrame]->GetVkFence());
+      // signals the frame counter (see VulkanDevice::GetFrameTimeline())
+      m_Device->Submit(m_Device->GetGraphicsQueue(), commandBuffer, m_FrameTimeline, m_ImageAvailableSemaphores[m_CurrentFrame], vk::PipelineStageFlagBits::eColorAttachmentOutput, m_RenderFinishedSemaphores[m_CurrentFrame], m_Waits);
+      m_Waits.clear();
+
+      // everything this frame uses is now in flight, so anything released before now can be destroyed once this frame has finished
+      m_Device->CollectDeferred();
 
       if (m_ImGuiFrameStarted) {
          if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
@@ -968,7 +1129,7 @@ namespace Pikzel {
          .Device          = m_Device->GetVkDevice(),
          .QueueFamily     = m_Device->GetGraphicsQueueFamilyIndex(),
          .Queue           = m_Device->GetGraphicsQueue(),
-         .PipelineCache   = m_PipelineCache,
+         .PipelineCache   = GetVkPipelineCache(),
          .DescriptorPool  = m_DescriptorPoolImGui,
          .Subpass         = 0,
          .MinImageCount   = static_cast<uint32_t>(m_SwapChainImages.size()),
@@ -1042,12 +1203,12 @@ namespace Pikzel {
 
 
    vk::CommandBuffer VulkanWindowGC::GetVkCommandBuffer() {
-      return m_CommandBuffers[m_CurrentImage];
+      return m_CommandBuffers[m_CurrentFrame];
    }
 
 
    std::shared_ptr<VulkanFence> VulkanWindowGC::GetFence() {
-      return m_InFlightFences[m_CurrentFrame];
+      return m_FrameTimeline;
    }
 
 
@@ -1181,7 +1342,9 @@ namespace Pikzel {
    void VulkanWindowGC::DestroySwapChain(vk::SwapchainKHR& swapChain) {
       if (m_Device && swapChain) {
          m_SwapChainImages.clear();
-         m_Device->GetVkDevice().destroy(swapChain);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), swapChain] {
+            device.destroy(swapChain);
+         });
          swapChain = nullptr;
       }
    }
@@ -1290,9 +1453,11 @@ namespace Pikzel {
 
    void VulkanWindowGC::DestroyFramebuffers() {
       if (m_Device) {
-         for (auto framebuffer : m_SwapChainFramebuffers) {
-            m_Device->GetVkDevice().destroy(framebuffer);
-         }
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), framebuffers = std::move(m_SwapChainFramebuffers)] {
+            for (auto framebuffer : framebuffers) {
+               device.destroy(framebuffer);
+            }
+         });
          m_SwapChainFramebuffers.clear();
       }
    }
@@ -1301,13 +1466,11 @@ namespace Pikzel {
    void VulkanWindowGC::CreateSyncObjects() {
       m_ImageAvailableSemaphores.reserve(m_MaxFramesInFlight);
       m_RenderFinishedSemaphores.reserve(m_MaxFramesInFlight);
-      m_InFlightFences.reserve(m_MaxFramesInFlight);
-
       for (uint32_t i = 0; i < m_MaxFramesInFlight; ++i) {
          m_ImageAvailableSemaphores.emplace_back(m_Device->GetVkDevice().createSemaphore({}));
          m_RenderFinishedSemaphores.emplace_back(m_Device->GetVkDevice().createSemaphore({}));
-         m_InFlightFences.emplace_back(std::make_shared<VulkanFence>(m_Device->GetVkDevice()));
       }
+      m_FrameTimeline = m_Device->GetFrameTimeline();
    }
 
 
@@ -1322,13 +1485,14 @@ namespace Pikzel {
             m_Device->GetVkDevice().destroy(semaphore);
          }
          m_RenderFinishedSemaphores.clear();
-         m_InFlightFences.clear();
+         m_FrameTimeline = nullptr;
       }
    }
 
 
    void VulkanWindowGC::RecreateSwapChain() {
-      m_Device->GetVkDevice().waitIdle();
+      // The old swap chain and everything that goes with it is destroyed once the frames in flight have finished with it.
+      // So there is no need to wait for the device to be idle.
       DestroyImageViews();
       CreateSwapChain();
       CreateImageViews();
@@ -1433,25 +1597,20 @@ namespace Pikzel {
       CreateCommandPool();
       CreateCommandBuffers(1);
       CreateSyncObjects();
-      CreatePipelineCache();
+      CreatePipelineTarget();
    }
 
 
    VulkanFramebufferGC::~VulkanFramebufferGC() {
       if (m_Device) {
-         m_Device->GetVkDevice().waitIdle();
-
+         // Vulkan objects are destroyed once the GPU has finished with them, so there is no need to wait here
          if (m_Pipeline) {
             Unbind(*m_Pipeline);
          }
-         DestroyPipelineCache();
          DestroySyncObjects();
          DestroyCommandBuffers();
          DestroyCommandPool();
-         for (auto& [beginFrameOp, renderPass] : m_RenderPasses) {
-            DestroyRenderPass(renderPass);
-         }
-         m_RenderPasses.clear();
+         DestroyPipelineTarget();
       }
    }
 
@@ -1502,39 +1661,76 @@ namespace Pikzel {
    }
 
 
-   void VulkanFramebufferGC::EndFrame() {
+   void VulkanFramebufferGC::ClearDepth(const glm::uvec2& offset, const glm::uvec2& extent, const uint32_t baseLayer, const uint32_t layerCount) {
       PKZL_PROFILE_FUNCTION();
-      vk::CommandBuffer cmd = m_CommandBuffers.front();
-      cmd.endRenderPass();  // TODO: think about where render passes should begin/end
-      cmd.end();
+      PKZL_CORE_ASSERT(m_Framebuffer->HasDepthAttachment(), "Attempted to clear depth of a framebuffer that does not have a depth attachment!");
+      vk::ClearAttachment clearAttachment = {
+         vk::ImageAspectFlagBits::eDepth                                                             /*aspectMask*/,
+         0                                                                                           /*colorAttachment*/,
+         vk::ClearDepthStencilValue {static_cast<float>(m_Framebuffer->GetClearDepthValue()), 0}    /*clearValue*/
+      };
 
-      vk::SubmitInfo si = {
-         0                /*waitSemaphoreCount*/,
-         nullptr          /*pWaitSemaphores*/,
-         nullptr          /*pWaitDstStageMask*/,
-         1                /*commandBufferCount*/,
-         &cmd             /*pCommandBuffers*/,
-         0                /*signalSemaphoreCount*/,
-         nullptr          /*pSignalSemaphores*/
+      // Framebuffer viewport is not flipped (see BeginFrame()), so no need to flip y here either
+      vk::ClearRect clearRect = {
+         {
+            {static_cast<int32_t>(offset.x), static_cast<int32_t>(offset.y)},
+            {extent.x, extent.y}
+         }                                                                                           /*rect*/,
+         baseLayer                                                                                   /*baseArrayLayer*/,
+         layerCount                                                                                  /*layerCount*/
       };
+      GetVkCommandBuffer().clearAttachments(clearAttachment, clearRect);
+   }
 
-      m_Device->GetVkDevice().resetFences(m_InFlightFence->GetVkFence());
-      m_Device->GetGraphicsQueue().submit(si, m_InFlightFence->GetVkFence());
+
+   void VulkanFramebufferGC::SetViewport(const glm::uvec2& offset, const glm::uvec2& extent) {
+      // Framebuffer viewport is not flipped (see BeginFrame())
+      vk::Viewport viewport = {
+         static_cast<float>(offset.x), static_cast<float>(offset.y),
+         static_cast<float>(extent.x), static_cast<float>(extent.y),
+         0.0f, 1.0f
+      };
+      GetVkCommandBuffer().setViewport(0, viewport);
+
+      vk::Rect2D scissor = {
+         {static_cast<int32_t>(offset.x), static_cast<int32_t>(offset.y)},
+         {extent.x, extent.y}
+      };
+      GetVkCommandBuffer().setScissor(0, scissor);
+   }
+
+
+   void VulkanFramebufferGC::EndFrame() {
+      PKZL_PROFILE_FUNCTION();
+      vk::CommandBuffer cmd = m_CommandBuffers.front();
+      cmd.endRenderPass();  // TODO: think about where render passes should begin/end
 
       // Depth texture to shader read only here.
       // This is so that other "graphics contexts" can ask this framebuffer for the depth texture
       // and then sample from that.
-      // This is not really how things should be done, as it can be much more efficient to do it
-      // with render sub-passes instead.
+      // The transition is recorded into this frame's command buffer (rather than being submitted separately), and is skipped
+      // altogether if nothing is going to sample the depth texture (see SetDepthSampled())
       // TODO: subpasses
-      if(m_Framebuffer->HasDepthAttachment()) {
+      if (m_IsDepthSampled && m_Framebuffer->HasDepthAttachment()) {
          const auto& depthTexture = static_cast<const VulkanTexture&>(m_Framebuffer->GetDepthTexture());
-         m_Device->PipelineBarrier(
-            vk::PipelineStageFlagBits::eEarlyFragmentTests,
-            vk::PipelineStageFlagBits::eFragmentShader,
+         cmd.pipelineBarrier(
+            vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+            vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader,
+            {},
+            nullptr,
+            nullptr,
             depthTexture.GetImage().Barrier(vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, 0, 0, 0, 0)
          );
       }
+      cmd.end();
+
+      m_Device->Submit(m_Device->GetGraphicsQueue(), cmd, m_InFlightFence, {}, {}, {}, m_Waits);
+      m_Waits.clear();
+   }
+
+
+   void VulkanFramebufferGC::SetDepthSampled(const bool isSampled) {
+      m_IsDepthSampled = isSampled;
    }
 
 
@@ -1552,7 +1748,7 @@ namespace Pikzel {
 
 
    void VulkanFramebufferGC::SwapBuffers() {
-      vk::Result result = m_Device->GetVkDevice().waitForFences(m_InFlightFence->GetVkFence(), true, UINT64_MAX);
+      m_InFlightFence->Wait();
    }
 
 
@@ -1572,12 +1768,14 @@ namespace Pikzel {
 
 
    void VulkanFramebufferGC::CreateSyncObjects() {
-      m_InFlightFence = std::make_shared<VulkanFence>(m_Device->GetVkDevice());
+      m_InFlightFence = m_Device->CreateFence();
    }
 
 
    void VulkanFramebufferGC::DestroySyncObjects() {
       if (m_Device && m_InFlightFence) {
+         // the fence must outlive the work that was submitted with it
+         m_Device->DeferDestroy([fence = std::move(m_InFlightFence)] {});
          m_InFlightFence = nullptr;
       }
    }
@@ -11,11 +11,42 @@
 #include "Pikzel/Renderer/GraphicsContext.h"
 
 #include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace Pikzel {
 
    class VulkanPipeline;
 
+   // What graphics pipelines are built against: the context's render passes (which are all compatible with one another), its sample
+   // count and number of color attachments, and a pipeline cache.
+   // Pipelines share ownership of this, rather than referring to the context, so that they can still be built (on a worker thread,
+   // or when their shaders are reloaded) after the context has gone.  e.g. a framebuffer's context is replaced when the framebuffer
+   // is resized, and the FramebufferPool destroys framebuffers that have gone unused.
+   // It does not change once it has been constructed, so it may be read from any thread.
+   class VulkanPipelineTarget final {
+   public:
+      // Takes ownership of renderPasses
+      VulkanPipelineTarget(std::shared_ptr<VulkanDevice> device, const std::unordered_map<BeginFrameOp, vk::RenderPass>& renderPasses, const vk::SampleCountFlagBits sampleCount, const uint32_t numColorAttachments);
+      PKZL_NO_COPYMOVE(VulkanPipelineTarget);
+      ~VulkanPipelineTarget();
+
+      vk::RenderPass GetVkRenderPass() const;
+      vk::PipelineCache GetVkPipelineCache() const;
+      vk::SampleCountFlagBits GetNumSamples() const;
+      uint32_t GetNumColorAttachments() const;
+
+   private:
+      std::shared_ptr<VulkanDevice> m_Device;
+      std::vector<vk::RenderPass> m_RenderPasses;
+      vk::RenderPass m_RenderPass;                 // the one that pipelines are built with
+      vk::PipelineCache m_PipelineCache;
+      vk::SampleCountFlagBits m_SampleCount = vk::SampleCountFlagBits::e1;
+      uint32_t m_NumColorAttachments = 0;
+   };
+
+
    class VulkanGraphicsContext : public GraphicsContext {
    using super = GraphicsContext;
    protected:
@@ -28,6 +59,8 @@ namespace Pikzel {
       virtual void BeginImGuiFrame() override;
       virtual void EndImGuiFrame() override;
 
+      virtual void WaitFor(ComputeContext& compute) override;
+
       virtual void Bind(const VertexBuffer& buffer) override;
       virtual void Unbind(const VertexBuffer& buffer) override;
 
@@ -37,10 +70,14 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) override;
       virtual void Unbind(const UniformBuffer& buffer) override;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) override;
+      virtual void Unbind(const StorageBuffer& buffer) override;
+
       virtual void Bind(const Id resourceId, const Texture& texture) override;
       virtual void Unbind(const Texture& texture) override;
 
       virtual std::unique_ptr<Pipeline> CreatePipeline(const PipelineSettings& settings) const override;
+      virtual std::shared_ptr<PipelineFuture> CreatePipelineAsync(const PipelineSettings& settings) const override;
 
       virtual void PushConstant(const Id id, bool value) override;
       virtual void PushConstant(const Id id, int value) override;
@@ -82,11 +119,13 @@ namespace Pikzel {
       virtual void PushConstant(const Id id, const glm::dmat4& value) override;
 
       virtual void DrawTriangles(const VertexBuffer& vertexBuffer, const uint32_t vertexCount, const uint32_t vertexOffset = 0) override;
-      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0) override;
+      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0, const uint32_t firstIndex = 0) override;
+      virtual void DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const StorageBuffer& commands, const uint64_t commandsOffset, const StorageBuffer& count, const uint64_t countOffset, const uint32_t maxDrawCount) override;
 
    public:
       vk::RenderPass GetVkRenderPass(BeginFrameOp operation) const;
       vk::PipelineCache GetVkPipelineCache() const;
+      const std::shared_ptr<VulkanPipelineTarget>& GetPipelineTarget() const;
 
       virtual vk::CommandBuffer GetVkCommandBuffer() = 0;
       virtual std::shared_ptr<VulkanFence> GetFence() = 0;
@@ -108,8 +147,9 @@ namespace Pikzel {
       void CreateCommandBuffers(const uint32_t commandBufferCount);
       void DestroyCommandBuffers();
 
-      void CreatePipelineCache();
-      void DestroyPipelineCache();
+      // Call once the render passes have been created.  The pipeline target takes ownership of them
+      void CreatePipelineTarget();
+      void DestroyPipelineTarget();
 
       void BindDescriptorSets();
       void UnbindDescriptorSets();
@@ -126,12 +166,14 @@ namespace Pikzel {
 
       // We need a different render pass for each possible "BeginFrameOp".
       // This is less than ideal!
+      // They are owned by m_PipelineTarget
       std::unordered_map<BeginFrameOp, vk::RenderPass> m_RenderPasses;
 
       vk::CommandPool m_CommandPool;
       std::vector<vk::CommandBuffer> m_CommandBuffers;
+      std::vector<VulkanFenceValue> m_Waits;       // compute work that the current frame must wait for (see WaitFor())
 
-      vk::PipelineCache m_PipelineCache;
+      std::shared_ptr<VulkanPipelineTarget> m_PipelineTarget;
       VulkanPipeline* m_Pipeline = nullptr;       // currently bound pipeline  (TODO: should be a shared_ptr?)
    };
 
@@ -145,6 +187,9 @@ namespace Pikzel {
       virtual void BeginFrame(const BeginFrameOp operation = BeginFrameOp::ClearAll) override;
       virtual void EndFrame() override;
 
+      virtual void ClearDepth(const glm::uvec2& offset, const glm::uvec2& extent, const uint32_t baseLayer = 0, const uint32_t layerCount = 1) override;
+      virtual void SetViewport(const glm::uvec2& offset, const glm::uvec2& extent) override;
+
       virtual void InitializeImGui() override;
       virtual void BeginImGuiFrame() override;
       virtual void EndImGuiFrame() override;
@@ -154,6 +199,8 @@ namespace Pikzel {
 
       virtual void SwapBuffers() override;
 
+      virtual void SetDepthSampled(const bool isSampled) override;
+
    public:
       virtual vk::CommandBuffer GetVkCommandBuffer() override;
       virtual std::shared_ptr<VulkanFence> GetFence() override;
@@ -210,12 +257,12 @@ namespace Pikzel {
 
       std::vector<vk::Framebuffer> m_SwapChainFramebuffers;
 
-      uint32_t m_MaxFramesInFlight = 2;
-      uint32_t m_CurrentFrame = 0; // which frame (up to MaxFramesInFlight) are we currently rendering
-      uint32_t m_CurrentImage = 0; // which swap chain image are we currently rendering to
+      uint32_t m_MaxFramesInFlight = 2;      // see Window::Settings::framesInFlight
+      uint32_t m_CurrentFrame = 0;           // which frame (up to MaxFramesInFlight) are we currently rendering.  Indexes the command buffers and semaphores
+      uint32_t m_CurrentImage = 0;           // which swap chain image are we currently rendering to
       std::vector<vk::Semaphore> m_ImageAvailableSemaphores;
       std::vector<vk::Semaphore> m_RenderFinishedSemaphores;
-      std::vector<std::shared_ptr<VulkanFence>> m_InFlightFences;
+      std::shared_ptr<VulkanFence> m_FrameTimeline;   // the device's frame counter.  Each frame signals the next value
 
       bool m_IsVSync = false;
       bool m_WantResize = false;
@@ -233,11 +280,16 @@ namespace Pikzel {
       virtual void BeginFrame(const BeginFrameOp operation = BeginFrameOp::ClearAll) override;
       virtual void EndFrame() override;
 
+      virtual void ClearDepth(const glm::uvec2& offset, const glm::uvec2& extent, const uint32_t baseLayer = 0, const uint32_t layerCount = 1) override;
+      virtual void SetViewport(const glm::uvec2& offset, const glm::uvec2& extent) override;
+
       virtual void Bind(const Pipeline& pipeline) override;
       virtual void Unbind(const Pipeline& pipeline) override;
 
       virtual void SwapBuffers() override;
 
+      virtual void SetDepthSampled(const bool isSampled) override;
+
    public:
       virtual vk::CommandBuffer GetVkCommandBuffer() override;
       virtual std::shared_ptr<VulkanFence> GetFence() override;
@@ -253,6 +305,7 @@ namespace Pikzel {
       vk::Extent2D m_Extent;
       VulkanFramebuffer* m_Framebuffer;
       std::shared_ptr<VulkanFence> m_InFlightFence;
+      bool m_IsDepthSampled = true;
    };
 
 }
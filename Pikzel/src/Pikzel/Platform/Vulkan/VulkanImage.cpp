@@ -77,6 +77,16 @@ namespace Pikzel {
          vk::ImageLayout::eUndefined   /*initialLayout*/
       };
 
+      // Images that compute shaders might read or write are shared by the graphics and compute queue families (if they differ),
+      // rather than having their ownership transferred back and forth.
+      // Attachments that are not sampled stay exclusive to graphics (which can be faster).
+      const auto& sharedQueueFamilyIndices = m_Device->GetSharedQueueFamilyIndices();
+      if (!sharedQueueFamilyIndices.empty() && (usage & (vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eStorage))) {
+         imageInfo.sharingMode = vk::SharingMode::eConcurrent;
+         imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharedQueueFamilyIndices.size());
+         imageInfo.pQueueFamilyIndices = sharedQueueFamilyIndices.data();
+      }
+
       vma::AllocationCreateInfo allocInfo = {};
       allocInfo.usage = memoryUsage;
 
@@ -106,7 +116,10 @@ namespace Pikzel {
          // I.e. we allocated the image, so we destroy it.
          // As opposed to images that were created (and are destroyed) by
          // the swap chain.
-         VulkanMemoryAllocator::Get().destroyImage(m_Image, m_Allocation);
+         // The GPU may still be using it, so it is destroyed later.
+         m_Device->DeferDestroy([image = m_Image, allocation = m_Allocation] {
+            VulkanMemoryAllocator::Get().destroyImage(image, allocation);
+         });
          m_Image = nullptr;
          m_Allocation = nullptr;
       }
@@ -173,15 +186,17 @@ namespace Pikzel {
 
 
    void VulkanImage::DestroyImageViews() {
-      if (m_Device) {
-         for (auto& imageView : m_MIPImageViews) {
-            m_Device->GetVkDevice().destroy(imageView);
-         }
+      if (m_Device && (m_ImageView || !m_MIPImageViews.empty())) {
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), imageView = m_ImageView, mipImageViews = std::move(m_MIPImageViews)] {
+            for (auto mipImageView : mipImageViews) {
+               device.destroy(mipImageView);
+            }
+            if (imageView) {
+               device.destroy(imageView);
+            }
+         });
          m_MIPImageViews.clear();
-         if (m_ImageView) {
-            m_Device->GetVkDevice().destroy(m_ImageView);
-            m_ImageView = nullptr;
-         }
+         m_ImageView = nullptr;
       }
    }
 
@@ -245,6 +260,10 @@ namespace Pikzel {
                   barrier.srcAccessMask = {};
                   barrier.dstAccessMask = {};
                   break;
+               case vk::ImageLayout::eShaderReadOnlyOptimal:
+                  barrier.srcAccessMask = {};
+                  barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+                  break;
                default:
                   PKZL_CORE_ASSERT(false, "unsupported layout transition!");
             }
@@ -256,6 +275,10 @@ namespace Pikzel {
                   barrier.srcAccessMask = {};
                   barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
                   break;
+               case vk::ImageLayout::eTransferSrcOptimal:
+                  barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+                  barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+                  break;
                case vk::ImageLayout::eShaderReadOnlyOptimal:
                   barrier.srcAccessMask = {};
                   barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
@@ -271,6 +294,10 @@ namespace Pikzel {
                   barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
                   barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
                   break;
+               case vk::ImageLayout::eGeneral:
+                  barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
+                  barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+                  break;
                default:
                   PKZL_CORE_ASSERT(false, "unsupported layout transition!");
             }
@@ -308,6 +335,10 @@ namespace Pikzel {
                   barrier.srcAccessMask = {};
                   barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
                   break;
+               case vk::ImageLayout::eGeneral:
+                  barrier.srcAccessMask = vk::AccessFlagBits::eShaderRead;
+                  barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+                  break;
                default:
                   PKZL_CORE_ASSERT(false, "unsupported layout transition!");
             }
@@ -354,6 +385,23 @@ namespace Pikzel {
    }
 
 
+   void VulkanImage::CopyToBuffer(vk::Buffer buffer, const vk::ArrayProxy<const vk::BufferImageCopy>& regions, const vk::ImageLayout layout) const {
+      m_Device->SubmitSingleTimeCommands(m_Device->GetTransferQueue(), [this, buffer, &regions, layout] (vk::CommandBuffer cmd) {
+         std::vector<vk::ImageMemoryBarrier> beforeCopyBarriers;
+         std::vector<vk::ImageMemoryBarrier> afterCopyBarriers;
+         beforeCopyBarriers.reserve(regions.size());
+         afterCopyBarriers.reserve(regions.size());
+         for (const auto& region : regions) {
+            beforeCopyBarriers.emplace_back(Barrier(layout, vk::ImageLayout::eTransferSrcOptimal, region.imageSubresource.mipLevel, 1, region.imageSubresource.baseArrayLayer, region.imageSubresource.layerCount));
+            afterCopyBarriers.emplace_back(Barrier(vk::ImageLayout::eTransferSrcOptimal, layout, region.imageSubresource.mipLevel, 1, region.imageSubresource.baseArrayLayer, region.imageSubresource.layerCount));
+         }
+         cmd.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, beforeCopyBarriers);
+         cmd.copyImageToBuffer(m_Image, vk::ImageLayout::eTransferSrcOptimal, buffer, regions);
+         cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr, afterCopyBarriers);
+      });
+   }
+
+
    void VulkanImage::GenerateMipmap(const uint32_t baseMipLevel) {
       // Check if image format supports linear blitting
       vk::FormatProperties formatProperties = m_Device->GetVkPhysicalDevice().getFormatProperties(m_Format);
@@ -361,7 +409,7 @@ namespace Pikzel {
          throw std::runtime_error {"texture image format does not support linear blitting!"};
       }
 
-      m_Device->SubmitSingleTimeCommands(m_Device->GetComputeQueue(), [this, baseMipLevel] (vk::CommandBuffer cmd) {
+      m_Device->SubmitSingleTimeCommands(m_Device->GetGraphicsQueue(), [this, baseMipLevel] (vk::CommandBuffer cmd) {
          vk::ImageMemoryBarrier barrier = {
             {}                                   /*srcAccessMask*/,
             {}                                   /*dstAccessMask*/,
@@ -37,6 +37,9 @@ namespace Pikzel {
       void CopyFromBuffer(vk::Buffer buffer, const vk::ArrayProxy<const vk::BufferImageCopy>& regions);
       void CopyFromImage(const VulkanImage& image, const vk::ArrayProxy<const vk::ImageCopy>& regions);
 
+      // Copy from image (which must currently be in the given layout, and is left in that layout) to buffer
+      void CopyToBuffer(vk::Buffer buffer, const vk::ArrayProxy<const vk::BufferImageCopy>& regions, const vk::ImageLayout layout) const;
+
       void GenerateMipmap(const uint32_t baseMipLevel);
 
    protected:
@@ -8,8 +8,13 @@ namespace Pikzel {
       VulkanMemoryAllocator() = delete;
 
    public:
-      static void Init(vk::Instance instance, vk::PhysicalDevice physicalDevice, vk::Device device) {
+      // memoryBudget = true if the device has VK_EXT_memory_budget enabled.
+      // Without it, vmaGetBudget() still works but its values are estimates (based on heap sizes, and the allocator's own allocations)
+      static void Init(vk::Instance instance, vk::PhysicalDevice physicalDevice, vk::Device device, const bool memoryBudget) {
          vma::AllocatorCreateInfo allocatorInfo;
+         if (memoryBudget) {
+            allocatorInfo.flags = vma::AllocatorCreateFlagBits::eExtMemoryBudget;
+         }
          allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_1;
          allocatorInfo.instance = instance;
          allocatorInfo.physicalDevice = physicalDevice;
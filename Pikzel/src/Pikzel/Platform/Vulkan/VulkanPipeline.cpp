@@ -3,10 +3,12 @@
 #include "VulkanGraphicsContext.h"
 #include "Pikzel/Core/Utility.h"
 #include "Pikzel/Core/Window.h"
+#include "Pikzel/Renderer/ShaderReloader.h"
 #include "Pikzel/Renderer/ShaderUtil.h"
 
 #include <spirv_cross/spirv_cross.hpp>
 
+#include <array>
 #include <map>
 
 namespace Pikzel {
@@ -33,6 +35,9 @@ namespace Pikzel {
          case DataType::DVec2:    return vk::Format::eR64G64Sfloat;
          case DataType::DVec3:    return vk::Format::eR64G64B64Sfloat;
          case DataType::DVec4:    return vk::Format::eR64G64B64A64Sfloat;
+         case DataType::UNorm16Vec4: return vk::Format::eR16G16B16A16Unorm;
+         case DataType::SNorm16Vec2: return vk::Format::eR16G16Snorm;
+         case DataType::HVec2:    return vk::Format::eR16G16Sfloat;
       }
       PKZL_CORE_ASSERT(false, "Unknown DataType for VkFormat!");
       return {};
@@ -68,7 +73,8 @@ namespace Pikzel {
 
 
    VulkanPipeline::VulkanPipeline(std::shared_ptr<VulkanDevice> device, const PipelineSettings& settings)
-   : m_Device {device} {
+   : Pipeline {settings}
+   , m_Device {device} {
       CreateDescriptorSetLayouts(settings);
       CreatePipelineLayout();
       CreateComputePipeline(settings);
@@ -76,18 +82,21 @@ namespace Pikzel {
    }
 
 
-   VulkanPipeline::VulkanPipeline(std::shared_ptr<VulkanDevice> device, const VulkanGraphicsContext& gc, const PipelineSettings& settings)
-   : m_Device {device}
+   VulkanPipeline::VulkanPipeline(std::shared_ptr<VulkanDevice> device, std::shared_ptr<VulkanPipelineTarget> target, const PipelineSettings& settings)
+   : Pipeline {settings}
+   , m_Device {device}
+   , m_Target {target}
    {
+      PKZL_CORE_ASSERT(m_Target, "Attempted to create graphics pipeline with null target!");
       CreateDescriptorSetLayouts(settings);
       CreatePipelineLayout();
-      CreateGraphicsPipeline(gc, settings);
+      CreateGraphicsPipeline(*m_Target, settings);
       CreateDescriptorPool();
    }
 
 
    VulkanPipeline::~VulkanPipeline() {
-      m_Device->GetVkDevice().waitIdle();
+      // No need to wait for the device to be idle.  The Vulkan objects are destroyed once the GPU has finished with them
       DestroyDesciptorPool();
       DestroyPipeline();
       DestroyPipelineLayout();
@@ -95,6 +104,32 @@ namespace Pikzel {
    }
 
 
+   void VulkanPipeline::Reload() {
+      // Build the new pipeline completely before touching this one, so that if it fails this one is unchanged.
+      // The old pipeline is then destroyed with the temporary (once the frames that may be using it have finished)
+      std::unique_ptr<VulkanPipeline> reloaded = m_Target ? std::make_unique<VulkanPipeline>(m_Device, m_Target, GetSettings()) : std::make_unique<VulkanPipeline>(m_Device, GetSettings());
+      std::swap(m_DescriptorSetLayouts, reloaded->m_DescriptorSetLayouts);
+      std::swap(m_PipelineBindPoint, reloaded->m_PipelineBindPoint);
+      std::swap(m_PipelineLayout, reloaded->m_PipelineLayout);
+      std::swap(m_PipelineCompute, reloaded->m_PipelineCompute);
+      std::swap(m_PipelineFrontFaceCCW, reloaded->m_PipelineFrontFaceCCW);
+      std::swap(m_PipelineFrontFaceCW, reloaded->m_PipelineFrontFaceCW);
+      std::swap(m_DescriptorPool, reloaded->m_DescriptorPool);
+      std::swap(m_DescriptorSetInstances, reloaded->m_DescriptorSetInstances);
+      std::swap(m_DescriptorSetBound, reloaded->m_DescriptorSetBound);
+      std::swap(m_DescriptorSetFences, reloaded->m_DescriptorSetFences);
+      std::swap(m_DescriptorSetFenceValues, reloaded->m_DescriptorSetFenceValues);
+      std::swap(m_DescriptorSetIndices, reloaded->m_DescriptorSetIndices);
+      std::swap(m_DescriptorSetPending, reloaded->m_DescriptorSetPending);
+      std::swap(m_ShaderSrcs, reloaded->m_ShaderSrcs);
+      std::swap(m_ShaderSpecializations, reloaded->m_ShaderSpecializations);  // these point into m_SpecializationMap and m_SpecializationData,
+      std::swap(m_SpecializationMap, reloaded->m_SpecializationMap);          // whose storage moves with them
+      std::swap(m_SpecializationData, reloaded->m_SpecializationData);
+      std::swap(m_PushConstants, reloaded->m_PushConstants);
+      std::swap(m_Resources, reloaded->m_Resources);
+   }
+
+
    vk::Pipeline VulkanPipeline::GetVkPipelineCompute() const {
       return m_PipelineCompute;
    }
@@ -219,6 +254,7 @@ namespace Pikzel {
          ReflectResourceBindings(shaderType, vk::DescriptorType::eUniformBuffer, "uniform buffer", compiler, m_Resources, resources.uniform_buffers);
          ReflectResourceBindings(shaderType, vk::DescriptorType::eCombinedImageSampler, "sampled image", compiler, m_Resources, resources.sampled_images);
          ReflectResourceBindings(shaderType, vk::DescriptorType::eStorageImage, "storage image", compiler, m_Resources, resources.storage_images);
+         ReflectResourceBindings(shaderType, vk::DescriptorType::eStorageBuffer, "storage buffer", compiler, m_Resources, resources.storage_buffers);
 
          // specialization constants
          m_SpecializationMap.emplace_back();
@@ -245,7 +281,7 @@ namespace Pikzel {
 
    void VulkanPipeline::CreateDescriptorSetLayouts(const PipelineSettings& settings) {
       for (const auto& [shaderType, path] : settings.shaders) {
-         m_ShaderSrcs.emplace_back(shaderType, ReadFile<uint32_t>(path));
+         m_ShaderSrcs.emplace_back(shaderType, ShaderReloader::ReadSPIRV(path));
       }
 
       ReflectShaders(settings.specializationConstants);
@@ -268,6 +304,7 @@ namespace Pikzel {
          m_DescriptorSetLayouts.emplace_back(m_Device->GetVkDevice().createDescriptorSetLayout(ci));
          m_DescriptorSetInstances.emplace_back();
          m_DescriptorSetFences.emplace_back();
+         m_DescriptorSetFenceValues.emplace_back();
          m_DescriptorSetIndices.emplace_back(0);
          m_DescriptorSetPending.emplace_back(false);
          m_DescriptorSetBound.emplace_back(false);
@@ -287,9 +324,11 @@ namespace Pikzel {
 
    void VulkanPipeline::DestroyDescriptorSetLayouts() {
       if (m_Device) {
-         for (const auto descriptorSetLayout : m_DescriptorSetLayouts) {
-            m_Device->GetVkDevice().destroy(descriptorSetLayout);
-         }
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), descriptorSetLayouts = std::move(m_DescriptorSetLayouts)] {
+            for (const auto descriptorSetLayout : descriptorSetLayouts) {
+               device.destroy(descriptorSetLayout);
+            }
+         });
          m_DescriptorSetLayouts.clear();
       }
    }
@@ -325,9 +364,10 @@ namespace Pikzel {
 
 
    void VulkanPipeline::DestroyPipelineLayout() {
-      ;
       if (m_Device && m_PipelineLayout) {
-         m_Device->GetVkDevice().destroy(m_PipelineLayout);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), pipelineLayout = m_PipelineLayout] {
+            device.destroy(pipelineLayout);
+         });
          m_PipelineLayout = nullptr;
       }
    }
@@ -357,12 +397,12 @@ namespace Pikzel {
    }
 
 
-   void VulkanPipeline::CreateGraphicsPipeline(const VulkanGraphicsContext& gc, const PipelineSettings& settings) {
+   void VulkanPipeline::CreateGraphicsPipeline(const VulkanPipelineTarget& target, const PipelineSettings& settings) {
       m_PipelineBindPoint = vk::PipelineBindPoint::eGraphics;
 
       vk::GraphicsPipelineCreateInfo pipelineCI;
       pipelineCI.layout = m_PipelineLayout;
-      pipelineCI.renderPass = gc.GetVkRenderPass(BeginFrameOp::ClearAll);
+      pipelineCI.renderPass = target.GetVkRenderPass();
 
       // Input assembly state describes how primitives are assembled
       // This pipeline will assemble vertex data as a triangle lists
@@ -392,8 +432,8 @@ namespace Pikzel {
       // Color blend state describes how blend factors are calculated (if used)
       // We need one blend attachment state per color attachment (even if blending is not used)
       std::vector<vk::PipelineColorBlendAttachmentState> colorBlendAttachmentStates;
-      colorBlendAttachmentStates.reserve(gc.GetNumColorAttachments());
-      for (uint32_t i = 0; i < gc.GetNumColorAttachments(); ++i) {
+      colorBlendAttachmentStates.reserve(target.GetNumColorAttachments());
+      for (uint32_t i = 0; i < target.GetNumColorAttachments(); ++i) {
          colorBlendAttachmentStates.emplace_back(
             settings.enableBlend                     /*blendEnable*/,
             vk::BlendFactor::eSrcAlpha               /*srcColorBlendFactor*/,
@@ -410,7 +450,7 @@ namespace Pikzel {
          {}                                 /*flags*/,
          false                              /*logicOpEnable*/,
          vk::LogicOp::eCopy                 /*logicOp*/,
-         gc.GetNumColorAttachments()        /*attachmentCount*/,
+         target.GetNumColorAttachments()        /*attachmentCount*/,
          colorBlendAttachmentStates.data()  /*pAttachments*/,
          {{0.0f}}                           /*blendConstants*/
       };
@@ -491,7 +531,7 @@ namespace Pikzel {
       // Multi sampling state
       vk::PipelineMultisampleStateCreateInfo multisampleState = {
          {}                                                              /*flags*/,
-         gc.GetNumSamples()                                              /*rasterizationSamples*/,
+         target.GetNumSamples()                                              /*rasterizationSamples*/,
          m_Device->GetEnabledPhysicalDeviceFeatures().sampleRateShading  /*sampleShadingEnable*/,
          1.0f                                                            /*minSampleShading*/,
          nullptr                                                         /*pSampleMask*/,
@@ -536,10 +576,10 @@ namespace Pikzel {
       pipelineCI.pStages = shaderStages.data();
 
       // .value works around issue in Vulkan.hpp (refer https://github.com/KhronosGroup/Vulkan-Hpp/issues/659)
-      m_PipelineFrontFaceCCW = m_Device->GetVkDevice().createGraphicsPipeline(gc.GetVkPipelineCache(), pipelineCI).value;
+      m_PipelineFrontFaceCCW = m_Device->GetVkDevice().createGraphicsPipeline(target.GetVkPipelineCache(), pipelineCI).value;
 
       rasterizationState.frontFace = vk::FrontFace::eClockwise;
-      m_PipelineFrontFaceCW = m_Device->GetVkDevice().createGraphicsPipeline(gc.GetVkPipelineCache(), pipelineCI).value;
+      m_PipelineFrontFaceCW = m_Device->GetVkDevice().createGraphicsPipeline(target.GetVkPipelineCache(), pipelineCI).value;
 
       // Shader modules are no longer needed once the graphics pipeline has been created
       for (auto& shaderStage : shaderStages) {
@@ -551,18 +591,16 @@ namespace Pikzel {
 
    void VulkanPipeline::DestroyPipeline() {
       if (m_Device) {
-         if (m_PipelineFrontFaceCCW) {
-            m_Device->GetVkDevice().destroy(m_PipelineFrontFaceCCW);
-            m_PipelineFrontFaceCCW = nullptr;
-         }
-         if (m_PipelineFrontFaceCW) {
-            m_Device->GetVkDevice().destroy(m_PipelineFrontFaceCW);
-            m_PipelineFrontFaceCW = nullptr;
-         }
-         if (m_PipelineCompute) {
-            m_Device->GetVkDevice().destroy(m_PipelineCompute);
-            m_PipelineCompute = nullptr;
-         }
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), pipelines = std::array{m_PipelineFrontFaceCCW, m_PipelineFrontFaceCW, m_PipelineCompute}] {
+            for (const auto pipeline : pipelines) {
+               if (pipeline) {
+                  device.destroy(pipeline);
+               }
+            }
+         });
+         m_PipelineFrontFaceCCW = nullptr;
+         m_PipelineFrontFaceCW = nullptr;
+         m_PipelineCompute = nullptr;
       }
    }
 
@@ -597,11 +635,14 @@ namespace Pikzel {
 
    void VulkanPipeline::DestroyDesciptorPool() {
       if (m_Device && m_DescriptorPool) {
-         m_Device->GetVkDevice().destroy(m_DescriptorPool);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), descriptorPool = m_DescriptorPool] {
+            device.destroy(descriptorPool);
+         });
       }
       m_DescriptorPool = nullptr;
       m_DescriptorSetInstances.clear();
       m_DescriptorSetFences.clear();
+      m_DescriptorSetFenceValues.clear();
       m_DescriptorSetIndices.clear();
       m_DescriptorSetPending.clear();
       m_DescriptorSetBound.clear();
@@ -618,6 +659,7 @@ namespace Pikzel {
       m_DescriptorSetInstances[set].emplace_back(m_Device->GetVkDevice().allocateDescriptorSets(allocInfo).front());
       m_DescriptorSetBound[set].emplace_back(false);
       m_DescriptorSetFences[set].emplace_back(nullptr);
+      m_DescriptorSetFenceValues[set].emplace_back(0);
       m_DescriptorSetIndices[set] = m_DescriptorSetInstances[set].size() - 1;
       m_DescriptorSetPending[set] = true;
       return m_DescriptorSetInstances[set].back();
@@ -633,7 +675,7 @@ namespace Pikzel {
       }
       uint32_t i = m_DescriptorSetIndices[set];
       do {
-         if (!m_DescriptorSetBound[set][i] && (!m_DescriptorSetFences[set][i] || (m_Device->GetVkDevice().getFenceStatus(m_DescriptorSetFences[set][i]->GetVkFence()) == vk::Result::eSuccess))) {
+         if (!m_DescriptorSetBound[set][i] && (!m_DescriptorSetFences[set][i] || m_DescriptorSetFences[set][i]->IsSignalled(m_DescriptorSetFenceValues[set][i]))) {
             m_DescriptorSetIndices[set] = i;
             m_DescriptorSetPending[set] = true;
             m_DescriptorSetFences[set][i] = nullptr;
@@ -652,6 +694,7 @@ namespace Pikzel {
          if (m_DescriptorSetPending[i]) {
             commandBuffer.bindDescriptorSets(m_PipelineBindPoint, GetVkPipelineLayout(), i, m_DescriptorSetInstances[i][m_DescriptorSetIndices[i]], nullptr);
             m_DescriptorSetFences[i][m_DescriptorSetIndices[i]] = fence;
+            m_DescriptorSetFenceValues[i][m_DescriptorSetIndices[i]] = fence->GetPendingValue();
             m_DescriptorSetPending[i] = false;
             m_DescriptorSetBound[i][m_DescriptorSetIndices[i]] = true;
          }
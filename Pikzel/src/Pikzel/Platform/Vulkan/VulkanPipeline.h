@@ -44,11 +44,14 @@ namespace Pikzel {
       // construct compute pipeline with settings
       VulkanPipeline(std::shared_ptr<VulkanDevice> device, const PipelineSettings& settings);
 
-      // construct graphics pipeline with context and settings
-      VulkanPipeline(std::shared_ptr<VulkanDevice> device, const VulkanGraphicsContext& gc, const PipelineSettings& settings);
+      // construct graphics pipeline for target (see VulkanGraphicsContext::GetPipelineTarget()) with settings
+      VulkanPipeline(std::shared_ptr<VulkanDevice> device, std::shared_ptr<VulkanPipelineTarget> target, const PipelineSettings& settings);
 
       virtual ~VulkanPipeline();
 
+      // Note: a graphics pipeline is rebuilt for the target that it was created with, which it keeps alive (the context need not still exist)
+      virtual void Reload() override;
+
    public:
 
       std::shared_ptr<VulkanDevice> GetDevice();
@@ -89,7 +92,7 @@ namespace Pikzel {
       void DestroyPipelineLayout();
 
       void CreateComputePipeline(const PipelineSettings& settings);
-      void CreateGraphicsPipeline(const VulkanGraphicsContext& gc, const PipelineSettings& settings);
+      void CreateGraphicsPipeline(const VulkanPipelineTarget& target, const PipelineSettings& settings);
       void DestroyPipeline();
 
       void CreateDescriptorPool();
@@ -99,6 +102,7 @@ namespace Pikzel {
 
    private:
       std::shared_ptr<VulkanDevice> m_Device;
+      std::shared_ptr<VulkanPipelineTarget> m_Target;  // null for compute pipelines
       std::vector<vk::DescriptorSetLayout> m_DescriptorSetLayouts;
       vk::PipelineBindPoint m_PipelineBindPoint;
       vk::PipelineLayout m_PipelineLayout;
@@ -110,6 +114,7 @@ namespace Pikzel {
       std::vector<std::vector<vk::DescriptorSet>> m_DescriptorSetInstances;         // m_DescriptorSets[i] = collection of descriptor sets that have been allocated for set i
       std::vector<std::vector<bool>> m_DescriptorSetBound;                          // m_DescriptorSetBound[i] = collection of booleans indicating which elements from m_DescriptorSets[i] are currently bound to the pipeline
       std::vector<std::vector<std::shared_ptr<VulkanFence>>> m_DescriptorSetFences; // m_DescriptorSetFences[i] = collection of fences synchronizing access to m_DescriptorSets for set i
+      std::vector<std::vector<uint64_t>> m_DescriptorSetFenceValues;                // m_DescriptorSetFenceValues[i] = the values those fences reach once the GPU has finished with m_DescriptorSets for set i
       std::vector<uint32_t> m_DescriptorSetIndices;                                 // m_DescriptorSetIndices[i] = which element (of m_DescriptorSets) is currently available for writing for set i
       std::vector<bool> m_DescriptorSetPending;                                     // m_DescriptorSetPending[i] = true <=> set i needs to be bound for next draw call
 
@@ -0,0 +1,147 @@
+#include "VulkanReadback.h"
+
+#include <algorithm>
+
+namespace Pikzel {
+
+   VulkanReadback::VulkanReadback(std::shared_ptr<VulkanDevice> device)
+   : m_Device {device}
+   {
+      m_CommandPool = m_Device->GetVkDevice().createCommandPool({
+         vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+         m_Device->GetGraphicsQueueFamilyIndex()
+      });
+      m_Fence = m_Device->CreateFence();
+   }
+
+
+   VulkanReadback::~VulkanReadback() {
+      // staging buffers destroy themselves once the GPU has finished with them.  The command buffers go with the pool
+      m_Slots.clear();
+      m_Device->DeferDestroy([device = m_Device->GetVkDevice(), commandPool = m_CommandPool, fence = std::move(m_Fence)] {
+         device.destroy(commandPool);
+      });
+   }
+
+
+   std::shared_ptr<ReadbackFuture> VulkanReadback::ReadbackAsync(const VulkanTexture& texture, const uint32_t mipLevel) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(mipLevel < texture.GetMIPLevels(), "RenderCore::ReadbackAsync() texture does not have requested mip level!");
+      const VulkanImage& image = texture.GetImage();
+      const uint32_t width = std::max(texture.GetWidth() >> mipLevel, 1u);
+      const uint32_t height = std::max(texture.GetHeight() >> mipLevel, 1u);
+      const uint32_t layers = image.GetLayers(); // nb: includes cubemap faces
+      const vk::DeviceSize size = static_cast<vk::DeviceSize>(width) * height * layers * Texture::BPP(texture.GetFormat());
+
+      auto slot = AcquireSlot(size);
+      vk::BufferImageCopy region = {
+         0                                    /*bufferOffset*/,
+         0                                    /*bufferRowLength*/,
+         0                                    /*bufferImageHeight*/,
+         vk::ImageSubresourceLayers {
+            vk::ImageAspectFlagBits::eColor      /*aspectMask*/,
+            mipLevel                             /*mipLevel*/,
+            0                                    /*baseArrayLayer*/,
+            layers                               /*layerCount*/
+         }                                    /*imageSubresource*/,
+         {0, 0, 0}                            /*imageOffset*/,
+         {width, height, 1}                   /*imageExtent*/
+      };
+
+      // Storage images that have not been Commit()'d are still in general layout.  Everything else is shader read-only by now.
+      const vk::ImageLayout layout = texture.GetVkImageLayout() == vk::ImageLayout::eGeneral ? vk::ImageLayout::eGeneral : vk::ImageLayout::eShaderReadOnlyOptimal;
+      vk::MemoryBarrier hostBarrier = {
+         vk::AccessFlagBits::eTransferWrite   /*srcAccessMask*/,
+         vk::AccessFlagBits::eHostRead        /*dstAccessMask*/
+      };
+
+      vk::CommandBuffer cmd = slot->CommandBuffer;
+      cmd.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+      cmd.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, image.Barrier(layout, vk::ImageLayout::eTransferSrcOptimal, mipLevel, 1, 0, layers));
+      cmd.copyImageToBuffer(image.GetVkImage(), vk::ImageLayout::eTransferSrcOptimal, slot->Buffer->m_Buffer, region);
+      cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr, image.Barrier(vk::ImageLayout::eTransferSrcOptimal, layout, mipLevel, 1, 0, layers));
+      cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, hostBarrier, nullptr, nullptr);
+      cmd.end();
+
+      return Submit(std::move(slot), size, texture.GetFormat(), width, height);
+   }
+
+
+   std::shared_ptr<ReadbackFuture> VulkanReadback::ReadbackAsync(vk::Buffer buffer, const uint64_t offset, const uint64_t size) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(size > 0, "RenderCore::ReadbackAsync() size is zero!");
+      auto slot = AcquireSlot(size);
+
+      vk::BufferCopy region = {
+         offset   /*srcOffset*/,
+         0        /*dstOffset*/,
+         size     /*size*/
+      };
+      vk::MemoryBarrier beforeCopyBarrier = {
+         vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite   /*srcAccessMask*/,
+         vk::AccessFlagBits::eTransferRead                                       /*dstAccessMask*/
+      };
+      vk::MemoryBarrier hostBarrier = {
+         vk::AccessFlagBits::eTransferWrite   /*srcAccessMask*/,
+         vk::AccessFlagBits::eHostRead        /*dstAccessMask*/
+      };
+
+      vk::CommandBuffer cmd = slot->CommandBuffer;
+      cmd.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+      cmd.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {}, beforeCopyBarrier, nullptr, nullptr);
+      cmd.copyBuffer(buffer, slot->Buffer->m_Buffer, region);
+      cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, hostBarrier, nullptr, nullptr);
+      cmd.end();
+
+      return Submit(std::move(slot), size);
+   }
+
+
+   std::shared_ptr<VulkanReadback::Slot> VulkanReadback::AcquireSlot(const vk::DeviceSize size) {
+      // the smallest free staging buffer that is big enough.  Failing that, any free slot (whose buffer is then replaced)
+      std::shared_ptr<Slot> found;
+      std::shared_ptr<Slot> free;
+      for (const auto& slot : m_Slots) {
+         if ((slot.use_count() == 1) && m_Fence->IsSignalled(slot->Value)) {
+            if ((slot->Buffer->m_Size >= size) && (!found || (slot->Buffer->m_Size < found->Buffer->m_Size))) {
+               found = slot;
+            }
+            free = slot;
+         }
+      }
+      if (found) {
+         return found;
+      }
+      if (!free) {
+         free = m_Slots.emplace_back(std::make_shared<Slot>());
+         free->CommandBuffer = m_Device->GetVkDevice().allocateCommandBuffers({
+            m_CommandPool                      /*commandPool*/,
+            vk::CommandBufferLevel::ePrimary   /*level*/,
+            1                                  /*commandBufferCount*/
+         }).front();
+      }
+      free->Buffer = std::make_unique<VulkanBuffer>(m_Device, size, vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuToCpu);
+      return free;
+   }
+
+
+   std::shared_ptr<ReadbackFuture> VulkanReadback::Submit(std::shared_ptr<Slot> slot, const vk::DeviceSize size, const TextureFormat format, const uint32_t width, const uint32_t height) {
+      // The copy goes after the graphics work that has been submitted.  Compute work (if it is on a queue of its own) is waited on
+      // explicitly, so that the copy sees whatever the last compute dispatch wrote.
+      slot->Value = m_Device->Submit(m_Device->GetGraphicsQueue(), slot->CommandBuffer, m_Fence, {}, {}, {}, {m_Device->GetLastComputeSubmission()});
+
+      // the callbacks hold on to the slot (so it is not reused) until the future has read it
+      return std::make_shared<ReadbackFuture>(
+         [fence = m_Fence, slot] { return fence->IsSignalled(slot->Value); },
+         [fence = m_Fence, slot] { fence->Wait(slot->Value); },
+         [slot, size] (std::vector<uint8_t>& data) {
+            data.resize(static_cast<size_t>(size));
+            slot->Buffer->CopyToHost(0, size, data.data());
+         },
+         format,
+         width,
+         height
+      );
+   }
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanTexture.h"
+
+#include "Pikzel/Renderer/Readback.h"
+
+#include <memory>
+#include <vector>
+
+namespace Pikzel {
+
+   // Copies textures and buffers into host visible staging buffers on the graphics queue, without waiting for the copy.
+   // Staging buffers are kept in a pool, and a buffer goes back into the pool once the ReadbackFuture that it was handed out with
+   // has read it (or been thrown away) and the GPU has finished copying into it.
+   class VulkanReadback final {
+   public:
+      VulkanReadback(std::shared_ptr<VulkanDevice> device);
+      PKZL_NO_COPYMOVE(VulkanReadback);
+      ~VulkanReadback();
+
+      std::shared_ptr<ReadbackFuture> ReadbackAsync(const VulkanTexture& texture, const uint32_t mipLevel);
+      std::shared_ptr<ReadbackFuture> ReadbackAsync(vk::Buffer buffer, const uint64_t offset, const uint64_t size);
+
+   private:
+      struct Slot {
+         std::unique_ptr<VulkanBuffer> Buffer;
+         vk::CommandBuffer CommandBuffer;
+         uint64_t Value = 0;              // fence value signalled when the copy into Buffer has finished
+      };
+
+      // A slot that is not in use, with a staging buffer of at least size bytes.  Its command buffer is ready to record
+      std::shared_ptr<Slot> AcquireSlot(const vk::DeviceSize size);
+
+      // Submit the slot's (recorded) command buffer, and wrap it in a future that reads size bytes from its staging buffer
+      std::shared_ptr<ReadbackFuture> Submit(std::shared_ptr<Slot> slot, const vk::DeviceSize size, const TextureFormat format = TextureFormat::Undefined, const uint32_t width = 0, const uint32_t height = 0);
+
+   private:
+      std::shared_ptr<VulkanDevice> m_Device;
+      vk::CommandPool m_CommandPool;
+      std::shared_ptr<VulkanFence> m_Fence;
+      std::vector<std::shared_ptr<Slot>> m_Slots;  // a slot is in use while a future still refers to it
+   };
+
+}
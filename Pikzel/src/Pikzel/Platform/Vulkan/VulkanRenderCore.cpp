@@ -59,14 +59,17 @@ namespace Pikzel {
       if (glfwCreateWindowSurface(m_Instance, static_cast<GLFWwindow*>(window.GetNativeWindow()), nullptr, &surface) != VK_SUCCESS) {
          throw std::runtime_error {"failed to create window surface!"};
       }
-      m_Device = std::make_shared<VulkanDevice>(m_Instance, surface);
+      m_Device = std::make_shared<VulkanDevice>(m_Instance, surface, window.GetFramesInFlight());
       m_Instance.destroy(surface);
 
-      VulkanMemoryAllocator::Init(m_Instance, m_Device->GetVkPhysicalDevice(), m_Device->GetVkDevice());
+      VulkanMemoryAllocator::Init(m_Instance, m_Device->GetVkPhysicalDevice(), m_Device->GetVkDevice(), m_Device->IsMemoryBudgetSupported());
+      m_Readback = std::make_unique<VulkanReadback>(m_Device);
    }
 
 
    VulkanRenderCore::~VulkanRenderCore() {
+      m_Readback = nullptr;
+      m_Device->FlushDeferred();   // buffers and images waiting to be destroyed need the allocator
       VulkanMemoryAllocator::Get().destroy();
       m_Device = nullptr;
       DestroyInstance();
@@ -113,6 +116,11 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<IndexBuffer> VulkanRenderCore::CreateIndexBuffer(const uint32_t count, const uint16_t* indices) {
+      return std::make_unique<VulkanIndexBuffer>(m_Device, count, indices);
+   }
+
+
    std::unique_ptr<UniformBuffer> VulkanRenderCore::CreateUniformBuffer(const uint32_t size) {
       return std::make_unique<VulkanUniformBuffer>(m_Device, size);
    }
@@ -123,6 +131,16 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<StorageBuffer> VulkanRenderCore::CreateStorageBuffer(const uint32_t size) {
+      return std::make_unique<VulkanStorageBuffer>(m_Device, size);
+   }
+
+
+   std::unique_ptr<StorageBuffer> VulkanRenderCore::CreateStorageBuffer(const uint32_t size, const void* data) {
+      return std::make_unique<VulkanStorageBuffer>(m_Device, size, data);
+   }
+
+
    std::unique_ptr<Framebuffer> VulkanRenderCore::CreateFramebuffer(const FramebufferSettings& settings) {
       return std::make_unique<VulkanFramebuffer>(m_Device, settings);
    }
@@ -150,6 +168,33 @@ namespace Pikzel {
    }
 
 
+   MemoryBudget VulkanRenderCore::GetMemoryBudget() const {
+      // Sum over device local heaps only.  Host memory is not what the budget is for.
+      VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+      vmaGetBudget(static_cast<VmaAllocator>(VulkanMemoryAllocator::Get()), budgets);
+
+      MemoryBudget budget;
+      const vk::PhysicalDeviceMemoryProperties properties = m_Device->GetVkPhysicalDevice().getMemoryProperties();
+      for (uint32_t i = 0; i < properties.memoryHeapCount; ++i) {
+         if (properties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal) {
+            budget.Budget += budgets[i].budget;
+            budget.Usage += budgets[i].usage;
+         }
+      }
+      return budget;
+   }
+
+
+   std::shared_ptr<ReadbackFuture> VulkanRenderCore::ReadbackAsync(const Texture& texture, const uint32_t mipLevel) {
+      return m_Readback->ReadbackAsync(static_cast<const VulkanTexture&>(texture), mipLevel);
+   }
+
+
+   std::shared_ptr<ReadbackFuture> VulkanRenderCore::ReadbackAsync(const StorageBuffer& buffer, const uint64_t offset, const uint64_t size) {
+      return m_Readback->ReadbackAsync(static_cast<const VulkanStorageBuffer&>(buffer).GetVkBuffer(), offset, size);
+   }
+
+
    std::vector<const char*> VulkanRenderCore::GetRequiredInstanceExtensions() {
       std::vector<const char*> extensions;
       uint32_t glfwExtensionCount = 0;
@@ -2,6 +2,7 @@
 
 #include "Pikzel/Renderer/RenderCore.h"
 #include "VulkanDevice.h"
+#include "VulkanReadback.h"
 
 namespace Pikzel {
 
@@ -21,14 +22,23 @@ namespace Pikzel {
       virtual std::unique_ptr<VertexBuffer> CreateVertexBuffer(const BufferLayout& layout, const uint32_t size,const void* data) override;
 
       virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint32_t* indices) override;
+      virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint16_t* indices) override;
 
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size) override;
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size, const void* data) override;
 
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size) override;
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size, const void* data) override;
+
       virtual std::unique_ptr<Framebuffer> CreateFramebuffer(const FramebufferSettings& settings) override;
 
       virtual std::unique_ptr<Texture> CreateTexture(const TextureSettings& settings) override;
 
+      virtual MemoryBudget GetMemoryBudget() const override;
+
+      virtual std::shared_ptr<ReadbackFuture> ReadbackAsync(const Texture& texture, const uint32_t mipLevel) override;
+      virtual std::shared_ptr<ReadbackFuture> ReadbackAsync(const StorageBuffer& buffer, const uint64_t offset, const uint64_t size) override;
+
    private:
       std::vector<const char*> GetRequiredInstanceExtensions();
 
@@ -41,6 +51,7 @@ namespace Pikzel {
       vk::DebugUtilsMessengerEXT m_DebugUtilsMessengerEXT;
 
       std::shared_ptr<VulkanDevice> m_Device;
+      std::unique_ptr<VulkanReadback> m_Readback;
 
    };
 
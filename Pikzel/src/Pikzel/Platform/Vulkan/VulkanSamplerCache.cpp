@@ -0,0 +1,53 @@
+#include "VulkanSamplerCache.h"
+
+namespace Pikzel {
+
+   VulkanSamplerCache::VulkanSamplerCache(vk::Device device)
+   : m_Device {device}
+   {
+      PKZL_CORE_ASSERT(device, "null device");
+   }
+
+
+   VulkanSamplerCache::~VulkanSamplerCache() {
+      for (const auto& [key, sampler] : m_Samplers) {
+         m_Device.destroy(sampler);
+      }
+   }
+
+
+   vk::Sampler VulkanSamplerCache::GetSampler(const vk::SamplerCreateInfo& createInfo) {
+      PKZL_CORE_ASSERT(!createInfo.pNext, "VulkanSamplerCache::GetSampler() does not support pNext chains!");
+      const Key key {
+         createInfo.magFilter,
+         createInfo.minFilter,
+         createInfo.mipmapMode,
+         createInfo.addressModeU,
+         createInfo.addressModeV,
+         createInfo.addressModeW,
+         createInfo.mipLodBias,
+         createInfo.anisotropyEnable,
+         createInfo.anisotropyEnable ? createInfo.maxAnisotropy : 0.0f,
+         createInfo.compareEnable,
+         createInfo.compareEnable ? createInfo.compareOp : vk::CompareOp::eNever,
+         createInfo.minLod,
+         createInfo.maxLod,
+         createInfo.borderColor,
+         createInfo.unnormalizedCoordinates
+      };
+
+      std::lock_guard lock {m_Mutex};
+      auto sampler = m_Samplers.find(key);
+      if (sampler == m_Samplers.end()) {
+         sampler = m_Samplers.emplace(key, m_Device.createSampler(createInfo)).first;
+      }
+      return sampler->second;
+   }
+
+
+   size_t VulkanSamplerCache::GetSamplerCount() const {
+      std::lock_guard lock {m_Mutex};
+      return m_Samplers.size();
+   }
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+#include <vulkan/vulkan.hpp>
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace Pikzel {
+
+   // Samplers shared by all textures.
+   // Almost all textures use one of a handful of filter/wrap combinations, so there is no need for each texture to have its own
+   // sampler (and drivers limit how many samplers there can be).
+   // Samplers are owned by the cache, and destroyed along with it.  Do not destroy the samplers returned by GetSampler()
+   class VulkanSamplerCache final {
+   public:
+      VulkanSamplerCache(vk::Device device);
+      ~VulkanSamplerCache();
+
+      PKZL_NO_COPYMOVE(VulkanSamplerCache);
+
+      // Returns a sampler created from createInfo, or an existing sampler that was created from the same values.
+      // createInfo must not have a pNext chain (it is not part of the lookup)
+      vk::Sampler GetSampler(const vk::SamplerCreateInfo& createInfo);
+
+      size_t GetSamplerCount() const;
+
+   private:
+      using Key = std::tuple<
+         vk::Filter,              // magFilter
+         vk::Filter,              // minFilter
+         vk::SamplerMipmapMode,   // mipmapMode
+         vk::SamplerAddressMode,  // addressModeU
+         vk::SamplerAddressMode,  // addressModeV
+         vk::SamplerAddressMode,  // addressModeW
+         float,                   // mipLodBias
+         vk::Bool32,              // anisotropyEnable
+         float,                   // maxAnisotropy
+         vk::Bool32,              // compareEnable
+         vk::CompareOp,           // compareOp
+         float,                   // minLod
+         float,                   // maxLod
+         vk::BorderColor,         // borderColor
+         vk::Bool32               // unnormalizedCoordinates
+      >;
+
+      vk::Device m_Device;
+      std::map<Key, vk::Sampler> m_Samplers;
+      mutable std::mutex m_Mutex;
+   };
+
+}
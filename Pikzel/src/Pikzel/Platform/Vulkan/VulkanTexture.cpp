@@ -30,7 +30,8 @@ namespace Pikzel {
          case vk::Format::eR32G32Sfloat:          return TextureFormat::RG32F;
          case vk::Format::eR32G32B32Sfloat:       return TextureFormat::RGB32F;
          case vk::Format::eR32G32B32A32Sfloat:    return TextureFormat::RGBA32F;
-         case vk::Format::eB10G11R11UfloatPack32: return TextureFormat::BGR8;
+         case vk::Format::eR16G16Snorm:           return TextureFormat::RG16S;
+         case vk::Format::eB10G11R11UfloatPack32: return TextureFormat::R11G11B10F;
          case vk::Format::eB8G8R8A8Srgb:          return TextureFormat::BGRA8;
          case vk::Format::eR8Unorm:               return TextureFormat::R8;
          case vk::Format::eR32Sfloat:             return TextureFormat::R32F;
@@ -65,6 +66,8 @@ namespace Pikzel {
          case TextureFormat::RG32F:       return vk::Format::eR32G32Sfloat;
          case TextureFormat::RGB32F:      return vk::Format::eR32G32B32Sfloat;
          case TextureFormat::RGBA32F:     return vk::Format::eR32G32B32A32Sfloat;
+         case TextureFormat::R11G11B10F:  return vk::Format::eB10G11R11UfloatPack32;
+         case TextureFormat::RG16S:       return vk::Format::eR16G16Snorm;
          case TextureFormat::BGR8:        return vk::Format::eB10G11R11UfloatPack32; // the texels must still be 32-bits, so if no alpha channel then use more bits in other channels
          case TextureFormat::BGRA8:       return vk::Format::eB8G8R8A8Srgb;
          case TextureFormat::R8:          return vk::Format::eR8Unorm;
@@ -275,13 +278,102 @@ namespace Pikzel {
             m_Image->Barrier(vk::ImageLayout::eGeneral, vk::ImageLayout::eTransferDstOptimal, 0, 0, 0, 0)
          );
          m_Image->GenerateMipmap(baseMipLevel);
-      } else {
+      } else if (m_Layout != vk::ImageLayout::eShaderReadOnlyOptimal) {
          m_Device->PipelineBarrier(
             vk::PipelineStageFlagBits::eAllCommands,
             vk::PipelineStageFlagBits::eFragmentShader,
             m_Image->Barrier(vk::ImageLayout::eGeneral, vk::ImageLayout::eShaderReadOnlyOptimal, 0, 0, 0, 0)
          );
       }
+      m_Layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+   }
+
+
+   void VulkanTexture::SetMIPData(const uint32_t mipLevel, const void* data, const uint32_t size) {
+      PKZL_CORE_ASSERT(GetType() == TextureType::Texture2D, "VulkanTexture::SetMIPData() is only supported for 2D textures!");
+      PKZL_CORE_ASSERT(mipLevel < GetMIPLevels(), "VulkanTexture::SetMIPData() texture does not have requested mip level!");
+      PKZL_CORE_ASSERT(size == std::max(GetWidth() >> mipLevel, 1u) * std::max(GetHeight() >> mipLevel, 1u) * BPP(GetFormat()), "Data must be entire mip level!");
+      PKZL_CORE_ASSERT((m_Layout == vk::ImageLayout::eUndefined) || (m_Layout == vk::ImageLayout::eShaderReadOnlyOptimal), "VulkanTexture::SetMIPData() is not supported for storage images!");
+
+      VulkanBuffer stagingBuffer(m_Device, size, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu);
+      stagingBuffer.CopyFromHost(0, size, data);
+
+      const uint32_t width = std::max(GetWidth() >> mipLevel, 1u);
+      const uint32_t height = std::max(GetHeight() >> mipLevel, 1u);
+      vk::BufferImageCopy region = {
+         0                                    /*bufferOffset*/,
+         0                                    /*bufferRowLength*/,
+         0                                    /*bufferImageHeight*/,
+         vk::ImageSubresourceLayers {
+            vk::ImageAspectFlagBits::eColor      /*aspectMask*/,
+            mipLevel                             /*mipLevel*/,
+            0                                    /*baseArrayLayer*/,
+            1                                    /*layerCount*/
+         }                                    /*imageSubresource*/,
+         {0, 0, 0}                            /*imageOffset*/,
+         {width, height, 1}                   /*imageExtent*/
+      };
+
+      // This is called for mip levels as they stream in, so it does not wait for the copy to finish.  The copy goes on the graphics
+      // queue, and the barriers below order it before the draws of frames submitted after it.
+      // (the staging buffer can go straight away, its destruction is deferred until the GPU has finished with it)
+      const bool isFirst = m_Layout == vk::ImageLayout::eUndefined;
+      m_Device->SubmitAsyncCommands([this, isFirst, mipLevel, buffer = stagingBuffer.m_Buffer, &region] (vk::CommandBuffer cmd) {
+         // The first time, put the whole image into shader read-only layout, so that it can be sampled (at whichever mip levels
+         // have been set) while the other levels are still to come.
+         if (isFirst) {
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr, m_Image->Barrier(vk::ImageLayout::eUndefined, vk::ImageLayout::eShaderReadOnlyOptimal, 0, 0, 0, 0));
+         }
+
+         // The level's previous contents are not needed (and are not being sampled, the texture's minimum mip level excludes it)
+         cmd.pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, m_Image->Barrier(vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, mipLevel, 1, 0, 0));
+         cmd.copyBufferToImage(buffer, m_Image->GetVkImage(), vk::ImageLayout::eTransferDstOptimal, region);
+         cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr, m_Image->Barrier(vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, mipLevel, 1, 0, 0));
+      });
+      m_Layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+   }
+
+
+   void VulkanTexture::SetMinMIPLevel(const uint32_t mipLevel) {
+      PKZL_CORE_ASSERT(mipLevel < GetMIPLevels(), "VulkanTexture::SetMinMIPLevel() texture does not have requested mip level!");
+      vk::SamplerCreateInfo samplerCreateInfo = m_SamplerCreateInfo;
+      samplerCreateInfo.minLod = static_cast<float>(mipLevel);
+      m_TextureSampler = m_Device->GetSamplerCache().GetSampler(samplerCreateInfo);
+      m_MinMIPLevel = mipLevel;
+   }
+
+
+   uint32_t VulkanTexture::GetMinMIPLevel() const {
+      return m_MinMIPLevel;
+   }
+
+
+   std::vector<uint8_t> VulkanTexture::GetData(const uint32_t mipLevel) const {
+      PKZL_CORE_ASSERT(mipLevel < GetMIPLevels(), "VulkanTexture::GetData() texture does not have requested mip level!");
+      const uint32_t width = std::max(GetWidth() >> mipLevel, 1u);
+      const uint32_t height = std::max(GetHeight() >> mipLevel, 1u);
+      const uint32_t layers = m_Image->GetLayers(); // nb: includes cubemap faces
+      std::vector<uint8_t> data(static_cast<size_t>(width) * height * layers * BPP(GetFormat()));
+
+      VulkanBuffer stagingBuffer(m_Device, data.size(), vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuToCpu);
+      vk::BufferImageCopy region = {
+         0                                    /*bufferOffset*/,
+         0                                    /*bufferRowLength*/,
+         0                                    /*bufferImageHeight*/,
+         vk::ImageSubresourceLayers {
+            vk::ImageAspectFlagBits::eColor      /*aspectMask*/,
+            mipLevel                             /*mipLevel*/,
+            0                                    /*baseArrayLayer*/,
+            layers                               /*layerCount*/
+         }                                    /*imageSubresource*/,
+         {0, 0, 0}                            /*imageOffset*/,
+         {width, height, 1}                   /*imageExtent*/
+      };
+
+      // Storage images that have not been Commit()'d are still in general layout.  Everything else is shader read-only by now.
+      m_Image->CopyToBuffer(stagingBuffer.m_Buffer, region, m_Layout == vk::ImageLayout::eGeneral ? vk::ImageLayout::eGeneral : vk::ImageLayout::eShaderReadOnlyOptimal);
+      stagingBuffer.CopyToHost(0, data.size(), data.data());
+      return data;
    }
 
 
@@ -366,6 +458,16 @@ namespace Pikzel {
    }
 
 
+   vk::ImageLayout VulkanTexture::GetVkImageLayout() const {
+      return m_Layout;
+   }
+
+
+   void VulkanTexture::SetVkImageLayout(const vk::ImageLayout layout) {
+      m_Layout = layout;
+   }
+
+
    vk::ImageView VulkanTexture::GetVkImageView() const {
       return m_Image->GetVkImageView();
    }
@@ -391,8 +493,8 @@ namespace Pikzel {
       VulkanBuffer stagingBuffer(m_Device, size, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu);
       stagingBuffer.CopyFromHost(0, size, data);
 
-      uint32_t width = GetWidth() >> mipLevel;
-      uint32_t height = GetHeight() >> mipLevel;
+      uint32_t width = std::max(GetWidth() >> mipLevel, 1u);
+      uint32_t height = std::max(GetHeight() >> mipLevel, 1u);
       uint32_t depth = 1;
 
       uint32_t layerInternal = layer;
@@ -446,6 +548,7 @@ namespace Pikzel {
             vk::PipelineStageFlagBits::eAllCommands,
             m_Image->Barrier(vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, 0, 0, 0, 0)
          );
+         m_Layout = vk::ImageLayout::eGeneral;
       }
 
    }
@@ -480,7 +583,9 @@ namespace Pikzel {
          wrapW = IsDepthFormat(GetFormat()) ? TextureWrap::ClampToEdge : TextureWrap::Repeat;
       }
 
-      m_TextureSampler = m_Device->GetVkDevice().createSampler({
+      // maxLod is not clamped to this texture's mip levels (the image view does that anyway), so that textures with different
+      // numbers of mip levels can share a sampler
+      m_SamplerCreateInfo = vk::SamplerCreateInfo {
          {}                                                              /*flags*/,
          TextureFilterToVkFilter(magFilter)                              /*magFilter*/,
          TextureFilterToVkFilter(minFilter)                              /*minFilter*/,
@@ -494,18 +599,18 @@ namespace Pikzel {
          false                                                           /*compareEnable*/,
          vk::CompareOp::eNever                                           /*compareOp*/,
          0.0f                                                            /*minLod*/,
-         static_cast<float>(m_Image->GetMIPLevels())                     /*maxLod*/,
+         VK_LOD_CLAMP_NONE                                               /*maxLod*/,
          vk::BorderColor::eFloatOpaqueBlack                              /*borderColor*/,
          false                                                           /*unnormalizedCoordinates*/
-      });
+      };
+      m_TextureSampler = m_Device->GetSamplerCache().GetSampler(m_SamplerCreateInfo);
    }
 
 
    void VulkanTexture::DestroySampler() {
-      if (m_Device && m_TextureSampler) {
-         m_Device->GetVkDevice().destroy(m_TextureSampler);
-         m_TextureSampler = nullptr;
-      }
+      // sampler itself belongs to the sampler cache
+      m_TextureSampler = nullptr;
+      m_MinMIPLevel = 0;
    }
 
 
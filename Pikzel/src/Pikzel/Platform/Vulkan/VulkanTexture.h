@@ -5,6 +5,7 @@
 #include "VulkanImage.h"
 
 #include <filesystem>
+#include <vector>
 
 namespace Pikzel {
 
@@ -28,6 +29,13 @@ namespace Pikzel {
 
       virtual void Commit(const uint32_t generateMipmapAfterLevel) override;
 
+      virtual std::vector<uint8_t> GetData(const uint32_t mipLevel) const override;
+
+      virtual void SetMIPData(const uint32_t mipLevel, const void* data, const uint32_t size) override;
+
+      virtual void SetMinMIPLevel(const uint32_t mipLevel) override;
+      virtual uint32_t GetMinMIPLevel() const override;
+
       virtual bool operator==(const Texture& that) override;
 
       void CopyFrom(const Texture& srcTexture, const TextureCopySettings& settings = {}) override;
@@ -41,6 +49,12 @@ namespace Pikzel {
 
       const VulkanImage& GetImage() const;
 
+      // Storage images are in general layout while they are written by compute shaders, and shader read-only layout after
+      // they have been Commit()'d.  The compute context uses this to transition the image back to general layout if it is
+      // written again after being committed.
+      vk::ImageLayout GetVkImageLayout() const;
+      void SetVkImageLayout(const vk::ImageLayout layout);
+
    protected:
       void Init(std::shared_ptr<VulkanDevice> device, const TextureSettings& settings, vk::ImageUsageFlags usage, vk::ImageAspectFlags aspect);
 
@@ -59,8 +73,11 @@ namespace Pikzel {
       std::filesystem::path m_Path;
       std::shared_ptr<VulkanDevice> m_Device;
       std::unique_ptr<VulkanImage> m_Image;
-      vk::Sampler m_TextureSampler;
+      vk::Sampler m_TextureSampler;                   // owned by the device's sampler cache
+      vk::SamplerCreateInfo m_SamplerCreateInfo;
+      uint32_t m_MinMIPLevel = 0;
       TextureFormat m_DataFormat; // this is used temporarily while uploading cubemap textures to GPU
+      vk::ImageLayout m_Layout = vk::ImageLayout::eUndefined; // only tracked for storage images, and textures set via SetMIPData().  See GetVkImageLayout()
    };
 
 
@@ -73,32 +73,40 @@ namespace Pikzel {
    QueueFamilyIndices FindQueueFamilies(vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface) {
       QueueFamilyIndices indices;
 
+      // Compute prefers a family of its own (one without graphics), so that compute work can run at the same time as graphics work.
+      // Failing that, it shares the graphics family.
+      // Transfers (uploads, layout transitions, mipmap generation) share the graphics family, as they are followed by graphics work
+      // (and mipmaps are generated with blits, which need a graphics queue).
+      std::optional<uint32_t> dedicatedComputeFamily;
+
       std::vector<vk::QueueFamilyProperties> queueFamilies = physicalDevice.getQueueFamilyProperties();
-      int i = 0;
+      uint32_t i = 0;
       for (const auto& queueFamily : queueFamilies) {
-         if (queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) {
+         if ((queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) && !indices.GraphicsFamily.has_value()) {
             indices.GraphicsFamily = i;
          }
 
-         if (surface) {
+         if (surface && !indices.PresentFamily.has_value()) {
             if (physicalDevice.getSurfaceSupportKHR(i, surface)) {
                indices.PresentFamily = i;
             }
          }
 
-         if (queueFamily.queueFlags & vk::QueueFlagBits::eCompute) {
-            indices.ComputeFamily = i;
+         if ((queueFamily.queueFlags & vk::QueueFlagBits::eCompute) && !(queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) && !dedicatedComputeFamily.has_value()) {
+            dedicatedComputeFamily = i;
          }
 
-         if (queueFamily.queueFlags & vk::QueueFlagBits::eTransfer) {
-            indices.TransferFamily = i;
-         }
+         ++i;
+      }
 
-         if (indices.GraphicsFamily.has_value() && indices.PresentFamily.has_value() && indices.ComputeFamily.has_value() && indices.TransferFamily.has_value()) {
-            break;
+      if (indices.GraphicsFamily.has_value()) {
+         if (queueFamilies[indices.GraphicsFamily.value()].queueFlags & vk::QueueFlagBits::eCompute) {
+            indices.ComputeFamily = indices.GraphicsFamily;
          }
-
-         ++i;
+         indices.TransferFamily = indices.GraphicsFamily;
+      }
+      if (dedicatedComputeFamily.has_value()) {
+         indices.ComputeFamily = dedicatedComputeFamily;
       }
 
       return indices;
@@ -0,0 +1,107 @@
+#include "Bloom.h"
+#include "RenderCore.h"
+
+#include <algorithm>
+
+namespace Pikzel {
+
+   Bloom::Bloom(const uint32_t width, const uint32_t height) {
+      m_ComputeContext = RenderCore::CreateComputeContext();
+      m_PipelineDownsample = m_ComputeContext->CreatePipeline({
+         .shaders = {
+            { Pikzel::ShaderType::Compute, "Renderer/BloomDownsample.comp.spv"}
+         }
+      });
+      m_PipelineUpsample = m_ComputeContext->CreatePipeline({
+         .shaders = {
+            { Pikzel::ShaderType::Compute, "Renderer/BloomUpsample.comp.spv"}
+         }
+      });
+      CreateTextures(width, height);
+   }
+
+
+   void Bloom::Resize(const uint32_t width, const uint32_t height) {
+      CreateTextures(width, height);
+   }
+
+
+   void Bloom::Apply(const Texture& input, const BloomSettings& settings) {
+      PKZL_PROFILE_FUNCTION();
+      const uint32_t numLevels = GetNumLevels();
+      const auto dispatch = [this](const uint32_t level) {
+         const uint32_t width = std::max(m_Downsample->GetWidth() >> level, 1u);
+         const uint32_t height = std::max(m_Downsample->GetHeight() >> level, 1u);
+         m_ComputeContext->Dispatch((width + 7) / 8, (height + 7) / 8, 1);
+      };
+
+      m_ComputeContext->Begin();
+
+      // Downsample: input => level 0 => level 1 => ... => level N - 1
+      m_ComputeContext->Bind(*m_PipelineDownsample);
+      for (uint32_t level = 0; level < numLevels; ++level) {
+         m_ComputeContext->PushConstant("constants.threshold"_hs, settings.threshold);
+         m_ComputeContext->PushConstant("constants.knee"_hs, settings.knee);
+         m_ComputeContext->PushConstant("constants.prefilter"_hs, level == 0 ? 1u : 0u);
+         if (level == 0) {
+            m_ComputeContext->Bind("inputTexture"_hs, input);
+         } else {
+            m_ComputeContext->Bind("inputTexture"_hs, *m_Downsample, level - 1);
+         }
+         m_ComputeContext->Bind("outputTexture"_hs, *m_Downsample, level);
+         dispatch(level);
+      }
+
+      // Upsample: level N - 1 => level N - 2 => ... => level 0, adding in the downsample chain at each level.
+      // The smallest level of the upsample chain would be the same as the downsample chain, so it is skipped and the first
+      // upsample reads directly from the downsample chain instead.
+      m_ComputeContext->Bind(*m_PipelineUpsample);
+      for (uint32_t level = numLevels - 1; level-- > 0;) {
+         m_ComputeContext->PushConstant("constants.radius"_hs, settings.radius);
+         m_ComputeContext->PushConstant("constants.weight"_hs, level == 0 ? settings.intensity / static_cast<float>(numLevels) : 1.0f);
+         m_ComputeContext->Bind("inputLow"_hs, level == numLevels - 2 ? *m_Downsample : *m_Upsample, level + 1);
+         m_ComputeContext->Bind("inputHigh"_hs, *m_Downsample, level);
+         m_ComputeContext->Bind("outputTexture"_hs, *m_Upsample, level);
+         dispatch(level);
+      }
+
+      m_ComputeContext->End();
+      m_Upsample->Commit(m_Upsample->GetMIPLevels());
+   }
+
+
+   const Texture& Bloom::GetTexture() const {
+      return *m_Upsample;
+   }
+
+
+   ComputeContext& Bloom::GetComputeContext() {
+      return *m_ComputeContext;
+   }
+
+
+   uint32_t Bloom::GetNumLevels() const {
+      return m_Downsample->GetMIPLevels();
+   }
+
+
+   void Bloom::CreateTextures(const uint32_t width, const uint32_t height) {
+      const uint32_t levelWidth = std::max(width / 2, 2u);
+      const uint32_t levelHeight = std::max(height / 2, 2u);
+      const TextureSettings settings = {
+         .width = levelWidth,
+         .height = levelHeight,
+         .format = TextureFormat::RGBA16F,
+         .minFilter = TextureFilter::Linear,
+         .magFilter = TextureFilter::Linear,
+         .wrapU = TextureWrap::ClampToEdge,
+         .wrapV = TextureWrap::ClampToEdge,
+         .wrapW = TextureWrap::ClampToEdge,
+         .mipLevels = std::clamp(Texture::CalculateMipmapLevels(levelWidth, levelHeight), 2u, MaxLevels),
+         .imageStorage = true
+      };
+      m_Downsample = RenderCore::CreateTexture(settings);
+      m_Upsample = RenderCore::CreateTexture(settings);
+   }
+
+}
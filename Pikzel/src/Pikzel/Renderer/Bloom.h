@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ComputeContext.h"
+#include "Pipeline.h"
+#include "Texture.h"
+
+#include <memory>
+
+namespace Pikzel {
+
+   struct PKZL_API BloomSettings {
+      float threshold = 1.0f;  // brightness (max of r, g, b) below which pixels do not bloom
+      float knee = 0.5f;       // width of the soft transition either side of threshold
+      float intensity = 1.0f;  // scale applied to the result
+      float radius = 1.0f;     // upsample filter radius (in texels of each level).  Larger spreads the bloom more
+   };
+
+
+   // Bloom post-processing effect, computed with compute shaders on a mip chain.
+   //
+   // The input (HDR color) is progressively downsampled to a chain of mip levels starting at half resolution, with a 13-tap filter.
+   // The chain is then progressively upsampled with a tent filter, each level being added to the one above.
+   // Each level blurs twice as far as the last, for a quarter of the cost, so the total cost is proportional to the number
+   // of pixels in the input (and the number of levels is log of the resolution), and does not depend on blur radius.
+   //
+   // See Renderer/Shaders/BloomDownsample.comp and Renderer/Shaders/BloomUpsample.comp
+   class PKZL_API Bloom {
+   public:
+      static const uint32_t MaxLevels = 8;
+
+      // width and height are the size of the input
+      Bloom(const uint32_t width, const uint32_t height);
+
+      PKZL_NO_COPY(Bloom);
+
+      void Resize(const uint32_t width, const uint32_t height);
+
+      // Compute bloom for input.  input must be the size that this Bloom was constructed (or resized) with.
+      void Apply(const Texture& input, const BloomSettings& settings = {});
+
+      // The result of the most recent Apply() (at half the input resolution).  Add this to the HDR color before tone mapping.
+      const Texture& GetTexture() const;
+
+      // The context that Apply() computes with.  Before Apply(), have it wait for the graphics work that draws the input (and that
+      // reads the previous result).  Graphics work that reads the result should wait for it (see ComputeContext::WaitFor() and
+      // GraphicsContext::WaitFor())
+      ComputeContext& GetComputeContext();
+
+      uint32_t GetNumLevels() const;
+
+   private:
+      void CreateTextures(const uint32_t width, const uint32_t height);
+
+   private:
+      std::unique_ptr<ComputeContext> m_ComputeContext;
+      std::unique_ptr<Pipeline> m_PipelineDownsample;
+      std::unique_ptr<Pipeline> m_PipelineUpsample;
+      std::unique_ptr<Texture> m_Downsample;  // the downsample chain.  Level 0 is half the input resolution
+      std::unique_ptr<Texture> m_Upsample;    // the upsample chain.  Same size as m_Downsample, and level 0 is the result
+   };
+
+}
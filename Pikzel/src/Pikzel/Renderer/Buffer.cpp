@@ -25,6 +25,9 @@ namespace Pikzel {
          case DataType::DVec2:    return "DVec2";
          case DataType::DVec3:    return "DVec3";
          case DataType::DVec4:    return "DVec4";
+         case DataType::UNorm16Vec4: return "UNorm16Vec4";
+         case DataType::SNorm16Vec2: return "SNorm16Vec2";
+         case DataType::HVec2:    return "HVec2";
          case DataType::Mat2:     return "Mat2";
          case DataType::Mat2x3:   return "Mat2x3";
          case DataType::Mat2x4:   return "Mat2x4";
@@ -71,6 +74,9 @@ namespace Pikzel {
          case DataType::DVec2:    return 8 * 2;
          case DataType::DVec3:    return 8 * 3;
          case DataType::DVec4:    return 8 * 4;
+         case DataType::UNorm16Vec4: return 2 * 4;
+         case DataType::SNorm16Vec2: return 2 * 2;
+         case DataType::HVec2:    return 2 * 2;
          case DataType::Mat2:     return 4 * 2 * 2;
          case DataType::Mat2x3:   return 4 * 2 * 3;
          case DataType::Mat2x4:   return 4 * 2 * 4;
@@ -99,6 +105,8 @@ namespace Pikzel {
    : name {name}
    , dataType {type}
    , size {DataTypeSize(type)}
+   , offset {0}
+   , normalized {(type == DataType::UNorm16Vec4) || (type == DataType::SNorm16Vec2)}
    {}
 
 
@@ -124,6 +132,9 @@ namespace Pikzel {
          case DataType::DVec2:    return 2;
          case DataType::DVec3:    return 3;
          case DataType::DVec4:    return 4;
+         case DataType::UNorm16Vec4: return 4;
+         case DataType::SNorm16Vec2: return 2;
+         case DataType::HVec2:    return 2;
          case DataType::Mat2:     return 2; // 2 * vec2,
          case DataType::Mat2x3:   return 2; // 2 * vec3, etc.
          case DataType::Mat2x4:   return 2;
@@ -153,6 +164,11 @@ namespace Pikzel {
    }
 
 
+   BufferLayout::BufferLayout(const std::vector<BufferElement>& elements) : m_Elements(elements) {
+      CalculateOffsetsAndStride();
+   }
+
+
    uint32_t BufferLayout::GetStride() const {
       return m_Stride;
    }
@@ -26,6 +26,9 @@ namespace Pikzel {
       DVec2,
       DVec3,
       DVec4,
+      UNorm16Vec4,  // four unsigned 16-bit integers, read by shaders as floats normalized to [0, 1]
+      SNorm16Vec2,  // two signed 16-bit integers, read by shaders as floats normalized to [-1, 1]
+      HVec2,        // two 16-bit (half precision) floats
       Mat2,
       Mat2x3,
       Mat2x4,
@@ -68,6 +71,7 @@ namespace Pikzel {
    public:
       BufferLayout() = default;
       BufferLayout(const std::initializer_list<BufferElement>& elements);
+      BufferLayout(const std::vector<BufferElement>& elements);
 
       uint32_t GetStride() const;
       const std::vector<BufferElement>& GetElements() const;
@@ -104,11 +108,18 @@ namespace Pikzel {
    };
 
 
+   enum class IndexType {
+      UInt16,
+      UInt32
+   };
+
+
    class PKZL_API IndexBuffer : public Buffer {
    public:
       virtual ~IndexBuffer() = default;
 
       virtual uint32_t GetCount() const = 0;
+      virtual IndexType GetIndexType() const = 0;
    };
 
 
@@ -117,4 +128,23 @@ namespace Pikzel {
       virtual ~UniformBuffer() = default;
    };
 
+
+   // A buffer that shaders can both read and write (e.g. an SSBO in glsl).
+   // Unlike a uniform buffer, the last member of the shader block may be an unsized array.
+   class PKZL_API StorageBuffer : public Buffer {
+   public:
+      virtual ~StorageBuffer() = default;
+   };
+
+
+   // Layout of one command in the storage buffer given to GraphicsContext::DrawIndexedIndirect().
+   // (this is the same for both Vulkan and OpenGL)
+   struct DrawIndexedIndirectCommand {
+      uint32_t IndexCount;
+      uint32_t InstanceCount;
+      uint32_t FirstIndex;
+      int32_t VertexOffset;
+      uint32_t FirstInstance;
+   };
+
 }
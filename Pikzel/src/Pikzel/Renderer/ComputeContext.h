@@ -8,6 +8,9 @@
 
 namespace Pikzel {
 
+   class GraphicsContext;
+   class PipelineFuture;
+
    class PKZL_API ComputeContext {
    public:
       virtual ~ComputeContext() = default;
@@ -15,9 +18,21 @@ namespace Pikzel {
       virtual void Begin() = 0;
       virtual void End() = 0;
 
+      // Make the work submitted by the next End() wait (on the GPU) for the work most recently submitted by gc's EndFrame().
+      // Call it when the compute work reads what gc drew (e.g. bloom reads the scene).  Compute work that does not depend on a
+      // graphics frame (e.g. light culling, particles) need not wait for anything, and can then run at the same time as graphics work.
+      // Graphics work that reads what the compute work writes must say so with GraphicsContext::WaitFor().
+      virtual void WaitFor(GraphicsContext& gc) {}
+
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) = 0;
       virtual void Unbind(const UniformBuffer& buffer) = 0;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) = 0;
+      virtual void Unbind(const StorageBuffer& buffer) = 0;
+
+      // For storage images, mipLevel is the level that is written.
+      // For samplers, a non-zero mipLevel binds just that level, which the shader then sees as level 0.
+      // (this is so that a compute shader can read one level of a texture while writing another)
       virtual void Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel = 0) = 0;
       virtual void Unbind(const Texture& texture) = 0;
 
@@ -26,6 +41,10 @@ namespace Pikzel {
 
       virtual std::unique_ptr<Pipeline> CreatePipeline(const PipelineSettings& settings) = 0;
 
+      // Same as CreatePipeline(), except that the pipeline is created in the background (see PipelineCompiler), and this returns straight away.
+      // This context must outlive the pipeline's creation.
+      virtual std::shared_ptr<PipelineFuture> CreatePipelineAsync(const PipelineSettings& settings) = 0;
+
       // Methods dealing with arrays of 3-element vectors are not implemented.
       // The reason for this is to avoid some alignment headaches.
       // For example, in glsl there may be some padding between each column of a matrix
@@ -73,6 +92,11 @@ namespace Pikzel {
 
       virtual void Dispatch(const uint32_t x, const uint32_t y, const uint32_t z) = 0;
 
+      // Set size bytes of buffer (starting at offset) to value, repeated.  offset and size must be multiples of 4.
+      // Unlike StorageBuffer::CopyFromHost(), this happens on the GPU, in order with the dispatches around it.  So it is safe to
+      // use on buffers that work already submitted (e.g. the previous frame's indirect draws) may still be reading.
+      virtual void Fill(const StorageBuffer& buffer, const uint32_t value, const uint64_t offset, const uint64_t size) = 0;
+
    };
 
 }
@@ -0,0 +1,172 @@
+#include "ContentCache.h"
+
+#include "RenderCore.h"
+#include "Pikzel/Core/Hash.h"
+#include "Pikzel/Core/Utility.h"
+
+namespace Pikzel {
+
+   // Each kind of resource starts its hash from a different seed, so that (for example) a vertex buffer and a storage buffer
+   // with the same data are not mistaken for one another
+   enum class ContentKind : uint64_t {
+      VertexBuffer = 1,
+      IndexBuffer16,
+      IndexBuffer32,
+      StorageBuffer,
+      Texture
+   };
+
+
+   static uint64_t GetLayoutKey(const BufferLayout& layout) {
+      uint64_t key = static_cast<uint64_t>(ContentKind::VertexBuffer);
+      for (const auto& element : layout) {
+         const uint32_t fields[] = {static_cast<uint32_t>(element.dataType), element.size, element.offset, element.normalized ? 1u : 0u};
+         key = Hash64(element.name.data(), element.name.size(), key);
+         key = Hash64(fields, sizeof(fields), key);
+      }
+      return key;
+   }
+
+
+   std::shared_ptr<VertexBuffer> ContentCache::CreateVertexBuffer(const BufferLayout& layout, const uint32_t size, const void* data) {
+      PKZL_PROFILE_FUNCTION();
+      const uint64_t key = Hash64(data, size, GetLayoutKey(layout));
+      if (auto existing = Find(key)) {
+         return std::static_pointer_cast<VertexBuffer>(existing);
+      }
+      std::shared_ptr<VertexBuffer> buffer = RenderCore::CreateVertexBuffer(layout, size, data);
+      Add(key, buffer, size);
+      return buffer;
+   }
+
+
+   std::shared_ptr<IndexBuffer> ContentCache::CreateIndexBuffer(const uint32_t count, const uint32_t* indices) {
+      PKZL_PROFILE_FUNCTION();
+      const uint64_t size = static_cast<uint64_t>(count) * sizeof(uint32_t);
+      const uint64_t key = Hash64(indices, size, static_cast<uint64_t>(ContentKind::IndexBuffer32));
+      if (auto existing = Find(key)) {
+         return std::static_pointer_cast<IndexBuffer>(existing);
+      }
+      std::shared_ptr<IndexBuffer> buffer = RenderCore::CreateIndexBuffer(count, indices);
+      Add(key, buffer, size);
+      return buffer;
+   }
+
+
+   std::shared_ptr<IndexBuffer> ContentCache::CreateIndexBuffer(const uint32_t count, const uint16_t* indices) {
+      PKZL_PROFILE_FUNCTION();
+      const uint64_t size = static_cast<uint64_t>(count) * sizeof(uint16_t);
+      const uint64_t key = Hash64(indices, size, static_cast<uint64_t>(ContentKind::IndexBuffer16));
+      if (auto existing = Find(key)) {
+         return std::static_pointer_cast<IndexBuffer>(existing);
+      }
+      std::shared_ptr<IndexBuffer> buffer = RenderCore::CreateIndexBuffer(count, indices);
+      Add(key, buffer, size);
+      return buffer;
+   }
+
+
+   std::shared_ptr<StorageBuffer> ContentCache::CreateStorageBuffer(const uint32_t size, const void* data) {
+      PKZL_PROFILE_FUNCTION();
+      const uint64_t key = Hash64(data, size, static_cast<uint64_t>(ContentKind::StorageBuffer));
+      if (auto existing = Find(key)) {
+         return std::static_pointer_cast<StorageBuffer>(existing);
+      }
+      std::shared_ptr<StorageBuffer> buffer = RenderCore::CreateStorageBuffer(size, data);
+      Add(key, buffer, size);
+      return buffer;
+   }
+
+
+   std::shared_ptr<Texture> ContentCache::CreateTexture(const TextureSettings& settings) {
+      PKZL_PROFILE_FUNCTION();
+      if (settings.path.empty() || settings.imageStorage) {
+         return RenderCore::CreateTexture(settings);
+      }
+
+      // The back-end reads the file again to create the texture.  That is cheap (the file will still be in the OS file cache)
+      // compared to decoding and uploading a duplicate.
+      const uint64_t key = GetTextureKey(settings, ReadFile<uint8_t>(settings.path));
+      if (auto existing = FindTexture(key)) {
+         return existing;
+      }
+      std::shared_ptr<Texture> texture = RenderCore::CreateTexture(settings);
+      AddTexture(key, texture);
+      return texture;
+   }
+
+
+   uint64_t ContentCache::GetTextureKey(const TextureSettings& settings, const std::vector<uint8_t>& fileData) {
+      const uint32_t fields[] = {
+         static_cast<uint32_t>(settings.textureType),
+         settings.width,
+         settings.height,
+         settings.depth,
+         settings.layers,
+         static_cast<uint32_t>(settings.format),
+         static_cast<uint32_t>(settings.minFilter),
+         static_cast<uint32_t>(settings.magFilter),
+         static_cast<uint32_t>(settings.wrapU),
+         static_cast<uint32_t>(settings.wrapV),
+         static_cast<uint32_t>(settings.wrapW),
+         settings.mipLevels,
+         settings.imageStorage ? 1u : 0u
+      };
+      const uint64_t key = Hash64(fields, sizeof(fields), static_cast<uint64_t>(ContentKind::Texture));
+      return Hash64(fileData.data(), fileData.size(), key);
+   }
+
+
+   std::shared_ptr<Texture> ContentCache::FindTexture(const uint64_t key) {
+      return std::static_pointer_cast<Texture>(Find(key));
+   }
+
+
+   void ContentCache::AddTexture(const uint64_t key, const std::shared_ptr<Texture>& texture) {
+      Add(key, texture, Texture::CalculateSize(*texture));
+   }
+
+
+   ContentCacheStats ContentCache::GetStats() {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      std::erase_if(m_Entries, [](const auto& entry) { return entry.second.Resource.expired(); });
+
+      ContentCacheStats stats;
+      for (const auto& [key, entry] : m_Entries) {
+         ++stats.Resources;
+         stats.SharedResources += entry.Shares > 0 ? 1 : 0;
+         stats.Bytes += entry.Bytes;
+         stats.BytesSaved += entry.Shares * entry.Bytes;
+      }
+      return stats;
+   }
+
+
+   void ContentCache::Clear() {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      m_Entries.clear();
+   }
+
+
+   std::shared_ptr<void> ContentCache::Find(const uint64_t key) {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      auto entry = m_Entries.find(key);
+      if (entry == m_Entries.end()) {
+         return nullptr;
+      }
+      std::shared_ptr<void> resource = entry->second.Resource.lock();
+      if (resource) {
+         ++entry->second.Shares;
+      } else {
+         m_Entries.erase(entry);
+      }
+      return resource;
+   }
+
+
+   void ContentCache::Add(const uint64_t key, const std::shared_ptr<void>& resource, const uint64_t bytes) {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      m_Entries[key] = {resource, bytes, 0};
+   }
+
+}
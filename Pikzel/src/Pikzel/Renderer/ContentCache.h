@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+#include "Pikzel/Renderer/Buffer.h"
+#include "Pikzel/Renderer/Texture.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Pikzel {
+
+   // See ContentCache::GetStats()
+   struct PKZL_API ContentCacheStats {
+      uint32_t Resources = 0;          // distinct resources currently alive
+      uint32_t SharedResources = 0;    // of those, how many have been handed out more than once
+      uint64_t Bytes = 0;              // GPU memory used by the distinct resources
+      uint64_t BytesSaved = 0;         // GPU memory that duplicates would have used, had they not been shared
+   };
+
+
+   // Deduplication of immutable GPU resources (vertex, index and storage buffers, and textures loaded from files) by content.
+   //
+   // Resources are identified by a 64-bit xxHash of their data (for textures, of the image file) together with whatever else
+   // determines what ends up on the GPU (buffer layout, texture settings, ...), but not their name or path.  So identical resources
+   // reached through different models, paths or scenes are created and uploaded once, and shared.
+   //
+   // The cache does not own anything: it only remembers resources for as long as something else is holding on to them.
+   // Resources from here must not be written to after creation (they may be shared), so writable resources (e.g. textures with
+   // imageStorage) are always created afresh.
+   class PKZL_API ContentCache {
+      ContentCache() = delete;
+      PKZL_NO_COPYMOVE(ContentCache);
+
+   public:
+      static std::shared_ptr<VertexBuffer> CreateVertexBuffer(const BufferLayout& layout, const uint32_t size, const void* data);
+
+      static std::shared_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint32_t* indices);
+      static std::shared_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint16_t* indices);
+
+      static std::shared_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size, const void* data);
+
+      // Same as RenderCore::CreateTexture(), but returns an existing texture if one has already been created from an identical
+      // file with the same settings.  Textures that are not from a file are not shared.
+      static std::shared_ptr<Texture> CreateTexture(const TextureSettings& settings);
+
+      // For textures that are created some other way (e.g. by TextureStreamer).
+      // Key is from the contents of the texture's image file, and its settings (path is ignored).
+      static uint64_t GetTextureKey(const TextureSettings& settings, const std::vector<uint8_t>& fileData);
+      static std::shared_ptr<Texture> FindTexture(const uint64_t key);
+      static void AddTexture(const uint64_t key, const std::shared_ptr<Texture>& texture);
+
+      static ContentCacheStats GetStats();
+
+      // Forget everything.  Resources that have already been handed out are not affected
+      static void Clear();
+
+   private:
+      struct Entry {
+         std::weak_ptr<void> Resource;
+         uint64_t Bytes = 0;
+         uint32_t Shares = 0;    // how many times this resource has been handed out in place of a duplicate
+      };
+
+      static std::shared_ptr<void> Find(const uint64_t key);
+      static void Add(const uint64_t key, const std::shared_ptr<void>& resource, const uint64_t bytes);
+
+   private:
+      inline static std::unordered_map<uint64_t, Entry> m_Entries;
+      inline static std::mutex m_Mutex;
+   };
+
+}
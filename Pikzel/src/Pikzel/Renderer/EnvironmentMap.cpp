@@ -0,0 +1,235 @@
+#include "EnvironmentMap.h"
+#include "RenderCore.h"
+#include "Pikzel/Core/Hash.h"
+#include "Pikzel/Core/Utility.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Pikzel {
+
+   // Increment this whenever the baking changes (e.g. shaders or texture formats), so that existing cache files are not used
+   static const uint32_t CacheVersion = 1;
+
+
+   struct CachePaths {
+      std::filesystem::path skybox;
+      std::filesystem::path irradiance;
+      std::filesystem::path specularIrradiance;
+      std::filesystem::path specularBRDF_LUT;
+   };
+
+
+   static CachePaths GetCachePaths(const EnvironmentMapSettings& settings) {
+      std::filesystem::path source = settings.path;
+      if (!std::filesystem::exists(source)) {
+         source = Application::Get().GetRootDir() / settings.path;
+      }
+
+      const std::vector<uint8_t> data = ReadFile<uint8_t>(source);
+      uint64_t key = Hash64(data.data(), data.size());
+      key = Hash64(&CacheVersion, sizeof(CacheVersion), key);
+      key = Hash64(&settings.irradianceSize, sizeof(settings.irradianceSize), key);
+
+      // The BRDF lookup table does not depend on the environment, so can be shared by all environment maps in the same directory
+      uint64_t keyLUT = Hash64(&CacheVersion, sizeof(CacheVersion));
+      keyLUT = Hash64(&settings.specularBRDFSize, sizeof(settings.specularBRDFSize), keyLUT);
+
+      const std::filesystem::path stem = source.parent_path() / source.stem();
+      return {
+         .skybox = fmt::format("{0}.{1:016x}.skybox.dds", stem.string(), key),
+         .irradiance = fmt::format("{0}.{1:016x}.irradiance.dds", stem.string(), key),
+         .specularIrradiance = fmt::format("{0}.{1:016x}.specular.dds", stem.string(), key),
+         .specularBRDF_LUT = source.parent_path() / fmt::format("SpecularBRDF_LUT.{0:016x}.dds", keyLUT)
+      };
+   }
+
+
+   EnvironmentMap::EnvironmentMap(const EnvironmentMapSettings& settings)
+   : EnvironmentMap {settings, false}
+   {}
+
+
+   EnvironmentMap::EnvironmentMap(const EnvironmentMapSettings& settings, const bool isOfflineBake) {
+      PKZL_PROFILE_FUNCTION();
+      const auto start = std::chrono::steady_clock::now();
+
+      CachePaths paths;
+      if (settings.useCache || isOfflineBake) {
+         paths = GetCachePaths(settings);
+      }
+
+      // Write a cache file.  Failing to write the cache is not fatal, unless writing the cache is the whole point (i.e. offline bake)
+      const auto write = [isOfflineBake](const std::filesystem::path& path, const Texture& texture, const uint32_t mipLevels) {
+         try {
+            WriteDDS(path, texture, mipLevels);
+         } catch (const std::exception& err) {
+            if (isOfflineBake) {
+               throw;
+            }
+            PKZL_CORE_LOG_WARN("Could not write environment map cache: {0}", err.what());
+         }
+      };
+
+      if (
+         settings.useCache && !isOfflineBake &&
+         std::filesystem::exists(paths.skybox) &&
+         std::filesystem::exists(paths.irradiance) &&
+         std::filesystem::exists(paths.specularIrradiance)
+      ) {
+         m_Skybox = RenderCore::CreateTexture({.textureType = TextureType::TextureCube, .path = paths.skybox});
+         m_Irradiance = RenderCore::CreateTexture({.textureType = TextureType::TextureCube, .path = paths.irradiance});
+         m_SpecularIrradiance = RenderCore::CreateTexture({.textureType = TextureType::TextureCube, .path = paths.specularIrradiance});
+         m_IsFromCache = true;
+      } else {
+         BakeEnvironment(settings);
+         if (settings.useCache || isOfflineBake) {
+            write(paths.skybox, *m_Skybox, 1);                   // skybox mip levels are just a regular mip chain, and are generated on load
+            write(paths.irradiance, *m_Irradiance, 0);
+            write(paths.specularIrradiance, *m_SpecularIrradiance, 0);
+         }
+      }
+
+      if (settings.useCache && !isOfflineBake && std::filesystem::exists(paths.specularBRDF_LUT)) {
+         m_SpecularBRDF_LUT = RenderCore::CreateTexture({
+            .path = paths.specularBRDF_LUT,
+            .wrapU = TextureWrap::ClampToEdge,
+            .wrapV = TextureWrap::ClampToEdge,
+            .mipLevels = 1
+         });
+      } else {
+         BakeSpecularBRDF(settings);
+         m_IsFromCache = false;
+         if (settings.useCache || isOfflineBake) {
+            write(paths.specularBRDF_LUT, *m_SpecularBRDF_LUT, 1);
+         }
+      }
+
+      m_LoadMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+      PKZL_CORE_LOG_INFO("Environment map '{0}' {1} in {2:.1f} ms", settings.path.string(), m_IsFromCache ? "loaded from cache" : "baked", m_LoadMilliseconds);
+   }
+
+
+   void EnvironmentMap::Bake(const EnvironmentMapSettings& settings) {
+      EnvironmentMap environmentMap {settings, true};
+   }
+
+
+   const Texture& EnvironmentMap::GetSkybox() const {
+      return *m_Skybox;
+   }
+
+
+   const Texture& EnvironmentMap::GetIrradiance() const {
+      return *m_Irradiance;
+   }
+
+
+   const Texture& EnvironmentMap::GetSpecularIrradiance() const {
+      return *m_SpecularIrradiance;
+   }
+
+
+   const Texture& EnvironmentMap::GetSpecularBRDF_LUT() const {
+      return *m_SpecularBRDF_LUT;
+   }
+
+
+   bool EnvironmentMap::IsFromCache() const {
+      return m_IsFromCache;
+   }
+
+
+   float EnvironmentMap::GetLoadMilliseconds() const {
+      return m_LoadMilliseconds;
+   }
+
+
+   void EnvironmentMap::BakeEnvironment(const EnvironmentMapSettings& settings) {
+      PKZL_PROFILE_FUNCTION();
+
+      // loading a cubemap from an equirectangular image dispatches EquirectangularToCubeMap.comp
+      m_Skybox = RenderCore::CreateTexture({.textureType = TextureType::TextureCube, .path = settings.path});
+
+      // diffuse irradiance
+      m_Irradiance = RenderCore::CreateTexture({
+         .textureType = TextureType::TextureCube,
+         .width = settings.irradianceSize,
+         .height = settings.irradianceSize,
+         .format = TextureFormat::RGBA16F,
+         .imageStorage = true
+      });
+      std::unique_ptr<ComputeContext> compute = RenderCore::CreateComputeContext();
+      std::unique_ptr<Pipeline> pipelineIrradiance = compute->CreatePipeline({
+         .shaders = {
+            { ShaderType::Compute, "Renderer/EnvironmentIrradiance.comp.spv"}
+         }
+      });
+      compute->Begin();
+      compute->Bind(*pipelineIrradiance);
+      compute->Bind("inputTexture"_hs, *m_Skybox);
+      compute->Bind("outputTexture"_hs, *m_Irradiance);
+      compute->Dispatch(std::max(1u, m_Irradiance->GetWidth() / 32), std::max(1u, m_Irradiance->GetHeight() / 32), 6);
+      compute->End();
+      m_Irradiance->Commit(0);
+
+      // specular irradiance.  Mip level 0 is a copy of the skybox, and mip levels 1..N are pre-filtered for increasing roughness
+      m_SpecularIrradiance = RenderCore::CreateTexture({
+         .textureType = TextureType::TextureCube,
+         .width = m_Skybox->GetWidth(),
+         .height = m_Skybox->GetHeight(),
+         .format = TextureFormat::RGBA16F,
+         .imageStorage = true
+      });
+      m_SpecularIrradiance->CopyFrom(*m_Skybox);
+
+      std::unique_ptr<Pipeline> pipelinePrefilter = compute->CreatePipeline({
+         .shaders = {
+            { ShaderType::Compute, "Renderer/EnvironmentPrefilter.comp.spv"}
+         }
+      });
+      const float deltaRoughness = 0.5f / static_cast<float>(m_SpecularIrradiance->GetMIPLevels() - 1);
+      for (uint32_t level = 1; level < m_SpecularIrradiance->GetMIPLevels(); ++level) {
+         compute->Begin();
+         compute->Bind(*pipelinePrefilter);
+         compute->PushConstant("constants.roughness"_hs, level * deltaRoughness);
+         compute->Bind("inputTexture"_hs, *m_Skybox);
+         compute->Bind("outputTexture"_hs, *m_SpecularIrradiance, level);
+         compute->Dispatch(
+            std::max(1u, m_SpecularIrradiance->GetWidth() / (1 << level) / 32),
+            std::max(1u, m_SpecularIrradiance->GetHeight() / (1 << level) / 32),
+            6
+         );
+         compute->End();
+      }
+      m_SpecularIrradiance->Commit(m_SpecularIrradiance->GetMIPLevels());
+   }
+
+
+   void EnvironmentMap::BakeSpecularBRDF(const EnvironmentMapSettings& settings) {
+      PKZL_PROFILE_FUNCTION();
+
+      m_SpecularBRDF_LUT = RenderCore::CreateTexture({
+         .width = settings.specularBRDFSize,
+         .height = settings.specularBRDFSize,
+         .format = TextureFormat::RG16F,
+         .wrapU = TextureWrap::ClampToEdge,
+         .wrapV = TextureWrap::ClampToEdge,
+         .mipLevels = 1,
+         .imageStorage = true
+      });
+      std::unique_ptr<ComputeContext> compute = RenderCore::CreateComputeContext();
+      std::unique_ptr<Pipeline> pipelineSpecularBRDF = compute->CreatePipeline({
+         .shaders = {
+            { ShaderType::Compute, "Renderer/EnvironmentSpecularBRDF.comp.spv"}
+         }
+      });
+      compute->Begin();
+      compute->Bind(*pipelineSpecularBRDF);
+      compute->Bind("LUT"_hs, *m_SpecularBRDF_LUT);
+      compute->Dispatch(m_SpecularBRDF_LUT->GetWidth() / 32, m_SpecularBRDF_LUT->GetHeight() / 32, 1);
+      compute->End();
+      m_SpecularBRDF_LUT->Commit(m_SpecularBRDF_LUT->GetMIPLevels());
+   }
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <filesystem>
+#include <memory>
+
+namespace Pikzel {
+
+   struct PKZL_API EnvironmentMapSettings {
+      std::filesystem::path path;       // HDR environment image (equirectangular, or six faces of a cube)
+      uint32_t irradianceSize = 32;     // width (and height) of the diffuse irradiance cubemap
+      uint32_t specularBRDFSize = 512;  // width (and height) of the specular BRDF lookup table
+      bool useCache = true;             // false = always bake, and do not read or write cache files
+   };
+
+
+   // Image based lighting for a HDR environment image.
+   //
+   // An EnvironmentMap consists of the environment as a cubemap (skybox), a diffuse irradiance cubemap, a pre-filtered specular
+   // irradiance cubemap (one mip level per roughness), and the specular BRDF lookup table.
+   // These are baked with compute shaders, which is slow for large environment images.  So the baked textures are written to
+   // .dds files next to the source image, and loaded directly from there next time.
+   // Cache files are named by a hash of the source image's content and the settings, so a changed image (or changed settings)
+   // is re-baked automatically.
+   class PKZL_API EnvironmentMap {
+   public:
+      EnvironmentMap(const EnvironmentMapSettings& settings);
+
+      PKZL_NO_COPY(EnvironmentMap);
+
+      const Texture& GetSkybox() const;
+      const Texture& GetIrradiance() const;
+      const Texture& GetSpecularIrradiance() const;
+      const Texture& GetSpecularBRDF_LUT() const;
+
+      // true if the textures were loaded from cache files (rather than baked)
+      bool IsFromCache() const;
+
+      // How long the constructor took (load or bake)
+      float GetLoadMilliseconds() const;
+
+   public:
+      // Bake the environment map and write its cache files, regardless of whether they already exist.
+      // For baking offline, e.g. as a build or packaging step, so that applications never need to bake at startup.
+      static void Bake(const EnvironmentMapSettings& settings);
+
+   private:
+      EnvironmentMap(const EnvironmentMapSettings& settings, const bool isOfflineBake);
+
+      void BakeEnvironment(const EnvironmentMapSettings& settings);
+      void BakeSpecularBRDF(const EnvironmentMapSettings& settings);
+
+   private:
+      std::unique_ptr<Texture> m_Skybox;
+      std::unique_ptr<Texture> m_Irradiance;
+      std::unique_ptr<Texture> m_SpecularIrradiance;
+      std::unique_ptr<Texture> m_SpecularBRDF_LUT;
+      float m_LoadMilliseconds = 0.0f;
+      bool m_IsFromCache = false;
+   };
+
+}
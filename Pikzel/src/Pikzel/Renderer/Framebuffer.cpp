@@ -1 +1,49 @@
 #include "Framebuffer.h"
+
+namespace Pikzel {
+
+   uint32_t GetBytesPerPixel(const FramebufferSettings& settings) {
+      uint32_t bytes = 0;
+      for (const auto& attachment : settings.attachments) {
+         bytes += Texture::BPP(attachment.format);
+      }
+      return bytes * settings.msaaNumSamples;
+   }
+
+
+   uint64_t GetEstimatedBytes(const FramebufferSettings& settings) {
+      uint64_t bytes = 0;
+      for (const auto& attachment : settings.attachments) {
+         const bool isCube = (attachment.textureType == TextureType::TextureCube) || (attachment.textureType == TextureType::TextureCubeArray);
+         bytes += static_cast<uint64_t>(Texture::BPP(attachment.format)) * (isCube ? 6 : 1);
+      }
+
+      // multisampled attachments are resolved into single sampled textures of their own
+      const uint64_t samples = settings.msaaNumSamples > 1 ? settings.msaaNumSamples + 1 : 1;
+      return bytes * samples * settings.width * settings.height * settings.layers;
+   }
+
+
+   bool IsSameButSize(const FramebufferSettings& a, const FramebufferSettings& b) {
+      if (
+         (a.layers != b.layers) ||
+         (a.msaaNumSamples != b.msaaNumSamples) ||
+         (a.clearColorValue != b.clearColorValue) ||
+         (a.clearDepthValue != b.clearDepthValue) ||
+         (a.attachments.size() != b.attachments.size())
+      ) {
+         return false;
+      }
+      for (size_t i = 0; i < a.attachments.size(); ++i) {
+         if (
+            (a.attachments[i].attachmentType != b.attachments[i].attachmentType) ||
+            (a.attachments[i].format != b.attachments[i].format) ||
+            (a.attachments[i].textureType != b.attachments[i].textureType)
+         ) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+}
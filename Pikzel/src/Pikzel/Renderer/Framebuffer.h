@@ -34,6 +34,20 @@ namespace Pikzel {
    };
 
 
+   // Number of bytes written per pixel when every attachment of a framebuffer with given settings is written once
+   // (i.e. summed over all attachments and MSAA samples).
+   // This is a rough measure of the memory bandwidth that rendering to the framebuffer costs.
+   uint32_t PKZL_API GetBytesPerPixel(const FramebufferSettings& settings);
+
+
+   // GPU memory used by a framebuffer with given settings (roughly: ignores alignment and padding)
+   uint64_t PKZL_API GetEstimatedBytes(const FramebufferSettings& settings);
+
+
+   // true if framebuffers with settings a and b are the same in everything but their width and height
+   bool PKZL_API IsSameButSize(const FramebufferSettings& a, const FramebufferSettings& b);
+
+
    class PKZL_API Framebuffer {
    public:
       virtual ~Framebuffer() = default;
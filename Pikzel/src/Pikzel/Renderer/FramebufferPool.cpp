@@ -0,0 +1,135 @@
+#include "FramebufferPool.h"
+
+#include "RenderCore.h"
+
+#include <algorithm>
+
+namespace Pikzel {
+
+   static uint32_t RoundUp(const uint32_t size) {
+      return ((std::max(size, 1u) + FramebufferPool::Granularity - 1) / FramebufferPool::Granularity) * FramebufferPool::Granularity;
+   }
+
+
+   // Whether a framebuffer allocated with settings is a reasonable fit for width x height.
+   // It must be big enough, but not so much bigger that a smaller framebuffer would be better.
+   static bool IsGoodFit(const FramebufferSettings& settings, const uint32_t width, const uint32_t height) {
+      return
+         (width <= settings.width) &&
+         (height <= settings.height) &&
+         (settings.width - width < 2 * FramebufferPool::Granularity) &&
+         (settings.height - height < 2 * FramebufferPool::Granularity)
+      ;
+   }
+
+
+   std::shared_ptr<Framebuffer> FramebufferPool::Acquire(const FramebufferSettings& settings) {
+      PKZL_PROFILE_FUNCTION();
+
+      // the smallest free framebuffer that fits, and that the GPU is done with
+      Entry* found = nullptr;
+      for (auto& entry : m_Entries) {
+         if (
+            !entry.IsInUse &&
+            (m_Frame > entry.FreeFrame + m_FramesInFlight) &&
+            IsGoodFit(entry.Settings, settings.width, settings.height) &&
+            IsSameButSize(entry.Settings, settings) &&
+            (!found || (GetEstimatedBytes(entry.Settings) < GetEstimatedBytes(found->Settings)))
+         ) {
+            found = &entry;
+         }
+      }
+
+      if (found) {
+         ++m_Stats.Reused;
+      } else {
+         FramebufferSettings allocate = settings;
+         allocate.width = RoundUp(settings.width);
+         allocate.height = RoundUp(settings.height);
+         m_Entries.push_back({.Settings = allocate, .Physical = RenderCore::CreateFramebuffer(allocate)});
+         found = &m_Entries.back();
+         ++m_Stats.Created;
+      }
+      found->IsInUse = true;
+      return std::shared_ptr<Framebuffer>(found->Physical.get(), &FramebufferPool::GiveBack);
+   }
+
+
+   bool FramebufferPool::Resize(std::shared_ptr<Framebuffer>& framebuffer, const uint32_t width, const uint32_t height) {
+      PKZL_PROFILE_FUNCTION();
+      auto entry = std::find_if(m_Entries.begin(), m_Entries.end(), [&framebuffer] (const Entry& entry) {
+         return entry.Physical.get() == framebuffer.get();
+      });
+      PKZL_CORE_ASSERT(entry != m_Entries.end(), "FramebufferPool::Resize() given a framebuffer that did not come from the pool!");
+      if (IsGoodFit(entry->Settings, width, height)) {
+         return false;
+      }
+
+      FramebufferSettings settings = entry->Settings;
+      settings.width = width;
+      settings.height = height;
+
+      // the new framebuffer is acquired before the old one is given back, so the old one cannot be handed straight out again
+      framebuffer = Acquire(settings);
+      return true;
+   }
+
+
+   glm::vec2 FramebufferPool::GetUVScale(const Framebuffer& framebuffer, const uint32_t width, const uint32_t height) {
+      return {
+         static_cast<float>(width) / static_cast<float>(framebuffer.GetWidth()),
+         static_cast<float>(height) / static_cast<float>(framebuffer.GetHeight())
+      };
+   }
+
+
+   void FramebufferPool::SetFramesInFlight(const uint32_t framesInFlight) {
+      m_FramesInFlight = framesInFlight;
+   }
+
+
+   void FramebufferPool::Update() {
+      PKZL_PROFILE_FUNCTION();
+      ++m_Frame;
+      m_Stats.Destroyed += static_cast<uint32_t>(std::erase_if(m_Entries, [] (const Entry& entry) {
+         return !entry.IsInUse && (m_Frame > entry.FreeFrame + ReleaseAfterFrames);
+      }));
+   }
+
+
+   void FramebufferPool::Clear() {
+      for (auto& entry : m_Entries) {
+         if (entry.IsInUse) {
+            static_cast<void>(entry.Physical.release());  // GiveBack() will delete it
+         }
+      }
+      m_Entries.clear();
+      m_Stats = {};
+   }
+
+
+   FramebufferPoolStats FramebufferPool::GetStats() {
+      FramebufferPoolStats stats = m_Stats;
+      stats.Framebuffers = static_cast<uint32_t>(m_Entries.size());
+      for (const auto& entry : m_Entries) {
+         stats.InUse += entry.IsInUse ? 1 : 0;
+         stats.Bytes += GetEstimatedBytes(entry.Settings);
+      }
+      return stats;
+   }
+
+
+   void FramebufferPool::GiveBack(Framebuffer* framebuffer) {
+      auto entry = std::find_if(m_Entries.begin(), m_Entries.end(), [framebuffer] (const Entry& entry) {
+         return entry.Physical.get() == framebuffer;
+      });
+      if (entry == m_Entries.end()) {
+         // the pool was cleared while this was in use
+         delete framebuffer;
+         return;
+      }
+      entry->IsInUse = false;
+      entry->FreeFrame = m_Frame;
+   }
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Framebuffer.h"
+
+#include <memory>
+#include <vector>
+
+namespace Pikzel {
+
+   // See FramebufferPool::GetStats()
+   struct PKZL_API FramebufferPoolStats {
+      uint32_t Framebuffers = 0;       // in the pool, whether in use or not
+      uint32_t InUse = 0;              // handed out, and not yet given back
+      uint32_t Created = 0;            // since the pool was last cleared
+      uint32_t Reused = 0;             // times a framebuffer was handed out again, rather than a new one created
+      uint32_t Destroyed = 0;          // having gone unused for FramebufferPool::ReleaseAfterFrames frames
+      uint64_t Bytes = 0;              // GPU memory used by the framebuffers in the pool (estimated from their settings)
+   };
+
+
+   // Framebuffers that are kept and reused, so that resizing a window or viewport does not mean destroying and recreating
+   // attachments (and waiting for the GPU to finish with them first) every time the size changes.
+   //
+   // Framebuffers are matched on everything in their settings but size.  Any framebuffer that is at least as big as asked for
+   // (but no more than a couple of Granularity bigger) will do.  New framebuffers are over-allocated: their size is rounded up to a
+   // multiple of Granularity.  So while a window is being resized interactively, most sizes are satisfied by a framebuffer the pool
+   // already has.
+   // Draw into the wanted part of the framebuffer with GraphicsContext::SetViewport({0, 0}, size), and scale texture coordinates
+   // by GetUVScale() when sampling it.
+   //
+   // A framebuffer that is given back (when the last std::shared_ptr to it goes away) is not handed out again until the frames that
+   // might still be using it have retired, and is destroyed once it has gone unused for ReleaseAfterFrames frames.
+   // Render thread only.
+   class PKZL_API FramebufferPool {
+      FramebufferPool() = delete;
+      PKZL_NO_COPYMOVE(FramebufferPool);
+
+   public:
+      static constexpr uint32_t Granularity = 128;
+      static constexpr uint32_t ReleaseAfterFrames = 120;
+
+      // A framebuffer that is given back is not reused until this many frames have retired.  Application sets this from the window
+      static void SetFramesInFlight(const uint32_t framesInFlight);
+
+      // A framebuffer with settings, except that it may be bigger
+      static std::shared_ptr<Framebuffer> Acquire(const FramebufferSettings& settings);
+
+      // Make framebuffer (which must have come from Acquire()) fit width x height.  If it already does, it is left as is.  Otherwise
+      // it is given back and replaced with another one from the pool.  Returns true if it was replaced.
+      static bool Resize(std::shared_ptr<Framebuffer>& framebuffer, const uint32_t width, const uint32_t height);
+
+      // Texture coordinates of the far corner of a width x height image drawn at (0, 0) in framebuffer
+      static glm::vec2 GetUVScale(const Framebuffer& framebuffer, const uint32_t width, const uint32_t height);
+
+      // Advance the frame count, and destroy framebuffers that have not been used for a while.  Called once per frame by Application
+      static void Update();
+
+      // Destroy the framebuffers that are not in use (those that are get destroyed when they are given back).  Called by Application on exit
+      static void Clear();
+
+      static FramebufferPoolStats GetStats();
+
+   private:
+      static void GiveBack(Framebuffer* framebuffer);
+
+   private:
+      struct Entry {
+         FramebufferSettings Settings;             // as allocated
+         std::unique_ptr<Framebuffer> Physical;
+         uint64_t FreeFrame = 0;                   // when it was given back
+         bool IsInUse = false;
+      };
+
+      inline static std::vector<Entry> m_Entries;
+      inline static uint64_t m_Frame = 0;
+      inline static uint32_t m_FramesInFlight = 2;
+      inline static FramebufferPoolStats m_Stats;  // just the counts of created, reused and destroyed.  The rest are filled in by GetStats()
+   };
+
+}
@@ -9,6 +9,9 @@
 
 namespace Pikzel {
 
+   class ComputeContext;
+   class PipelineFuture;
+
    enum BeginFrameOp {
       ClearNone,
       ClearColor,
@@ -23,6 +26,17 @@ namespace Pikzel {
       virtual void BeginFrame(const BeginFrameOp operation = BeginFrameOp::ClearAll) = 0;
       virtual void EndFrame() = 0;
 
+      // Clear part of the depth attachment to the depth clear value, leaving the rest of it untouched.
+      // Must be called between BeginFrame() and EndFrame().
+      // offset and extent are in pixels (0,0 is bottom-left).  baseLayer and layerCount select which layers of a layered
+      // attachment to clear (e.g. for a cube map array, layer = 6 * cubeIndex + face)
+      virtual void ClearDepth(const glm::uvec2& offset, const glm::uvec2& extent, const uint32_t baseLayer = 0, const uint32_t layerCount = 1) = 0;
+
+      // Restrict subsequent drawing to part of the render target (e.g. one tile of a texture atlas).
+      // Must be called between BeginFrame() and EndFrame().  BeginFrame() resets the viewport to the whole render target.
+      // offset and extent are in pixels (0,0 is bottom-left)
+      virtual void SetViewport(const glm::uvec2& offset, const glm::uvec2& extent) = 0;
+
       // These don't belong here - what if client doesn't want ImGui baggage?  TODO: move somewhere else.
       virtual void InitializeImGui() {
          // This is a bit nasty.
@@ -37,6 +51,18 @@ namespace Pikzel {
 
       virtual void SwapBuffers() = 0;
 
+      // Whether anything samples the render target's depth attachment after EndFrame() (e.g. it is a shadow map).  Default is true.
+      // If it is not sampled, then EndFrame() can leave it as is instead of transitioning it for shader reads.
+      // Only meaningful for framebuffers (see RenderGraph, which sets this from the passes that read each render target)
+      virtual void SetDepthSampled(const bool isSampled) {}
+
+      // Make the work of this context's current frame wait (on the GPU) for the work most recently submitted by compute's End().
+      // Call it (between BeginFrame() and EndFrame()) when the frame reads what compute wrote.  Graphics work that does not
+      // depend on compute (e.g. shadow maps) can then run at the same time as it.
+      // See also ComputeContext::WaitFor().  Only the Vulkan backend (and only with a separate compute queue) does anything with this:
+      // elsewhere, work is executed in the order it was submitted.
+      virtual void WaitFor(ComputeContext& compute) {}
+
       virtual void Bind(const VertexBuffer& buffer) = 0;
       virtual void Unbind(const VertexBuffer& buffer) = 0;
 
@@ -46,6 +72,9 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) = 0;
       virtual void Unbind(const UniformBuffer& buffer) = 0;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) = 0;
+      virtual void Unbind(const StorageBuffer& buffer) = 0;
+
       virtual void Bind(const Id resourceId, const Texture& texture) = 0;
       virtual void Unbind(const Texture& texture) = 0;
 
@@ -54,6 +83,10 @@ namespace Pikzel {
 
       virtual std::unique_ptr<Pipeline> CreatePipeline(const PipelineSettings& settings) const = 0;
 
+      // Same as CreatePipeline(), except that the pipeline is created in the background (see PipelineCompiler), and this returns straight away.
+      // This context must outlive the pipeline's creation.
+      virtual std::shared_ptr<PipelineFuture> CreatePipelineAsync(const PipelineSettings& settings) const = 0;
+
       // Methods dealing with arrays of 3-element vectors are not implemented.
       // The reason for this is to avoid some alignment headaches.
       // For example, in glsl there may be some padding between each column of a matrix
@@ -106,8 +139,15 @@ namespace Pikzel {
 
       // Draw contents of vertex buffer, as triangles indexed by index buffer.
       // The number of vertices drawn is determined by the number of indices in the index buffer, unless you override the indexCount parameter.
-      // Drawing starts from [vertexOffset]th element of the vertex buffer (default 0)
-      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0) = 0;
+      // Indices are read starting from the [firstIndex]th element of the index buffer (default 0), and are relative to the
+      // [vertexOffset]th element of the vertex buffer (default 0)
+      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0, const uint32_t firstIndex = 0) = 0;
+
+      // Draw contents of vertex buffer, as triangles indexed by index buffer, with the draw parameters read from GPU memory.
+      // commands is an array of DrawIndexedIndirectCommand, starting at byte offset commandsOffset.
+      // The number of commands is a uint32_t read from count at byte offset countOffset (and is clamped to maxDrawCount).
+      // commands and count would typically be written by a compute shader (e.g. see Renderer/Shaders/MeshletCull.comp)
+      virtual void DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const StorageBuffer& commands, const uint64_t commandsOffset, const StorageBuffer& count, const uint64_t countOffset, const uint32_t maxDrawCount) = 0;
 
    };
 
@@ -0,0 +1,40 @@
+#include "Pipeline.h"
+#include "PipelineCompiler.h"
+#include "ShaderReloader.h"
+
+namespace Pikzel {
+
+   Pipeline::Pipeline(const PipelineSettings& settings)
+   : m_Shaders {settings.shaders}
+   , m_BufferLayout {settings.bufferLayout}
+   , m_SpecializationConstants {settings.specializationConstants}
+   , m_EnableBlend {settings.enableBlend}
+   {
+      // Pipelines that are created in the background are registered once they are ready (see PipelineFuture)
+      if (!PipelineCompiler::IsWorkerThread()) {
+         ShaderReloader::Register(*this);
+      }
+      PipelineCompiler::Record(settings);
+   }
+
+
+   Pipeline::~Pipeline() {
+      ShaderReloader::Unregister(*this);
+   }
+
+
+   const std::vector<std::pair<ShaderType, std::filesystem::path>>& Pipeline::GetShaders() const {
+      return m_Shaders;
+   }
+
+
+   PipelineSettings Pipeline::GetSettings() const {
+      return {
+         .enableBlend = m_EnableBlend,
+         .shaders = m_Shaders,
+         .bufferLayout = m_BufferLayout,
+         .specializationConstants = m_SpecializationConstants
+      };
+   }
+
+}
@@ -29,7 +29,26 @@ namespace Pikzel {
 
    class PKZL_API Pipeline {
    public:
-      virtual ~Pipeline() = default;
+      Pipeline(const PipelineSettings& settings);
+      virtual ~Pipeline();
+
+      PKZL_NO_COPYMOVE(Pipeline);
+
+      // Rebuild the pipeline from the latest compiled versions of its shaders (see ShaderReloader).
+      // If that fails, throws, and the pipeline is left as it was.
+      virtual void Reload() = 0;
+
+      const std::vector<std::pair<ShaderType, std::filesystem::path>>& GetShaders() const;
+
+   protected:
+      // The settings that the pipeline was created with (for Reload())
+      PipelineSettings GetSettings() const;
+
+   private:
+      std::vector<std::pair<ShaderType, std::filesystem::path>> m_Shaders;
+      BufferLayout m_BufferLayout;
+      SpecializationConstantsMap m_SpecializationConstants;
+      bool m_EnableBlend = true;
    };
 
 }
\ No newline at end of file
@@ -0,0 +1,435 @@
+#include "PipelineCompiler.h"
+
+#include "GraphicsContext.h"
+#include "RenderCore.h"
+#include "ShaderReloader.h"
+#include "Pikzel/Core/Hash.h"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <fstream>
+
+namespace Pikzel {
+
+   // Increment this whenever the warm-up list file format changes, so that old files are ignored
+   static const uint32_t WarmUpListVersion = 1;
+
+   static thread_local bool IsPipelineWorker = false;
+
+
+   static const char* ShaderTypeToString(const ShaderType type) {
+      switch (type) {
+         case ShaderType::Vertex:   return "Vertex";
+         case ShaderType::Geometry: return "Geometry";
+         case ShaderType::Fragment: return "Fragment";
+         case ShaderType::Compute:  return "Compute";
+      }
+      PKZL_CORE_ASSERT(false, "Unknown ShaderType!");
+      return "";
+   }
+
+
+   static ShaderType StringToShaderType(const std::string& type) {
+      for (const auto candidate : {ShaderType::Vertex, ShaderType::Geometry, ShaderType::Fragment, ShaderType::Compute}) {
+         if (type == ShaderTypeToString(candidate)) {
+            return candidate;
+         }
+      }
+      throw std::runtime_error {fmt::format("Unknown shader type '{0}' in pipeline warm-up list", type)};
+   }
+
+
+   static PipelineWarmUpEntry ToWarmUpEntry(const PipelineSettings& settings) {
+      PipelineWarmUpEntry entry {
+         .Shaders = settings.shaders,
+         .SpecializationConstants = settings.specializationConstants,
+         .EnableBlend = settings.enableBlend
+      };
+      for (const auto& element : settings.bufferLayout) {
+         entry.Layout.emplace_back(element.name, element.dataType);
+      }
+      return entry;
+   }
+
+
+   static BufferLayout ToBufferLayout(const PipelineWarmUpEntry& entry) {
+      std::vector<BufferElement> elements;
+      for (const auto& [name, type] : entry.Layout) {
+         elements.emplace_back(name, type);
+      }
+      return elements;
+   }
+
+
+   // Pipelines with equal keys have equal settings
+   static uint64_t GetKey(const PipelineWarmUpEntry& entry) {
+      const auto hashString = [](const std::string& string, const uint64_t seed) {
+         const uint64_t hash = Hash64(string.data(), string.size(), seed);
+         return Hash64(&hash, sizeof(hash), string.size());  // so that ("ab", "c") and ("a", "bc") differ
+      };
+
+      uint64_t key = entry.EnableBlend ? 1 : 0;
+      for (const auto& [type, path] : entry.Shaders) {
+         key = Hash64(&type, sizeof(type), key);
+         key = hashString(path.generic_string(), key);
+      }
+      for (const auto& [name, type] : entry.Layout) {
+         key = hashString(name, key);
+         key = Hash64(&type, sizeof(type), key);
+      }
+
+      // unordered, so sort for a consistent key
+      std::vector<std::pair<std::string, int>> constants {entry.SpecializationConstants.begin(), entry.SpecializationConstants.end()};
+      std::sort(constants.begin(), constants.end());
+      for (const auto& [name, value] : constants) {
+         key = hashString(name, key);
+         key = Hash64(&value, sizeof(value), key);
+      }
+      return key;
+   }
+
+
+   static bool IsCompute(const PipelineWarmUpEntry& entry) {
+      return std::any_of(entry.Shaders.begin(), entry.Shaders.end(), [](const auto& shader) { return shader.first == ShaderType::Compute; });
+   }
+
+
+   PipelineFuture::PipelineFuture(const PipelineSettings& settings, CreateFn create, FinishFn finish)
+   : m_Shaders {settings.shaders}
+   , m_BufferLayout {settings.bufferLayout}
+   , m_SpecializationConstants {settings.specializationConstants}
+   , m_EnableBlend {settings.enableBlend}
+   , m_CreateFn {std::move(create)}
+   , m_FinishFn {std::move(finish)}
+   {}
+
+
+   bool PipelineFuture::IsReady() const {
+      return m_IsReady;
+   }
+
+
+   bool PipelineFuture::IsFailed() const {
+      return m_IsReady && !m_Pipeline;
+   }
+
+
+   Pipeline* PipelineFuture::Get() const {
+      return m_IsReady ? m_Pipeline.get() : nullptr;
+   }
+
+
+   Pipeline& PipelineFuture::Wait() {
+      if (!m_IsReady) {
+         PKZL_PROFILE_FUNCTION();
+         {
+            std::unique_lock<std::mutex> lock {m_Mutex};
+            m_Created.wait(lock, [this] { return m_IsCreated; });
+         }
+         Finish();
+      }
+      if (!m_Pipeline) {
+         std::rethrow_exception(m_Error);
+      }
+      return *m_Pipeline;
+   }
+
+
+   void PipelineFuture::Create() {
+      PKZL_PROFILE_FUNCTION();
+      std::unique_ptr<Pipeline> pipeline;
+      std::exception_ptr error;
+      try {
+         pipeline = m_CreateFn({
+            .enableBlend = m_EnableBlend,
+            .shaders = m_Shaders,
+            .bufferLayout = m_BufferLayout,
+            .specializationConstants = m_SpecializationConstants
+         });
+      } catch (...) {
+         error = std::current_exception();
+      }
+      {
+         std::lock_guard<std::mutex> lock {m_Mutex};
+         m_Pipeline = std::move(pipeline);
+         m_Error = error;
+         m_IsCreated = true;
+      }
+      m_Created.notify_all();
+   }
+
+
+   void PipelineFuture::Finish() {
+      if (m_IsReady) {
+         return;
+      }
+      if (m_Pipeline && m_FinishFn) {
+         try {
+            m_FinishFn(*m_Pipeline);
+         } catch (...) {
+            m_Error = std::current_exception();
+            m_Pipeline.reset();
+         }
+      }
+      if (m_Pipeline) {
+         // Not registered by the Pipeline constructor, as ShaderReloader must not see a pipeline that is still being created
+         ShaderReloader::Register(*m_Pipeline);
+      } else {
+         try {
+            std::rethrow_exception(m_Error);
+         } catch (const std::exception& err) {
+            PKZL_CORE_LOG_ERROR("Pipeline could not be created: {0}", err.what());
+         } catch (...) {
+            PKZL_CORE_LOG_ERROR("Pipeline could not be created");
+         }
+      }
+      m_IsReady = true;
+   }
+
+
+   std::shared_ptr<PipelineFuture> PipelineCompiler::Submit(const void* context, const PipelineSettings& settings, PipelineFuture::CreateFn create, PipelineFuture::FinishFn finish) {
+      if (!m_WarmedUp.empty()) {
+         if (auto warmedUp = m_WarmedUp.find({context, GetKey(ToWarmUpEntry(settings))}); warmedUp != m_WarmedUp.end()) {
+            std::shared_ptr<PipelineFuture> future = std::move(warmedUp->second);
+            m_WarmedUp.erase(warmedUp);
+            return future;
+         }
+      }
+
+      auto future = std::make_shared<PipelineFuture>(settings, std::move(create), std::move(finish));
+      {
+         std::lock_guard<std::mutex> lock {m_Mutex};
+         if (m_Workers.empty()) {
+            m_IsQuitting = false;
+            const uint32_t numThreads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+            for (uint32_t i = 0; i < numThreads; ++i) {
+               m_Workers.emplace_back(&PipelineCompiler::WorkerMain);
+            }
+         }
+         m_Queue.push_back(future);
+      }
+      m_WorkAvailable.notify_one();
+      return future;
+   }
+
+
+   std::unique_ptr<Pipeline> PipelineCompiler::TakeWarmedUp(const void* context, const PipelineSettings& settings) {
+      if (m_WarmedUp.empty()) {
+         return nullptr;
+      }
+      auto warmedUp = m_WarmedUp.find({context, GetKey(ToWarmUpEntry(settings))});
+      if (warmedUp == m_WarmedUp.end()) {
+         return nullptr;
+      }
+      std::shared_ptr<PipelineFuture> future = std::move(warmedUp->second);
+      m_WarmedUp.erase(warmedUp);
+      try {
+         future->Wait();
+      } catch (const std::exception&) {
+         return nullptr;  // already logged.  The caller creates the pipeline itself (and so gets the error)
+      }
+      return std::move(future->m_Pipeline);
+   }
+
+
+   void PipelineCompiler::Update() {
+      PKZL_PROFILE_FUNCTION();
+      std::vector<std::shared_ptr<PipelineFuture>> created;
+      {
+         std::lock_guard<std::mutex> lock {m_Mutex};
+         std::swap(created, m_Created);
+      }
+
+      // Futures that nothing else refers to any more are released here (on the render thread) rather than on the worker
+      for (const auto& future : created) {
+         if (future.use_count() > 1) {
+            future->Finish();
+         }
+      }
+   }
+
+
+   void PipelineCompiler::Shutdown() {
+      std::vector<std::shared_ptr<PipelineFuture>> cancelled;
+      {
+         std::lock_guard<std::mutex> lock {m_Mutex};
+         m_IsQuitting = true;
+         cancelled.assign(m_Queue.begin(), m_Queue.end());
+         m_Queue.clear();
+      }
+      m_WorkAvailable.notify_all();
+      for (auto& worker : m_Workers) {
+         worker.join();
+      }
+      m_Workers.clear();
+
+      for (const auto& future : cancelled) {
+         {
+            std::lock_guard<std::mutex> lock {future->m_Mutex};
+            future->m_Error = std::make_exception_ptr(std::runtime_error {"Pipeline creation was cancelled"});
+            future->m_IsCreated = true;
+         }
+         future->m_Created.notify_all();
+      }
+      Update();
+      m_WarmedUp.clear();
+      m_WarmUpComputeContext.reset();
+   }
+
+
+   bool PipelineCompiler::IsWorkerThread() {
+      return IsPipelineWorker;
+   }
+
+
+   void PipelineCompiler::SetRecording(const bool isRecording) {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      m_IsRecording = isRecording;
+   }
+
+
+   bool PipelineCompiler::IsRecording() {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      return m_IsRecording;
+   }
+
+
+   void PipelineCompiler::Record(const PipelineSettings& settings) {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      if (m_IsRecording) {
+         PipelineWarmUpEntry entry = ToWarmUpEntry(settings);
+         const uint64_t key = GetKey(entry);
+         if (std::find(m_WarmUpKeys.begin(), m_WarmUpKeys.end(), key) == m_WarmUpKeys.end()) {
+            m_WarmUpList.emplace_back(std::move(entry));
+            m_WarmUpKeys.emplace_back(key);
+         }
+      }
+   }
+
+
+   const std::vector<PipelineWarmUpEntry>& PipelineCompiler::GetWarmUpList() {
+      return m_WarmUpList;
+   }
+
+
+   void PipelineCompiler::SaveWarmUpList(const std::filesystem::path& path) {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      std::ofstream out {path};
+      if (!out) {
+         throw std::runtime_error {fmt::format("Could not write pipeline warm-up list '{0}'", path.string())};
+      }
+
+      YAML::Emitter yaml {out};
+      yaml << YAML::BeginMap;
+      yaml << YAML::Key << "Version" << YAML::Value << WarmUpListVersion;
+      yaml << YAML::Key << "Pipelines" << YAML::Value << YAML::BeginSeq;
+      for (const auto& entry : m_WarmUpList) {
+         yaml << YAML::BeginMap;
+         yaml << YAML::Key << "Shaders" << YAML::Value << YAML::BeginSeq;
+         for (const auto& [type, shaderPath] : entry.Shaders) {
+            yaml << YAML::Flow << YAML::BeginSeq << ShaderTypeToString(type) << shaderPath.generic_string() << YAML::EndSeq;
+         }
+         yaml << YAML::EndSeq;
+         yaml << YAML::Key << "Layout" << YAML::Value << YAML::BeginSeq;
+         for (const auto& [name, type] : entry.Layout) {
+            yaml << YAML::Flow << YAML::BeginSeq << name << static_cast<int>(type) << YAML::EndSeq;
+         }
+         yaml << YAML::EndSeq;
+         yaml << YAML::Key << "SpecializationConstants" << YAML::Value << YAML::BeginMap;
+         for (const auto& [name, value] : entry.SpecializationConstants) {
+            yaml << YAML::Key << name << YAML::Value << value;
+         }
+         yaml << YAML::EndMap;
+         yaml << YAML::Key << "EnableBlend" << YAML::Value << entry.EnableBlend;
+         yaml << YAML::EndMap;
+      }
+      yaml << YAML::EndSeq;
+      yaml << YAML::EndMap;
+   }
+
+
+   std::vector<PipelineWarmUpEntry> PipelineCompiler::LoadWarmUpList(const std::filesystem::path& path) {
+      std::vector<PipelineWarmUpEntry> list;
+      YAML::Node node = YAML::LoadFile(path.string());
+      if (node["Version"].as<uint32_t>(0) != WarmUpListVersion) {
+         PKZL_CORE_LOG_WARN("Pipeline warm-up list '{0}' is out of date, and has been ignored", path.string());
+         return list;
+      }
+      for (const auto& pipeline : node["Pipelines"]) {
+         PipelineWarmUpEntry entry;
+         for (const auto& shader : pipeline["Shaders"]) {
+            entry.Shaders.emplace_back(StringToShaderType(shader[0].as<std::string>()), shader[1].as<std::string>());
+         }
+         for (const auto& element : pipeline["Layout"]) {
+            entry.Layout.emplace_back(element[0].as<std::string>(), static_cast<DataType>(element[1].as<int>()));
+         }
+         for (const auto& constant : pipeline["SpecializationConstants"]) {
+            entry.SpecializationConstants.emplace(constant.first.as<std::string>(), constant.second.as<int>());
+         }
+         entry.EnableBlend = pipeline["EnableBlend"].as<bool>(true);
+         list.emplace_back(std::move(entry));
+      }
+      return list;
+   }
+
+
+   void PipelineCompiler::WarmUp(const GraphicsContext& gc, const std::filesystem::path& path) {
+      PKZL_PROFILE_FUNCTION();
+      if (!std::filesystem::exists(path)) {
+         PKZL_CORE_LOG_INFO("No pipeline warm-up list at '{0}'", path.string());
+         return;
+      }
+
+      std::vector<PipelineWarmUpEntry> list;
+      try {
+         list = LoadWarmUpList(path);
+      } catch (const std::exception& err) {
+         PKZL_CORE_LOG_WARN("Could not read pipeline warm-up list '{0}': {1}", path.string(), err.what());
+         return;
+      }
+
+      for (const auto& entry : list) {
+         const BufferLayout layout = ToBufferLayout(entry);
+         const PipelineSettings settings {
+            .enableBlend = entry.EnableBlend,
+            .shaders = entry.Shaders,
+            .bufferLayout = layout,
+            .specializationConstants = entry.SpecializationConstants
+         };
+         const bool isCompute = IsCompute(entry);
+         if (isCompute && !m_WarmUpComputeContext) {
+            m_WarmUpComputeContext = RenderCore::CreateComputeContext();
+         }
+         std::shared_ptr<PipelineFuture> future = isCompute ? m_WarmUpComputeContext->CreatePipelineAsync(settings) : gc.CreatePipelineAsync(settings);
+         m_WarmedUp[{isCompute ? nullptr : &gc, GetKey(entry)}] = std::move(future);
+      }
+      PKZL_CORE_LOG_INFO("Warming up {0} pipelines from '{1}'", list.size(), path.string());
+   }
+
+
+   bool PipelineCompiler::IsWarmingUp() {
+      return std::any_of(m_WarmedUp.begin(), m_WarmedUp.end(), [](const auto& warmedUp) { return !warmedUp.second->IsReady(); });
+   }
+
+
+   void PipelineCompiler::WorkerMain() {
+      IsPipelineWorker = true;
+      std::unique_lock<std::mutex> lock {m_Mutex};
+      while (true) {
+         m_WorkAvailable.wait(lock, [] { return m_IsQuitting || !m_Queue.empty(); });
+         if (m_IsQuitting) {
+            break;
+         }
+         std::shared_ptr<PipelineFuture> future = std::move(m_Queue.front());
+         m_Queue.pop_front();
+
+         lock.unlock();
+         future->Create();
+         lock.lock();
+
+         m_Created.emplace_back(std::move(future));
+      }
+   }
+
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "ComputeContext.h"
+#include "Pipeline.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Pikzel {
+
+   class GraphicsContext;
+
+   // A pipeline that is being created in the background.  See GraphicsContext::CreatePipelineAsync() and ComputeContext::CreatePipelineAsync()
+   //
+   // Until the pipeline IsReady(), callers should skip the draws (or dispatches) that need it, or substitute a pipeline that is ready.
+   // Call only from the render thread.
+   class PKZL_API PipelineFuture {
+   public:
+      using CreateFn = std::function<std::unique_ptr<Pipeline>(const PipelineSettings&)>;
+      using FinishFn = std::function<void(Pipeline&)>;
+
+      PipelineFuture(const PipelineSettings& settings, CreateFn create, FinishFn finish);
+      PKZL_NO_COPYMOVE(PipelineFuture);
+
+      // true once the pipeline has been created (or creation has failed).  Does not block
+      bool IsReady() const;
+
+      // true if the pipeline could not be created.  Wait() rethrows the reason
+      bool IsFailed() const;
+
+      // The pipeline, or nullptr if it is not ready yet (or failed)
+      Pipeline* Get() const;
+
+      // Block until the pipeline has been created.  Throws if it could not be
+      Pipeline& Wait();
+
+   private:
+      friend class PipelineCompiler;
+
+      void Create();    // worker thread
+      void Finish();    // render thread
+
+   private:
+      std::vector<std::pair<ShaderType, std::filesystem::path>> m_Shaders;   // the settings (which cannot be kept as is, as they refer to the layout)
+      BufferLayout m_BufferLayout;
+      SpecializationConstantsMap m_SpecializationConstants;
+      bool m_EnableBlend = true;
+
+      CreateFn m_CreateFn;                   // run on a worker thread
+      FinishFn m_FinishFn;                   // then run on the render thread (e.g. OpenGL objects can only be created there)
+
+      std::unique_ptr<Pipeline> m_Pipeline;
+      std::exception_ptr m_Error;
+
+      mutable std::mutex m_Mutex;
+      std::condition_variable m_Created;
+      bool m_IsCreated = false;              // guarded by m_Mutex
+      bool m_IsReady = false;                // render thread only
+   };
+
+
+   // One pipeline in a warm-up list
+   struct PKZL_API PipelineWarmUpEntry {
+      std::vector<std::pair<ShaderType, std::filesystem::path>> Shaders;
+      std::vector<std::pair<std::string, DataType>> Layout;                  // (name, type) of each element of the buffer layout
+      SpecializationConstantsMap SpecializationConstants;
+      bool EnableBlend = true;
+   };
+
+
+   // Creates pipelines in the background, on worker threads.
+   //
+   // The CPU side of creating a pipeline (reading shaders, reflecting them, laying out descriptors) and, on Vulkan, compiling it,
+   // all happens on a worker.  On OpenGL, compiling and linking the program needs the GL context, so that part is done by Update().
+   //
+   // Pipelines can also be warmed up.  While recording, the settings of every pipeline that is created are added to a warm-up list,
+   // which SaveWarmUpList() writes to a file.  At startup, an application can WarmUp() the pipelines in that file: they are all created
+   // in parallel, and kept until a pipeline with the same settings is created (on the same context), which then gets the warmed-up one.
+   // On Vulkan, warming up also fills the graphics context's pipeline cache.
+   class PKZL_API PipelineCompiler {
+      PipelineCompiler() = delete;
+      PKZL_NO_COPYMOVE(PipelineCompiler);
+
+   public:
+      // Queue a pipeline to be created by create() on a worker thread, and then finish() on the render thread (finish may be empty).
+      // context is whatever the pipeline is created for (nullptr for compute pipelines, which do not depend on their context).
+      // It is only used to match warmed-up pipelines.  create() must not refer to the context itself, as the context may be destroyed
+      // while the pipeline is being created: it should capture (shared) ownership of whatever it needs instead.
+      // Contexts' CreatePipelineAsync() call this.  If a pipeline with the same settings has been warmed up for the same context, then
+      // that is returned instead.
+      static std::shared_ptr<PipelineFuture> Submit(const void* context, const PipelineSettings& settings, PipelineFuture::CreateFn create, PipelineFuture::FinishFn finish = {});
+
+      // The pipeline with these settings that has been warmed up for context, waiting for it if necessary.  nullptr if there is not one.
+      // Contexts' CreatePipeline() call this, so that warming up benefits pipelines that are created synchronously too.
+      static std::unique_ptr<Pipeline> TakeWarmedUp(const void* context, const PipelineSettings& settings);
+
+      // Finish pipelines that the workers have created.  Called once per frame by Application
+      static void Update();
+
+      // Wait for the workers, and release warmed-up pipelines that were never used.  Called by Application on exit
+      static void Shutdown();
+
+      static bool IsWorkerThread();
+
+      static void SetRecording(const bool isRecording);
+      static bool IsRecording();
+
+      // Add to the warm-up list (if recording).  Called by the Pipeline constructor
+      static void Record(const PipelineSettings& settings);
+
+      static const std::vector<PipelineWarmUpEntry>& GetWarmUpList();
+      static void SaveWarmUpList(const std::filesystem::path& path);
+      static std::vector<PipelineWarmUpEntry> LoadWarmUpList(const std::filesystem::path& path);
+
+      // Start creating all of the pipelines in the warm-up list at path (if it exists).
+      // Graphics pipelines are created for gc, and compute pipelines for a compute context that PipelineCompiler keeps until Shutdown().
+      // Returns straight away.  IsWarmingUp() says when they are done.
+      static void WarmUp(const GraphicsContext& gc, const std::filesystem::path& path);
+      static bool IsWarmingUp();
+
+   private:
+      static void WorkerMain();
+
+   private:
+      inline static std::vector<std::thread> m_Workers;
+      inline static std::deque<std::shared_ptr<PipelineFuture>> m_Queue;          // guarded by m_Mutex
+      inline static std::vector<std::shared_ptr<PipelineFuture>> m_Created;       // by workers, not yet finished by Update().  Guarded by m_Mutex
+      inline static std::mutex m_Mutex;
+      inline static std::condition_variable m_WorkAvailable;
+      inline static bool m_IsQuitting = false;
+
+      inline static std::map<std::pair<const void*, uint64_t>, std::shared_ptr<PipelineFuture>> m_WarmedUp;   // by (context, settings key).  Render thread only
+      inline static std::unique_ptr<ComputeContext> m_WarmUpComputeContext;
+
+      inline static std::vector<PipelineWarmUpEntry> m_WarmUpList;                // guarded by m_Mutex
+      inline static std::vector<uint64_t> m_WarmUpKeys;                           // of m_WarmUpList.  Guarded by m_Mutex
+      inline static bool m_IsRecording = false;                                   // guarded by m_Mutex
+   };
+
+}
@@ -0,0 +1,209 @@
+#include "Readback.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+// static, so as not to clash with any other copy of stb_image_write that gets linked in (e.g. by a dependency)
+#define STB_IMAGE_WRITE_STATIC
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace Pikzel {
+
+   ReadbackFuture::ReadbackFuture(IsCopiedFn isCopied, WaitFn wait, ReadFn read, const TextureFormat format, const uint32_t width, const uint32_t height)
+   : m_IsCopiedFn {std::move(isCopied)}
+   , m_WaitFn {std::move(wait)}
+   , m_ReadFn {std::move(read)}
+   , m_Format {format}
+   , m_Width {width}
+   , m_Height {height}
+   {}
+
+
+   bool ReadbackFuture::IsReady() {
+      if (!m_IsReady && m_IsCopiedFn()) {
+         Read();
+      }
+      return m_IsReady;
+   }
+
+
+   const std::vector<uint8_t>& ReadbackFuture::Get() const {
+      return m_Data;
+   }
+
+
+   const std::vector<uint8_t>& ReadbackFuture::Wait() {
+      if (!m_IsReady) {
+         m_WaitFn();
+         Read();
+      }
+      return m_Data;
+   }
+
+
+   TextureFormat ReadbackFuture::GetFormat() const {
+      return m_Format;
+   }
+
+
+   uint32_t ReadbackFuture::GetWidth() const {
+      return m_Width;
+   }
+
+
+   uint32_t ReadbackFuture::GetHeight() const {
+      return m_Height;
+   }
+
+
+   void ReadbackFuture::Read() {
+      PKZL_PROFILE_FUNCTION();
+      m_ReadFn(m_Data);
+      m_IsCopiedFn = {};
+      m_WaitFn = {};
+      m_ReadFn = {};
+      m_IsReady = true;
+   }
+
+
+   static uint8_t FloatToUNorm8(const float value) {
+      return static_cast<uint8_t>(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+   }
+
+
+   std::future<void> ImageWriter::SavePNG(std::shared_ptr<ReadbackFuture> readback, const std::filesystem::path& path) {
+      PKZL_CORE_ASSERT(readback, "ImageWriter::SavePNG() given a null readback!");
+      m_Pending.push_back({.Readback = std::move(readback), .Path = path});
+      return m_Pending.back().Written.get_future();
+   }
+
+
+   void ImageWriter::Update() {
+      PKZL_PROFILE_FUNCTION();
+      auto first = std::stable_partition(m_Pending.begin(), m_Pending.end(), [] (Job& job) { return !job.Readback->IsReady(); });
+      if (first == m_Pending.end()) {
+         return;
+      }
+      {
+         std::lock_guard<std::mutex> lock {m_Mutex};
+         if (!m_Worker.joinable()) {
+            m_IsQuitting = false;
+            m_Worker = std::thread {&ImageWriter::WorkerMain};
+         }
+         std::move(first, m_Pending.end(), std::back_inserter(m_Queue));
+      }
+      m_Pending.erase(first, m_Pending.end());
+      m_WorkAvailable.notify_one();
+   }
+
+
+   void ImageWriter::Shutdown() {
+      for (auto& job : m_Pending) {
+         job.Readback->Wait();
+      }
+      Update();
+      {
+         std::lock_guard<std::mutex> lock {m_Mutex};
+         m_IsQuitting = true;
+      }
+      m_WorkAvailable.notify_all();
+      if (m_Worker.joinable()) {
+         m_Worker.join();
+      }
+   }
+
+
+   void ImageWriter::WorkerMain() {
+      std::unique_lock<std::mutex> lock {m_Mutex};
+      while (true) {
+         m_WorkAvailable.wait(lock, [] { return m_IsQuitting || !m_Queue.empty(); });
+         if (m_Queue.empty()) {
+            // quitting, and everything has been written
+            break;
+         }
+         Job job = std::move(m_Queue.front());
+         m_Queue.pop_front();
+
+         lock.unlock();
+         try {
+            Write(*job.Readback, job.Path);
+            job.Written.set_value();
+         } catch (...) {
+            job.Written.set_exception(std::current_exception());
+         }
+         job.Readback.reset();
+         lock.lock();
+      }
+   }
+
+
+   // Worker thread.  The readback's data has arrived, and the render thread no longer changes it
+   void ImageWriter::Write(const ReadbackFuture& readback, const std::filesystem::path& path) {
+      PKZL_PROFILE_FUNCTION();
+      const std::vector<uint8_t>& data = readback.Get();
+      const size_t texels = static_cast<size_t>(readback.GetWidth()) * readback.GetHeight();
+      if ((texels == 0) || (data.size() < texels * Texture::BPP(readback.GetFormat()))) {
+         throw std::runtime_error {fmt::format("Cannot write '{0}': readback is not of a texture!", path.string())};
+      }
+
+      int channels = 0;
+      std::vector<uint8_t> converted;
+      const uint8_t* pixels = data.data();
+      switch (readback.GetFormat()) {
+         case TextureFormat::R8:
+            channels = 1;
+            break;
+         case TextureFormat::RGB8:
+         case TextureFormat::SRGB8:
+            channels = 3;
+            break;
+         case TextureFormat::RGBA8:
+         case TextureFormat::SRGBA8:
+            channels = 4;
+            break;
+         case TextureFormat::BGRA8:
+            channels = 4;
+            converted.assign(data.begin(), data.begin() + texels * 4);
+            for (size_t i = 0; i < texels; ++i) {
+               std::swap(converted[i * 4], converted[i * 4 + 2]);
+            }
+            pixels = converted.data();
+            break;
+         case TextureFormat::RGBA16F: {
+            channels = 4;
+            converted.resize(texels * 4);
+            const uint16_t* halfs = reinterpret_cast<const uint16_t*>(data.data());
+            for (size_t i = 0; i < texels * 4; ++i) {
+               converted[i] = FloatToUNorm8(glm::unpackHalf1x16(halfs[i]));
+            }
+            pixels = converted.data();
+            break;
+         }
+         case TextureFormat::RGBA32F: {
+            channels = 4;
+            converted.resize(texels * 4);
+            const float* floats = reinterpret_cast<const float*>(data.data());
+            for (size_t i = 0; i < texels * 4; ++i) {
+               converted[i] = FloatToUNorm8(floats[i]);
+            }
+            pixels = converted.data();
+            break;
+         }
+         default:
+            throw std::runtime_error {fmt::format("Cannot write '{0}': texture format is not supported!", path.string())};
+      }
+
+      // only this thread writes images, so the (global) flip setting is not shared with anything
+      stbi_flip_vertically_on_write(1);
+      const int width = static_cast<int>(readback.GetWidth());
+      const int height = static_cast<int>(readback.GetHeight());
+      if (!stbi_write_png(path.string().c_str(), width, height, channels, pixels, width * channels)) {
+         throw std::runtime_error {fmt::format("Failed to write '{0}'!", path.string())};
+      }
+   }
+
+}
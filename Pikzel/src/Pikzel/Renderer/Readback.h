@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Pikzel {
+
+   // Data that is being copied from the GPU to the CPU.  See RenderCore::ReadbackAsync()
+   //
+   // The copy is queued behind whatever the GPU is already doing, into staging memory that the CPU can read, and the CPU carries on
+   // without waiting for it.  The data arrives a frame or two later: poll IsReady() (e.g. once per frame) and then Get() it.
+   // Wait() blocks until the data arrives, which stalls just as Texture::GetData() does.
+   // Render thread only.  Must not outlive RenderCore.
+   class PKZL_API ReadbackFuture {
+   public:
+      using IsCopiedFn = std::function<bool()>;                         // whether the GPU has finished copying.  Must not block
+      using WaitFn = std::function<void()>;                             // block until it has
+      using ReadFn = std::function<void(std::vector<uint8_t>& data)>;   // copy the data out of the staging memory
+
+      // format, width and height describe the data, if it is from a texture
+      ReadbackFuture(IsCopiedFn isCopied, WaitFn wait, ReadFn read, const TextureFormat format = TextureFormat::Undefined, const uint32_t width = 0, const uint32_t height = 0);
+      PKZL_NO_COPYMOVE(ReadbackFuture);
+
+      // true once the data has arrived.  Does not block
+      bool IsReady();
+
+      // The data, or empty if it has not arrived yet
+      const std::vector<uint8_t>& Get() const;
+
+      // Block until the data has arrived
+      const std::vector<uint8_t>& Wait();
+
+      // For data from a texture: the texture's format, and the size of the mip level that was read.
+      // The data is laid out as for Texture::GetData()
+      TextureFormat GetFormat() const;
+      uint32_t GetWidth() const;
+      uint32_t GetHeight() const;
+
+   private:
+      void Read();
+
+   private:
+      IsCopiedFn m_IsCopiedFn;      // released once the data has been read, which gives the staging memory back to the back-end
+      WaitFn m_WaitFn;
+      ReadFn m_ReadFn;
+
+      std::vector<uint8_t> m_Data;
+      TextureFormat m_Format = TextureFormat::Undefined;
+      uint32_t m_Width = 0;
+      uint32_t m_Height = 0;
+      bool m_IsReady = false;
+   };
+
+
+   // Writes texture readbacks to image files on a worker thread, so that encoding them (e.g. screenshots) does not hold up rendering.
+   class PKZL_API ImageWriter {
+      ImageWriter() = delete;
+      PKZL_NO_COPYMOVE(ImageWriter);
+
+   public:
+      // Write the first layer of readback to path as a PNG, once its data has arrived.  Returns straight away.
+      // Formats with 8-bit components are written as is.  Floating point RGBA is clamped to [0, 1] first.  Other formats are not supported.
+      // Texture row 0 is the bottom of the image (as for textures that Pikzel loads), so the rows are written bottom-up.
+      // The returned future is ready once the file has been written, and rethrows if it could not be.
+      static std::future<void> SavePNG(std::shared_ptr<ReadbackFuture> readback, const std::filesystem::path& path);
+
+      // Hand readbacks whose data has arrived to the worker.  Called once per frame by Application
+      static void Update();
+
+      // Wait for pending readbacks to arrive, and for the worker to write them.  Called by Application on exit
+      static void Shutdown();
+
+   private:
+      struct Job {
+         std::shared_ptr<ReadbackFuture> Readback;
+         std::filesystem::path Path;
+         std::promise<void> Written;
+      };
+
+      static void WorkerMain();
+      static void Write(const ReadbackFuture& readback, const std::filesystem::path& path);
+
+   private:
+      inline static std::vector<Job> m_Pending;          // waiting for their data.  Render thread only
+      inline static std::deque<Job> m_Queue;             // data has arrived, waiting for the worker.  Guarded by m_Mutex
+      inline static std::thread m_Worker;
+      inline static std::mutex m_Mutex;
+      inline static std::condition_variable m_WorkAvailable;
+      inline static bool m_IsQuitting = false;           // guarded by m_Mutex
+   };
+
+}
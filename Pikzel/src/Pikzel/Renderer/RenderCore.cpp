@@ -130,6 +130,11 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<IndexBuffer> RenderCore::CreateIndexBuffer(const uint32_t count, const uint16_t* indices) {
+      return s_RenderCore->CreateIndexBuffer(count, indices);
+   }
+
+
    std::unique_ptr<Pikzel::UniformBuffer> RenderCore::CreateUniformBuffer(const uint32_t size) {
       return s_RenderCore->CreateUniformBuffer(size);
    }
@@ -140,6 +145,16 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<Pikzel::StorageBuffer> RenderCore::CreateStorageBuffer(const uint32_t size) {
+      return s_RenderCore->CreateStorageBuffer(size);
+   }
+
+
+   std::unique_ptr<Pikzel::StorageBuffer> RenderCore::CreateStorageBuffer(const uint32_t size, const void* data) {
+      return s_RenderCore->CreateStorageBuffer(size, data);
+   }
+
+
    std::unique_ptr<Pikzel::Framebuffer> RenderCore::CreateFramebuffer(const FramebufferSettings& settings) {
       if(!(
          (settings.msaaNumSamples == 1) ||
@@ -157,4 +172,19 @@ namespace Pikzel {
       return s_RenderCore->CreateTexture(settings);
    }
 
+
+   MemoryBudget RenderCore::GetMemoryBudget() {
+      return s_RenderCore->GetMemoryBudget();
+   }
+
+
+   std::shared_ptr<ReadbackFuture> RenderCore::ReadbackAsync(const Texture& texture, const uint32_t mipLevel) {
+      return s_RenderCore->ReadbackAsync(texture, mipLevel);
+   }
+
+
+   std::shared_ptr<ReadbackFuture> RenderCore::ReadbackAsync(const StorageBuffer& buffer, const uint64_t offset, const uint64_t size) {
+      return s_RenderCore->ReadbackAsync(buffer, offset, size);
+   }
+
 }
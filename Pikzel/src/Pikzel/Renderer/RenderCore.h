@@ -5,6 +5,7 @@
 #include "ComputeContext.h"
 #include "GraphicsContext.h"
 #include "Pipeline.h"
+#include "Readback.h"
 #include "Texture.h"
 #include "Pikzel/Core/Window.h"
 
@@ -16,6 +17,13 @@
 
 namespace Pikzel {
 
+   // GPU memory, as reported by the device (all values in bytes)
+   struct PKZL_API MemoryBudget {
+      uint64_t Budget = 0;   // how much memory the application can use (0 = not known)
+      uint64_t Usage = 0;    // how much memory the application is using (0 = not known)
+   };
+
+
    struct PKZL_API IRenderCore {
       virtual ~IRenderCore() = default;
 
@@ -30,14 +38,23 @@ namespace Pikzel {
       virtual std::unique_ptr<VertexBuffer> CreateVertexBuffer(const BufferLayout& layout, const uint32_t size, const void* data) = 0;
 
       virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint32_t* indices) = 0;
+      virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint16_t* indices) = 0;
 
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size) = 0;
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size, const void* data) = 0;
 
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size) = 0;
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size, const void* data) = 0;
+
       virtual std::unique_ptr<Framebuffer> CreateFramebuffer(const FramebufferSettings& settings) = 0;
 
       virtual std::unique_ptr<Texture> CreateTexture(const TextureSettings& settings) = 0;
 
+      virtual MemoryBudget GetMemoryBudget() const = 0;
+
+      virtual std::shared_ptr<ReadbackFuture> ReadbackAsync(const Texture& texture, const uint32_t mipLevel) = 0;
+      virtual std::shared_ptr<ReadbackFuture> ReadbackAsync(const StorageBuffer& buffer, const uint64_t offset, const uint64_t size) = 0;
+
    };
 
 
@@ -63,9 +80,17 @@ namespace Pikzel {
 
       static void UploadImGuiFonts();
 
-      static const uint32_t ShadowMapWidth = 4096;
-      static const uint32_t ShadowMapHeight = 4096;
-      static const uint32_t MaxPointLights = 32;
+      // Cascaded shadow maps for directional lights.  Each cascade is a layer of a Texture2DArray
+      static const uint32_t MaxShadowCascades = 4;
+      static const uint32_t ShadowCascadeSize = 2048;
+
+      // Clustered lighting.  See Renderer/Shaders/LightClusters.comp
+      static const uint32_t MaxPointLights = 4096;
+      static const uint32_t LightClustersX = 16;
+      static const uint32_t LightClustersY = 9;
+      static const uint32_t LightClustersZ = 24;
+      static const uint32_t NumLightClusters = LightClustersX * LightClustersY * LightClustersZ;
+      static const uint32_t MaxLightIndices = NumLightClusters * 64;  // room for an average of 64 lights per cluster
 
       static void SetViewport(const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height);
 
@@ -76,14 +101,32 @@ namespace Pikzel {
       static std::unique_ptr<VertexBuffer> CreateVertexBuffer(const BufferLayout& layout, const uint32_t size, const void* data);
 
       static std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint32_t* indices);
+      static std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint16_t* indices);
 
       static std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size);
       static std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size, const void* data);
 
+      static std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size);
+      static std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size, const void* data);
+
       static std::unique_ptr<Framebuffer> CreateFramebuffer(const FramebufferSettings& settings = {});
 
       static std::unique_ptr<Texture> CreateTexture(const TextureSettings& settings = {});
 
+      // Device local (i.e. video) memory budget and usage.
+      // Vulkan reports these via VK_EXT_memory_budget (where the driver supports it).
+      // OpenGL has no standard way to ask, so these are estimated from GL_NVX_gpu_memory_info or GL_ATI_meminfo where available.
+      // Values are 0 when they cannot be determined.
+      static MemoryBudget GetMemoryBudget();
+
+      // Copy one mip level of texture (as for Texture::GetData()), or size bytes of buffer from offset, to the CPU without waiting for
+      // the GPU.  The copy happens after the work that has already been submitted (e.g. call this after the EndFrame() that draws
+      // texture).  The data arrives a frame or two later (see ReadbackFuture).
+      // Staging memory for the copies is kept and reused from one readback to the next.
+      // For uncompressed texture formats only.
+      static std::shared_ptr<ReadbackFuture> ReadbackAsync(const Texture& texture, const uint32_t mipLevel = 0);
+      static std::shared_ptr<ReadbackFuture> ReadbackAsync(const StorageBuffer& buffer, const uint64_t offset, const uint64_t size);
+
    private:
       inline static API s_API = API::Undefined;
       inline static std::unique_ptr<IRenderCore> s_RenderCore;
@@ -0,0 +1,301 @@
+#include "RenderGraph.h"
+
+#include "RenderCore.h"
+
+#include <algorithm>
+#include <set>
+
+namespace Pikzel {
+
+   static bool IsSameSettings(const FramebufferSettings& a, const FramebufferSettings& b) {
+      return (a.width == b.width) && (a.height == b.height) && IsSameButSize(a, b);
+   }
+
+
+   void RenderGraph::Reset() {
+      m_Targets.clear();
+      m_Passes.clear();
+      m_Order.clear();
+      m_IsCompiled = false;
+   }
+
+
+   RenderGraphTarget RenderGraph::CreateTarget(const std::string& name, const FramebufferSettings& settings) {
+      m_Targets.push_back({.Name = name, .Settings = settings, .IsTransient = true});
+      m_IsCompiled = false;
+      return static_cast<RenderGraphTarget>(m_Targets.size() - 1);
+   }
+
+
+   RenderGraphTarget RenderGraph::ImportTarget(const std::string& name, Framebuffer& framebuffer) {
+      m_Targets.push_back({.Name = name, .Physical = &framebuffer, .IsOutput = true});
+      m_IsCompiled = false;
+      return static_cast<RenderGraphTarget>(m_Targets.size() - 1);
+   }
+
+
+   RenderGraphTarget RenderGraph::ImportTarget(const std::string& name, GraphicsContext& gc) {
+      m_Targets.push_back({.Name = name, .GC = &gc, .IsOutput = true});
+      m_IsCompiled = false;
+      return static_cast<RenderGraphTarget>(m_Targets.size() - 1);
+   }
+
+
+   void RenderGraph::AddPass(const std::string& name, const RenderPassSettings& settings, ExecuteFn execute) {
+      PKZL_CORE_ASSERT(settings.target < m_Targets.size(), "RenderGraph pass '{0}' draws to a target that does not exist!", name);
+      m_Passes.push_back({.Name = name, .Settings = settings, .Execute = std::move(execute)});
+      m_IsCompiled = false;
+   }
+
+
+   void RenderGraph::SetOutput(const RenderGraphTarget target) {
+      PKZL_CORE_ASSERT(target < m_Targets.size(), "RenderGraph::SetOutput() given a target that does not exist!");
+      m_Targets[target].IsOutput = true;
+      m_IsCompiled = false;
+   }
+
+
+   void RenderGraph::Compile() {
+      PKZL_PROFILE_FUNCTION();
+
+      const uint32_t numPasses = static_cast<uint32_t>(m_Passes.size());
+      const uint32_t numTargets = static_cast<uint32_t>(m_Targets.size());
+
+      std::vector<std::vector<uint32_t>> writers(numTargets);
+      for (uint32_t pass = 0; pass < numPasses; ++pass) {
+         writers[m_Passes[pass].Settings.target].push_back(pass);
+      }
+
+      // Each pass must run after the passes in its data dependencies (the ones that draw what it uses), and also after the passes in
+      // its order dependencies (ones that read what it is about to draw over).  Only data dependencies keep passes from being culled.
+      std::vector<std::vector<uint32_t>> dataDependencies(numPasses);
+      std::vector<std::vector<uint32_t>> orderDependencies(numPasses);
+      for (const auto& targetWriters : writers) {
+         for (size_t i = 1; i < targetWriters.size(); ++i) {
+            dataDependencies[targetWriters[i]].push_back(targetWriters[i - 1]);
+         }
+      }
+      for (uint32_t pass = 0; pass < numPasses; ++pass) {
+         for (const auto target : m_Passes[pass].Settings.reads) {
+            PKZL_CORE_ASSERT(target < numTargets, "RenderGraph pass '{0}' reads a target that does not exist!", m_Passes[pass].Name);
+            if (target == m_Passes[pass].Settings.target) {
+               throw std::runtime_error {fmt::format("RenderGraph pass '{0}' reads the target that it draws to!", m_Passes[pass].Name)};
+            }
+            const auto& targetWriters = writers[target];
+            const auto next = std::upper_bound(targetWriters.begin(), targetWriters.end(), pass);
+            if (next != targetWriters.begin()) {
+               dataDependencies[pass].push_back(*(next - 1));
+               if (next != targetWriters.end()) {
+                  orderDependencies[*next].push_back(pass);
+               }
+            } else if (!targetWriters.empty()) {
+               dataDependencies[pass].push_back(targetWriters.back());
+            } else if (m_Targets[target].IsTransient) {
+               throw std::runtime_error {fmt::format("RenderGraph pass '{0}' reads target '{1}', which nothing draws to!", m_Passes[pass].Name, m_Targets[target].Name)};
+            }
+         }
+      }
+
+      // cull passes that no output depends on
+      std::vector<bool> isLive(numPasses, false);
+      std::vector<uint32_t> stack;
+      for (uint32_t pass = 0; pass < numPasses; ++pass) {
+         if (m_Targets[m_Passes[pass].Settings.target].IsOutput) {
+            isLive[pass] = true;
+            stack.push_back(pass);
+         }
+      }
+      while (!stack.empty()) {
+         const uint32_t pass = stack.back();
+         stack.pop_back();
+         for (const auto dependency : dataDependencies[pass]) {
+            if (!isLive[dependency]) {
+               isLive[dependency] = true;
+               stack.push_back(dependency);
+            }
+         }
+      }
+
+      // order the passes that are left.  Where there is a choice, passes run in the order they were added
+      std::vector<std::vector<uint32_t>> dependents(numPasses);
+      std::vector<uint32_t> numDependencies(numPasses, 0);
+      for (uint32_t pass = 0; pass < numPasses; ++pass) {
+         if (!isLive[pass]) {
+            continue;
+         }
+         for (const auto* dependencies : {&dataDependencies[pass], &orderDependencies[pass]}) {
+            for (const auto dependency : *dependencies) {
+               if (isLive[dependency]) {
+                  dependents[dependency].push_back(pass);
+                  ++numDependencies[pass];
+               }
+            }
+         }
+      }
+      std::set<uint32_t> ready;
+      for (uint32_t pass = 0; pass < numPasses; ++pass) {
+         if (isLive[pass] && (numDependencies[pass] == 0)) {
+            ready.insert(pass);
+         }
+      }
+      m_Order.clear();
+      while (!ready.empty()) {
+         const uint32_t pass = *ready.begin();
+         ready.erase(ready.begin());
+         m_Order.push_back(pass);
+         for (const auto dependent : dependents[pass]) {
+            if (--numDependencies[dependent] == 0) {
+               ready.insert(dependent);
+            }
+         }
+      }
+      const uint32_t numLive = static_cast<uint32_t>(std::count(isLive.begin(), isLive.end(), true));
+      if (m_Order.size() != numLive) {
+         m_Order.clear();
+         throw std::runtime_error {"RenderGraph passes have cyclic dependencies!"};
+      }
+
+      // lifetimes of the transient targets, as [first, last] positions in m_Order.  Targets that are used after the graph has been
+      // executed (outputs, and anything read by a pass that draws to an imported graphics context, as that is only submitted later on)
+      // live until the end.
+      constexpr uint32_t unused = ~0u;
+      std::vector<uint32_t> firstUse(numTargets, unused);
+      std::vector<uint32_t> lastUse(numTargets, 0);
+      const uint32_t end = static_cast<uint32_t>(m_Order.size());
+      for (auto& target : m_Targets) {
+         target.IsDepthSampled = target.IsOutput;
+      }
+      for (uint32_t position = 0; position < end; ++position) {
+         const Pass& pass = m_Passes[m_Order[position]];
+         const bool isDeferred = m_Targets[pass.Settings.target].GC != nullptr;
+         firstUse[pass.Settings.target] = std::min(firstUse[pass.Settings.target], position);
+         lastUse[pass.Settings.target] = std::max(lastUse[pass.Settings.target], position);
+         for (const auto target : pass.Settings.reads) {
+            firstUse[target] = std::min(firstUse[target], position);
+            lastUse[target] = std::max(lastUse[target], isDeferred ? end : position);
+            m_Targets[target].IsDepthSampled = true;
+         }
+      }
+
+      // alias transient targets onto as few framebuffers as possible.  Each target goes into the first framebuffer with the same
+      // settings that is free by the time the target is first used.
+      struct Slot {
+         const FramebufferSettings* Settings;
+         uint32_t LastUse;
+         std::vector<RenderGraphTarget> Targets;
+      };
+      std::vector<RenderGraphTarget> transients;
+      for (RenderGraphTarget target = 0; target < numTargets; ++target) {
+         if (m_Targets[target].IsTransient) {
+            m_Targets[target].Physical = nullptr;
+            if (firstUse[target] != unused) {
+               if (m_Targets[target].IsOutput) {
+                  lastUse[target] = end;
+               }
+               transients.push_back(target);
+            }
+         }
+      }
+      std::stable_sort(transients.begin(), transients.end(), [&firstUse] (const RenderGraphTarget a, const RenderGraphTarget b) {
+         return firstUse[a] < firstUse[b];
+      });
+
+      m_Stats = {};
+      std::vector<Slot> slots;
+      for (const auto target : transients) {
+         const FramebufferSettings& settings = m_Targets[target].Settings;
+         auto slot = std::find_if(slots.begin(), slots.end(), [&] (const Slot& slot) {
+            return (slot.LastUse < firstUse[target]) && IsSameSettings(*slot.Settings, settings);
+         });
+         if (slot == slots.end()) {
+            slots.push_back({.Settings = &settings});
+            slot = slots.end() - 1;
+            m_Stats.TransientBytesAliased += GetEstimatedBytes(settings);
+         }
+         slot->LastUse = lastUse[target];
+         slot->Targets.push_back(target);
+         m_Stats.TransientBytes += GetEstimatedBytes(settings);
+      }
+
+      // Framebuffers from the previous Compile() are re-used where the settings match.  The rest are destroyed.
+      // (framebuffers hold on to their GPU resources until the GPU has finished with them, so there is no need to wait here)
+      std::vector<PooledFramebuffer> framebuffers;
+      for (const auto& slot : slots) {
+         auto pooled = std::find_if(m_Framebuffers.begin(), m_Framebuffers.end(), [&slot] (const PooledFramebuffer& pooled) {
+            return pooled.Physical && IsSameSettings(pooled.Settings, *slot.Settings);
+         });
+         if (pooled != m_Framebuffers.end()) {
+            framebuffers.push_back(std::move(*pooled));
+         } else {
+            framebuffers.push_back({.Settings = *slot.Settings, .Physical = RenderCore::CreateFramebuffer(*slot.Settings)});
+         }
+         for (const auto target : slot.Targets) {
+            m_Targets[target].Physical = framebuffers.back().Physical.get();
+         }
+      }
+      m_Framebuffers = std::move(framebuffers);
+
+      // frames still in flight from the previous Execute() only matter if their framebuffer is still in the graph
+      std::erase_if(m_Pending, [this] (const Framebuffer* pending) {
+         return std::none_of(m_Targets.begin(), m_Targets.end(), [pending] (const Target& target) { return target.Physical == pending; });
+      });
+
+      m_Stats.Passes = static_cast<uint32_t>(m_Order.size());
+      m_Stats.PassesCulled = numPasses - m_Stats.Passes;
+      m_Stats.TransientTargets = static_cast<uint32_t>(transients.size());
+      m_Stats.Framebuffers = static_cast<uint32_t>(m_Framebuffers.size());
+      m_IsCompiled = true;
+   }
+
+
+   void RenderGraph::Execute() {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(m_IsCompiled, "RenderGraph::Execute() called before Compile()!");
+
+      // Passes are submitted in execution order, and each framebuffer's frame synchronizes (on the GPU) with the work submitted
+      // before and after it: it does not draw over its attachments until earlier reads of them have finished, and what it draws is
+      // made visible to (and transitioned for) later reads.  So the only waiting done here is on the CPU, before a framebuffer's
+      // graphics context records a frame while its previous one has not finished (it has the one command buffer to record into).
+      // Frames from the previous Execute() are waited for (if need be) when their framebuffer is next drawn to.
+      m_Stats.Stalls = 0;
+      std::vector<Framebuffer*> submitted;
+      for (const auto passIndex : m_Order) {
+         const Pass& pass = m_Passes[passIndex];
+         const Target& target = m_Targets[pass.Settings.target];
+         if (!target.Physical) {
+            pass.Execute(*target.GC);
+            continue;
+         }
+
+         GraphicsContext& gc = target.Physical->GetGraphicsContext();
+         if (auto pending = std::find(m_Pending.begin(), m_Pending.end(), target.Physical); pending != m_Pending.end()) {
+            gc.SwapBuffers();
+            m_Pending.erase(pending);
+            if (std::find(submitted.begin(), submitted.end(), target.Physical) != submitted.end()) {
+               ++m_Stats.Stalls;
+            }
+         }
+         if (target.IsTransient) {
+            gc.SetDepthSampled(target.IsDepthSampled);
+         }
+         gc.BeginFrame(pass.Settings.beginFrameOp);
+         pass.Execute(gc);
+         gc.EndFrame();
+         submitted.push_back(target.Physical);
+         m_Pending.push_back(target.Physical);
+      }
+   }
+
+
+   Framebuffer& RenderGraph::GetFramebuffer(const RenderGraphTarget target) const {
+      PKZL_CORE_ASSERT(target < m_Targets.size(), "RenderGraph::GetFramebuffer() given a target that does not exist!");
+      PKZL_CORE_ASSERT(m_Targets[target].Physical, "RenderGraph target '{0}' does not have a framebuffer (is the graph compiled?)", m_Targets[target].Name);
+      return *m_Targets[target].Physical;
+   }
+
+
+   const RenderGraphStats& RenderGraph::GetStats() const {
+      return m_Stats;
+   }
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Framebuffer.h"
+#include "GraphicsContext.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Pikzel {
+
+   // A render target in a RenderGraph.  See RenderGraph::CreateTarget() and RenderGraph::ImportTarget()
+   using RenderGraphTarget = uint32_t;
+
+
+   struct PKZL_API RenderPassSettings {
+      RenderGraphTarget target = 0;                   // what the pass draws to
+      std::vector<RenderGraphTarget> reads;           // targets whose attachments the pass samples
+      BeginFrameOp beginFrameOp = BeginFrameOp::ClearAll;
+   };
+
+
+   // See RenderGraph::GetStats()
+   struct PKZL_API RenderGraphStats {
+      uint32_t Passes = 0;                   // passes that are executed
+      uint32_t PassesCulled = 0;             // passes that are not, as nothing uses what they draw
+      uint32_t TransientTargets = 0;         // render targets created by the graph (and used by a pass that is executed)
+      uint32_t Framebuffers = 0;             // framebuffers that the transient targets are aliased onto
+      uint32_t Stalls = 0;                   // times (in the most recent Execute()) the CPU had to wait for a framebuffer's earlier frame to finish before a pass could draw to it again
+      uint64_t TransientBytes = 0;           // GPU memory the transient targets would use if each had a framebuffer of its own (estimated from their settings)
+      uint64_t TransientBytesAliased = 0;    // GPU memory they do use
+   };
+
+
+   // Orders and runs the render passes of a frame.
+   //
+   // Each pass declares the render target it draws to, and the render targets it reads (samples from).  Reading a target
+   // gets what the passes added before the reader drew to it (or if there are none, what all of the passes that draw to it drew).
+   // Passes that draw to the same target run in the order they were added.  From that, Compile():
+   // - orders the passes, so that each runs after the passes that draw what it reads
+   // - culls passes that do not contribute to an output (imported targets are always outputs)
+   // - works out the lifetime of each transient target, and aliases transient targets with identical settings and lifetimes
+   //   that do not overlap onto the same framebuffer.  Aliasing is of whole framebuffers: targets whose settings differ at all
+   //   (size, formats, samples, ...) never share memory, as the backends allocate each framebuffer's attachments separately.
+   //
+   // Execute() then begins and ends the frame of each pass's framebuffer, in execution order, and tells each framebuffer whether its
+   // depth attachment needs transitioning for shader reads.  The barriers between passes are on the GPU: each framebuffer's render pass
+   // waits for earlier work to finish sampling its attachments before drawing over them, and makes what it draws visible (and transitions
+   // it) for later work that samples it.  These cover every kind of pass a graph can declare (draw to one target, sample others), but
+   // are not narrowed to the particular reads and writes of each pass.  The CPU waits only when a pass draws to a framebuffer whose
+   // previous frame is still in flight (a framebuffer's graphics context records one frame at a time).  Frames are left in flight when
+   // Execute() returns: their results can be used by work submitted afterwards, but call SwapBuffers() on an imported framebuffer
+   // before drawing to it outside the graph.
+   // Passes that draw to an imported graphics context (e.g. the window) are executed without beginning or ending its frame: that is up
+   // to the context's owner.
+   //
+   // The graph can be rebuilt every frame (Reset(), add targets and passes, Compile(), Execute()).  Framebuffers are kept from one
+   // Compile() to the next if they are still needed.
+   class PKZL_API RenderGraph {
+   public:
+      // Draws a pass.  BeginFrame() has already been called on gc, and EndFrame() will be called afterwards
+      using ExecuteFn = std::function<void(GraphicsContext& gc)>;
+
+      RenderGraph() = default;
+      PKZL_NO_COPYMOVE(RenderGraph);
+
+      // Remove all targets and passes
+      void Reset();
+
+      // A render target that only lives for the frame.  Its framebuffer is created by Compile(), and may be shared with
+      // other transient targets.  So the first pass that draws to it should clear it.
+      RenderGraphTarget CreateTarget(const std::string& name, const FramebufferSettings& settings);
+
+      // A render target whose contents live on outside the graph
+      RenderGraphTarget ImportTarget(const std::string& name, Framebuffer& framebuffer);
+      RenderGraphTarget ImportTarget(const std::string& name, GraphicsContext& gc);
+
+      void AddPass(const std::string& name, const RenderPassSettings& settings, ExecuteFn execute);
+
+      // Keep passes that draw to target (and the passes they depend on) from being culled, and keep target's framebuffer
+      // from being aliased, so that it can be used after Execute()
+      void SetOutput(const RenderGraphTarget target);
+
+      // Throws if the passes' dependencies are cyclic, or a pass reads a transient target that nothing draws to
+      void Compile();
+      void Execute();
+
+      // The framebuffer of a transient (after Compile()) or imported target
+      Framebuffer& GetFramebuffer(const RenderGraphTarget target) const;
+
+      const RenderGraphStats& GetStats() const;
+
+   private:
+      struct Target {
+         std::string Name;
+         FramebufferSettings Settings;          // transient targets only
+         Framebuffer* Physical = nullptr;       // imported, or the one the transient target is aliased onto
+         GraphicsContext* GC = nullptr;         // imported graphics context
+         bool IsTransient = false;
+         bool IsOutput = false;
+         bool IsDepthSampled = false;           // a pass that is executed reads the target
+      };
+
+      struct Pass {
+         std::string Name;
+         RenderPassSettings Settings;
+         ExecuteFn Execute;
+      };
+
+      struct PooledFramebuffer {
+         FramebufferSettings Settings;
+         std::unique_ptr<Framebuffer> Physical;
+      };
+
+   private:
+      std::vector<Target> m_Targets;
+      std::vector<Pass> m_Passes;
+      std::vector<uint32_t> m_Order;                     // indices into m_Passes of the passes to execute, in execution order
+      std::vector<PooledFramebuffer> m_Framebuffers;     // of the transient targets
+      std::vector<Framebuffer*> m_Pending;               // framebuffers whose most recent frame has been submitted, but not waited for
+      RenderGraphStats m_Stats;
+      bool m_IsCompiled = false;
+   };
+
+}
@@ -0,0 +1,295 @@
+#include "ShaderReloader.h"
+
+#include "Pikzel/Core/Hash.h"
+#include "Pikzel/Core/Utility.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+
+namespace Pikzel {
+
+   // How often the worker thread looks for changed shader sources
+   static const std::chrono::milliseconds PollInterval {500};
+
+
+   // What the build says about one compiled shader (from its ".source" file), and when its sources were last modified
+   struct WatchedShader {
+      std::filesystem::path Compiler;
+      std::filesystem::path Source;
+      std::vector<std::filesystem::path> Headers;
+      std::vector<std::filesystem::file_time_type> WriteTimes;  // of Source, then each of Headers
+      bool IsWatchable = false;
+   };
+
+
+   static std::filesystem::file_time_type GetWriteTime(const std::filesystem::path& path) {
+      std::error_code error;
+      const auto time = std::filesystem::last_write_time(path, error);
+      return error ? std::filesystem::file_time_type {} : time;
+   }
+
+
+   static WatchedShader Watch(const std::filesystem::path& path) {
+      WatchedShader shader;
+      std::vector<char> info;
+      try {
+         info = ReadFile<char>(path.string() + ".source");
+      } catch (const std::exception&) {
+         // No source information (e.g. a shader that was not built by compile_shaders()).  It is used as is
+         return shader;
+      }
+
+      std::istringstream lines {std::string {info.begin(), info.end()}};
+      std::string line;
+      std::getline(lines, line);
+      shader.Compiler = line;
+      std::getline(lines, line);
+      shader.Source = line;
+      while (std::getline(lines, line)) {
+         if (!line.empty()) {
+            shader.Headers.emplace_back(line);
+         }
+      }
+      shader.WriteTimes.push_back(GetWriteTime(shader.Source));
+      for (const auto& header : shader.Headers) {
+         shader.WriteTimes.push_back(GetWriteTime(header));
+      }
+      shader.IsWatchable = !shader.Compiler.empty() && std::filesystem::exists(shader.Source);
+      return shader;
+   }
+
+
+   // true if the shader's source, or any of its headers, has been written to since last time
+   static bool IsModified(WatchedShader& shader) {
+      bool isModified = false;
+      const auto check = [&isModified](const std::filesystem::path& path, std::filesystem::file_time_type& writeTime) {
+         const auto time = GetWriteTime(path);
+         if (time != writeTime) {
+            writeTime = time;
+            isModified = true;
+         }
+      };
+      check(shader.Source, shader.WriteTimes[0]);
+      for (size_t i = 0; i < shader.Headers.size(); ++i) {
+         check(shader.Headers[i], shader.WriteTimes[i + 1]);
+      }
+      return isModified;
+   }
+
+
+   // Compile in the same way as compile_shaders() in CMakeUtils.cmake does.
+   // Returns success, and fills in either spirv or the compiler's output
+   static bool Compile(const WatchedShader& shader, std::vector<uint32_t>& spirv, std::string& message) {
+      const std::string name = shader.Source.string();
+      const std::filesystem::path stem = std::filesystem::temp_directory_path() / fmt::format("pikzel-{0:016x}", Hash64(name.data(), name.size()));
+      const std::filesystem::path output = stem.string() + ".spv";
+      const std::filesystem::path log = stem.string() + ".log";
+
+      // each header's directory is on the include path
+      std::string includes;
+      std::vector<std::filesystem::path> includeDirs;
+      for (const auto& header : shader.Headers) {
+         const std::filesystem::path dir = header.parent_path();
+         if (std::find(includeDirs.begin(), includeDirs.end(), dir) == includeDirs.end()) {
+            includeDirs.push_back(dir);
+            includes += fmt::format("\"-I{0}\" ", dir.string());
+         }
+      }
+
+      std::string command = fmt::format("\"{0}\" --target-env vulkan1.2 {1}\"{2}\" -o \"{3}\" > \"{4}\" 2>&1", shader.Compiler.string(), includes, shader.Source.string(), output.string(), log.string());
+#if defined(PKZL_PLATFORM_WINDOWS)
+      // cmd.exe strips the outermost quotes from the command
+      command = fmt::format("\"{0}\"", command);
+#endif
+
+      std::error_code error;
+      std::filesystem::remove(output, error);
+      const int result = std::system(command.c_str());
+
+      std::ifstream logFile {log};
+      message.assign(std::istreambuf_iterator<char> {logFile}, std::istreambuf_iterator<char> {});
+      logFile.close();
+      std::filesystem::remove(log, error);
+
+      if ((result != 0) || !std::filesystem::exists(output)) {
+         if (message.empty()) {
+            message = fmt::format("Could not run shader compiler '{0}'", shader.Compiler.string());
+         }
+         return false;
+      }
+      spirv = ReadFile<uint32_t>(output);
+      std::filesystem::remove(output, error);
+      return true;
+   }
+
+
+   void ShaderReloader::SetEnabled(const bool isEnabled) {
+      if (isEnabled == IsEnabled()) {
+         return;
+      }
+      if (isEnabled) {
+         m_IsQuitting = false;
+         m_Worker = std::thread {&ShaderReloader::WorkerMain};
+      } else {
+         {
+            std::lock_guard<std::mutex> lock {m_Mutex};
+            m_IsQuitting = true;
+         }
+         m_WakeUp.notify_all();
+         m_Worker.join();
+      }
+   }
+
+
+   bool ShaderReloader::IsEnabled() {
+      return m_Worker.joinable();
+   }
+
+
+   void ShaderReloader::Update() {
+      PKZL_PROFILE_FUNCTION();
+
+      std::vector<CompileResult> results;
+      {
+         std::lock_guard<std::mutex> lock {m_Mutex};
+         std::swap(results, m_Results);
+      }
+
+      for (auto& result : results) {
+         const std::string key = result.Path.generic_string();
+         if (!result.IsSuccess) {
+            PKZL_CORE_LOG_ERROR("Shader '{0}' failed to compile:\n{1}", result.Path.string(), result.Message);
+            std::lock_guard<std::mutex> lock {m_Mutex};
+            m_Errors[key] = {result.Path, std::move(result.Message)};
+            continue;
+         }
+
+         // Swap in the new SPIR-V, and find the pipelines that use it.
+         // The pipelines are rebuilt without holding the lock, as creating a pipeline registers it
+         std::vector<Pipeline*> pipelines;
+         std::vector<uint32_t> previous;
+         bool hadPrevious = false;
+         {
+            std::lock_guard<std::mutex> lock {m_Mutex};
+            if (auto spirv = m_SPIRV.find(key); spirv != m_SPIRV.end()) {
+               previous = std::move(spirv->second);
+               hadPrevious = true;
+            }
+            m_SPIRV[key] = std::move(result.SPIRV);
+            for (const auto pipeline : m_Pipelines) {
+               for (const auto& [type, path] : pipeline->GetShaders()) {
+                  if (path.generic_string() == key) {
+                     pipelines.push_back(pipeline);
+                     break;
+                  }
+               }
+            }
+         }
+
+         std::string failure;
+         for (const auto pipeline : pipelines) {
+            try {
+               pipeline->Reload();
+            } catch (const std::exception& err) {
+               failure = err.what();
+            }
+         }
+
+         std::lock_guard<std::mutex> lock {m_Mutex};
+         if (failure.empty()) {
+            PKZL_CORE_LOG_INFO("Reloaded shader '{0}' ({1} pipelines)", result.Path.string(), pipelines.size());
+            m_Errors.erase(key);
+         } else {
+            // Pipelines that could not be rebuilt still have the old shader, so pipelines created from now on should too
+            PKZL_CORE_LOG_ERROR("Shader '{0}' compiled, but pipelines could not be rebuilt with it: {1}", result.Path.string(), failure);
+            if (hadPrevious) {
+               m_SPIRV[key] = std::move(previous);
+            } else {
+               m_SPIRV.erase(key);
+            }
+            m_Errors[key] = {result.Path, std::move(failure)};
+         }
+      }
+   }
+
+
+   std::vector<uint32_t> ShaderReloader::ReadSPIRV(const std::filesystem::path& path) {
+      {
+         std::lock_guard<std::mutex> lock {m_Mutex};
+         if (auto spirv = m_SPIRV.find(path.generic_string()); spirv != m_SPIRV.end()) {
+            return spirv->second;
+         }
+      }
+      return ReadFile<uint32_t>(path);
+   }
+
+
+   std::vector<ShaderReloadError> ShaderReloader::GetErrors() {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      std::vector<ShaderReloadError> errors;
+      errors.reserve(m_Errors.size());
+      for (const auto& [key, error] : m_Errors) {
+         errors.push_back(error);
+      }
+      return errors;
+   }
+
+
+   void ShaderReloader::Register(Pipeline& pipeline) {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      m_Pipelines.insert(&pipeline);
+   }
+
+
+   void ShaderReloader::Unregister(Pipeline& pipeline) {
+      std::lock_guard<std::mutex> lock {m_Mutex};
+      m_Pipelines.erase(&pipeline);
+   }
+
+
+   void ShaderReloader::WorkerMain() {
+      std::unordered_map<std::string, WatchedShader> shaders;  // worker thread only
+
+      std::unique_lock<std::mutex> lock {m_Mutex};
+      while (!m_WakeUp.wait_for(lock, PollInterval, [] { return m_IsQuitting; })) {
+
+         // Shaders that are in use right now.  (pipelines cannot be destroyed while the lock is held)
+         std::unordered_set<std::string> paths;
+         for (const auto pipeline : m_Pipelines) {
+            for (const auto& [type, path] : pipeline->GetShaders()) {
+               paths.insert(path.generic_string());
+            }
+         }
+         lock.unlock();
+
+         for (const auto& path : paths) {
+            auto shader = shaders.find(path);
+            if (shader == shaders.end()) {
+               shaders.emplace(path, Watch(path));
+               continue;
+            }
+            if (!shader->second.IsWatchable || !IsModified(shader->second)) {
+               continue;
+            }
+
+            PKZL_CORE_LOG_INFO("Recompiling shader '{0}'", shader->second.Source.string());
+            CompileResult result {.Path = path, .SPIRV = {}, .Message = {}, .IsSuccess = false};
+            try {
+               result.IsSuccess = Compile(shader->second, result.SPIRV, result.Message);
+            } catch (const std::exception& err) {
+               result.Message = err.what();
+            }
+            std::lock_guard<std::mutex> resultLock {m_Mutex};
+            m_Results.emplace_back(std::move(result));
+         }
+
+         lock.lock();
+      }
+   }
+
+}
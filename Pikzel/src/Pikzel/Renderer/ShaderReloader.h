@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Pipeline.h"
+
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Pikzel {
+
+   struct PKZL_API ShaderReloadError {
+      std::filesystem::path Path;   // the compiled shader, as named in PipelineSettings
+      std::string Message;          // compiler output (or why the pipeline could not be rebuilt)
+   };
+
+
+   // Shader hot reload.
+   //
+   // The build writes a "<shader>.spv.source" file beside each compiled shader (see compile_shaders() in CMakeUtils.cmake), saying which
+   // compiler to use, where the shader's source is, and which headers it may include.
+   // While enabled, a worker thread polls the sources (and headers) of the shaders that live pipelines use, and recompiles any that change.
+   // Update() then rebuilds only the pipelines that use a recompiled shader.  It is called by Application between frames, so a pipeline
+   // is never swapped part way through a frame.
+   //
+   // If a shader fails to compile, or a pipeline cannot be rebuilt with it, then pipelines keep their previous shaders and the error is
+   // reported by GetErrors() (see also ImGuiEx::ShaderErrors()) until the shader next compiles successfully.
+   //
+   // Enabled by default in debug builds.
+   class PKZL_API ShaderReloader {
+      ShaderReloader() = delete;
+      PKZL_NO_COPYMOVE(ShaderReloader);
+
+   public:
+      static void SetEnabled(const bool isEnabled);
+      static bool IsEnabled();
+
+      // Swap recompiled shaders into the pipelines that use them.  Call once per frame, between frames
+      static void Update();
+
+      // Compiled shader at path.  That is the most recent recompile, if there has been one, otherwise the file that the build compiled.
+      // Pipelines load their shaders with this.
+      static std::vector<uint32_t> ReadSPIRV(const std::filesystem::path& path);
+
+      static std::vector<ShaderReloadError> GetErrors();
+
+      // Pipelines register themselves (see Pipeline constructor and destructor)
+      static void Register(Pipeline& pipeline);
+      static void Unregister(Pipeline& pipeline);
+
+   private:
+      struct CompileResult {
+         std::filesystem::path Path;
+         std::vector<uint32_t> SPIRV;
+         std::string Message;
+         bool IsSuccess;
+      };
+
+      static void WorkerMain();
+
+   private:
+      inline static std::unordered_set<Pipeline*> m_Pipelines;                         // guarded by m_Mutex
+      inline static std::unordered_map<std::string, std::vector<uint32_t>> m_SPIRV;    // recompiled shaders, by path.  Guarded by m_Mutex
+      inline static std::vector<CompileResult> m_Results;                              // not yet swapped in by Update().  Guarded by m_Mutex
+      inline static std::map<std::string, ShaderReloadError> m_Errors;                 // guarded by m_Mutex
+
+      inline static std::thread m_Worker;
+      inline static std::mutex m_Mutex;
+      inline static std::condition_variable m_WakeUp;
+      inline static bool m_IsQuitting = false;
+   };
+
+}
@@ -0,0 +1,44 @@
+// Clustered lighting.
+// Shared by Pikzel's LightClusters.comp (which assigns lights to clusters), and the shaders that light with its output.
+// The includer must define PointLight first.
+struct Clusters {
+   mat4 view;
+   mat4 projection;
+   mat4 inverseProjection;
+   uvec4 size;           // x, y, z = number of clusters in each dimension, w = number of point lights
+   vec4 depthParams;     // x = near depth, y = far depth, z = slice scale, w = slice bias
+   float lightThreshold; // light range is the distance at which light's radiance falls below this value
+};
+
+
+// Returns index of the cluster containing given world space position
+uint ClusterIndex(const Clusters clusters, const vec3 worldPos) {
+   const vec4 viewPos = clusters.view * vec4(worldPos, 1.0);
+   const vec4 clipPos = clusters.projection * viewPos;
+   const vec2 ndc = clipPos.xy / clipPos.w;
+   const uvec2 tile = uvec2(clamp((ndc * 0.5 + 0.5) * vec2(clusters.size.xy), vec2(0.0), vec2(clusters.size.xy - 1)));
+   const float slice = log(max(-viewPos.z, 0.0001)) * clusters.depthParams.z + clusters.depthParams.w;
+   const uint z = uint(clamp(slice, 0.0, float(clusters.size.z - 1)));
+   return tile.x + (clusters.size.x * (tile.y + (clusters.size.y * z)));
+}
+
+
+float LightRange(const Clusters clusters, const PointLight light) {
+   const float maxComponent = max(light.color.r, max(light.color.g, light.color.b));
+   return sqrt(max(light.power * maxComponent, 0.0) / clusters.lightThreshold);
+}
+
+
+// Smoothly brings light's attenuation to zero at its range, so that there is no visible seam at cluster boundaries
+float RangeWindow(const float distance, const float range) {
+   const float d = distance / range;
+   const float window = clamp(1.0 - (d * d * d * d), 0.0, 1.0);
+   return window * window;
+}
+
+
+// Debug colour for number of lights in a cluster.  Blue (none) through green, to red (maxLights or more)
+vec3 ClusterHeatMap(const uint numLights, const uint maxLights) {
+   const float t = clamp(float(numLights) / float(maxLights), 0.0, 1.0);
+   return numLights == 0 ? vec3(0.0, 0.0, 0.1) : clamp(vec3(2.0 * t - 0.5, 1.5 - abs(2.0 * t - 1.0) * 2.0, 1.0 - 2.0 * t), 0.0, 1.0);
+}
@@ -1,8 +1,11 @@
 #version 450 core
+#extension GL_GOOGLE_include_directive: require
+
+#include "VertexCompression.glsl"
 
 layout(location = 0) in vec3 inPos;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec3 inTangent;
+layout(location = 1) in vec2 inNormal;
+layout(location = 2) in vec2 inTangent;
 layout(location = 3) in vec2 inTexCoords;
 
 layout(push_constant) uniform PC {
@@ -12,6 +15,6 @@ layout(push_constant) uniform PC {
 layout (location = 0) out vec3 outColor;
 
 void main() {
-   outColor = vec3(inTexCoords, 0);
+   outColor = (DecodeOctahedral(inNormal) * 0.5) + 0.5;
    gl_Position = constants.mvp * vec4(inPos, 1.0);
 }
@@ -0,0 +1,14 @@
+// Decoding of the compact vertex format (see Pikzel/Scene/VertexCompression.h)
+//
+// Positions are quantized to the mesh's bounding box and arrive in the shader as [0, 1].  The transform back to mesh space
+// is pre-multiplied into the model matrix, so there is nothing to decode here.
+// UVs are half floats, and arrive in the shader as ordinary floats.
+
+
+// Decode an octahedral encoded unit vector (normals and tangents)
+vec3 DecodeOctahedral(const vec2 e) {
+   vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+   const float t = max(-v.z, 0.0);
+   v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+   return normalize(v);
+}
@@ -9,17 +9,88 @@
 
 namespace Pikzel {
 
+   uint64_t Texture::CalculateSize(const Texture& texture) {
+      // bytes per 4x4 block for block compressed formats, 0 for uncompressed
+      uint32_t blockBytes = 0;
+      switch (texture.GetFormat()) {
+         case TextureFormat::DXT1RGBA:
+         case TextureFormat::DXT1SRGBA:
+         case TextureFormat::RGTC1R:
+         case TextureFormat::RGTC1SR:
+            blockBytes = 8;
+            break;
+         case TextureFormat::DXT3RGBA:
+         case TextureFormat::DXT3SRGBA:
+         case TextureFormat::DXT5RGBA:
+         case TextureFormat::DXT5SRGBA:
+         case TextureFormat::RGTC2RG:
+         case TextureFormat::RGTC2SRG:
+            blockBytes = 16;
+            break;
+         default:
+            break;
+      }
+
+      const uint64_t layers = static_cast<uint64_t>(texture.GetLayers()) * texture.GetDepth() * (((texture.GetType() == TextureType::TextureCube) || (texture.GetType() == TextureType::TextureCubeArray)) ? 6 : 1);
+      uint64_t bytes = 0;
+      for (uint32_t level = 0; level < texture.GetMIPLevels(); ++level) {
+         const uint64_t width = std::max(texture.GetWidth() >> level, 1u);
+         const uint64_t height = std::max(texture.GetHeight() >> level, 1u);
+         if (blockBytes) {
+            bytes += ((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+         } else {
+            bytes += width * height * BPP(texture.GetFormat());
+         }
+      }
+      return bytes * layers;
+   }
+
+
    TextureLoader::TextureLoader(const std::filesystem::path& path) {
       m_FileData = ReadFile<uint8_t>(path);
+      Load(path.string());
+   }
+
+
+   TextureLoader::TextureLoader(std::vector<uint8_t> fileData) {
+      m_FileData = std::move(fileData);
+      Load("<memory>");
+   }
+
+
+   void TextureLoader::Load(const std::string& name) {
       if (!TrySTBI()) {
          if (!TryDDSKTX()) {
-            PKZL_CORE_ASSERT(false, "'{0}': Image format not supported!", path.string());
+            PKZL_CORE_ASSERT(false, "'{0}': Image format not supported!", name);
          }
          Flip();
       }
    }
 
 
+   bool TextureLoader::GetInfo(const std::vector<uint8_t>& fileData, uint32_t& width, uint32_t& height, TextureFormat& format) {
+      int iWidth;
+      int iHeight;
+      int channels;
+      if (!stbi_info_from_memory(fileData.data(), static_cast<int>(fileData.size()), &iWidth, &iHeight, &channels)) {
+         return false;
+      }
+
+      // same formats as TrySTBI() ends up with
+      const bool isHDR = stbi_is_hdr_from_memory(fileData.data(), static_cast<int>(fileData.size()));
+      if ((channels == 3) || (channels == 4)) {
+         format = isHDR ? TextureFormat::RGBA32F : TextureFormat::RGBA8;
+      } else if (channels == 1) {
+         format = isHDR ? TextureFormat::R32F : TextureFormat::R8;
+      } else {
+         return false;
+      }
+      width = static_cast<uint32_t>(iWidth);
+      height = static_cast<uint32_t>(iHeight);
+      return true;
+   }
+
+
    TextureLoader::~TextureLoader() {
       if (m_Data) {
          if (m_IsDDSKTX) {
@@ -118,6 +189,7 @@ namespace Pikzel {
       if (m_Data) {
          m_IsDDSKTX = false;
          m_IsCompressed = false;
+         m_IsCubeMap = false;
          m_Depth = 1;
          m_Layers = 1;
          m_MIPLevels = 1;
@@ -175,12 +247,12 @@ namespace Pikzel {
       case DDSKTX_FORMAT_R32F:      return TextureFormat::R32F;
       case DDSKTX_FORMAT_R16F:      break;
       case DDSKTX_FORMAT_RG16F:     return TextureFormat::RG16F;
-      case DDSKTX_FORMAT_RG16S:     break;
+      case DDSKTX_FORMAT_RG16S:     return TextureFormat::RG16S;
       case DDSKTX_FORMAT_RGBA16F:   return TextureFormat::RGBA16F;
       case DDSKTX_FORMAT_RGBA16:    return TextureFormat::RGBA16F;
       case DDSKTX_FORMAT_BGRA8:     return TextureFormat::BGRA8;
       case DDSKTX_FORMAT_RGB10A2:   break;
-      case DDSKTX_FORMAT_RG11B10F:  break;
+      case DDSKTX_FORMAT_RG11B10F:  return TextureFormat::R11G11B10F;
       case DDSKTX_FORMAT_RG8:       break;
       case DDSKTX_FORMAT_RG8S:      break;
       }
@@ -196,13 +268,13 @@ namespace Pikzel {
       if (ddsktx_parse(info, m_FileData.data(), m_FileData.size())) {
          isParsed = true;
          m_IsDDSKTX = true;
+         m_IsCubeMap = info->flags & DDSKTX_TEXTURE_FLAG_CUBEMAP;
          m_Width = info->width;
          m_Height = info->height;
-         m_Depth = info->depth;
+         m_Depth = m_IsCubeMap ? 6 : info->depth; // cubemap faces are accessed as slices, and the renderers expect cubemaps to have depth 6 here
          m_Layers = info->num_layers;
          m_MIPLevels = info->num_mips;
          m_Format = DDSKTXFormatToTextureFormat(info->format, info->flags & DDSKTX_TEXTURE_FLAG_SRGB);
-         m_IsCubeMap = info->flags & DDSKTX_TEXTURE_FLAG_CUBEMAP;
          m_IsCompressed = ddsktx_format_compressed(info->format);
       } else {
          delete static_cast<ddsktx_texture_info*>(m_Data);
@@ -726,4 +798,125 @@ namespace Pikzel {
       }
    }
 
-}
\ No newline at end of file
+
+
+   static uint32_t TextureFormatToDXGIFormat(const TextureFormat format) {
+      switch (format) {
+         case TextureFormat::R8:         return 61; // DXGI_FORMAT_R8_UNORM
+         case TextureFormat::RGBA8:      return 28; // DXGI_FORMAT_R8G8B8A8_UNORM
+         case TextureFormat::SRGBA8:     return 29; // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+         case TextureFormat::RG16F:      return 34; // DXGI_FORMAT_R16G16_FLOAT
+         case TextureFormat::RG16S:      return 37; // DXGI_FORMAT_R16G16_SNORM
+         case TextureFormat::RGBA16F:    return 10; // DXGI_FORMAT_R16G16B16A16_FLOAT
+         case TextureFormat::R11G11B10F: return 26; // DXGI_FORMAT_R11G11B10_FLOAT
+         case TextureFormat::R32F:       return 41; // DXGI_FORMAT_R32_FLOAT
+      }
+      return 0;
+   }
+
+
+   void WriteDDS(const std::filesystem::path& path, const Texture& texture, const uint32_t mipLevels) {
+      PKZL_PROFILE_FUNCTION();
+
+      // See "DDS file layout" in the DirectX documentation
+      struct DDSPixelFormat {
+         uint32_t size = sizeof(DDSPixelFormat);
+         uint32_t flags = 0x4;                                // DDPF_FOURCC
+         uint32_t fourCC = 0x30315844;                        // "DX10"
+         uint32_t rgbBitCount = 0;
+         uint32_t rBitMask = 0;
+         uint32_t gBitMask = 0;
+         uint32_t bBitMask = 0;
+         uint32_t aBitMask = 0;
+      };
+
+      struct DDSHeader {
+         uint32_t size = sizeof(DDSHeader);
+         uint32_t flags = 0x1 | 0x2 | 0x4 | 0x8 | 0x1000 | 0x20000; // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PITCH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT
+         uint32_t height = 0;
+         uint32_t width = 0;
+         uint32_t pitch = 0;
+         uint32_t depth = 0;
+         uint32_t mipMapCount = 0;
+         uint32_t reserved1[11] = {};
+         DDSPixelFormat pixelFormat = {};
+         uint32_t caps = 0x1000;                              // DDSCAPS_TEXTURE
+         uint32_t caps2 = 0;
+         uint32_t caps3 = 0;
+         uint32_t caps4 = 0;
+         uint32_t reserved2 = 0;
+      };
+
+      struct DDSHeaderDX10 {
+         uint32_t dxgiFormat = 0;
+         uint32_t resourceDimension = 3;                      // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+         uint32_t miscFlag = 0;
+         uint32_t arraySize = 1;
+         uint32_t miscFlags2 = 0;
+      };
+
+      static_assert(sizeof(DDSHeader) == 124);
+      static_assert(sizeof(DDSHeaderDX10) == 20);
+
+      const uint32_t dxgiFormat = TextureFormatToDXGIFormat(texture.GetFormat());
+      if (dxgiFormat == 0) {
+         throw std::runtime_error {fmt::format("Cannot write '{0}': texture format is not supported!", path.string())};
+      }
+
+      const bool isCubeMap = (texture.GetType() == TextureType::TextureCube) || (texture.GetType() == TextureType::TextureCubeArray);
+      const uint32_t numLevels = (mipLevels == 0) ? texture.GetMIPLevels() : std::min(mipLevels, texture.GetMIPLevels());
+      const uint32_t numImages = texture.GetLayers() * (isCubeMap ? 6 : 1);
+      const uint32_t bpp = Texture::BPP(texture.GetFormat());
+
+      DDSHeader header;
+      header.width = texture.GetWidth();
+      header.height = texture.GetHeight();
+      header.pitch = header.width * bpp;
+      header.mipMapCount = numLevels;
+      if (numLevels > 1) {
+         header.caps |= 0x8 | 0x400000;                       // DDSCAPS_COMPLEX | DDSCAPS_MIPMAP
+      }
+      if (isCubeMap) {
+         header.caps |= 0x8;                                  // DDSCAPS_COMPLEX
+         header.caps2 = 0x200 | 0xFC00;                       // DDSCAPS2_CUBEMAP | all six faces
+      }
+
+      DDSHeaderDX10 headerDX10;
+      headerDX10.dxgiFormat = dxgiFormat;
+      headerDX10.miscFlag = isCubeMap ? 0x4 : 0;              // D3D10_RESOURCE_MISC_TEXTURECUBE
+      headerDX10.arraySize = texture.GetLayers();
+
+      // DDS stores each image (layer or cube face) with all of its mip levels, whereas GetData() returns all images for one mip level.
+      std::vector<std::vector<uint8_t>> levels;
+      levels.reserve(numLevels);
+      for (uint32_t level = 0; level < numLevels; ++level) {
+         levels.emplace_back(texture.GetData(level));
+      }
+
+      std::ofstream file {path, std::ios::binary};
+      if (!file.is_open()) {
+         throw std::runtime_error {fmt::format("Could not open file '{0}' for writing!", path.string())};
+      }
+      file.write("DDS ", 4);
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+
+      // TextureLoader flips images vertically when it loads them, so write the rows in reverse order here.
+      for (uint32_t image = 0; image < numImages; ++image) {
+         for (uint32_t level = 0; level < numLevels; ++level) {
+            const uint32_t width = std::max(texture.GetWidth() >> level, 1u);
+            const uint32_t height = std::max(texture.GetHeight() >> level, 1u);
+            const size_t rowSize = static_cast<size_t>(width) * bpp;
+            const uint8_t* data = levels[level].data() + (image * height * rowSize);
+            for (uint32_t row = height; row > 0; --row) {
+               file.write(reinterpret_cast<const char*>(data + ((row - 1) * rowSize)), rowSize);
+            }
+         }
+      }
+
+      if (!file.good()) {
+         throw std::runtime_error {fmt::format("Error writing file '{0}'!", path.string())};
+      }
+   }
+
+}
@@ -3,7 +3,9 @@
 #include "Pikzel/Core/Core.h"
 
 #include <filesystem>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace Pikzel {
 
@@ -19,6 +21,8 @@ namespace Pikzel {
       RG32F            /* linear RG, 32-bit floating point components */,
       RGB32F           /* linear RGB, 32-bit floating point components */,
       RGBA32F          /* linear RGBA, 32-bit floating point components */,
+      R11G11B10F       /* linear RGB, packed unsigned floating point: 11 bits red and green, 10 bits blue (32 bits per texel).  For HDR color without alpha */,
+      RG16S            /* linear RG, 16-bit signed normalized components.  For octahedral encoded normals */,
       BGR8             /* BGR in sRGB color space, 8 bits per component (except: on Vulkan this one is B10 G11 R11, for 32-bit texels)*/,
       BGRA8            /* BGRA in sRGB color space. 8 bits per component */,
       R8               /* linear single channel, 8 bits */,
@@ -81,6 +85,8 @@ namespace Pikzel {
          case TextureFormat::RG32F:     return true;
          case TextureFormat::RGB32F:    return true;
          case TextureFormat::RGBA32F:   return true;
+         case TextureFormat::R11G11B10F: return true;
+         case TextureFormat::RG16S:     return true;
          case TextureFormat::BGR8:      return true;
          case TextureFormat::BGRA8:     return true;
          case TextureFormat::R8:        return true;
@@ -115,6 +121,8 @@ namespace Pikzel {
          case TextureFormat::RG32F:     return false;
          case TextureFormat::RGB32F:    return false;
          case TextureFormat::RGBA32F:   return false;
+         case TextureFormat::R11G11B10F: return false;
+         case TextureFormat::RG16S:     return false;
          case TextureFormat::BGR8:      return false;
          case TextureFormat::BGRA8:     return false;
          case TextureFormat::R8:        return false;
@@ -149,6 +157,8 @@ namespace Pikzel {
          case TextureFormat::RG32F:     return true;
          case TextureFormat::RGB32F:    return true;
          case TextureFormat::RGBA32F:   return true;
+         case TextureFormat::R11G11B10F: return true;
+         case TextureFormat::RG16S:     return true;
          case TextureFormat::BGR8:      return true;
          case TextureFormat::BGRA8:     return true;
          case TextureFormat::R8:        return true;
@@ -233,12 +243,22 @@ namespace Pikzel {
 
       // Set data for base mip level for entire texture extent (incl. layers)
       // For uncompressed texture format only (TODO: may need SetCompressedData())
-      // Only does base mip level (TODO: may need to support SetData for other mip levels)
+      // Only does base mip level (see SetMIPData() for other mip levels of 2D textures)
       // For cubemap texture, this assumes that the data is a 2d image either unrolled into 6-faces,
       // or an equirectangular projection.  A compute shader will be dispatched to copy the 2d
       // data into the cubemap
       virtual void SetData(const void* data, const uint32_t size) = 0;
 
+      // Set data for one mip level of a 2D texture (uncompressed formats only).
+      // The mip level is ready to sample on return, there is no need to Commit() it.
+      // Intended for streaming mip levels in one at a time (see TextureStreamer), together with SetMinMIPLevel()
+      virtual void SetMIPData(const uint32_t mipLevel, const void* data, const uint32_t size) = 0;
+
+      // Clamp sampling to mip levels at or coarser than mipLevel (i.e. ignore finer levels, as if they did not exist).
+      // Default is 0 (all mip levels are sampled)
+      virtual void SetMinMIPLevel(const uint32_t mipLevel) = 0;
+      virtual uint32_t GetMinMIPLevel() const = 0;
+
       // See default TextureCopySettings.
       // By default CopyFrom() will copy the full extent and all array layers of srcTexture, mipLevel 0 into self, mipLevel 0
       // To copy all miplevels you need multiple calls to CopyFrom()
@@ -254,11 +274,20 @@ namespace Pikzel {
       // Pass GetMIPLevels() (or any number larger than that) to generate no mipmaps
       virtual void Commit(const uint32_t baseMipLevel) = 0;
 
+      // Read back the texels of one mip level (all layers, and all six faces of a cubemap) from the GPU.
+      // The data is tightly packed, one layer (or cube face) after another, which is the same layout that SetData() expects.
+      // For uncompressed texture formats only.
+      // This waits for the GPU, so it is meant for tools and offline processing (e.g. baking textures to disk), not for every frame.
+      virtual std::vector<uint8_t> GetData(const uint32_t mipLevel) const = 0;
+
       virtual bool operator==(const Texture& that) = 0;
 
    public:
       static uint32_t CalculateMipmapLevels(const uint32_t width, const uint32_t height);
       static uint32_t BPP(const TextureFormat format);
+
+      // GPU memory used by texture (all mip levels, layers and faces), estimated from its dimensions and format
+      static uint64_t CalculateSize(const Texture& texture);
    };
 
 
@@ -276,8 +305,13 @@ namespace Pikzel {
          case TextureFormat::RGBA16F: return 8;
          case TextureFormat::RGB32F:  return 12;
          case TextureFormat::RGBA32F: return 16;
+         case TextureFormat::R11G11B10F: return 4;
+         case TextureFormat::RG16S:   return 4;
          case TextureFormat::BGR8:    return 3; // warning: with Vulkan back-end this format is actually 4 bytes
          case TextureFormat::BGRA8:   return 4;
+         case TextureFormat::D32F:    return 4;
+         case TextureFormat::D24S8:   return 4;
+         case TextureFormat::D32S8:   return 8; // typically padded to 64-bits
          default: PKZL_CORE_ASSERT(false, "Unknown texture format!"); return 0;
       }
    }
@@ -299,8 +333,13 @@ namespace Pikzel {
    public:
       PKZL_NO_COPYMOVE(TextureLoader);
       TextureLoader(const std::filesystem::path& path);
+      TextureLoader(std::vector<uint8_t> fileData);   // file already read into memory (e.g. so that it can be decoded on another thread)
       ~TextureLoader();
 
+      // Read the dimensions and format of an image file in memory, without decoding it.
+      // For the formats that stb_image supports (i.e. not .dds or .ktx).  Returns false if the format is not supported
+      static bool GetInfo(const std::vector<uint8_t>& fileData, uint32_t& width, uint32_t& height, TextureFormat& format);
+
       bool IsLoaded() const;
 
       uint32_t GetWidth() const;
@@ -319,6 +358,7 @@ namespace Pikzel {
       std::pair<const void*, const uint32_t> GetData(const uint32_t layer, const uint32_t slice, const uint32_t mipLevel) const;
 
    private:
+      void Load(const std::string& name);
       bool TrySTBI();
       bool TryDDSKTX();
 
@@ -341,4 +381,11 @@ namespace Pikzel {
       bool m_IsCompressed;
    };
 
+
+   // Write a texture to a .dds file (with DX10 header extension), so that it can be loaded again later via TextureSettings::path.
+   // All layers and cube faces are written, along with the first mipLevels mip levels (0 = all of them).
+   // Any mip levels not written are generated when the file is loaded.
+   // Supports the uncompressed formats that TextureLoader can read back (R8, RGBA8, SRGBA8, RG16F, RG16S, RGBA16F, R11G11B10F, R32F)
+   void PKZL_API WriteDDS(const std::filesystem::path& path, const Texture& texture, const uint32_t mipLevels = 0);
+
 }
@@ -0,0 +1,352 @@
+#include "TextureStreamer.h"
+#include "ContentCache.h"
+#include "RenderCore.h"
+#include "Pikzel/Core/Utility.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace Pikzel {
+
+   static bool IsStreamable(const TextureFormat format) {
+      switch (format) {
+         case TextureFormat::RGBA8:   return true;
+         case TextureFormat::SRGBA8:  return true;
+         case TextureFormat::R8:      return true;
+         case TextureFormat::RGBA32F: return true;
+         case TextureFormat::R32F:    return true;
+         default:                     return false;
+      }
+   }
+
+
+   static uint32_t NumComponents(const TextureFormat format) {
+      return ((format == TextureFormat::R8) || (format == TextureFormat::R32F)) ? 1 : 4;
+   }
+
+
+   static float SRGBToLinear(const uint8_t value) {
+      static const std::array<float, 256> table = [] {
+         std::array<float, 256> table;
+         for (uint32_t i = 0; i < 256; ++i) {
+            const float val = i / 255.0f;
+            table[i] = val < 0.04045f ? val / 12.92f : std::pow((val + 0.055f) / 1.055f, 2.4f);
+         }
+         return table;
+      }();
+      return table[value];
+   }
+
+
+   static uint8_t LinearToSRGB(const float value) {
+      const float val = std::clamp(value, 0.0f, 1.0f);
+      const float srgb = val < 0.0031308f ? val * 12.92f : (1.055f * std::pow(val, 1.0f / 2.4f)) - 0.055f;
+      return static_cast<uint8_t>(srgb * 255.0f + 0.5f);
+   }
+
+
+   // Next mip level down, by 2x2 box filter.  sRGB color components are averaged in linear space.
+   static std::vector<uint8_t> Downsample(const std::vector<uint8_t>& src, const uint32_t srcWidth, const uint32_t srcHeight, const TextureFormat format) {
+      const uint32_t width = std::max(srcWidth / 2, 1u);
+      const uint32_t height = std::max(srcHeight / 2, 1u);
+      const uint32_t components = NumComponents(format);
+      const bool isFloat = (format == TextureFormat::RGBA32F) || (format == TextureFormat::R32F);
+      const bool isSRGB = (format == TextureFormat::SRGBA8);
+
+      const auto load = [&](const uint32_t x, const uint32_t y, const uint32_t c) {
+         const size_t i = ((static_cast<size_t>(y) * srcWidth) + x) * components + c;
+         if (isFloat) {
+            return reinterpret_cast<const float*>(src.data())[i];
+         }
+         return (isSRGB && (c < 3)) ? SRGBToLinear(src[i]) : src[i] / 255.0f;
+      };
+
+      std::vector<uint8_t> dst(static_cast<size_t>(width) * height * Texture::BPP(format));
+      for (uint32_t y = 0; y < height; ++y) {
+         const uint32_t y0 = std::min(2 * y, srcHeight - 1);
+         const uint32_t y1 = std::min((2 * y) + 1, srcHeight - 1);
+         for (uint32_t x = 0; x < width; ++x) {
+            const uint32_t x0 = std::min(2 * x, srcWidth - 1);
+            const uint32_t x1 = std::min((2 * x) + 1, srcWidth - 1);
+            for (uint32_t c = 0; c < components; ++c) {
+               const float value = 0.25f * (load(x0, y0, c) + load(x1, y0, c) + load(x0, y1, c) + load(x1, y1, c));
+               const size_t i = ((static_cast<size_t>(y) * width) + x) * components + c;
+               if (isFloat) {
+                  reinterpret_cast<float*>(dst.data())[i] = value;
+               } else if (isSRGB && (c < 3)) {
+                  dst[i] = LinearToSRGB(value);
+               } else {
+                  dst[i] = static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+               }
+            }
+         }
+      }
+      return dst;
+   }
+
+
+   // texels of a solid color
+   static std::vector<uint8_t> Fill(const uint32_t width, const uint32_t height, const TextureFormat format, const glm::vec4& color) {
+      const uint32_t components = NumComponents(format);
+      const bool isFloat = (format == TextureFormat::RGBA32F) || (format == TextureFormat::R32F);
+      std::vector<uint8_t> data(static_cast<size_t>(width) * height * Texture::BPP(format));
+      for (size_t i = 0; i < static_cast<size_t>(width) * height * components; ++i) {
+         const float value = color[static_cast<glm::length_t>(i % components)];
+         if (isFloat) {
+            reinterpret_cast<float*>(data.data())[i] = value;
+         } else {
+            data[i] = static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+         }
+      }
+      return data;
+   }
+
+
+   TextureStreamer::TextureStreamer(const uint64_t uploadBudget)
+   : m_UploadBudget {uploadBudget}
+   {
+      m_Worker = std::thread {&TextureStreamer::WorkerMain, this};
+   }
+
+
+   TextureStreamer::~TextureStreamer() {
+      {
+         std::lock_guard lock {m_Mutex};
+         m_IsQuitting = true;
+      }
+      m_WorkAvailable.notify_all();
+      m_Worker.join();
+   }
+
+
+   std::shared_ptr<Texture> TextureStreamer::CreateTexture(const TextureSettings& settings, const glm::vec4& placeholder) {
+      PKZL_PROFILE_FUNCTION();
+
+      if ((settings.textureType != TextureType::Texture2D) || settings.path.empty() || settings.imageStorage) {
+         return ContentCache::CreateTexture(settings);
+      }
+
+      // An identical image (perhaps from a different path) may already have been loaded, in which case share it (whether
+      // or not it has finished streaming)
+      std::vector<uint8_t> fileData = ReadFile<uint8_t>(settings.path);
+      const uint64_t key = ContentCache::GetTextureKey(settings, fileData);
+      if (auto existing = ContentCache::FindTexture(key)) {
+         return existing;
+      }
+
+      // Only the image header is looked at here.  Decoding is done on the worker thread
+      uint32_t width;
+      uint32_t height;
+      TextureFormat format;
+      if (!TextureLoader::GetInfo(fileData, width, height, format) || !IsStreamable(format)) {
+         std::shared_ptr<Texture> texture = RenderCore::CreateTexture(settings);
+         ContentCache::AddTexture(key, texture);
+         return texture;
+      }
+
+      // Same as the back-ends do when they load an image: the file cannot tell whether the image was in sRGB colorspace, so go by the hint in settings
+      if (!IsLinearColorSpace(settings.format) && (format == TextureFormat::RGBA8)) {
+         format = TextureFormat::SRGBA8;
+      }
+
+      const uint32_t mipLevels = settings.mipLevels == 0 ? Texture::CalculateMipmapLevels(width, height) : std::min(settings.mipLevels, Texture::CalculateMipmapLevels(width, height));
+      TextureSettings streamedSettings = settings;
+      streamedSettings.path.clear();
+      streamedSettings.width = width;
+      streamedSettings.height = height;
+      streamedSettings.format = format;
+      streamedSettings.mipLevels = mipLevels;
+      std::shared_ptr<Texture> texture = RenderCore::CreateTexture(streamedSettings);
+      ContentCache::AddTexture(key, texture);
+
+      const uint32_t coarsest = mipLevels - 1;
+      const std::vector<uint8_t> placeholderData = Fill(std::max(width >> coarsest, 1u), std::max(height >> coarsest, 1u), format, placeholder);
+      texture->SetMIPData(coarsest, placeholderData.data(), static_cast<uint32_t>(placeholderData.size()));
+      texture->SetMinMIPLevel(coarsest);
+
+      auto streamingTexture = std::make_shared<StreamingTexture>();
+      streamingTexture->Texture = texture;
+      streamingTexture->Path = settings.path;
+      streamingTexture->Format = format;
+      streamingTexture->Width = width;
+      streamingTexture->Height = height;
+      streamingTexture->MIPLevels = mipLevels;
+      streamingTexture->FileData = std::move(fileData);
+      streamingTexture->ResidentMIPLevel = mipLevels;
+      m_Textures.emplace_back(streamingTexture);
+      m_TextureIndex[texture.get()] = streamingTexture.get();
+      {
+         std::lock_guard lock {m_Mutex};
+         m_DecodeQueue.emplace_back(std::move(streamingTexture));
+      }
+      m_WorkAvailable.notify_one();
+
+      return texture;
+   }
+
+
+   void TextureStreamer::ReportPixelsPerUV(const Texture& texture, const float pixelsPerUV) {
+      if (auto it = m_TextureIndex.find(&texture); it != m_TextureIndex.end()) {
+         it->second->PixelsPerUV = std::max(it->second->PixelsPerUV, pixelsPerUV);
+      }
+   }
+
+
+   void TextureStreamer::Update() {
+      PKZL_PROFILE_FUNCTION();
+      m_Stats = {};
+
+      // Textures that nothing else refers to any more need not be streamed.
+      // nb: The worker thread may still have hold of a StreamingTexture, so its Texture is released here (on this thread) explicitly
+      const auto remove = [this](const std::shared_ptr<StreamingTexture>& streamingTexture) {
+         m_TextureIndex.erase(streamingTexture->Texture.get());
+         streamingTexture->Texture.reset();
+         streamingTexture->MIPData.clear();
+      };
+      {
+         std::lock_guard lock {m_Mutex};
+         std::erase_if(m_DecodeQueue, [](const auto& streamingTexture) { return streamingTexture->Texture.use_count() == 1; });
+         std::erase_if(m_Textures, [&](const auto& streamingTexture) {
+            if (streamingTexture->Texture.use_count() == 1) {
+               remove(streamingTexture);
+               return true;
+            }
+            if (streamingTexture->IsFailed) {
+               // leave the texture as it is, with the placeholder
+               remove(streamingTexture);
+               return true;
+            }
+            streamingTexture->IsReady = streamingTexture->IsDecoded;
+            streamingTexture->Priority = GetPriority(*streamingTexture);
+            return false;
+         });
+      }
+
+      // Upload one mip level at a time, always to whichever texture needs it most
+      for (;;) {
+         StreamingTexture* next = nullptr;
+         float nextPriority = std::numeric_limits<float>::lowest();
+         for (const auto& streamingTexture : m_Textures) {
+            if (streamingTexture->IsReady && (streamingTexture->ResidentMIPLevel > 0)) {
+               const float priority = GetPriority(*streamingTexture);
+               if (priority > nextPriority) {
+                  next = streamingTexture.get();
+                  nextPriority = priority;
+               }
+            }
+         }
+         if (!next) {
+            break;
+         }
+
+         const uint32_t mipLevel = next->ResidentMIPLevel - 1;
+         std::vector<uint8_t>& data = next->MIPData[mipLevel];
+         if ((m_Stats.BytesUploaded > 0) && (m_Stats.BytesUploaded + data.size() > m_UploadBudget)) {
+            break;
+         }
+         next->Texture->SetMIPData(mipLevel, data.data(), static_cast<uint32_t>(data.size()));
+         next->Texture->SetMinMIPLevel(mipLevel);
+         next->ResidentMIPLevel = mipLevel;
+         m_Stats.BytesUploaded += data.size();
+         std::vector<uint8_t>().swap(data);
+      }
+
+      std::erase_if(m_Textures, [&](const auto& streamingTexture) {
+         if (streamingTexture->IsReady && (streamingTexture->ResidentMIPLevel == 0)) {
+            remove(streamingTexture);
+            return true;
+         }
+         return false;
+      });
+
+      for (const auto& streamingTexture : m_Textures) {
+         streamingTexture->PixelsPerUV = 0.0f;
+         ++m_Stats.TexturesStreaming;
+         if (streamingTexture->IsReady) {
+            for (uint32_t mipLevel = 0; mipLevel < streamingTexture->ResidentMIPLevel; ++mipLevel) {
+               m_Stats.BytesPending += streamingTexture->MIPData[mipLevel].size();
+            }
+         } else {
+            ++m_Stats.TexturesDecoding;
+         }
+      }
+   }
+
+
+   void TextureStreamer::SetUploadBudget(const uint64_t bytes) {
+      m_UploadBudget = bytes;
+   }
+
+
+   bool TextureStreamer::IsIdle() const {
+      return m_Textures.empty();
+   }
+
+
+   const TextureStreamer::Stats& TextureStreamer::GetStats() const {
+      return m_Stats;
+   }
+
+
+   // Higher is more urgent.
+   // A texture that has been reported, and is coarser than the screen needs, gets a positive priority: how many mip levels it
+   // is short of what the screen needs.
+   // Anything else gets a priority <= 0, so that it is streamed after those, starting with the ones that have the least resident.
+   float TextureStreamer::GetPriority(const StreamingTexture& texture) const {
+      if (texture.PixelsPerUV > 0.0f) {
+         // mip level at which one texel covers one pixel
+         const float texelsPerUV = static_cast<float>(std::max(texture.Width, texture.Height));
+         const float requiredMIPLevel = std::max(std::log2(texelsPerUV / texture.PixelsPerUV), 0.0f);
+         const float shortfall = static_cast<float>(texture.ResidentMIPLevel) - requiredMIPLevel;
+         if (shortfall > 0.0f) {
+            return shortfall;
+         }
+      }
+      return static_cast<float>(texture.ResidentMIPLevel) - static_cast<float>(texture.MIPLevels);
+   }
+
+
+   void TextureStreamer::WorkerMain() {
+      for (;;) {
+         std::shared_ptr<StreamingTexture> streamingTexture;
+         std::vector<uint8_t> fileData;
+         {
+            std::unique_lock lock {m_Mutex};
+            m_WorkAvailable.wait(lock, [this] { return m_IsQuitting || !m_DecodeQueue.empty(); });
+            if (m_IsQuitting) {
+               return;
+            }
+            auto it = std::max_element(m_DecodeQueue.begin(), m_DecodeQueue.end(), [](const auto& a, const auto& b) { return a->Priority < b->Priority; });
+            streamingTexture = std::move(*it);
+            m_DecodeQueue.erase(it);
+            fileData = std::move(streamingTexture->FileData);
+         }
+
+         // Path, Format, Width, Height and MIPLevels do not change after CreateTexture(), so can be read without the lock
+         std::vector<std::vector<uint8_t>> mipData;
+         {
+            TextureLoader loader {std::move(fileData)};
+            if (loader.IsLoaded() && (loader.GetWidth() == streamingTexture->Width) && (loader.GetHeight() == streamingTexture->Height)) {
+               const auto [data, size] = loader.GetData(0, 0, 0);
+               mipData.reserve(streamingTexture->MIPLevels);
+               mipData.emplace_back(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+            }
+         }
+         for (uint32_t mipLevel = 1; !mipData.empty() && (mipLevel < streamingTexture->MIPLevels); ++mipLevel) {
+            mipData.emplace_back(Downsample(mipData.back(), std::max(streamingTexture->Width >> (mipLevel - 1), 1u), std::max(streamingTexture->Height >> (mipLevel - 1), 1u), streamingTexture->Format));
+         }
+
+         std::lock_guard lock {m_Mutex};
+         if (mipData.empty()) {
+            PKZL_CORE_LOG_WARN("TextureStreamer: failed to decode image '{0}'", streamingTexture->Path.string());
+            streamingTexture->IsFailed = true;
+         } else {
+            streamingTexture->MIPData = std::move(mipData);
+            streamingTexture->IsDecoded = true;
+         }
+      }
+   }
+
+}
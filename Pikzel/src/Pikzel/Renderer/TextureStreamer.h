@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Pikzel {
+
+   // Progressive loading of textures, one mip level at a time.
+   //
+   // CreateTexture() returns straight away with a texture that has only its coarsest (1x1) mip level resident, filled with a
+   // placeholder color.  The image file is decoded, and its mip chain generated, on a worker thread.  Then each Update()
+   // uploads decoded mip levels (coarsest first) up to a per-frame budget, and clamps sampling to the finest level that has
+   // been uploaded so far (Texture::SetMinMIPLevel()).  So a scene is usable immediately, and gets sharper over the next
+   // few frames.
+   //
+   // Textures that are big on screen are streamed first.  Each frame, call ReportPixelsPerUV() for the textures that are
+   // drawn, with how many pixels one unit of texture coordinates covers on screen (see SceneRenderer::GetPixelsPerUV()).
+   // The textures that are furthest from the mip level the screen needs are then uploaded first.
+   // Textures that are not reported are still streamed, after the others.
+   //
+   // Only plain 2D images (the formats that stb_image reads) are streamed.  Anything else (e.g. cubemaps, and .dds or .ktx
+   // files, which already contain their own mip levels) is loaded synchronously with RenderCore::CreateTexture().
+   class PKZL_API TextureStreamer {
+   public:
+
+      struct Stats {
+         uint32_t TexturesStreaming = 0;  // textures that do not have all of their mip levels resident yet
+         uint32_t TexturesDecoding = 0;   // of those, how many are still waiting for the worker thread to decode them
+         uint64_t BytesUploaded = 0;      // uploaded by the most recent Update()
+         uint64_t BytesPending = 0;       // decoded, but not uploaded yet
+      };
+
+      // uploadBudget is bytes per Update().  At least one mip level is uploaded each Update() regardless
+      TextureStreamer(const uint64_t uploadBudget = 8 * 1024 * 1024);
+      ~TextureStreamer();
+
+      PKZL_NO_COPY(TextureStreamer);
+
+      // Create a texture from an image file (settings.path), and start streaming it in.
+      // placeholder is the color of the texture until the image has been decoded (components 0 to 1)
+      // If an identical image has already been loaded with the same settings, then that texture is returned instead (see ContentCache)
+      std::shared_ptr<Texture> CreateTexture(const TextureSettings& settings, const glm::vec4& placeholder = {0.5f, 0.5f, 0.5f, 1.0f});
+
+      // How many pixels one unit of texture coordinates covers on screen, where the texture is drawn this frame.
+      // If a texture is drawn more than once, the largest value reported is used.  Reports are cleared by Update()
+      void ReportPixelsPerUV(const Texture& texture, const float pixelsPerUV);
+
+      // Upload decoded mip levels up to the upload budget, and release textures that are no longer referenced by anything else.
+      // Call once per frame, from the render thread.
+      void Update();
+
+      void SetUploadBudget(const uint64_t bytes);
+
+      // true if there is nothing left to stream
+      bool IsIdle() const;
+
+      // Statistics for the most recent Update()
+      const Stats& GetStats() const;
+
+   private:
+      struct StreamingTexture {
+         std::shared_ptr<Pikzel::Texture> Texture;
+         std::filesystem::path Path;
+         TextureFormat Format = TextureFormat::Undefined;  // Format, dimensions and mip levels of Texture (copied, so that the worker thread need not touch Texture)
+         uint32_t Width = 0;
+         uint32_t Height = 0;
+         uint32_t MIPLevels = 0;
+         std::vector<uint8_t> FileData;               // until it has been decoded
+         std::vector<std::vector<uint8_t>> MIPData;   // decoded mip levels.  Each is released once it has been uploaded
+         uint32_t ResidentMIPLevel = 0;               // finest mip level uploaded so far (MIPLevels = none yet)
+         float PixelsPerUV = 0.0f;                    // largest reported this frame (0 = not reported)
+         float Priority = 0.0f;                       // for the worker thread's decode order (guarded by m_Mutex)
+         bool IsDecoded = false;                      // guarded by m_Mutex
+         bool IsFailed = false;                       // guarded by m_Mutex
+         bool IsReady = false;                        // render thread's copy of IsDecoded
+      };
+
+      void WorkerMain();
+      float GetPriority(const StreamingTexture& texture) const;
+
+   private:
+      std::vector<std::shared_ptr<StreamingTexture>> m_Textures;              // render thread only
+      std::unordered_map<const Texture*, StreamingTexture*> m_TextureIndex;   // render thread only
+      std::vector<std::shared_ptr<StreamingTexture>> m_DecodeQueue;           // guarded by m_Mutex
+
+      std::thread m_Worker;
+      mutable std::mutex m_Mutex;
+      std::condition_variable m_WorkAvailable;
+      bool m_IsQuitting = false;
+
+      Stats m_Stats;
+      uint64_t m_UploadBudget = 0;
+   };
+
+}
@@ -1,29 +1,257 @@
 #include "AssetCache.h"
 
+#include "Pikzel/Renderer/ContentCache.h"
+#include "Pikzel/Renderer/RenderCore.h"
 #include "Pikzel/Scene/ModelResourceLoader.h"
 
+#include <entt/resource/loader.hpp>
+
+#include <algorithm>
+
 namespace Pikzel {
 
+   // When the budget comes from the device, leave this fraction of it spare
+   static const float DeviceBudgetHeadroom = 0.1f;
+
+
+   struct TextureResourceLoader final : entt::resource_loader<TextureResourceLoader, Texture> {
+
+      std::shared_ptr<Texture> load(const TextureSettings& settings, TextureStreamer* streamer) const {
+         return streamer ? streamer->CreateTexture(settings) : ContentCache::CreateTexture(settings);
+      }
+
+   };
+
+
+   static uint64_t GetGPUBytes(const ModelResource& model) {
+      const auto indexBytes = [](const IndexBuffer& indexBuffer) {
+         return static_cast<uint64_t>(indexBuffer.GetCount()) * (indexBuffer.GetIndexType() == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t));
+      };
+
+      uint64_t bytes = 0;
+      for (const auto& mesh : model.Meshes) {
+         bytes += static_cast<uint64_t>(mesh.VertexCount) * sizeof(Mesh::CompactVertex);
+         if (mesh.IndexBuffer) {
+            bytes += indexBytes(*mesh.IndexBuffer);
+         }
+         for (const auto& lod : mesh.LODs) {
+            bytes += indexBytes(*lod.IndexBuffer);
+         }
+         if (mesh.MeshletBuffer) {
+            bytes += mesh.Meshlets.size() * sizeof(Meshlet);
+         }
+      }
+      return bytes;
+   }
+
+
    Id AssetCache::LoadModelResource(const std::string_view name, const std::filesystem::path& path) {
       auto id = entt::hashed_string(name.data());
-      if (auto handle = GetModelResource(id)) {
-         if (handle->Path != path) {
-            PKZL_CORE_LOG_ERROR("Model with name '{0}' has already been loaded from path '{1}'.  This conflicts with attempt to load from path '{2}'", name, handle->Path, path);
+      if (auto source = m_ModelSources.find(id); source != m_ModelSources.end()) {
+         if (source->second.Path != path) {
+            PKZL_CORE_LOG_ERROR("Model with name '{0}' has already been loaded from path '{1}'.  This conflicts with attempt to load from path '{2}'", name, source->second.Path, path);
          }
       } else {
-         m_ModelCache.load<ModelResourceLoader>(id, name, path);
+         m_ModelSources.emplace(id, ModelResourceSource {std::string {name}, path});
+         GetModelResource(id);
       }
       return id;
    }
 
 
    ModelResourceHandle AssetCache::GetModelResource(Id id) {
-      return m_ModelCache.handle(id);
+      auto residency = m_ModelResidency.find(id);
+      if (residency != m_ModelResidency.end() && residency->second.IsResident) {
+         Touch(residency->second);
+         return m_ModelCache.handle(id);
+      }
+
+      // not loaded yet, or evicted
+      auto source = m_ModelSources.find(id);
+      if (source == m_ModelSources.end()) {
+         return m_ModelCache.handle(id);
+      }
+      if (residency != m_ModelResidency.end()) {
+         PKZL_CORE_LOG_INFO("Reloading evicted model '{0}'", source->second.Name);
+         ++m_Reloads;
+      } else {
+         residency = m_ModelResidency.emplace(id, Residency {}).first;
+      }
+      auto handle = m_ModelCache.load<ModelResourceLoader>(id, source->second.Name, source->second.Path);
+      if (handle) {
+         residency->second.Bytes = GetGPUBytes(*handle);
+         residency->second.IsResident = true;
+         m_ResidentBytes += residency->second.Bytes;
+         Touch(residency->second);
+      }
+      return handle;
+   }
+
+
+   Id AssetCache::LoadTexture(const std::string_view name, const TextureSettings& settings) {
+      auto id = entt::hashed_string(name.data());
+      if (auto source = m_TextureSources.find(id); source != m_TextureSources.end()) {
+         if (source->second.path != settings.path) {
+            PKZL_CORE_LOG_ERROR("Texture with name '{0}' has already been loaded from path '{1}'.  This conflicts with attempt to load from path '{2}'", name, source->second.path, settings.path);
+         }
+      } else {
+         m_TextureSources.emplace(id, settings);
+         GetTexture(id);
+      }
+      return id;
+   }
+
+
+   TextureResourceHandle AssetCache::GetTexture(Id id) {
+      auto residency = m_TextureResidency.find(id);
+      if (residency != m_TextureResidency.end() && residency->second.IsResident) {
+         Touch(residency->second);
+         return m_TextureCache.handle(id);
+      }
+
+      auto source = m_TextureSources.find(id);
+      if (source == m_TextureSources.end()) {
+         return m_TextureCache.handle(id);
+      }
+      if (residency != m_TextureResidency.end()) {
+         PKZL_CORE_LOG_INFO("Reloading evicted texture '{0}'", source->second.path);
+         ++m_Reloads;
+      } else {
+         residency = m_TextureResidency.emplace(id, Residency {}).first;
+      }
+      auto handle = m_TextureCache.load<TextureResourceLoader>(id, source->second, m_TextureStreamer.get());
+      if (handle) {
+         residency->second.Bytes = Texture::CalculateSize(*handle);
+         residency->second.IsResident = true;
+         m_ResidentBytes += residency->second.Bytes;
+         Touch(residency->second);
+      }
+      return handle;
+   }
+
+
+   void AssetCache::EnableTextureStreaming(const uint64_t uploadBudget) {
+      if (m_TextureStreamer) {
+         m_TextureStreamer->SetUploadBudget(uploadBudget);
+      } else {
+         m_TextureStreamer = std::make_unique<TextureStreamer>(uploadBudget);
+      }
+   }
+
+
+   TextureStreamer* AssetCache::GetTextureStreamer() {
+      return m_TextureStreamer.get();
+   }
+
+
+   void AssetCache::SetMemoryBudget(const uint64_t bytes) {
+      m_MemoryBudget = bytes;
+   }
+
+
+   void AssetCache::Update() {
+      PKZL_PROFILE_FUNCTION();
+
+      if (m_TextureStreamer) {
+         m_TextureStreamer->Update();
+      }
+
+      const MemoryBudget device = RenderCore::GetMemoryBudget();
+      uint64_t budget = m_MemoryBudget;
+      if ((budget == 0) && (device.Budget > 0)) {
+         // Assets get whatever is left after everything else (framebuffers, pipelines, ...).
+         // Device usage includes the assets themselves, so take those back out to get the usage of everything else.
+         const uint64_t otherUsage = device.Usage - std::min(device.Usage, m_ResidentBytes);
+         const uint64_t available = static_cast<uint64_t>(static_cast<double>(device.Budget) * (1.0 - DeviceBudgetHeadroom));
+         budget = std::max<uint64_t>(available - std::min(available, otherUsage), 1);
+      }
+
+      m_Stats.Evictions = 0;
+      if ((budget > 0) && (m_ResidentBytes > budget)) {
+         Evict(budget);
+      }
+
+      m_Stats.ResidentBytes = m_ResidentBytes;
+      m_Stats.Budget = budget;
+      m_Stats.DeviceBudget = device.Budget;
+      m_Stats.DeviceUsage = device.Usage;
+      m_Stats.ModelsResident = 0;
+      m_Stats.TexturesResident = 0;
+      for (const auto& [id, residency] : m_ModelResidency) {
+         m_Stats.ModelsResident += residency.IsResident ? 1 : 0;
+      }
+      for (const auto& [id, residency] : m_TextureResidency) {
+         m_Stats.TexturesResident += residency.IsResident ? 1 : 0;
+      }
+      m_Stats.ModelsEvicted = static_cast<uint32_t>(m_ModelResidency.size()) - m_Stats.ModelsResident;
+      m_Stats.TexturesEvicted = static_cast<uint32_t>(m_TextureResidency.size()) - m_Stats.TexturesResident;
+      m_Stats.Reloads = m_Reloads;
+      m_Reloads = 0;
+
+      ++m_Frame;
+   }
+
+
+   const AssetResidencyStats& AssetCache::GetResidencyStats() {
+      return m_Stats;
    }
 
 
    void AssetCache::Clear() {
       m_ModelCache.clear();
+      m_TextureCache.clear();
+      m_TextureStreamer.reset();
+      m_ModelSources.clear();
+      m_TextureSources.clear();
+      m_ModelResidency.clear();
+      m_TextureResidency.clear();
+      m_Stats = {};
+      m_ResidentBytes = 0;
+      m_Reloads = 0;
+   }
+
+
+   void AssetCache::Touch(Residency& residency) {
+      residency.LastUsedFrame = m_Frame;
+   }
+
+
+   void AssetCache::Evict(const uint64_t budget) {
+      // Candidates are assets that have not been used this frame, least recently used first.
+      // Assets used this frame are never evicted (they would just be reloaded next frame)
+      struct Candidate {
+         Id AssetId;
+         Residency* State;
+         bool IsModel;
+      };
+      std::vector<Candidate> candidates;
+      for (auto& [id, residency] : m_ModelResidency) {
+         if (residency.IsResident && (residency.LastUsedFrame < m_Frame)) {
+            candidates.push_back({id, &residency, true});
+         }
+      }
+      for (auto& [id, residency] : m_TextureResidency) {
+         if (residency.IsResident && (residency.LastUsedFrame < m_Frame)) {
+            candidates.push_back({id, &residency, false});
+         }
+      }
+      std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+         return a.State->LastUsedFrame < b.State->LastUsedFrame;
+      });
+
+      for (const auto& candidate : candidates) {
+         if (m_ResidentBytes <= budget) {
+            break;
+         }
+         if (candidate.IsModel) {
+            m_ModelCache.discard(candidate.AssetId);
+         } else {
+            m_TextureCache.discard(candidate.AssetId);
+         }
+         candidate.State->IsResident = false;
+         m_ResidentBytes -= candidate.State->Bytes;
+         ++m_Stats.Evictions;
+      }
    }
 
 }
@@ -1,19 +1,63 @@
 #pragma once
 
 #include "Pikzel/Core/Core.h"
+#include "Pikzel/Renderer/Texture.h"
+#include "Pikzel/Renderer/TextureStreamer.h"
 #include "Pikzel/Scene/ModelResource.h"
 
 #include <entt/resource/cache.hpp>
 #include <entt/resource/handle.hpp>
 
 #include <filesystem>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace Pikzel {
 
    using ModelResourceCache = entt::resource_cache<ModelResource>;
    using ModelResourceHandle = entt::resource_handle<ModelResource>;
 
+   using TextureResourceCache = entt::resource_cache<Texture>;
+   using TextureResourceHandle = entt::resource_handle<Texture>;
+
+   // Where a model resource was loaded from, so that it can be loaded again
+   struct PKZL_API ModelResourceSource {
+      std::string Name;
+      std::filesystem::path Path;
+   };
+
+   using ModelResourceSources = std::unordered_map<Id, ModelResourceSource>;
+
+
+   // GPU memory used by the AssetCache.  See AssetCache::GetResidencyStats()
+   struct PKZL_API AssetResidencyStats {
+      uint64_t ResidentBytes = 0;      // GPU memory used by resident assets (estimated from their sizes)
+      uint64_t Budget = 0;             // what ResidentBytes is held to (0 = no budget, nothing is evicted)
+      uint64_t DeviceBudget = 0;       // from RenderCore::GetMemoryBudget() (0 = not known)
+      uint64_t DeviceUsage = 0;
+      uint32_t ModelsResident = 0;
+      uint32_t ModelsEvicted = 0;      // currently evicted (will be reloaded when next used)
+      uint32_t TexturesResident = 0;
+      uint32_t TexturesEvicted = 0;
+      uint32_t Evictions = 0;          // in the most recent Update()
+      uint32_t Reloads = 0;            // since the Update() before that
+   };
+
+
+   // The AssetCache owns models and textures, by Id.
+   //
+   // It also keeps the GPU memory that they use within a budget.  When the assets' (estimated) GPU memory exceeds the budget,
+   // Update() evicts the least recently used ones (i.e. those that have gone the longest without a GetModelResource() or GetTexture()).
+   // An evicted asset is reloaded from its source the next time it is asked for, so eviction is invisible to callers except for the
+   // time taken to reload.
+   // Consequently: hold on to Ids, not handles.  A handle that is kept across frames keeps its asset's memory in use even after eviction.
+   // Evicted assets are released straight away: frames still in flight on the GPU are not a concern, as the renderer defers destroying
+   // GPU resources until the GPU has finished with them.
+   // Asset sizes are estimated independently of one another, so GPU memory that is shared between assets (see ContentCache) is counted once
+   // for each asset that uses it, and is not freed until all of those assets have been evicted.
    class PKZL_API AssetCache {
       AssetCache() = delete;
       PKZL_NO_COPYMOVE(AssetCache);
@@ -23,11 +67,58 @@ namespace Pikzel {
 
       static ModelResourceHandle GetModelResource(Id modelId);
 
+      // Load a texture from settings.path (see RenderCore::CreateTexture())
+      static Id LoadTexture(const std::string_view name, const TextureSettings& settings);
+
+      static TextureResourceHandle GetTexture(Id textureId);
+
+      // From now on, stream textures that are loaded (or reloaded after eviction) in one mip level at a time, instead of loading them
+      // up front (see TextureStreamer).  Update() then uploads up to uploadBudget bytes of mip levels per frame.
+      // Calling this again just changes the budget.
+      static void EnableTextureStreaming(const uint64_t uploadBudget = 8 * 1024 * 1024);
+
+      // nullptr if texture streaming has not been enabled.
+      // Report where textures are drawn to it (TextureStreamer::ReportPixelsPerUV()) to have those streamed first.
+      static TextureStreamer* GetTextureStreamer();
+
+      // bytes = 0 means use whatever the device says is available (see RenderCore::GetMemoryBudget()), less what everything
+      // other than assets is using.  If the device does not report a budget, then nothing is evicted.
+      static void SetMemoryBudget(const uint64_t bytes);
+
+      // Stream in textures (if enabled), and evict least recently used assets until within budget.
+      // Called once per frame by Application (after the frame has been rendered)
+      static void Update();
+
+      static const AssetResidencyStats& GetResidencyStats();
+
       static void Clear();
 
+   private:
+      struct Residency {
+         uint64_t Bytes = 0;
+         uint64_t LastUsedFrame = 0;
+         bool IsResident = false;
+      };
+
+      static void Touch(Residency& residency);
+      static void Evict(const uint64_t budget);
+
    private:
       friend class SceneSerializerYAML;
       inline static ModelResourceCache m_ModelCache;
+      inline static TextureResourceCache m_TextureCache;
+
+      inline static ModelResourceSources m_ModelSources;
+      inline static std::unordered_map<Id, TextureSettings> m_TextureSources;
+      inline static std::unordered_map<Id, Residency> m_ModelResidency;
+      inline static std::unordered_map<Id, Residency> m_TextureResidency;
+      inline static std::unique_ptr<TextureStreamer> m_TextureStreamer;
+
+      inline static AssetResidencyStats m_Stats;
+      inline static uint64_t m_MemoryBudget = 0;
+      inline static uint64_t m_ResidentBytes = 0;
+      inline static uint64_t m_Frame = 1;
+      inline static uint32_t m_Reloads = 0;
 
    };
 
@@ -0,0 +1,87 @@
+#include "Material.h"
+
+#include "Pikzel/Renderer/RenderCore.h"
+#include "Pikzel/Scene/Mesh.h"
+
+#include <algorithm>
+
+namespace Pikzel {
+
+   Material::Material(const GraphicsContext& gc, const MaterialSettings& settings)
+   : m_ParametersId {settings.parametersId}
+   {
+      const PipelineSettings pipelineSettings {
+         .enableBlend = settings.enableBlend,
+         .shaders = settings.shaders,
+         .bufferLayout = Mesh::CompactVertexBufferLayout,
+         .specializationConstants = settings.specializationConstants
+      };
+      if (settings.createAsync) {
+         m_PipelineFuture = gc.CreatePipelineAsync(pipelineSettings);
+      } else {
+         m_Pipeline = gc.CreatePipeline(pipelineSettings);
+      }
+   }
+
+
+   bool Material::IsReady() const {
+      return m_Pipeline || (m_PipelineFuture->Get() != nullptr);
+   }
+
+
+   const Pipeline& Material::GetPipeline() const {
+      PKZL_CORE_ASSERT(IsReady(), "Material pipeline is not ready!");
+      return m_Pipeline ? *m_Pipeline : *m_PipelineFuture->Get();
+   }
+
+
+   Id Material::GetParametersId() const {
+      return m_ParametersId;
+   }
+
+
+   MaterialInstance::MaterialInstance(std::shared_ptr<Material> material)
+   : m_Material {std::move(material)}
+   {
+      PKZL_CORE_ASSERT(m_Material, "MaterialInstance must have a material!");
+   }
+
+
+   const Material& MaterialInstance::GetMaterial() const {
+      return *m_Material;
+   }
+
+
+   void MaterialInstance::SetTexture(const Id resourceId, std::shared_ptr<Texture> texture) {
+      auto existing = std::find_if(m_Textures.begin(), m_Textures.end(), [resourceId](const auto& binding) { return binding.first == resourceId; });
+      if (existing != m_Textures.end()) {
+         existing->second = std::move(texture);
+      } else {
+         m_Textures.emplace_back(resourceId, std::move(texture));
+      }
+   }
+
+
+   void MaterialInstance::SetParameters(const void* data, const uint32_t size) {
+      if (!m_Parameters) {
+         m_Parameters = RenderCore::CreateUniformBuffer(size, data);
+         m_ParametersSize = size;
+         return;
+      }
+      if (size != m_ParametersSize) {
+         throw std::runtime_error {fmt::format("Material parameters are {0} bytes.  Cannot change them to {1} bytes!", m_ParametersSize, size)};
+      }
+      m_Parameters->CopyFromHost(0, size, data);
+   }
+
+
+   void MaterialInstance::Bind(GraphicsContext& gc) const {
+      if (m_Parameters) {
+         gc.Bind(m_Material->GetParametersId(), *m_Parameters);
+      }
+      for (const auto& [resourceId, texture] : m_Textures) {
+         gc.Bind(resourceId, *texture);
+      }
+   }
+
+}
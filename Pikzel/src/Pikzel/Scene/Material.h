@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Pikzel/Renderer/Buffer.h"
+#include "Pikzel/Renderer/GraphicsContext.h"
+#include "Pikzel/Renderer/Pipeline.h"
+#include "Pikzel/Renderer/PipelineCompiler.h"
+#include "Pikzel/Renderer/Texture.h"
+
+#include <filesystem>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Pikzel {
+
+   struct PKZL_API MaterialSettings {
+      std::vector<std::pair<ShaderType, std::filesystem::path>> shaders;
+      SpecializationConstantsMap specializationConstants;
+      bool enableBlend = false;
+      Id parametersId = "Material"_hs;   // name of the uniform block in the shaders that MaterialInstance parameters are bound to
+      bool createAsync = false;          // create the pipeline in the background (see GraphicsContext::CreatePipelineAsync())
+   };
+
+
+   // A Material is how a surface is shaded: shaders, and their specialization constants (i.e. a pipeline).
+   // What is shaded with it (textures and parameter values) is up to each MaterialInstance.
+   //
+   // Materials are for drawing meshes (see SceneRenderer).  So the vertex shader must take Mesh::CompactVertexBufferLayout, and a
+   // push constant block with a mat4 "constants.mvp" (which includes the mesh's dequantize transform)
+   //
+   // A material whose pipeline is created asynchronously cannot be drawn with until IsReady().  SceneRenderer draws with its default
+   // material instead until then.
+   class PKZL_API Material {
+   public:
+      Material(const GraphicsContext& gc, const MaterialSettings& settings);
+      virtual ~Material() = default;
+
+      PKZL_NO_COPY(Material);
+
+      // false until an asynchronously created pipeline is ready (and also if it failed)
+      bool IsReady() const;
+
+      const Pipeline& GetPipeline() const;
+      Id GetParametersId() const;
+
+   private:
+      std::unique_ptr<Pipeline> m_Pipeline;
+      std::shared_ptr<PipelineFuture> m_PipelineFuture;
+      Id m_ParametersId;
+   };
+
+
+   // A set of textures and parameter values to shade with a Material.
+   // Parameters are packed into one uniform block (laid out std140, to match the shaders), so binding an instance is at most one
+   // uniform buffer bind plus one bind per texture.
+   class PKZL_API MaterialInstance {
+   public:
+      MaterialInstance(std::shared_ptr<Material> material);
+      virtual ~MaterialInstance() = default;
+
+      PKZL_NO_COPY(MaterialInstance);
+
+      const Material& GetMaterial() const;
+
+      // Bind texture to the shader resource resourceId.  Setting the same resourceId again replaces the texture
+      void SetTexture(const Id resourceId, std::shared_ptr<Texture> texture);
+
+      // Set the whole parameter block.  The size must stay the same after the first call
+      void SetParameters(const void* data, const uint32_t size);
+
+      template<typename T>
+      void SetParameters(const T& parameters) {
+         SetParameters(&parameters, static_cast<uint32_t>(sizeof(T)));
+      }
+
+      // Bind textures and parameters.  The material's pipeline must already be bound
+      void Bind(GraphicsContext& gc) const;
+
+   private:
+      std::shared_ptr<Material> m_Material;
+      std::vector<std::pair<Id, std::shared_ptr<Texture>>> m_Textures;
+      std::unique_ptr<UniformBuffer> m_Parameters;
+      uint32_t m_ParametersSize = 0;
+   };
+
+}
@@ -1,10 +1,17 @@
 #pragma once
 
 #include "Pikzel/Renderer/Buffer.h"
+#include "Pikzel/Scene/Meshlets.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
 namespace Pikzel {
 
    struct PKZL_API Mesh final {
@@ -25,10 +32,34 @@ namespace Pikzel {
          { "inUV",      Pikzel::DataType::Vec2 },
       };
 
+      // Compact vertex format: 20 bytes, as opposed to 44 for Vertex.  See VertexCompression.h
+      struct CompactVertex {
+         uint16_t Pos[4];     // quantized to the mesh's bounding box (DequantizeTransform maps back to mesh space).  w is unused
+         int16_t Normal[2];   // octahedral encoded
+         int16_t Tangent[2];  // octahedral encoded
+         uint16_t UV[2];      // half floats
+      };
+
+      inline static BufferLayout CompactVertexBufferLayout = {
+         { "inPos",     Pikzel::DataType::UNorm16Vec4 },
+         { "inNormal",  Pikzel::DataType::SNorm16Vec2 },
+         { "inTangent", Pikzel::DataType::SNorm16Vec2 },
+         { "inUV",      Pikzel::DataType::HVec2 },
+      };
+
+      // A simplified version of the mesh.  Uses the same vertex buffer as the full resolution mesh.
+      struct LOD {
+         std::shared_ptr<Pikzel::IndexBuffer> IndexBuffer;
+         float Error = 0.0f;  // how far (in mesh units) the simplified surface may be from the full resolution one
+      };
+
+      // Maximum number of levels of detail (including the full resolution mesh)
+      static constexpr uint32_t MaxLODs = 6;
+
       Mesh() = default;
       ~Mesh() = default;
 
-      Mesh(std::unique_ptr<VertexBuffer> vb, std::unique_ptr<IndexBuffer> ib)
+      Mesh(std::shared_ptr<VertexBuffer> vb, std::shared_ptr<IndexBuffer> ib)
       : VertexBuffer { std::move(vb) }
       , IndexBuffer {std::move(ib) }
       {}
@@ -36,18 +67,81 @@ namespace Pikzel {
       Mesh(Mesh&& mesh) noexcept
       : VertexBuffer { std::move(mesh.VertexBuffer) }
       , IndexBuffer { std::move(mesh.IndexBuffer) }
+      , LODs { std::move(mesh.LODs) }
+      , Meshlets { std::move(mesh.Meshlets) }
+      , MeshletBuffer { std::move(mesh.MeshletBuffer) }
+      , OccluderPositions { std::move(mesh.OccluderPositions) }
+      , OccluderIndices { std::move(mesh.OccluderIndices) }
+      , AABB { mesh.AABB }
+      , DequantizeTransform { mesh.DequantizeTransform }
+      , VertexCount { mesh.VertexCount }
       {}
 
       Mesh& operator=(Mesh&& mesh) noexcept {
          if (this != &mesh) {
             VertexBuffer = std::move(mesh.VertexBuffer);
             IndexBuffer = std::move(mesh.IndexBuffer);
+            LODs = std::move(mesh.LODs);
+            Meshlets = std::move(mesh.Meshlets);
+            MeshletBuffer = std::move(mesh.MeshletBuffer);
+            OccluderPositions = std::move(mesh.OccluderPositions);
+            OccluderIndices = std::move(mesh.OccluderIndices);
+            AABB = mesh.AABB;
+            DequantizeTransform = mesh.DequantizeTransform;
+            VertexCount = mesh.VertexCount;
          }
          return *this;
       }
 
-      std::unique_ptr<VertexBuffer> VertexBuffer;
-      std::unique_ptr<IndexBuffer> IndexBuffer;
+      // Index buffer for given level of detail.  Level 0 is the full resolution mesh.
+      // If the mesh does not have that many levels, then the coarsest one it does have is returned.
+      const Pikzel::IndexBuffer& GetIndexBuffer(const uint32_t lod) const {
+         if ((lod == 0) || LODs.empty()) {
+            return *IndexBuffer;
+         }
+         return *LODs[std::min<size_t>(lod, LODs.size()) - 1].IndexBuffer;
+      }
+
+      // Simplification error at given level of detail (0 for the full resolution mesh)
+      float GetLODError(const uint32_t lod) const {
+         if ((lod == 0) || LODs.empty()) {
+            return 0.0f;
+         }
+         return LODs[std::min<size_t>(lod, LODs.size()) - 1].Error;
+      }
+
+      // Buffers are shared with any other mesh that has identical contents (see ContentCache)
+      std::shared_ptr<VertexBuffer> VertexBuffer;
+      std::shared_ptr<IndexBuffer> IndexBuffer;
+      std::vector<LOD> LODs;                                  // LODs[0] is level of detail 1 (i.e. the first simplified version of the mesh)
+      std::vector<Meshlet> Meshlets;                          // meshlets of the full resolution mesh (LODs are not split into meshlets)
+      std::shared_ptr<StorageBuffer> MeshletBuffer;           // Meshlets, for culling on the GPU
+      std::vector<glm::vec3> OccluderPositions;               // geometry for software occlusion culling (full resolution, positions only, mesh space).  See OcclusionCuller.h
+      std::vector<uint32_t> OccluderIndices;
+      std::pair<glm::vec3, glm::vec3> AABB = {glm::vec3 {std::numeric_limits<float>::max()}, glm::vec3 {std::numeric_limits<float>::lowest()}};  // (min, max) in mesh space
+      glm::mat4 DequantizeTransform = glm::identity<glm::mat4>();  // maps vertex positions in the vertex buffer to mesh space
+      uint32_t VertexCount = 0;
    };
 
+
+   // Texture coordinate units per mesh space unit, on average over the surface of a mesh
+   // (square root of the ratio of total triangle area in texture space to total triangle area in mesh space).
+   // Together with the transform and camera, this says how big a mesh's textures appear on screen.  See SceneRenderer::GetPixelsPerUV()
+   // Vertex must have a glm::vec3 member called Pos, and a glm::vec2 member called UV.
+   template<typename Vertex>
+   float CalculateUVDensity(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+      double area = 0.0;
+      double areaUV = 0.0;
+      for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+         const Vertex& v0 = vertices[indices[i]];
+         const Vertex& v1 = vertices[indices[i + 1]];
+         const Vertex& v2 = vertices[indices[i + 2]];
+         area += 0.5 * glm::length(glm::cross(v1.Pos - v0.Pos, v2.Pos - v0.Pos));
+         const glm::vec2 e1 = v1.UV - v0.UV;
+         const glm::vec2 e2 = v2.UV - v0.UV;
+         areaUV += 0.5 * std::abs((e1.x * e2.y) - (e1.y * e2.x));
+      }
+      return area > 0.0 ? static_cast<float>(std::sqrt(areaUV / area)) : 0.0f;
+   }
+
 }
@@ -0,0 +1,219 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Pikzel {
+
+   VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, const size_t vertexCount, const uint32_t cacheSize) {
+      // no whole triangles => nothing to measure (and ACMR would divide by zero)
+      if (indices.size() < 3) {
+         return {};
+      }
+
+      // FIFO cache: vertex v is in the cache if it was added within the last cacheSize misses
+      std::vector<uint32_t> cacheTime(vertexCount, 0);
+      std::vector<bool> isReferenced(vertexCount, false);
+      uint32_t time = cacheSize + 1;
+      size_t misses = 0;
+      size_t numReferenced = 0;
+      for (const uint32_t index : indices) {
+         if (time - cacheTime[index] > cacheSize) {
+            cacheTime[index] = time++;
+            ++misses;
+         }
+         if (!isReferenced[index]) {
+            isReferenced[index] = true;
+            ++numReferenced;
+         }
+      }
+
+      return {
+         .ACMR = static_cast<float>(misses) / static_cast<float>(indices.size() / 3),
+         .ATVR = static_cast<float>(misses) / static_cast<float>(numReferenced)
+      };
+   }
+
+
+   std::vector<size_t> OptimizeVertexCache(std::vector<uint32_t>& indices, const size_t vertexCount, const uint32_t cacheSize) {
+      PKZL_PROFILE_FUNCTION();
+
+      const size_t numTriangles = indices.size() / 3;
+      std::vector<size_t> clusters;
+      if (numTriangles == 0) {
+         return clusters;
+      }
+
+      // vertex => triangles that use it
+      std::vector<uint32_t> live(vertexCount, 0);  // number of not yet emitted triangles that use each vertex
+      for (const uint32_t index : indices) {
+         ++live[index];
+      }
+      std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+      for (size_t i = 0; i < vertexCount; ++i) {
+         triangleOffsets[i + 1] = triangleOffsets[i] + live[i];
+      }
+      std::vector<uint32_t> triangles(indices.size());
+      {
+         std::vector<uint32_t> next(triangleOffsets.begin(), triangleOffsets.end() - 1);
+         for (uint32_t i = 0; i < indices.size(); ++i) {
+            triangles[next[indices[i]]++] = i / 3;
+         }
+      }
+
+      std::vector<uint32_t> result;
+      result.reserve(indices.size());
+      std::vector<bool> isEmitted(numTriangles, false);
+      std::vector<uint32_t> cacheTime(vertexCount, 0);
+      std::vector<uint32_t> deadEnd;     // recently used vertices, to return to when the current fan runs out
+      std::vector<uint32_t> candidates;  // vertices of the triangles emitted by the current fan
+      uint32_t time = cacheSize + 1;
+      size_t cursor = 0;                 // for finding any vertex with triangles left, once the dead end stack is exhausted
+
+      int64_t fanning = indices[0];
+      clusters.push_back(0);
+      while (fanning >= 0) {
+         candidates.clear();
+         for (uint32_t t = triangleOffsets[fanning]; t < triangleOffsets[fanning + 1]; ++t) {
+            const uint32_t triangle = triangles[t];
+            if (isEmitted[triangle]) {
+               continue;
+            }
+            isEmitted[triangle] = true;
+            for (size_t k = 0; k < 3; ++k) {
+               const uint32_t v = indices[(triangle * 3) + k];
+               result.push_back(v);
+               deadEnd.push_back(v);
+               candidates.push_back(v);
+               --live[v];
+               if (time - cacheTime[v] > cacheSize) {
+                  cacheTime[v] = time++;
+               }
+            }
+         }
+
+         // Next fanning vertex is the candidate that will still be in the cache (after its remaining triangles are emitted)
+         // and has been there longest.
+         fanning = -1;
+         int64_t best = -1;
+         for (const uint32_t v : candidates) {
+            if (live[v] > 0) {
+               int64_t priority = 0;
+               if ((time - cacheTime[v]) + (2 * live[v]) <= cacheSize) {
+                  priority = time - cacheTime[v];
+               }
+               if (priority > best) {
+                  best = priority;
+                  fanning = v;
+               }
+            }
+         }
+
+         // None of the candidates have any triangles left, so we have to jump somewhere else in the mesh.
+         // Try recently used vertices first, and failing that, any vertex that still has triangles.
+         if (fanning < 0) {
+            while (!deadEnd.empty()) {
+               const uint32_t v = deadEnd.back();
+               deadEnd.pop_back();
+               if (live[v] > 0) {
+                  fanning = v;
+                  break;
+               }
+            }
+            while ((fanning < 0) && (cursor < vertexCount)) {
+               if (live[cursor] > 0) {
+                  fanning = cursor;
+               }
+               ++cursor;
+            }
+            if ((fanning >= 0) && (result.size() < indices.size())) {
+               clusters.push_back(result.size());
+            }
+         }
+      }
+
+      PKZL_CORE_ASSERT(result.size() == indices.size(), "OptimizeVertexCache() did not emit every triangle!");
+      indices = std::move(result);
+      return clusters;
+   }
+
+
+   void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<size_t>& clusters, const glm::vec3* positions, const size_t vertexStride) {
+      PKZL_PROFILE_FUNCTION();
+
+      if (clusters.size() < 2) {
+         return;
+      }
+
+      const auto position = [positions, vertexStride](const uint32_t v) -> const glm::vec3& {
+         return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const std::byte*>(positions) + (v * vertexStride));
+      };
+
+      struct Cluster {
+         size_t begin;
+         size_t end;
+         glm::vec3 centroid;
+         glm::vec3 normal;
+         float sortKey;
+      };
+
+      std::vector<Cluster> sorted;
+      sorted.reserve(clusters.size());
+      glm::vec3 meshCentroid = {};
+      float meshArea = 0.0f;
+      for (size_t c = 0; c < clusters.size(); ++c) {
+         Cluster cluster = {clusters[c], c + 1 < clusters.size() ? clusters[c + 1] : indices.size(), {}, {}, 0.0f};
+         float area = 0.0f;
+         for (size_t i = cluster.begin; i < cluster.end; i += 3) {
+            const glm::vec3& p0 = position(indices[i]);
+            const glm::vec3& p1 = position(indices[i + 1]);
+            const glm::vec3& p2 = position(indices[i + 2]);
+            const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            const float triangleArea = glm::length(normal) * 0.5f;
+            cluster.centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            cluster.normal += normal;
+            area += triangleArea;
+         }
+         meshCentroid += cluster.centroid;
+         meshArea += area;
+         cluster.centroid = area > 0.0f ? cluster.centroid / area : position(indices[cluster.begin]);
+         sorted.push_back(cluster);
+      }
+      meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3 {};
+
+      for (auto& cluster : sorted) {
+         const float length = glm::length(cluster.normal);
+         cluster.sortKey = length > 0.0f ? glm::dot(cluster.centroid - meshCentroid, cluster.normal / length) : 0.0f;
+      }
+      std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+      std::vector<uint32_t> result;
+      result.reserve(indices.size());
+      for (const auto& cluster : sorted) {
+         result.insert(result.end(), indices.begin() + cluster.begin, indices.begin() + cluster.end);
+      }
+      indices = std::move(result);
+   }
+
+
+   std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices, const size_t vertexCount) {
+      PKZL_PROFILE_FUNCTION();
+
+      const uint32_t unused = ~0u;
+      std::vector<uint32_t> remap(vertexCount, unused);
+      uint32_t next = 0;
+      for (uint32_t& index : indices) {
+         if (remap[index] == unused) {
+            remap[index] = next++;
+         }
+         index = remap[index];
+      }
+      for (uint32_t& v : remap) {
+         if (v == unused) {
+            v = next++;
+         }
+      }
+      return remap;
+   }
+
+}
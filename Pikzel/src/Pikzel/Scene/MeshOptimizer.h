@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+#include <glm/glm.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace Pikzel {
+
+   // Post-transform vertex cache statistics for an index buffer, measured by simulating a FIFO cache
+   struct VertexCacheStats {
+      float ACMR = 0.0f;  // average cache miss ratio: vertices transformed per triangle.  0.5 is ideal for a large regular grid, 3.0 is worst case
+      float ATVR = 0.0f;  // average transformed vertex ratio: vertices transformed per (referenced) vertex.  1.0 is ideal
+   };
+
+   // Size of the post-transform vertex cache that the optimizations below aim for
+   constexpr uint32_t VertexCacheSize = 16;
+
+   VertexCacheStats PKZL_API AnalyzeVertexCache(const std::vector<uint32_t>& indices, const size_t vertexCount, const uint32_t cacheSize = VertexCacheSize);
+
+   // Reorder triangles for post-transform vertex cache locality ("Tipsify", Sander, Nehab and Barczak 2007).
+   // Returns the offset (into indices) of the start of each cluster of triangles.  A cluster boundary is wherever the
+   // algorithm had to jump to a different part of the mesh, so the clusters can then be reordered without hurting the cache much.
+   std::vector<size_t> PKZL_API OptimizeVertexCache(std::vector<uint32_t>& indices, const size_t vertexCount, const uint32_t cacheSize = VertexCacheSize);
+
+   // Reorder clusters of triangles (as returned by OptimizeVertexCache()) to reduce overdraw.
+   // Clusters that face outwards from the middle of the mesh are more likely to occlude other clusters, so they are drawn first.
+   // positions points to the position of the first vertex, and vertexStride is the distance (in bytes) between consecutive positions.
+   void PKZL_API OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<size_t>& clusters, const glm::vec3* positions, const size_t vertexStride);
+
+   // Renumber vertices in the order that they are first used by indices (for vertex fetch locality).
+   // indices are updated, and the returned table maps old vertex index to new (vertices not used by indices go last).
+   // Use RemapVertices() to apply the table to the vertex data.
+   std::vector<uint32_t> PKZL_API OptimizeVertexFetch(std::vector<uint32_t>& indices, const size_t vertexCount);
+
+   template<typename Vertex>
+   void RemapVertices(std::vector<Vertex>& vertices, const std::vector<uint32_t>& remap) {
+      std::vector<Vertex> remapped;
+      remapped.reserve(vertices.size());
+      std::vector<uint32_t> order(vertices.size());
+      for (uint32_t i = 0; i < remap.size(); ++i) {
+         order[remap[i]] = i;
+      }
+      for (const uint32_t i : order) {
+         remapped.push_back(vertices[i]);
+      }
+      vertices = std::move(remapped);
+   }
+
+
+   // Runs all of the above, in order: vertex cache, then overdraw, then vertex fetch.
+   // Vertex must have a glm::vec3 member called Pos.
+   // Returns vertex cache statistics from before and after optimization.
+   template<typename Vertex>
+   std::pair<VertexCacheStats, VertexCacheStats> OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+      PKZL_PROFILE_FUNCTION();
+      const VertexCacheStats before = AnalyzeVertexCache(indices, vertices.size());
+      if (!vertices.empty()) {
+         const std::vector<size_t> clusters = OptimizeVertexCache(indices, vertices.size());
+         OptimizeOverdraw(indices, clusters, &vertices[0].Pos, sizeof(Vertex));
+         RemapVertices(vertices, OptimizeVertexFetch(indices, vertices.size()));
+      }
+      return {before, AnalyzeVertexCache(indices, vertices.size())};
+   }
+
+}
@@ -0,0 +1,287 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace Pikzel {
+
+   // Symmetric 4x4 matrix that measures squared distance to a set of planes (weighted by triangle area)
+   struct Quadric {
+      double a2 = 0.0, b2 = 0.0, c2 = 0.0, d2 = 0.0;
+      double ab = 0.0, ac = 0.0, ad = 0.0;
+      double bc = 0.0, bd = 0.0;
+      double cd = 0.0;
+      double weight = 0.0;
+
+      Quadric& operator+=(const Quadric& q) {
+         a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+         ab += q.ab; ac += q.ac; ad += q.ad;
+         bc += q.bc; bd += q.bd;
+         cd += q.cd;
+         weight += q.weight;
+         return *this;
+      }
+   };
+
+
+   static Quadric PlaneQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+      const glm::dvec3 cross = glm::cross(glm::dvec3 {p1 - p0}, glm::dvec3 {p2 - p0});
+      const double length = glm::length(cross);
+      if (length == 0.0) {
+         return {};
+      }
+      const glm::dvec3 n = cross / length;
+      const double d = -glm::dot(n, glm::dvec3 {p0});
+      const double w = length * 0.5;  // triangle area
+      return {
+         .a2 = w * n.x * n.x, .b2 = w * n.y * n.y, .c2 = w * n.z * n.z, .d2 = w * d * d,
+         .ab = w * n.x * n.y, .ac = w * n.x * n.z, .ad = w * n.x * d,
+         .bc = w * n.y * n.z, .bd = w * n.y * d,
+         .cd = w * n.z * d,
+         .weight = w
+      };
+   }
+
+
+   // Returns (area weighted) mean squared distance from point p to the quadric's planes
+   static double QuadricError(const Quadric& q, const glm::vec3& p) {
+      if (q.weight == 0.0) {
+         return 0.0;
+      }
+      const double x = p.x;
+      const double y = p.y;
+      const double z = p.z;
+      const double error =
+         (q.a2 * x * x) + (q.b2 * y * y) + (q.c2 * z * z) +
+         2.0 * ((q.ab * x * y) + (q.ac * x * z) + (q.bc * y * z)) +
+         2.0 * ((q.ad * x) + (q.bd * y) + (q.cd * z)) +
+         q.d2
+      ;
+      return glm::max(error, 0.0) / q.weight;
+   }
+
+
+   struct PositionHash {
+      size_t operator()(const glm::vec3& p) const {
+         const std::hash<float> hash;
+         return hash(p.x) ^ (hash(p.y) * 73856093) ^ (hash(p.z) * 19349663);
+      }
+   };
+
+
+   std::vector<uint32_t> SimplifyMesh(const std::vector<Mesh::Vertex>& vertices, const std::vector<uint32_t>& indices, const size_t targetIndexCount, const float maxError, float& error) {
+      PKZL_PROFILE_FUNCTION();
+
+      const size_t numVertices = vertices.size();
+
+      // Vertices with the same position (but different normals, tangents or UVs) are "wedges" of one point on the surface: there
+      // is a seam there (e.g. a UV seam, or a hard edge).
+      // positionId is the same for all wedges of a position, and nextWedge links them into a cycle.
+      std::vector<uint32_t> positionId(numVertices);
+      std::vector<uint32_t> nextWedge(numVertices);
+      {
+         std::unordered_map<glm::vec3, uint32_t, PositionHash> positions;
+         for (uint32_t i = 0; i < numVertices; ++i) {
+            const auto [position, isNew] = positions.try_emplace(vertices[i].Pos, i);
+            positionId[i] = position->second;
+            nextWedge[i] = isNew ? i : nextWedge[position->second];
+            if (!isNew) {
+               nextWedge[position->second] = i;
+            }
+         }
+      }
+
+      // Positions that must not move: the ends of border edges (edges that belong to only one triangle), so that the outline of the mesh is kept.
+      // Seams are not borders (the edge count is by position), so seams are free to simplify (see below)
+      std::vector<bool> isLocked(numVertices, false);  // by positionId
+      {
+         std::unordered_map<uint64_t, int> edgeCount;
+         for (size_t i = 0; i < indices.size(); i += 3) {
+            for (size_t j = 0; j < 3; ++j) {
+               const uint64_t a = positionId[indices[i + j]];
+               const uint64_t b = positionId[indices[i + ((j + 1) % 3)]];
+               ++edgeCount[(std::min(a, b) << 32) | std::max(a, b)];
+            }
+         }
+         for (const auto& [edge, count] : edgeCount) {
+            if (count == 1) {
+               isLocked[edge >> 32] = true;
+               isLocked[edge & 0xFFFFFFFF] = true;
+            }
+         }
+      }
+
+      // All wedges of a position are on the same surface, so quadrics are by position
+      std::vector<Quadric> quadrics(numVertices);
+      for (size_t i = 0; i < indices.size(); i += 3) {
+         const Quadric q = PlaneQuadric(vertices[indices[i]].Pos, vertices[indices[i + 1]].Pos, vertices[indices[i + 2]].Pos);
+         quadrics[positionId[indices[i]]] += q;
+         quadrics[positionId[indices[i + 1]]] += q;
+         quadrics[positionId[indices[i + 2]]] += q;
+      }
+
+      struct Collapse {
+         uint32_t from;
+         uint32_t to;
+         double cost;
+      };
+
+      std::vector<uint32_t> result = indices;
+      std::vector<uint32_t> triangleOffsets(numVertices + 1);
+      std::vector<uint32_t> triangles;
+      std::vector<Collapse> collapses;
+      std::vector<std::pair<uint32_t, uint32_t>> wedgeCollapses;  // (from, to) for each wedge moved by a collapse
+      std::vector<uint32_t> remap(numVertices);
+      std::vector<bool> isTouched(numVertices);                   // by positionId
+      const double maxCost = static_cast<double>(maxError) * static_cast<double>(maxError);
+      double maxCollapseCost = 0.0;
+
+      // Each pass collapses as many edges as it can without any two collapses touching the same triangles.
+      // Adjacency is then rebuilt for the next pass.
+      while (result.size() > targetIndexCount) {
+
+         // vertex => triangles that use it
+         std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+         for (const uint32_t index : result) {
+            ++triangleOffsets[index + 1];
+         }
+         for (size_t i = 1; i <= numVertices; ++i) {
+            triangleOffsets[i] += triangleOffsets[i - 1];
+         }
+         triangles.resize(result.size());
+         {
+            std::vector<uint32_t> next(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for (uint32_t i = 0; i < result.size(); ++i) {
+               triangles[next[result[i]]++] = i / 3;
+            }
+         }
+
+         collapses.clear();
+         for (size_t i = 0; i < result.size(); i += 3) {
+            for (size_t j = 0; j < 3; ++j) {
+               const uint32_t v0 = result[i + j];
+               const uint32_t v1 = result[i + ((j + 1) % 3)];
+               Quadric q = quadrics[positionId[v0]];
+               q += quadrics[positionId[v1]];
+               if (!isLocked[positionId[v0]]) {
+                  collapses.push_back({v0, v1, QuadricError(q, vertices[v1].Pos)});
+               }
+               if (!isLocked[positionId[v1]]) {
+                  collapses.push_back({v1, v0, QuadricError(q, vertices[v0].Pos)});
+               }
+            }
+         }
+         std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+         for (uint32_t i = 0; i < numVertices; ++i) {
+            remap[i] = i;
+         }
+         std::fill(isTouched.begin(), isTouched.end(), false);
+
+         const size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+         size_t trianglesRemoved = 0;
+         for (const auto& collapse : collapses) {
+            if ((collapse.cost > maxCost) || (trianglesRemoved >= trianglesToRemove)) {
+               break;
+            }
+            const uint32_t from = positionId[collapse.from];
+            const uint32_t to = positionId[collapse.to];
+            if (isTouched[from] || isTouched[to]) {
+               continue;
+            }
+
+            // Every wedge at the position being moved goes to the (one) wedge at the destination that it shares an edge with.
+            // So a seam only ever collapses along itself, and each side of it keeps its own attributes.
+            // There is no such wedge (and the collapse is rejected) if the edge crosses from a seam into the interior of one side
+            // of it, or at a corner where more than two sides meet.
+            wedgeCollapses.clear();
+            bool isValid = true;
+            uint32_t wedge = collapse.from;
+            do {
+               if (triangleOffsets[wedge] != triangleOffsets[wedge + 1]) {
+                  int64_t target = -1;
+                  for (uint32_t t = triangleOffsets[wedge]; isValid && (t < triangleOffsets[wedge + 1]); ++t) {
+                     for (size_t k = 0; k < 3; ++k) {
+                        const uint32_t v = result[(triangles[t] * 3) + k];
+                        if (positionId[v] == to) {
+                           isValid = isValid && ((target < 0) || (target == v));
+                           target = v;
+                        }
+                     }
+                  }
+                  isValid = isValid && (target >= 0);
+                  if (isValid) {
+                     wedgeCollapses.emplace_back(wedge, static_cast<uint32_t>(target));
+                  }
+               }
+               wedge = nextWedge[wedge];
+            } while (isValid && (wedge != collapse.from));
+            if (!isValid) {
+               continue;
+            }
+
+            // Reject collapses that would flip (or squash flat) any of the triangles around the position being moved
+            bool isFlipped = false;
+            size_t numCollapsedTriangles = 0;
+            for (const auto& [wedgeFrom, wedgeTo] : wedgeCollapses) {
+               for (uint32_t t = triangleOffsets[wedgeFrom]; !isFlipped && (t < triangleOffsets[wedgeFrom + 1]); ++t) {
+                  const uint32_t* triangle = &result[triangles[t] * 3];
+                  if ((triangle[0] == wedgeTo) || (triangle[1] == wedgeTo) || (triangle[2] == wedgeTo)) {
+                     ++numCollapsedTriangles;
+                     continue;
+                  }
+                  glm::vec3 p[3];
+                  glm::vec3 q[3];
+                  for (size_t k = 0; k < 3; ++k) {
+                     p[k] = vertices[triangle[k]].Pos;
+                     q[k] = triangle[k] == wedgeFrom ? vertices[wedgeTo].Pos : p[k];
+                  }
+                  const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                  const glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                  if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after)) {
+                     isFlipped = true;
+                  }
+               }
+            }
+            if (isFlipped) {
+               continue;
+            }
+
+            quadrics[to] += quadrics[from];
+            for (const auto& [wedgeFrom, wedgeTo] : wedgeCollapses) {
+               remap[wedgeFrom] = wedgeTo;
+               for (uint32_t t = triangleOffsets[wedgeFrom]; t < triangleOffsets[wedgeFrom + 1]; ++t) {
+                  const uint32_t* triangle = &result[triangles[t] * 3];
+                  isTouched[positionId[triangle[0]]] = true;
+                  isTouched[positionId[triangle[1]]] = true;
+                  isTouched[positionId[triangle[2]]] = true;
+               }
+            }
+            trianglesRemoved += numCollapsedTriangles;
+            maxCollapseCost = glm::max(maxCollapseCost, collapse.cost);
+         }
+
+         if (trianglesRemoved == 0) {
+            break;
+         }
+
+         size_t count = 0;
+         for (size_t i = 0; i < result.size(); i += 3) {
+            const uint32_t v0 = remap[result[i]];
+            const uint32_t v1 = remap[result[i + 1]];
+            const uint32_t v2 = remap[result[i + 2]];
+            if ((v0 != v1) && (v1 != v2) && (v2 != v0)) {
+               result[count++] = v0;
+               result[count++] = v1;
+               result[count++] = v2;
+            }
+         }
+         result.resize(count);
+      }
+
+      error = static_cast<float>(glm::sqrt(maxCollapseCost));
+      return result;
+   }
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Pikzel/Scene/Mesh.h"
+
+#include <vector>
+
+namespace Pikzel {
+
+   // Simplifies a triangle mesh by collapsing edges, cheapest first, where the cost of a collapse is measured by
+   // quadric error metrics (Garland and Heckbert).
+   //
+   // A collapse always moves a vertex onto one of its neighbours, so no new vertices are created and the simplified indices
+   // can be used with the original vertex buffer.
+   // Vertices on open borders are never moved, so that the outline of the mesh is kept.
+   // Vertices on UV or normal seams (i.e. where more than one vertex has the same position) are only moved along the seam, with all of
+   // the vertices at that position moving together (each to its neighbour on the same side of the seam), so that seams do not tear open.
+   //
+   // Simplification stops when the number of indices is at most targetIndexCount, or when no further collapse has error less than maxError.
+   // On return, error is (an estimate of) how far the simplified surface is from the original, in the same units as the vertex positions.
+   std::vector<uint32_t> PKZL_API SimplifyMesh(const std::vector<Mesh::Vertex>& vertices, const std::vector<uint32_t>& indices, const size_t targetIndexCount, const float maxError, float& error);
+
+}
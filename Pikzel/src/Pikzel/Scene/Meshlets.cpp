@@ -0,0 +1,234 @@
+#include "Meshlets.h"
+
+#include <algorithm>
+
+namespace Pikzel {
+
+   static void ComputeMeshletBounds(Meshlet& meshlet, const std::vector<uint32_t>& indices, const std::vector<uint32_t>& vertices, const glm::vec3* positions, const size_t vertexStride) {
+      const auto position = [positions, vertexStride](const uint32_t v) -> const glm::vec3& {
+         return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const std::byte*>(positions) + (v * vertexStride));
+      };
+
+      // Bounding sphere: centre of the bounding box, and radius that encloses every vertex
+      glm::vec3 min = position(vertices.front());
+      glm::vec3 max = min;
+      for (const uint32_t v : vertices) {
+         min = glm::min(min, position(v));
+         max = glm::max(max, position(v));
+      }
+      const glm::vec3 centre = (min + max) * 0.5f;
+      float radius = 0.0f;
+      for (const uint32_t v : vertices) {
+         radius = glm::max(radius, glm::length(position(v) - centre));
+      }
+      meshlet.Sphere = {centre, radius};
+
+      // Normal cone: axis is the average of the triangle normals, and the cutoff is from the normal that is furthest from the axis.
+      // If the normals spread too widely then the meshlet is never back facing, so backface culling is disabled (cutoff = 1).
+      glm::vec3 axis = {};
+      std::vector<glm::vec3> normals;
+      normals.reserve(meshlet.IndexCount / 3);
+      for (size_t i = meshlet.IndexOffset; i < meshlet.IndexOffset + meshlet.IndexCount; i += 3) {
+         const glm::vec3& p0 = position(indices[i]);
+         const glm::vec3 normal = glm::cross(position(indices[i + 1]) - p0, position(indices[i + 2]) - p0);
+         const float length = glm::length(normal);
+         if (length > 0.0f) {
+            normals.push_back(normal / length);
+            axis += normals.back();
+         }
+      }
+      const float axisLength = glm::length(axis);
+      if (normals.empty() || (axisLength == 0.0f)) {
+         meshlet.Cone = {0.0f, 0.0f, 0.0f, 1.0f};
+         return;
+      }
+      axis /= axisLength;
+      float minDot = 1.0f;
+      for (const auto& normal : normals) {
+         minDot = glm::min(minDot, glm::dot(normal, axis));
+      }
+      meshlet.Cone = {axis, minDot <= 0.1f ? 1.0f : glm::sqrt(1.0f - (minDot * minDot))};
+   }
+
+
+   std::vector<Meshlet> BuildMeshlets(std::vector<uint32_t>& indices, const glm::vec3* positions, const size_t vertexCount, const size_t vertexStride) {
+      PKZL_PROFILE_FUNCTION();
+
+      std::vector<Meshlet> meshlets;
+      const size_t numTriangles = indices.size() / 3;
+      if (numTriangles == 0) {
+         return meshlets;
+      }
+
+      // vertex => triangles that use it
+      std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+      for (const uint32_t index : indices) {
+         ++triangleOffsets[index + 1];
+      }
+      for (size_t i = 1; i <= vertexCount; ++i) {
+         triangleOffsets[i] += triangleOffsets[i - 1];
+      }
+      std::vector<uint32_t> triangles(indices.size());
+      {
+         std::vector<uint32_t> next(triangleOffsets.begin(), triangleOffsets.end() - 1);
+         for (uint32_t i = 0; i < indices.size(); ++i) {
+            triangles[next[indices[i]]++] = i / 3;
+         }
+      }
+
+      std::vector<uint32_t> result;
+      result.reserve(indices.size());
+      std::vector<bool> isEmitted(numTriangles, false);
+      std::vector<uint32_t> vertexMeshlet(vertexCount, ~0u);  // the meshlet that each vertex was last added to
+      std::vector<uint32_t> meshletVertices;                   // unique vertices of the current meshlet
+      meshletVertices.reserve(MeshletMaxVertices);
+      Meshlet meshlet = {};
+      size_t cursor = 0;                                       // for finding the next triangle (in input order) that has not been emitted
+
+      const auto newVertices = [&](const uint32_t triangle) {
+         uint32_t count = 0;
+         for (size_t k = 0; k < 3; ++k) {
+            count += vertexMeshlet[indices[(triangle * 3) + k]] != meshlets.size() ? 1 : 0;
+         }
+         return count;
+      };
+
+      const auto finishMeshlet = [&]() {
+         ComputeMeshletBounds(meshlet, result, meshletVertices, positions, vertexStride);
+         meshlet.VertexCount = static_cast<uint32_t>(meshletVertices.size());
+         meshlets.push_back(meshlet);
+         meshlet = {};
+         meshlet.IndexOffset = static_cast<uint32_t>(result.size());
+         meshletVertices.clear();
+      };
+
+      // Best next triangle out of those that use any of the given vertices: the one that adds fewest new vertices to the meshlet
+      const auto bestAdjacent = [&](const auto begin, const auto end) {
+         int64_t best = -1;
+         uint32_t bestNewVertices = 4;
+         for (auto v = begin; v != end; ++v) {
+            for (uint32_t t = triangleOffsets[*v]; t < triangleOffsets[*v + 1]; ++t) {
+               const uint32_t triangle = triangles[t];
+               if (!isEmitted[triangle]) {
+                  const uint32_t n = newVertices(triangle);
+                  if ((n < bestNewVertices) || ((n == bestNewVertices) && (triangle < best))) {
+                     best = triangle;
+                     bestNewVertices = n;
+                  }
+               }
+            }
+         }
+         return best;
+      };
+
+      int64_t lastTriangle = -1;
+      for (size_t emitted = 0; emitted < numTriangles; ++emitted) {
+
+         // Prefer triangles next to the last one added (this is cheap, and keeps most of the vertex cache order).
+         // Failing that, anything connected to the meshlet.  Failing that, the next triangle in input order.
+         int64_t triangle = -1;
+         if (lastTriangle >= 0) {
+            const uint32_t* last = &indices[lastTriangle * 3];
+            triangle = bestAdjacent(last, last + 3);
+            if (triangle < 0) {
+               triangle = bestAdjacent(meshletVertices.begin(), meshletVertices.end());
+            }
+         }
+         if (triangle < 0) {
+            while (isEmitted[cursor]) {
+               ++cursor;
+            }
+            triangle = cursor;
+         }
+
+         if ((meshletVertices.size() + newVertices(static_cast<uint32_t>(triangle)) > MeshletMaxVertices) || (meshlet.IndexCount / 3 >= MeshletMaxTriangles)) {
+            finishMeshlet();
+         }
+
+         isEmitted[triangle] = true;
+         for (size_t k = 0; k < 3; ++k) {
+            const uint32_t v = indices[(triangle * 3) + k];
+            if (vertexMeshlet[v] != meshlets.size()) {
+               vertexMeshlet[v] = static_cast<uint32_t>(meshlets.size());
+               meshletVertices.push_back(v);
+            }
+            result.push_back(v);
+         }
+         meshlet.IndexCount += 3;
+         lastTriangle = triangle;
+      }
+      finishMeshlet();
+
+      indices = std::move(result);
+      return meshlets;
+   }
+
+
+   void GetFrustumPlanes(const glm::mat4& mvp, glm::vec4 frustum[4]) {
+      const auto row = [&mvp](const int i) {
+         return glm::vec4 {mvp[0][i], mvp[1][i], mvp[2][i], mvp[3][i]};
+      };
+      frustum[0] = row(3) + row(0);  // left
+      frustum[1] = row(3) - row(0);  // right
+      frustum[2] = row(3) + row(1);  // bottom
+      frustum[3] = row(3) - row(1);  // top
+      for (size_t i = 0; i < 4; ++i) {
+         frustum[i] /= glm::length(glm::vec3 {frustum[i]});
+      }
+   }
+
+
+   bool IsMeshletVisible(const Meshlet& meshlet, const glm::vec4 frustum[4], const glm::vec3& cameraPosition) {
+      const glm::vec3 centre = meshlet.Sphere;
+      const float radius = meshlet.Sphere.w;
+      for (size_t i = 0; i < 4; ++i) {
+         if (glm::dot(glm::vec3 {frustum[i]}, centre) + frustum[i].w < -radius) {
+            return false;
+         }
+      }
+
+      // Every triangle is back facing if the direction from the camera to any point in the bounding sphere is within
+      // (90 degrees - cone half angle) of the cone axis.
+      const float cutoff = meshlet.Cone.w;
+      if (cutoff < 1.0f) {
+         const glm::vec3 view = centre - cameraPosition;
+         if (glm::dot(view, glm::vec3 {meshlet.Cone}) >= (cutoff * glm::length(view)) + radius) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+
+   uint32_t CullMeshlets(const std::vector<Meshlet>& meshlets, const glm::mat4& mvp, const glm::vec3& cameraPosition, std::vector<DrawIndexedIndirectCommand>& commands) {
+      PKZL_PROFILE_FUNCTION();
+
+      glm::vec4 frustum[4];
+      GetFrustumPlanes(mvp, frustum);
+
+      const size_t firstCommand = commands.size();
+      uint32_t numVisible = 0;
+      for (const auto& meshlet : meshlets) {
+         if (!IsMeshletVisible(meshlet, frustum, cameraPosition)) {
+            continue;
+         }
+         ++numVisible;
+         if (commands.size() > firstCommand) {
+            auto& last = commands.back();
+            if (last.FirstIndex + last.IndexCount == meshlet.IndexOffset) {
+               last.IndexCount += meshlet.IndexCount;
+               continue;
+            }
+         }
+         commands.push_back({
+            .IndexCount = meshlet.IndexCount,
+            .InstanceCount = 1,
+            .FirstIndex = meshlet.IndexOffset,
+            .VertexOffset = 0,
+            .FirstInstance = 0
+         });
+      }
+      return numVisible;
+   }
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+#include "Pikzel/Renderer/Buffer.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace Pikzel {
+
+   // A meshlet is a small cluster of connected triangles that is culled as a unit.
+   // The triangles of each meshlet occupy a contiguous range of the mesh's index buffer.
+   //
+   // The layout of this struct matches the std430 layout of struct Meshlet in Renderer/Shaders/MeshletCull.comp,
+   // so an array of them can be uploaded as is to a storage buffer for culling on the GPU.
+   struct Meshlet {
+      glm::vec4 Sphere;        // bounding sphere: centre in xyz, radius in w (mesh space)
+      glm::vec4 Cone;          // normal cone: axis in xyz, cutoff in w (sine of the cone's half angle).  cutoff >= 1 means the meshlet can never be backface culled
+      uint32_t IndexOffset;    // first index of the meshlet in the mesh's index buffer
+      uint32_t IndexCount;     // number of indices (3 x number of triangles)
+      uint32_t VertexCount;    // number of unique vertices referenced
+      uint32_t Padding;
+   };
+   static_assert(sizeof(Meshlet) == 48);
+
+   constexpr uint32_t MeshletMaxVertices = 64;
+   constexpr uint32_t MeshletMaxTriangles = 124;
+
+   // Split a triangle mesh into meshlets of at most MeshletMaxVertices vertices and MeshletMaxTriangles triangles.
+   // Meshlets are grown greedily from the input order, preferring triangles that are connected to the meshlet and add fewest new vertices.
+   // indices are reordered so that each meshlet is a contiguous range.  (so vertex cache optimization should be done first, it is
+   // mostly preserved within each meshlet).
+   // positions points to the position of the first vertex, and vertexStride is the distance (in bytes) between consecutive positions.
+   std::vector<Meshlet> PKZL_API BuildMeshlets(std::vector<uint32_t>& indices, const glm::vec3* positions, const size_t vertexCount, const size_t vertexStride);
+
+   // Returns true if a meshlet is (possibly) visible, i.e. its bounding sphere is not entirely outside the view frustum and
+   // it is not entirely back facing.
+   // frustum is the (normalized) left, right, bottom and top planes of the view frustum, in mesh space.  See GetFrustumPlanes()
+   // cameraPosition is in mesh space.
+   bool PKZL_API IsMeshletVisible(const Meshlet& meshlet, const glm::vec4 frustum[4], const glm::vec3& cameraPosition);
+
+   // Extract left, right, bottom and top planes from a (model-)view-projection matrix.
+   // The planes are in the space that the matrix transforms from, and are normalized so that plane distances are in that space's units.
+   // Near and far planes are not needed: the four side planes meet at the eye, so together they already reject everything behind it.
+   void PKZL_API GetFrustumPlanes(const glm::mat4& mvp, glm::vec4 frustum[4]);
+
+   // Cull meshlets on the CPU.
+   // mvp transforms mesh space to clip space, and cameraPosition is in mesh space.
+   // A draw command is appended to commands for each run of consecutive visible meshlets (consecutive meshlets are adjacent in the
+   // index buffer, so can be merged into one draw).
+   // Returns the number of meshlets that are visible.
+   //
+   // This produces the same result as Renderer/Shaders/MeshletCull.comp (except that the compute shader does not merge adjacent meshlets)
+   uint32_t PKZL_API CullMeshlets(const std::vector<Meshlet>& meshlets, const glm::mat4& mvp, const glm::vec3& cameraPosition, std::vector<DrawIndexedIndirectCommand>& commands);
+
+}
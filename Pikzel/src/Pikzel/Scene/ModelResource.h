@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 
 #include <filesystem>
+#include <limits>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,18 +26,24 @@ namespace Pikzel {
 
       ModelResource(ModelResource&& model) noexcept
       : Meshes{ std::move(model.Meshes) }
+      , AABB{ model.AABB }
+      , LODErrors{ std::move(model.LODErrors) }
       , Path{ std::move(model.Path) }
       {}
 
       ModelResource& operator=(ModelResource&& model) noexcept {
          if (this != &model) {
             Meshes = std::move(model.Meshes);
+            AABB = model.AABB;
+            LODErrors = std::move(model.LODErrors);
             Path = std::move(model.Path);
          }
          return *this;
       }
 
       std::vector<Mesh> Meshes;
+      std::pair<glm::vec3, glm::vec3> AABB = {glm::vec3 {std::numeric_limits<float>::max()}, glm::vec3 {std::numeric_limits<float>::lowest()}};  // (min, max) in model space
+      std::vector<float> LODErrors;  // LODErrors[i] is the largest simplification error of any of the meshes at level of detail i
       std::string Name;
       std::filesystem::path Path;
    };
@@ -1,6 +1,10 @@
 #include "ModelResourceLoader.h"
 
-#include "Pikzel/Renderer/RenderCore.h"
+#include "Pikzel/Renderer/ContentCache.h"
+#include "Pikzel/Scene/MeshOptimizer.h"
+#include "Pikzel/Scene/MeshSimplifier.h"
+#include "Pikzel/Scene/Meshlets.h"
+#include "Pikzel/Scene/VertexCompression.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -91,6 +95,19 @@ namespace Pikzel {
          }
       }
 
+      // Reorder triangles (for vertex cache and overdraw) and vertices (for vertex fetch)
+      const auto [before, after] = OptimizeMesh(vertices, indices);
+      PKZL_CORE_LOG_TRACE("Mesh '{0}': ACMR {1:.3f} => {2:.3f}, ATVR {3:.3f} => {4:.3f}", pmesh->mName.C_Str(), before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+
+      // Split into meshlets for finer grained culling.  This reorders the triangles again (mostly keeping the vertex cache order
+      // within each meshlet), so vertices are then renumbered for fetch locality once more.
+      std::vector<Meshlet> meshlets;
+      if (!vertices.empty()) {
+         meshlets = BuildMeshlets(indices, &vertices[0].Pos, vertices.size(), sizeof(Mesh::Vertex));
+         RemapVertices(vertices, OptimizeVertexFetch(indices, vertices.size()));
+      }
+      PKZL_CORE_LOG_TRACE("Mesh '{0}': {1} meshlets", pmesh->mName.C_Str(), meshlets.size());
+
 //      if (pmesh->mMaterialIndex >= 0) {
 //         aiMaterial* material = pscene->mMaterials[pmesh->mMaterialIndex];
 //
@@ -155,12 +172,57 @@ namespace Pikzel {
 //         mesh.HeightTexture = LoadMaterialTexture(material, aiTextureType_HEIGHT, modelDir);                      // There is no height map in the bistro model data, this will just create a default one
 //      }
 
-      return {
+      glm::mat4 dequantizeTransform;
+      const std::vector<Mesh::CompactVertex> compactVertices = CompressVertices(vertices, dequantizeTransform);
+      Mesh mesh {
          //AssimpMat4ToGLMMat4(transform),
-         RenderCore::CreateVertexBuffer(Mesh::VertexBufferLayout, vertices.size() * sizeof(Mesh::Vertex), vertices.data()),
-         RenderCore::CreateIndexBuffer(indices.size(), indices.data())
+         ContentCache::CreateVertexBuffer(Mesh::CompactVertexBufferLayout, static_cast<uint32_t>(compactVertices.size() * sizeof(Mesh::CompactVertex)), compactVertices.data()),
+         CreateCompactIndexBuffer(indices, vertices.size())
       };
+      mesh.DequantizeTransform = dequantizeTransform;
+      mesh.VertexCount = static_cast<uint32_t>(vertices.size());
+      if (!meshlets.empty()) {
+         mesh.MeshletBuffer = ContentCache::CreateStorageBuffer(static_cast<uint32_t>(meshlets.size() * sizeof(Meshlet)), meshlets.data());
+      }
+      mesh.Meshlets = std::move(meshlets);
+
+      for (const auto& vertex : vertices) {
+         mesh.AABB.first = glm::min(mesh.AABB.first, vertex.Pos);
+         mesh.AABB.second = glm::max(mesh.AABB.second, vertex.Pos);
+      }
+
+      // Levels of detail.
+      // Each level is simplified from the one before, aiming for half as many triangles.  Errors accumulate down the chain.
+      // Stop when the mesh is small enough, or will not simplify any further (e.g. because most of its vertices are on seams)
+      const size_t minLODIndexCount = 3 * 32;
+      const float maxError = glm::length(mesh.AABB.second - mesh.AABB.first) * 0.5f;
+      std::vector<uint32_t> lodIndices = indices;
+      float lodError = 0.0f;
+      while ((mesh.LODs.size() + 1 < Mesh::MaxLODs) && (lodIndices.size() > minLODIndexCount)) {
+         float error = 0.0f;
+         std::vector<uint32_t> simplified = SimplifyMesh(vertices, lodIndices, (lodIndices.size() / 6) * 3, maxError, error);
+         if (simplified.size() * 10 > lodIndices.size() * 9) {
+            break;
+         }
+         lodError += error;
+         lodIndices = std::move(simplified);
+         OptimizeVertexCache(lodIndices, vertices.size());
+         mesh.LODs.push_back({CreateCompactIndexBuffer(lodIndices, vertices.size()), lodError});
+      }
 
+      // Occluder geometry for software occlusion culling is the full resolution mesh, not a level of detail: occlusion must be
+      // conservative, and a simplified surface can be in front of the real one.  Only the vertex positions are kept.
+      std::vector<uint32_t> occluderVertex(vertices.size(), ~0u);
+      mesh.OccluderIndices.reserve(indices.size());
+      for (const uint32_t index : indices) {
+         if (occluderVertex[index] == ~0u) {
+            occluderVertex[index] = static_cast<uint32_t>(mesh.OccluderPositions.size());
+            mesh.OccluderPositions.push_back(vertices[index].Pos);
+         }
+         mesh.OccluderIndices.push_back(occluderVertex[index]);
+      }
+
+      return mesh;
    }
 
 
@@ -183,7 +245,7 @@ namespace Pikzel {
          aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
          model.Meshes.emplace_back(ProcessMesh(mesh, transform, scene, modelDir, indentAmount + 3));
          //model.Meshes.back().Index = model.Meshes.size() - 1;
-         //model.AABB = { glm::min(model.AABB.first, model.Meshes.back().AABB.first), glm::max(model.AABB.second, model.Meshes.back().AABB.second) };
+         model.AABB = { glm::min(model.AABB.first, model.Meshes.back().AABB.first), glm::max(model.AABB.second, model.Meshes.back().AABB.second) };
       }
       //PKZL_CORE_LOG_TRACE("{0} }}", indent);
       //PKZL_CORE_LOG_TRACE("{0} Children {{", indent);
@@ -234,6 +296,31 @@ namespace Pikzel {
       modelDir.remove_filename();
       ProcessNode(*model, mat, scene->mRootNode, scene, modelDir, 0);
 
+      uint64_t vertexBytes = 0;
+      uint64_t indexBytes = 0;
+      uint64_t uncompressedBytes = 0;
+      for (const auto& mesh : model->Meshes) {
+         vertexBytes += mesh.VertexCount * sizeof(Mesh::CompactVertex);
+         indexBytes += mesh.IndexBuffer->GetCount() * (mesh.IndexBuffer->GetIndexType() == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t));
+         uncompressedBytes += (mesh.VertexCount * sizeof(Mesh::Vertex)) + (mesh.IndexBuffer->GetCount() * sizeof(uint32_t));
+      }
+      PKZL_CORE_LOG_INFO("Model '{0}': vertex data {1} KB, index data {2} KB (uncompressed would be {3} KB)", name, vertexBytes / 1024, indexBytes / 1024, uncompressedBytes / 1024);
+
+      // A level of detail of the model as a whole exists if at least one of its meshes has it.
+      // (meshes with fewer levels use their coarsest)
+      for (uint32_t lod = 0; lod < Mesh::MaxLODs; ++lod) {
+         bool hasLOD = (lod == 0);
+         float error = 0.0f;
+         for (const auto& mesh : model->Meshes) {
+            hasLOD = hasLOD || (lod <= mesh.LODs.size());
+            error = std::max(error, mesh.GetLODError(lod));
+         }
+         if (!hasLOD) {
+            break;
+         }
+         model->LODErrors.push_back(error);
+      }
+
       return model;
    }
 
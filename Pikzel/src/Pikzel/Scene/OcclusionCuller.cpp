@@ -0,0 +1,423 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PKZL_OCCLUSION_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define PKZL_TARGET_AVX2
+#else
+#define PKZL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#else
+#define PKZL_OCCLUSION_AVX2 0
+#endif
+
+namespace Pikzel {
+
+   // Anything nearer than this (in view space units) is clipped from occluders, and occludees that come this close are always visible
+   constexpr float NearW = 0.01f;
+
+   struct ScreenVertex {
+      float x;
+      float y;
+      float z;  // 1/w
+   };
+
+
+   // Triangle set up for rasterization: three edge functions, and a plane for depth.  All of the form a*x + b*y + c
+   struct TriangleSetup {
+      float edgeA[3];
+      float edgeB[3];
+      float edgeC[3];
+      float zA;
+      float zB;
+      float zC;
+      int minX;
+      int maxX;
+      int minY;
+      int maxY;
+   };
+
+
+   static bool SetupTriangle(ScreenVertex v0, ScreenVertex v1, ScreenVertex v2, const int rowBegin, const int rowEnd, TriangleSetup& setup) {
+      float area = ((v1.x - v0.x) * (v2.y - v0.y)) - ((v2.x - v0.x) * (v1.y - v0.y));
+      if (area == 0.0f) {
+         return false;
+      }
+      // Occluders are rasterized regardless of facing, so just fix up the winding
+      if (area < 0.0f) {
+         std::swap(v1, v2);
+         area = -area;
+      }
+
+      setup.minX = std::max(0, static_cast<int>(std::floor(std::min({v0.x, v1.x, v2.x}))));
+      setup.maxX = std::min(static_cast<int>(OcclusionCuller::Width) - 1, static_cast<int>(std::ceil(std::max({v0.x, v1.x, v2.x}))));
+      setup.minY = std::max(rowBegin, static_cast<int>(std::floor(std::min({v0.y, v1.y, v2.y}))));
+      setup.maxY = std::min(rowEnd - 1, static_cast<int>(std::ceil(std::max({v0.y, v1.y, v2.y}))));
+      if ((setup.minX > setup.maxX) || (setup.minY > setup.maxY)) {
+         return false;
+      }
+
+      // edge i is opposite vertex i, and is positive on the inside
+      const ScreenVertex* v[3] = {&v0, &v1, &v2};
+      for (int i = 0; i < 3; ++i) {
+         const ScreenVertex& a = *v[(i + 1) % 3];
+         const ScreenVertex& b = *v[(i + 2) % 3];
+         setup.edgeA[i] = a.y - b.y;
+         setup.edgeB[i] = b.x - a.x;
+         setup.edgeC[i] = -((setup.edgeA[i] * a.x) + (setup.edgeB[i] * a.y));
+      }
+
+      // depth interpolated with (normalized) edge functions as barycentric coordinates.  1/w is linear in screen space.
+      setup.zA = ((setup.edgeA[0] * v0.z) + (setup.edgeA[1] * v1.z) + (setup.edgeA[2] * v2.z)) / area;
+      setup.zB = ((setup.edgeB[0] * v0.z) + (setup.edgeB[1] * v1.z) + (setup.edgeB[2] * v2.z)) / area;
+      setup.zC = ((setup.edgeC[0] * v0.z) + (setup.edgeC[1] * v1.z) + (setup.edgeC[2] * v2.z)) / area;
+      return true;
+   }
+
+
+   static void RasterizeTriangleScalar(const TriangleSetup& setup, float* depth) {
+      for (int y = setup.minY; y <= setup.maxY; ++y) {
+         const float py = static_cast<float>(y) + 0.5f;
+         float* row = depth + (y * OcclusionCuller::Width);
+         for (int x = setup.minX; x <= setup.maxX; ++x) {
+            const float px = static_cast<float>(x) + 0.5f;
+            const float e0 = (setup.edgeA[0] * px) + (setup.edgeB[0] * py) + setup.edgeC[0];
+            const float e1 = (setup.edgeA[1] * px) + (setup.edgeB[1] * py) + setup.edgeC[1];
+            const float e2 = (setup.edgeA[2] * px) + (setup.edgeB[2] * py) + setup.edgeC[2];
+            if ((e0 > 0.0f) && (e1 > 0.0f) && (e2 > 0.0f)) {
+               const float z = (setup.zA * px) + (setup.zB * py) + setup.zC;
+               row[x] = std::max(row[x], z);
+            }
+         }
+      }
+   }
+
+
+#if PKZL_OCCLUSION_AVX2
+   // As RasterizeTriangleScalar(), but 8 pixels at a time.
+   // Width is a multiple of 8, so starting each row at a multiple of 8 means every load and store is in bounds (pixels outside the
+   // triangle's bounding box are also outside the triangle, so they fail the edge tests and are left untouched).
+   PKZL_TARGET_AVX2 static void RasterizeTriangleAVX2(const TriangleSetup& setup, float* depth) {
+      const __m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+      const __m256 zero = _mm256_setzero_ps();
+      const __m256 edgeA0 = _mm256_set1_ps(setup.edgeA[0]);
+      const __m256 edgeA1 = _mm256_set1_ps(setup.edgeA[1]);
+      const __m256 edgeA2 = _mm256_set1_ps(setup.edgeA[2]);
+      const __m256 zA = _mm256_set1_ps(setup.zA);
+      const int beginX = setup.minX & ~7;
+
+      for (int y = setup.minY; y <= setup.maxY; ++y) {
+         const float py = static_cast<float>(y) + 0.5f;
+         const __m256 rowE0 = _mm256_set1_ps((setup.edgeB[0] * py) + setup.edgeC[0]);
+         const __m256 rowE1 = _mm256_set1_ps((setup.edgeB[1] * py) + setup.edgeC[1]);
+         const __m256 rowE2 = _mm256_set1_ps((setup.edgeB[2] * py) + setup.edgeC[2]);
+         const __m256 rowZ = _mm256_set1_ps((setup.zB * py) + setup.zC);
+         float* row = depth + (y * OcclusionCuller::Width);
+         for (int x = beginX; x <= setup.maxX; x += 8) {
+            const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), offsets);
+            const __m256 e0 = _mm256_fmadd_ps(edgeA0, px, rowE0);
+            const __m256 e1 = _mm256_fmadd_ps(edgeA1, px, rowE1);
+            const __m256 e2 = _mm256_fmadd_ps(edgeA2, px, rowE2);
+            const __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GT_OQ), _mm256_cmp_ps(e1, zero, _CMP_GT_OQ)), _mm256_cmp_ps(e2, zero, _CMP_GT_OQ));
+            if (_mm256_testz_ps(inside, inside)) {
+               continue;
+            }
+            const __m256 z = _mm256_fmadd_ps(zA, px, rowZ);
+            const __m256 d = _mm256_loadu_ps(row + x);
+            _mm256_storeu_ps(row + x, _mm256_blendv_ps(d, _mm256_max_ps(d, z), inside));
+         }
+      }
+   }
+
+
+   static bool IsAVX2Supported() {
+#if defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 1);
+      const bool isFMA = (info[2] & (1 << 12)) != 0;
+      const bool isOSXSAVE = (info[2] & (1 << 27)) != 0;
+      if (!isFMA || !isOSXSAVE || ((_xgetbv(0) & 6) != 6)) {
+         return false;
+      }
+      __cpuidex(info, 7, 0);
+      return (info[1] & (1 << 5)) != 0;
+#else
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+   }
+#endif
+
+
+   // Clip polygon against the w = NearW plane.  Returns number of output vertices (0, 3 or 4)
+   static int ClipNear(const glm::vec4 in[3], glm::vec4 out[4]) {
+      int count = 0;
+      for (int i = 0; i < 3; ++i) {
+         const glm::vec4& a = in[i];
+         const glm::vec4& b = in[(i + 1) % 3];
+         const bool isAInside = a.w >= NearW;
+         const bool isBInside = b.w >= NearW;
+         if (isAInside) {
+            out[count++] = a;
+         }
+         if (isAInside != isBInside) {
+            const float t = (NearW - a.w) / (b.w - a.w);
+            out[count++] = a + ((b - a) * t);
+         }
+      }
+      return count;
+   }
+
+
+   static ScreenVertex ToScreen(const glm::vec4& clip) {
+      const float rw = 1.0f / clip.w;
+      return {
+         ((clip.x * rw) * 0.5f + 0.5f) * static_cast<float>(OcclusionCuller::Width),
+         ((clip.y * rw) * 0.5f + 0.5f) * static_cast<float>(OcclusionCuller::Height),
+         rw
+      };
+   }
+
+
+   OcclusionCuller::OcclusionCuller(uint32_t numThreads)
+   : m_Depth(Width * Height, 0.0f)
+   , m_TileDepth((Width / TileWidth) * (Height / TileHeight), 0.0f)
+   {
+      static_assert((Width % TileWidth == 0) && (Height % TileHeight == 0) && (TileWidth % 8 == 0));
+#if PKZL_OCCLUSION_AVX2
+      m_IsAVX2 = IsAVX2Supported();
+#endif
+      if (numThreads == 0) {
+         numThreads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+      }
+      numThreads = std::min(numThreads, Height / TileHeight);
+      PKZL_CORE_LOG_INFO("Occlusion culling: {0} worker threads, {1} rasterizer", numThreads, m_IsAVX2 ? "AVX2" : "scalar");
+      for (uint32_t band = 0; band < numThreads; ++band) {
+         m_Workers.emplace_back(&OcclusionCuller::WorkerMain, this, band);
+      }
+   }
+
+
+   OcclusionCuller::~OcclusionCuller() {
+      {
+         std::lock_guard lock {m_Mutex};
+         m_IsQuitting = true;
+      }
+      m_WorkAvailable.notify_all();
+      for (auto& worker : m_Workers) {
+         worker.join();
+      }
+   }
+
+
+   void OcclusionCuller::Rasterize(std::vector<Occluder> occluders) {
+      PKZL_PROFILE_FUNCTION();
+      Wait();
+      m_Occluders = std::move(occluders);
+      m_RasterizeStart = std::chrono::steady_clock::now();
+      {
+         std::lock_guard lock {m_Mutex};
+         ++m_Generation;
+         m_NumBusy = static_cast<uint32_t>(m_Workers.size());
+      }
+      m_WorkAvailable.notify_all();
+   }
+
+
+   void OcclusionCuller::Wait() {
+      PKZL_PROFILE_FUNCTION();
+      std::unique_lock lock {m_Mutex};
+      m_WorkDone.wait(lock, [this] { return m_NumBusy == 0; });
+   }
+
+
+   void OcclusionCuller::WorkerMain(const uint32_t band) {
+      uint64_t generation = 0;
+      for (;;) {
+         {
+            std::unique_lock lock {m_Mutex};
+            m_WorkAvailable.wait(lock, [&] { return m_IsQuitting || (m_Generation != generation); });
+            if (m_IsQuitting) {
+               return;
+            }
+            generation = m_Generation;
+         }
+
+         RasterizeBand(band);
+
+         {
+            std::lock_guard lock {m_Mutex};
+            if (--m_NumBusy == 0) {
+               m_RasterizeEnd = std::chrono::steady_clock::now();
+               m_WorkDone.notify_all();
+            }
+         }
+      }
+   }
+
+
+   void OcclusionCuller::RasterizeBand(const uint32_t band) {
+      PKZL_PROFILE_FUNCTION();
+
+      const uint32_t tileRows = Height / TileHeight;
+      const uint32_t tileRowsPerBand = (tileRows + static_cast<uint32_t>(m_Workers.size()) - 1) / static_cast<uint32_t>(m_Workers.size());
+      const int rowBegin = static_cast<int>(std::min(band * tileRowsPerBand, tileRows) * TileHeight);
+      const int rowEnd = static_cast<int>(std::min((band + 1) * tileRowsPerBand, tileRows) * TileHeight);
+      if (rowBegin >= rowEnd) {
+         return;
+      }
+      std::fill(m_Depth.begin() + (rowBegin * Width), m_Depth.begin() + (rowEnd * Width), 0.0f);
+
+#if PKZL_OCCLUSION_AVX2
+      const auto rasterizeTriangle = m_IsAVX2 ? RasterizeTriangleAVX2 : RasterizeTriangleScalar;
+#else
+      const auto rasterizeTriangle = RasterizeTriangleScalar;
+#endif
+
+      // Every band transforms every occluder vertex.  Occluders are small (that is the point of them), so this duplicated work
+      // is cheap compared to having the workers synchronize between transforming and rasterizing.
+      std::vector<glm::vec4> clip;
+      TriangleSetup setup;
+      const float bandMinY = static_cast<float>(rowBegin);
+      const float bandMaxY = static_cast<float>(rowEnd);
+      for (const auto& occluder : m_Occluders) {
+         const auto& positions = *occluder.Positions;
+         const auto& indices = *occluder.Indices;
+         clip.resize(positions.size());
+         for (size_t i = 0; i < positions.size(); ++i) {
+            clip[i] = occluder.MVP * glm::vec4 {positions[i], 1.0f};
+         }
+         for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const glm::vec4 triangle[3] = {clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]]};
+
+            // trivial rejects: entirely outside one of the side planes (or entirely behind the near plane)
+            if (
+               ((triangle[0].x > triangle[0].w) && (triangle[1].x > triangle[1].w) && (triangle[2].x > triangle[2].w)) ||
+               ((triangle[0].x < -triangle[0].w) && (triangle[1].x < -triangle[1].w) && (triangle[2].x < -triangle[2].w)) ||
+               ((triangle[0].y > triangle[0].w) && (triangle[1].y > triangle[1].w) && (triangle[2].y > triangle[2].w)) ||
+               ((triangle[0].y < -triangle[0].w) && (triangle[1].y < -triangle[1].w) && (triangle[2].y < -triangle[2].w)) ||
+               ((triangle[0].w < NearW) && (triangle[1].w < NearW) && (triangle[2].w < NearW))
+            ) {
+               continue;
+            }
+
+            glm::vec4 clipped[4];
+            int count = 3;
+            if ((triangle[0].w < NearW) || (triangle[1].w < NearW) || (triangle[2].w < NearW)) {
+               count = ClipNear(triangle, clipped);
+            } else {
+               std::copy(triangle, triangle + 3, clipped);
+            }
+
+            ScreenVertex screen[4];
+            float minY = std::numeric_limits<float>::max();
+            float maxY = std::numeric_limits<float>::lowest();
+            for (int j = 0; j < count; ++j) {
+               screen[j] = ToScreen(clipped[j]);
+               minY = std::min(minY, screen[j].y);
+               maxY = std::max(maxY, screen[j].y);
+            }
+            if ((maxY < bandMinY) || (minY > bandMaxY)) {
+               continue;
+            }
+            for (int j = 2; j < count; ++j) {
+               if (SetupTriangle(screen[0], screen[j - 1], screen[j], rowBegin, rowEnd, setup)) {
+                  rasterizeTriangle(setup, m_Depth.data());
+               }
+            }
+         }
+      }
+
+      // Furthest depth in each of this band's tiles
+      for (int tileY = rowBegin / TileHeight; tileY < rowEnd / static_cast<int>(TileHeight); ++tileY) {
+         for (uint32_t tileX = 0; tileX < Width / TileWidth; ++tileX) {
+            float furthest = std::numeric_limits<float>::max();
+            for (uint32_t y = tileY * TileHeight; y < (tileY + 1) * TileHeight; ++y) {
+               const float* row = &m_Depth[(y * Width) + (tileX * TileWidth)];
+               furthest = std::min(furthest, *std::min_element(row, row + TileWidth));
+            }
+            m_TileDepth[(tileY * (Width / TileWidth)) + tileX] = furthest;
+         }
+      }
+   }
+
+
+   bool OcclusionCuller::IsVisible(const glm::mat4& mvp, const std::pair<glm::vec3, glm::vec3>& aabb) const {
+      float minX = std::numeric_limits<float>::max();
+      float maxX = std::numeric_limits<float>::lowest();
+      float minY = std::numeric_limits<float>::max();
+      float maxY = std::numeric_limits<float>::lowest();
+      float nearest = 0.0f;
+      for (int i = 0; i < 8; ++i) {
+         const glm::vec3 corner = {
+            (i & 1) ? aabb.second.x : aabb.first.x,
+            (i & 2) ? aabb.second.y : aabb.first.y,
+            (i & 4) ? aabb.second.z : aabb.first.z
+         };
+         const glm::vec4 clip = mvp * glm::vec4 {corner, 1.0f};
+         if (clip.w < NearW) {
+            return true;
+         }
+         const ScreenVertex screen = ToScreen(clip);
+         minX = std::min(minX, screen.x);
+         maxX = std::max(maxX, screen.x);
+         minY = std::min(minY, screen.y);
+         maxY = std::max(maxY, screen.y);
+         nearest = std::max(nearest, screen.z);
+      }
+
+      // Off screen entirely is for frustum culling to deal with
+      if ((maxX < 0.0f) || (minX >= static_cast<float>(Width)) || (maxY < 0.0f) || (minY >= static_cast<float>(Height))) {
+         return true;
+      }
+
+      const int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+      const int x1 = std::min(static_cast<int>(Width) - 1, static_cast<int>(std::floor(maxX)));
+      const int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+      const int y1 = std::min(static_cast<int>(Height) - 1, static_cast<int>(std::floor(maxY)));
+
+      // Visible if any covered pixel has occluder depth no nearer than the nearest point of the box.
+      // Tiles whose furthest depth is nearer than the box are hidden without looking at individual pixels.
+      for (int tileY = y0 / static_cast<int>(TileHeight); tileY <= y1 / static_cast<int>(TileHeight); ++tileY) {
+         for (int tileX = x0 / static_cast<int>(TileWidth); tileX <= x1 / static_cast<int>(TileWidth); ++tileX) {
+            if (m_TileDepth[(tileY * (Width / TileWidth)) + tileX] > nearest) {
+               continue;
+            }
+            const int py0 = std::max(y0, tileY * static_cast<int>(TileHeight));
+            const int py1 = std::min(y1, ((tileY + 1) * static_cast<int>(TileHeight)) - 1);
+            const int px0 = std::max(x0, tileX * static_cast<int>(TileWidth));
+            const int px1 = std::min(x1, ((tileX + 1) * static_cast<int>(TileWidth)) - 1);
+            for (int y = py0; y <= py1; ++y) {
+               for (int x = px0; x <= px1; ++x) {
+                  if (m_Depth[(y * Width) + x] <= nearest) {
+                     return true;
+                  }
+               }
+            }
+         }
+      }
+      return false;
+   }
+
+
+   float OcclusionCuller::GetRasterizeMilliseconds() const {
+      return std::chrono::duration<float, std::milli>(m_RasterizeEnd - m_RasterizeStart).count();
+   }
+
+
+   bool OcclusionCuller::IsAVX2() const {
+      return m_IsAVX2;
+   }
+
+
+   const std::vector<float>& OcclusionCuller::GetDepthBuffer() const {
+      return m_Depth;
+   }
+
+}
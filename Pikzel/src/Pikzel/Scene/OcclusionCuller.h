@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Pikzel {
+
+   // Software occlusion culling.
+   //
+   // Occluders (typically large, simple meshes such as walls and floors) are rasterized on the CPU into a low
+   // resolution depth buffer.  Bounding boxes of potential occludees are then tested against that depth buffer, and anything that
+   // is entirely behind the occluders need not be drawn.
+   //
+   // The depth buffer is divided into horizontal bands, and each band is rasterized by its own worker thread.  Rasterize() returns
+   // immediately, so the caller can get on with other work while the occluders are rasterized, and then Wait() before testing.
+   // The inner loop processes 8 pixels at a time with AVX2 where the CPU supports it (there is a scalar fallback otherwise).
+   //
+   // Depth is stored as 1/w (i.e. reciprocal of view space distance), so larger is nearer and a cleared buffer (0) is infinitely far away.
+   // A coarse "hierarchical" level holds the furthest depth in each tile, so most bounding box tests only need to look at a few tiles.
+   class PKZL_API OcclusionCuller {
+   public:
+
+      static constexpr uint32_t Width = 320;
+      static constexpr uint32_t Height = 192;
+      static constexpr uint32_t TileWidth = 8;
+      static constexpr uint32_t TileHeight = 8;
+
+      // Occluder geometry, and the transform from its space to clip space.
+      // The geometry must not extend beyond the surface that it stands for (e.g. it must not be a simplified version of it),
+      // otherwise things that are actually visible can be culled.
+      // Positions and indices must remain valid (and unchanged) until after Wait()
+      struct Occluder {
+         glm::mat4 MVP;
+         const std::vector<glm::vec3>* Positions;
+         const std::vector<uint32_t>* Indices;
+      };
+
+      // numThreads == 0 picks a number of worker threads based on the number of CPU cores
+      OcclusionCuller(uint32_t numThreads = 0);
+      ~OcclusionCuller();
+
+      PKZL_NO_COPY(OcclusionCuller);
+
+      // Clear the depth buffer and start rasterizing given occluders on the worker threads.
+      void Rasterize(std::vector<Occluder> occluders);
+
+      // Wait for Rasterize() to finish.
+      void Wait();
+
+      // Returns false if the box is definitely hidden behind the occluders.
+      // aabb is (min, max) in the space that mvp transforms from.  Only call this after Wait()
+      bool IsVisible(const glm::mat4& mvp, const std::pair<glm::vec3, glm::vec3>& aabb) const;
+
+      // Time taken (wall clock) from Rasterize() until the last worker thread finished, for the most recent frame
+      float GetRasterizeMilliseconds() const;
+
+      // True if the AVX2 rasterizer is in use
+      bool IsAVX2() const;
+
+      // The depth buffer (Width x Height, 1/w, bottom row first).  Only valid after Wait()
+      const std::vector<float>& GetDepthBuffer() const;
+
+   private:
+      void WorkerMain(const uint32_t band);
+      void RasterizeBand(const uint32_t band);
+
+   private:
+      std::vector<float> m_Depth;            // Width x Height
+      std::vector<float> m_TileDepth;        // furthest depth in each tile
+      std::vector<Occluder> m_Occluders;
+
+      std::vector<std::thread> m_Workers;
+      std::mutex m_Mutex;
+      std::condition_variable m_WorkAvailable;
+      std::condition_variable m_WorkDone;
+      uint64_t m_Generation = 0;             // incremented each time there is new work for the workers
+      uint32_t m_NumBusy = 0;                // number of workers still working on the current generation
+      bool m_IsQuitting = false;
+
+      std::chrono::steady_clock::time_point m_RasterizeStart;
+      std::chrono::steady_clock::time_point m_RasterizeEnd;
+      bool m_IsAVX2 = false;
+   };
+
+}
@@ -1,8 +1,16 @@
 #include "SceneRenderer.h"
 
+#include "Pikzel/Components/Materials.h"
 #include "Pikzel/Components/Model.h"
+#include "Pikzel/Components/Occluder.h"
 #include "Pikzel/Components/Transform.h"
+#include "Pikzel/Renderer/RenderCore.h"
 #include "Pikzel/Scene/AssetCache.h"
+#include "Pikzel/Scene/Meshlets.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
 
 namespace Pikzel {
 
@@ -13,40 +21,307 @@ namespace Pikzel {
 
    SceneRenderer::SceneRenderer(const GraphicsContext& gc) {
 
-      // HACK: This needs to change,  obviously...
-      //       We will want to be able to render with different "materials"
-      m_Pipeline = gc.CreatePipeline({
+      // For objects that do not have a Materials component
+      m_DefaultMaterial = std::make_shared<Material>(gc, MaterialSettings {
          .shaders = {
             { Pikzel::ShaderType::Vertex, "Renderer/Triangle.vert.spv" },
             { Pikzel::ShaderType::Fragment, "Renderer/Triangle.frag.spv" }
-         },
-         .bufferLayout = Mesh::VertexBufferLayout
+         }
       });
+      m_DefaultMaterialInstance = std::make_shared<MaterialInstance>(m_DefaultMaterial);
 
+      m_OcclusionCuller = std::make_unique<OcclusionCuller>();
    }
 
 
    void SceneRenderer::Render(GraphicsContext& gc, Camera& camera, Scene& scene) {
-      gc.Bind(*m_Pipeline);
+      m_Stats = {};
 
       glm::mat4 vp = camera.projection * glm::lookAt(camera.position, camera.position + camera.direction, camera.upVector);
 
-      // something like this.. only more complicated.. (e.g need materials, shadows, animation, ...)
-      for (auto&& [entity, transform, model] : scene.m_Registry.group<const Transform, const Model>().each()) {
-         gc.PushConstant("constants.mvp"_hs, vp * transform.Matrix);
+      // Occluders are rasterized on worker threads while the rest of the frame is prepared
+      if (m_IsOcclusionCullingEnabled) {
+         std::vector<OcclusionCuller::Occluder> occluders;
+         for (auto&& [entity, transform, model, occluder] : scene.m_Registry.view<const Transform, const Model, const Occluder>().each()) {
+            if (occluder.IsEnabled) {
+               auto modelResource = AssetCache::GetModelResource(model.Id);
+               for (const auto& mesh : modelResource->Meshes) {
+                  if (!mesh.OccluderIndices.empty()) {
+                     occluders.push_back({vp * transform.Matrix, &mesh.OccluderPositions, &mesh.OccluderIndices});
+                  }
+               }
+            }
+         }
+         m_OcclusionCuller->Rasterize(std::move(occluders));
+      }
 
+      m_Draws.clear();
+      m_Objects.clear();
+      m_PreviousObjectLODs.swap(m_ObjectLODs);
+      m_ObjectLODs.clear();
+      for (auto&& [entity, transform, model] : scene.m_Registry.group<const Transform, const Model>().each()) {
          auto modelResource = AssetCache::GetModelResource(model.Id);
+         const uint32_t lod = SelectLOD(entity, transform.Matrix, *modelResource, camera);
+         ++m_Stats.ObjectsPerLOD[lod];
+         const Materials* materials = scene.m_Registry.try_get<Materials>(entity);
+         m_Objects.push_back({transform.Matrix, &*modelResource, m_Draws.size(), m_Draws.size() + modelResource->Meshes.size()});
+         for (size_t i = 0; i < modelResource->Meshes.size(); ++i) {
+            const MaterialInstance* material = m_DefaultMaterialInstance.get();
+            if (materials && !materials->Instances.empty()) {
+               const MaterialInstance* instance = materials->Instances[std::min(i, materials->Instances.size() - 1)].get();
+               if (instance->GetMaterial().IsReady()) {
+                  material = instance;
+               } else {
+                  ++m_Stats.DrawsSubstituted;
+               }
+            }
+            m_Draws.push_back({&modelResource->Meshes[i], material, transform.Matrix, lod, 0, 0});
+         }
+      }
+
+      // Test each object's bounding box against the occluders, and then each of its meshes
+      if (m_IsOcclusionCullingEnabled) {
+         m_OcclusionCuller->Wait();
+         m_Stats.OcclusionRasterizeMs = m_OcclusionCuller->GetRasterizeMilliseconds();
+         size_t numVisible = 0;
+         for (const auto& object : m_Objects) {
+            const glm::mat4 mvp = vp * object.Transform;
+            const bool isObjectVisible = m_OcclusionCuller->IsVisible(mvp, object.Model->AABB);
+            for (size_t i = object.Begin; i < object.End; ++i) {
+               if (isObjectVisible && m_OcclusionCuller->IsVisible(mvp, m_Draws[i].Mesh->AABB)) {
+                  m_Draws[numVisible++] = m_Draws[i];
+               } else {
+                  ++m_Stats.DrawsOccluded;
+               }
+            }
+         }
+         m_Draws.resize(numVisible);
+      }
+
+      // Sort draws by pipeline, then by material instance, so that each is bound only once.
+      // (then by mesh, so that draws of the same mesh are adjacent)
+      std::sort(m_Draws.begin(), m_Draws.end(), [](const Draw& a, const Draw& b) {
+         const Pipeline* pipelineA = &a.Material->GetMaterial().GetPipeline();
+         const Pipeline* pipelineB = &b.Material->GetMaterial().GetPipeline();
+         if (pipelineA != pipelineB) {
+            return std::less<const Pipeline*> {}(pipelineA, pipelineB);
+         }
+         if (a.Material != b.Material) {
+            return std::less<const MaterialInstance*> {}(a.Material, b.Material);
+         }
+         return std::less<const Mesh*> {}(a.Mesh, b.Mesh);
+      });
+
+      if (m_MeshletCulling == MeshletCulling::GPU) {
+         CullMeshletsGPU(gc, vp, camera.position);
+      }
+
+      // Resources are bound per pipeline, so a change of pipeline means the material instance must be bound again too
+      const Pipeline* boundPipeline = nullptr;
+      const MaterialInstance* boundMaterial = nullptr;
+      for (const auto& draw : m_Draws) {
+         const Mesh& mesh = *draw.Mesh;
+         const Pipeline* pipeline = &draw.Material->GetMaterial().GetPipeline();
+         if (pipeline != boundPipeline) {
+            gc.Bind(*pipeline);
+            boundPipeline = pipeline;
+            boundMaterial = nullptr;
+            ++m_Stats.PipelineBinds;
+         }
+         if (draw.Material != boundMaterial) {
+            draw.Material->Bind(gc);
+            boundMaterial = draw.Material;
+            ++m_Stats.MaterialBinds;
+         }
+         gc.PushConstant("constants.mvp"_hs, vp * draw.Transform * mesh.DequantizeTransform);
+         const IndexBuffer& indexBuffer = mesh.GetIndexBuffer(draw.LOD);
+         const uint64_t indexSize = indexBuffer.GetIndexType() == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+         uint32_t indexCount = indexBuffer.GetCount();
+
+         // Meshlets only exist for the full resolution mesh
+         const bool isMeshletCulled = (m_MeshletCulling != MeshletCulling::None) && (draw.LOD == 0) && !mesh.Meshlets.empty();
+         if (isMeshletCulled && (m_MeshletCulling == MeshletCulling::CPU)) {
+            const glm::vec3 cameraPosition = glm::inverse(draw.Transform) * glm::vec4 {camera.position, 1.0f};
+            m_DrawCommands.clear();
+            m_Stats.Meshlets += static_cast<uint32_t>(mesh.Meshlets.size());
+            m_Stats.MeshletsVisible += CullMeshlets(mesh.Meshlets, vp * draw.Transform, cameraPosition, m_DrawCommands);
+            indexCount = 0;
+            for (const auto& command : m_DrawCommands) {
+               gc.DrawIndexed(*mesh.VertexBuffer, indexBuffer, command.IndexCount, 0, command.FirstIndex);
+               indexCount += command.IndexCount;
+            }
+            m_Stats.DrawCalls += static_cast<uint32_t>(m_DrawCommands.size());
+         } else if (isMeshletCulled && (m_MeshletCulling == MeshletCulling::GPU)) {
+            // note: triangle and index statistics are then an upper bound, as the number of visible meshlets is not known on the CPU
+            m_Stats.Meshlets += static_cast<uint32_t>(mesh.Meshlets.size());
+            gc.DrawIndexedIndirect(*mesh.VertexBuffer, indexBuffer, *m_BufferDrawCommands, draw.CommandOffset * sizeof(DrawIndexedIndirectCommand), *m_BufferDrawCounts, draw.CountIndex * sizeof(uint32_t), static_cast<uint32_t>(mesh.Meshlets.size()));
+            ++m_Stats.DrawCalls;
+         } else {
+            gc.DrawIndexed(*mesh.VertexBuffer, indexBuffer);
+            ++m_Stats.DrawCalls;
+         }
+         m_Stats.Triangles += indexCount / 3;
+         m_Stats.VertexBytes += mesh.VertexCount * sizeof(Mesh::CompactVertex);
+         m_Stats.IndexBytes += indexCount * indexSize;
+         m_Stats.UncompressedBytes += (mesh.VertexCount * sizeof(Mesh::Vertex)) + (indexCount * sizeof(uint32_t));
+      }
+   }
 
-         for (const auto& mesh : modelResource->Meshes) {
-            //gc.PushConstant("constants.mvp"_hs, transform * mesh.Transform);
-            //gc.Bind("uAlbedo"_hs, *mesh.AlbedoTexture);
-            //gc.Bind("uMetallicRoughness"_hs, *mesh.MetallicRoughnessTexture);
-            //gc.Bind("uNormals"_hs, *mesh.NormalTexture);
-            //gc.Bind("uAmbientOcclusion"_hs, *mesh.AmbientOcclusionTexture);
-            //gc.Bind("uHeightMap"_hs, *mesh.HeightTexture);
-            gc.DrawIndexed(*mesh.VertexBuffer, *mesh.IndexBuffer);
+
+   void SceneRenderer::CullMeshletsGPU(GraphicsContext& gc, const glm::mat4& vp, const glm::vec3& cameraPosition) {
+      if (!m_ComputeContext) {
+         m_ComputeContext = RenderCore::CreateComputeContext();
+         m_PipelineMeshletCull = m_ComputeContext->CreatePipeline({
+            .shaders = {
+               { Pikzel::ShaderType::Compute, "Renderer/MeshletCull.comp.spv" }
+            }
+         });
+      }
+
+      // Each draw gets a range of the commands buffer (one command per meshlet, worst case), and one count
+      uint32_t numCommands = 0;
+      uint32_t numCounts = 0;
+      for (auto& draw : m_Draws) {
+         if ((draw.LOD == 0) && draw.Mesh->MeshletBuffer) {
+            draw.CommandOffset = numCommands;
+            draw.CountIndex = numCounts++;
+            numCommands += static_cast<uint32_t>(draw.Mesh->Meshlets.size());
+         }
+      }
+      if (numCounts == 0) {
+         return;
+      }
+
+      // Buffers only ever grow (and grow to double what is needed), so that they are not being re-created every frame
+      if (numCommands > m_DrawCommandsCapacity) {
+         m_DrawCommandsCapacity = numCommands * 2;
+         m_BufferDrawCommands = RenderCore::CreateStorageBuffer(m_DrawCommandsCapacity * sizeof(DrawIndexedIndirectCommand));
+      }
+      if (numCounts > m_DrawCountsCapacity) {
+         m_DrawCountsCapacity = numCounts * 2;
+         m_BufferDrawCounts = RenderCore::CreateStorageBuffer(m_DrawCountsCapacity * sizeof(uint32_t));
+      }
+
+      // The counts are reset on the GPU, after the previous frame's indirect draws have finished reading them (see WaitFor() below).
+      // (commands past each count are never read, so the commands buffer needs no reset)
+      m_ComputeContext->Begin();
+      m_ComputeContext->Fill(*m_BufferDrawCounts, 0, 0, numCounts * sizeof(uint32_t));
+      m_ComputeContext->Bind(*m_PipelineMeshletCull);
+      for (const auto& draw : m_Draws) {
+         if ((draw.LOD == 0) && draw.Mesh->MeshletBuffer) {
+            const uint32_t numMeshlets = static_cast<uint32_t>(draw.Mesh->Meshlets.size());
+            m_ComputeContext->Bind("Meshlets"_hs, *draw.Mesh->MeshletBuffer);
+            m_ComputeContext->Bind("DrawCommands"_hs, *m_BufferDrawCommands);
+            m_ComputeContext->Bind("DrawCounts"_hs, *m_BufferDrawCounts);
+            m_ComputeContext->PushConstant("constants.mvp"_hs, vp * draw.Transform);
+            m_ComputeContext->PushConstant("constants.cameraPosition"_hs, glm::inverse(draw.Transform) * glm::vec4 {cameraPosition, 1.0f});
+            m_ComputeContext->PushConstant("constants.meshletCount"_hs, numMeshlets);
+            m_ComputeContext->PushConstant("constants.commandOffset"_hs, draw.CommandOffset);
+            m_ComputeContext->PushConstant("constants.countIndex"_hs, draw.CountIndex);
+            m_ComputeContext->Dispatch((numMeshlets + 63) / 64, 1, 1);  // MeshletCull.comp works in groups of 64 meshlets
+         }
+      }
+
+      // The draw commands and counts are rewritten each frame, and read by gc's indirect draws
+      m_ComputeContext->WaitFor(gc);
+      m_ComputeContext->End();
+      gc.WaitFor(*m_ComputeContext);
+   }
+
+
+   void SceneRenderer::SetViewportHeight(const uint32_t height) {
+      m_ViewportHeight = height;
+   }
+
+
+   void SceneRenderer::SetLODErrorThreshold(const float pixels) {
+      m_LODErrorThreshold = pixels;
+   }
+
+
+   void SceneRenderer::SetLODEnabled(const bool isEnabled) {
+      m_IsLODEnabled = isEnabled;
+   }
+
+
+   void SceneRenderer::SetMeshletCulling(const MeshletCulling culling) {
+      m_MeshletCulling = culling;
+   }
+
+
+   void SceneRenderer::SetOcclusionCullingEnabled(const bool isEnabled) {
+      m_IsOcclusionCullingEnabled = isEnabled;
+   }
+
+
+   const SceneRenderer::Stats& SceneRenderer::GetStats() const {
+      return m_Stats;
+   }
+
+
+   float SceneRenderer::GetPixelsPerUV(const Camera& camera, const uint32_t viewportHeight, const glm::mat4& transform, const std::pair<glm::vec3, glm::vec3>& aabb, const float uvDensity) {
+      if (uvDensity <= 0.0f) {
+         return 0.0f;
+      }
+
+      // world space bounding sphere
+      const float scale = glm::max(glm::length(glm::vec3 {transform[0]}), glm::max(glm::length(glm::vec3 {transform[1]}), glm::length(glm::vec3 {transform[2]})));
+      const glm::vec3 centre = transform * glm::vec4 {(aabb.first + aabb.second) * 0.5f, 1.0f};
+      const float radius = glm::length(aabb.second - aabb.first) * 0.5f * scale;
+
+      // camera is inside the bounds: the texture could be right in front of it
+      const float distance = glm::length(centre - camera.position) - radius;
+      if (distance <= 0.0f) {
+         return std::numeric_limits<float>::max();
+      }
+
+      // size, in pixels, of one mesh space unit at the nearest distance, divided by texture coordinate units per mesh space unit
+      const float pixelsPerUnit = 0.5f * static_cast<float>(viewportHeight) * camera.projection[1][1] / distance;
+      return pixelsPerUnit * scale / uvDensity;
+   }
+
+
+   uint32_t SceneRenderer::SelectLOD(const Object object, const glm::mat4& transform, const ModelResource& model, const Camera& camera) {
+      // An object must want a coarser level of detail by this much before it is switched to it.
+      // This stops objects flickering back and forth between levels when they are right on the threshold.
+      const float hysteresis = 0.5f;
+
+      if (!m_IsLODEnabled || (model.LODErrors.size() <= 1)) {
+         return 0;
+      }
+
+      // world space bounding sphere
+      const float scale = glm::max(glm::length(glm::vec3 {transform[0]}), glm::max(glm::length(glm::vec3 {transform[1]}), glm::length(glm::vec3 {transform[2]})));
+      const glm::vec3 centre = transform * glm::vec4 {(model.AABB.first + model.AABB.second) * 0.5f, 1.0f};
+      const float radius = glm::length(model.AABB.second - model.AABB.first) * 0.5f * scale;
+
+      uint32_t& currentLOD = m_ObjectLODs[object];
+      if (auto previous = m_PreviousObjectLODs.find(object); previous != m_PreviousObjectLODs.end()) {
+         currentLOD = previous->second;
+      }
+      const float distance = glm::length(centre - camera.position) - radius;
+      if (distance <= 0.0f) {
+         currentLOD = 0;
+         return currentLOD;
+      }
+
+      // size, in pixels, of one world space unit at the object's (nearest) distance
+      const float pixelsPerUnit = 0.5f * static_cast<float>(m_ViewportHeight) * camera.projection[1][1] / distance;
+      const auto screenError = [&](const uint32_t lod) {
+         return model.LODErrors[lod] * scale * pixelsPerUnit;
+      };
+
+      uint32_t lod = static_cast<uint32_t>(model.LODErrors.size() - 1);
+      while ((lod > 0) && (screenError(lod) > m_LODErrorThreshold)) {
+         --lod;
+      }
+      if (lod > currentLOD) {
+         while ((lod > currentLOD) && (screenError(lod) > m_LODErrorThreshold * hysteresis)) {
+            --lod;
          }
       }
+      currentLOD = lod;
+      return currentLOD;
    }
 
 }
\ No newline at end of file
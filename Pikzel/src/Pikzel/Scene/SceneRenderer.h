@@ -1,22 +1,118 @@
 #pragma once
 
+#include "Pikzel/Renderer/ComputeContext.h"
 #include "Pikzel/Renderer/GraphicsContext.h"
 #include "Pikzel/Renderer/Pipeline.h"
 #include "Pikzel/Scene/Camera.h"
+#include "Pikzel/Scene/Material.h"
+#include "Pikzel/Scene/Mesh.h"
+#include "Pikzel/Scene/ModelResource.h"
+#include "Pikzel/Scene/OcclusionCuller.h"
 #include "Pikzel/Scene/Scene.h"
 
+#include <array>
+#include <unordered_map>
+#include <vector>
+
 namespace Pikzel {
 
    class PKZL_API SceneRenderer {
    public:
 
+      // How (full resolution) meshes are culled at meshlet granularity.  See Meshlets.h
+      enum class MeshletCulling {
+         None,
+         CPU,   // culled on the CPU, and visible runs of meshlets drawn with DrawIndexed()
+         GPU    // culled by a compute shader, and drawn with DrawIndexedIndirect()
+      };
+
+      struct Stats {
+         uint32_t DrawCalls = 0;
+         uint32_t PipelineBinds = 0;      // number of times the pipeline changed (draws are sorted by material, so this is at most once per material)
+         uint32_t MaterialBinds = 0;      // number of times material instance textures and parameters were bound
+         uint32_t DrawsSubstituted = 0;   // number of draws that used the default material, because their own material was not ready yet
+         uint64_t Triangles = 0;
+         uint64_t VertexBytes = 0;        // size of vertex buffers drawn (an upper bound on vertex fetch bandwidth)
+         uint64_t IndexBytes = 0;         // size of index buffers drawn
+         uint64_t UncompressedBytes = 0;  // what VertexBytes + IndexBytes would be with full float vertices and 32-bit indices
+         std::array<uint32_t, Mesh::MaxLODs> ObjectsPerLOD = {};  // number of objects drawn at each level of detail
+         uint32_t Meshlets = 0;           // number of meshlets tested for culling
+         uint32_t MeshletsVisible = 0;    // number of meshlets that passed (CPU culling only: GPU culling results are not read back)
+         uint32_t DrawsOccluded = 0;      // number of draws skipped because they are hidden behind occluders
+         float OcclusionRasterizeMs = 0;  // time taken to rasterize the occluders (on worker threads)
+      };
+
       SceneRenderer(const GraphicsContext& gc);
       virtual ~SceneRenderer() = default;
 
       void Render(GraphicsContext& gc, Camera& camera, Scene& scene);
 
+      // Level of detail selection.
+      // Each object is drawn at the coarsest level of detail whose simplification error, projected onto the screen,
+      // is no more than the error threshold (in pixels).  The viewport height is needed to convert to pixels.
+      void SetViewportHeight(const uint32_t height);
+      void SetLODErrorThreshold(const float pixels);
+      void SetLODEnabled(const bool isEnabled);
+
+      void SetMeshletCulling(const MeshletCulling culling);
+
+      // Software occlusion culling.  Objects with an Occluder component are rasterized on the CPU, and then objects (and
+      // their meshes) that are hidden behind them are not drawn.  See OcclusionCuller.h
+      void SetOcclusionCullingEnabled(const bool isEnabled);
+
+      // Statistics for the most recent Render()
+      const Stats& GetStats() const;
+
+   public:
+      // How many pixels one unit of texture coordinates covers on screen, for a mesh with given transform, bounding box
+      // (mesh space), and texture coordinate density (see CalculateUVDensity()).
+      // Measured at the nearest point of the bounding box, in the same way as level of detail selection.
+      // This is the screen space texel density that TextureStreamer::ReportPixelsPerUV() prioritises streaming by.
+      static float GetPixelsPerUV(const Camera& camera, const uint32_t viewportHeight, const glm::mat4& transform, const std::pair<glm::vec3, glm::vec3>& aabb, const float uvDensity);
+
+   private:
+      // One mesh of one object, to be drawn this frame
+      struct Draw {
+         const Pikzel::Mesh* Mesh;
+         const MaterialInstance* Material;
+         glm::mat4 Transform;
+         uint32_t LOD;
+         uint32_t CommandOffset;  // where the meshlet culling compute shader writes this draw's commands (GPU culling only)
+         uint32_t CountIndex;     // where the meshlet culling compute shader counts this draw's commands (GPU culling only)
+      };
+
+      // The range of m_Draws that belongs to one object
+      struct ObjectDraws {
+         glm::mat4 Transform;
+         const ModelResource* Model;
+         size_t Begin;
+         size_t End;
+      };
+
+      uint32_t SelectLOD(const Object object, const glm::mat4& transform, const ModelResource& model, const Camera& camera);
+      void CullMeshletsGPU(GraphicsContext& gc, const glm::mat4& vp, const glm::vec3& cameraPosition);
+
    private:
-      std::unique_ptr<Pipeline> m_Pipeline;
+      std::shared_ptr<Material> m_DefaultMaterial;
+      std::shared_ptr<MaterialInstance> m_DefaultMaterialInstance;
+      std::unique_ptr<ComputeContext> m_ComputeContext;
+      std::unique_ptr<Pipeline> m_PipelineMeshletCull;
+      std::unique_ptr<StorageBuffer> m_BufferDrawCommands;
+      std::unique_ptr<StorageBuffer> m_BufferDrawCounts;
+      uint32_t m_DrawCommandsCapacity = 0;
+      uint32_t m_DrawCountsCapacity = 0;
+      std::vector<Draw> m_Draws;
+      std::vector<ObjectDraws> m_Objects;
+      std::unique_ptr<OcclusionCuller> m_OcclusionCuller;
+      std::vector<DrawIndexedIndirectCommand> m_DrawCommands;  // CPU culling output (kept to avoid re-allocating every frame)
+      std::unordered_map<Object, uint32_t> m_ObjectLODs;          // level of detail each object is drawn at this frame
+      std::unordered_map<Object, uint32_t> m_PreviousObjectLODs;  // and last frame (for hysteresis).  Only objects drawn last frame are in here, so objects that are destroyed (or belong to a different scene) drop out
+      Stats m_Stats;
+      uint32_t m_ViewportHeight = 1080;
+      float m_LODErrorThreshold = 1.0f;
+      bool m_IsLODEnabled = true;
+      MeshletCulling m_MeshletCulling = MeshletCulling::CPU;
+      bool m_IsOcclusionCullingEnabled = true;
    };
 
    std::unique_ptr<SceneRenderer> PKZL_API CreateSceneRenderer(const GraphicsContext& gc);
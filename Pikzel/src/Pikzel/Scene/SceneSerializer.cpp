@@ -1,6 +1,7 @@
 #include "SceneSerializer.h"
 
 #include "Pikzel/Components/Model.h"
+#include "Pikzel/Components/Occluder.h"
 #include "Pikzel/Components/Transform.h"
 #include "Pikzel/Scene/AssetCache.h"
 
@@ -180,30 +181,43 @@ namespace Pikzel {
 
 
    template<>
-   void Serialize<ModelResourceHandle>(YAML::Emitter& yaml, const ModelResourceHandle& handle) {
+   void Serialize<Occluder>(YAML::Emitter& yaml, const Occluder& occluder) {
+      yaml << occluder.IsEnabled;
+   }
+
+
+   template<>
+   void Deserialize<Occluder>(YAML::Node node, Occluder& occluder) {
+      occluder.IsEnabled = node.as<bool>();
+   }
+
+
+   template<>
+   void Serialize<ModelResourceSource>(YAML::Emitter& yaml, const ModelResourceSource& source) {
       yaml << YAML::BeginMap;
       {
-         yaml << YAML::Key << "Name" << YAML::Value << handle->Name;
-         yaml << YAML::Key << "Path" << YAML::Value << handle->Path.string().c_str();
+         yaml << YAML::Key << "Name" << YAML::Value << source.Name;
+         yaml << YAML::Key << "Path" << YAML::Value << source.Path.string().c_str();
       }
       yaml << YAML::EndMap;
    }
 
 
+   // Serialize from the model sources rather than the model cache, so that models that are currently evicted are included
    template<>
-   void Serialize<ModelResourceCache>(YAML::Emitter& yaml, const ModelResourceCache& cache) {
+   void Serialize<ModelResourceSources>(YAML::Emitter& yaml, const ModelResourceSources& sources) {
       yaml << YAML::Value << YAML::BeginSeq;
       {
-         cache.each([&](ModelResourceHandle handle) {
-            Serialize(yaml, handle);
-         });
+         for (const auto& [id, source] : sources) {
+            Serialize(yaml, source);
+         }
       }
       yaml << YAML::EndSeq;
    }
 
 
    template<>
-   void Deserialize<ModelResourceCache>(YAML::Node node, ModelResourceCache&) {
+   void Deserialize<ModelResourceSources>(YAML::Node node, ModelResourceSources&) {
       for (auto modelResourceNode : node) {
          auto name = modelResourceNode["Name"].as<std::string>();
          auto path = modelResourceNode["Path"].as<std::string>();
@@ -242,6 +256,7 @@ namespace Pikzel {
          SerializeComponent<Id>(yaml, "Id", scene, object);
          SerializeComponent<Transform>(yaml, "Transform", scene, object);
          SerializeComponent<Model>(yaml, "Model", scene, object);
+         SerializeComponent<Occluder>(yaml, "Occluder", scene, object);
       }
       yaml << YAML::EndMap;
    }
@@ -253,6 +268,7 @@ namespace Pikzel {
          DeserializeComponent<Id>(objectNode, "Id", scene, object);
          DeserializeComponent<Transform>(objectNode, "Transform", scene, object);
          DeserializeComponent<Model>(objectNode, "Model", scene, object);
+         DeserializeComponent<Occluder>(objectNode, "Occluder", scene, object);
       }
    }
 
@@ -294,7 +310,7 @@ namespace Pikzel {
             yaml << YAML::Value << YAML::BeginMap;
             {
                yaml << YAML::Key << "Models";
-               yaml << YAML::Value; Pikzel::Serialize(yaml, AssetCache::m_ModelCache);
+               yaml << YAML::Value; Pikzel::Serialize(yaml, AssetCache::m_ModelSources);
             }
             yaml << YAML::EndMap;
 
@@ -315,7 +331,7 @@ namespace Pikzel {
             PKZL_CORE_LOG_INFO("Deserializing scene from path '{0}'", m_Settings.Path);
 
             if (auto assetsNode = sceneNode["Assets"]) {
-               Pikzel::Deserialize(assetsNode["Models"], AssetCache::m_ModelCache);
+               Pikzel::Deserialize(assetsNode["Models"], AssetCache::m_ModelSources);
             }
 
             DeserializeObjects(sceneNode["Objects"], *scene);
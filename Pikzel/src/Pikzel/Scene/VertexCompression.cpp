@@ -0,0 +1,71 @@
+#include "VertexCompression.h"
+
+#include "Pikzel/Renderer/ContentCache.h"
+
+#include <glm/gtc/packing.hpp>
+
+namespace Pikzel {
+
+   std::array<int16_t, 2> EncodeOctahedral(const glm::vec3& v) {
+      const float sum = glm::abs(v.x) + glm::abs(v.y) + glm::abs(v.z);
+      if (sum == 0.0f) {
+         return {0, 0};
+      }
+      glm::vec2 p = glm::vec2 {v} / sum;
+      if (v.z < 0.0f) {
+         // fold the lower hemisphere out over the diagonals
+         p = (1.0f - glm::abs(glm::vec2 {p.y, p.x})) * glm::vec2 {p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f};
+      }
+      return {static_cast<int16_t>(glm::packSnorm1x16(p.x)), static_cast<int16_t>(glm::packSnorm1x16(p.y))};
+   }
+
+
+   glm::vec3 DecodeOctahedral(const std::array<int16_t, 2>& e) {
+      const glm::vec2 p = {glm::unpackSnorm1x16(static_cast<uint16_t>(e[0])), glm::unpackSnorm1x16(static_cast<uint16_t>(e[1]))};
+      glm::vec3 v = {p, 1.0f - glm::abs(p.x) - glm::abs(p.y)};
+      const float t = glm::max(-v.z, 0.0f);
+      v.x += v.x >= 0.0f ? -t : t;
+      v.y += v.y >= 0.0f ? -t : t;
+      return glm::normalize(v);
+   }
+
+
+   std::vector<Mesh::CompactVertex> CompressVertices(const std::vector<Mesh::Vertex>& vertices, glm::mat4& dequantizeTransform) {
+      PKZL_PROFILE_FUNCTION();
+
+      glm::vec3 aabbMin = glm::vec3 {std::numeric_limits<float>::max()};
+      glm::vec3 aabbMax = glm::vec3 {std::numeric_limits<float>::lowest()};
+      for (const auto& vertex : vertices) {
+         aabbMin = glm::min(aabbMin, vertex.Pos);
+         aabbMax = glm::max(aabbMax, vertex.Pos);
+      }
+      const glm::vec3 extent = vertices.empty() ? glm::vec3 {1.0f} : glm::max(aabbMax - aabbMin, glm::vec3 {std::numeric_limits<float>::min()});
+      const glm::vec3 offset = vertices.empty() ? glm::vec3 {0.0f} : aabbMin;
+      dequantizeTransform = glm::scale(glm::translate(glm::identity<glm::mat4>(), offset), extent);
+
+      std::vector<Mesh::CompactVertex> compactVertices;
+      compactVertices.reserve(vertices.size());
+      for (const auto& vertex : vertices) {
+         const glm::vec3 p = (vertex.Pos - offset) / extent;
+         const auto normal = EncodeOctahedral(vertex.Normal);
+         const auto tangent = EncodeOctahedral(vertex.Tangent);
+         compactVertices.push_back({
+            .Pos = {glm::packUnorm1x16(p.x), glm::packUnorm1x16(p.y), glm::packUnorm1x16(p.z), 0},
+            .Normal = {normal[0], normal[1]},
+            .Tangent = {tangent[0], tangent[1]},
+            .UV = {glm::packHalf1x16(vertex.UV.x), glm::packHalf1x16(vertex.UV.y)}
+         });
+      }
+      return compactVertices;
+   }
+
+
+   std::shared_ptr<IndexBuffer> CreateCompactIndexBuffer(const std::vector<uint32_t>& indices, const size_t vertexCount) {
+      if (vertexCount <= std::numeric_limits<uint16_t>::max() + 1) {
+         const std::vector<uint16_t> indices16 {indices.begin(), indices.end()};
+         return ContentCache::CreateIndexBuffer(static_cast<uint32_t>(indices16.size()), indices16.data());
+      }
+      return ContentCache::CreateIndexBuffer(static_cast<uint32_t>(indices.size()), indices.data());
+   }
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Pikzel/Renderer/Buffer.h"
+#include "Pikzel/Scene/Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace Pikzel {
+
+   // Encodes a unit vector as two signed normalized 16-bit values using an octahedral mapping.
+   // (the sphere is projected onto an octahedron, which is then unfolded into a square).
+   // The shader side decode is DecodeOctahedral() in Renderer/Shaders/VertexCompression.glsl
+   std::array<int16_t, 2> PKZL_API EncodeOctahedral(const glm::vec3& v);
+   glm::vec3 PKZL_API DecodeOctahedral(const std::array<int16_t, 2>& e);
+
+   // Converts vertices to the compact vertex format.
+   // Positions are quantized to 16 bits across the bounding box of the vertices.  dequantizeTransform maps the quantized
+   // positions (which shaders see as [0, 1]) back to mesh space.  Pre-multiply it into the model matrix.
+   std::vector<Mesh::CompactVertex> PKZL_API CompressVertices(const std::vector<Mesh::Vertex>& vertices, glm::mat4& dequantizeTransform);
+
+   // Creates an index buffer with 16-bit indices if vertexCount allows, otherwise 32-bit indices
+   std::shared_ptr<IndexBuffer> PKZL_API CreateCompactIndexBuffer(const std::vector<uint32_t>& indices, const size_t vertexCount);
+
+}
@@ -8,6 +8,9 @@
 const float nearPlane = 1000.f;
 const float farPlane = 0.1f;
 
+// Pipelines that were created last time, so that they can be created in parallel at startup
+const char* pipelineWarmUpList = "Pikzelated.pipelines.yaml";
+
 class Pikzelated final : public Pikzel::Application {
    using super = Pikzel::Application;
 public:
@@ -24,13 +27,25 @@ public:
          ImGui::LoadIniSettingsFromDisk("EditorImGui.ini");
       }
 
-      m_Framebuffer = Pikzel::RenderCore::CreateFramebuffer({.width = m_ViewportSize.x, .height = m_ViewportSize.y, .msaaNumSamples = 4, .clearColorValue = {1.0f, 1.0f, 1.0f, 1.0f}});
+      m_Framebuffer = Pikzel::FramebufferPool::Acquire({.width = m_ViewportSize.x, .height = m_ViewportSize.y, .msaaNumSamples = 4, .clearColorValue = {1.0f, 1.0f, 1.0f, 1.0f}});
+      m_RenderSize = m_ViewportSize;
+      Pikzel::PipelineCompiler::WarmUp(m_Framebuffer->GetGraphicsContext(), pipelineWarmUpList);
+      Pikzel::PipelineCompiler::SetRecording(true);
       m_SceneRenderer = Pikzel::CreateSceneRenderer(m_Framebuffer->GetGraphicsContext());
 
       m_Camera.projection = glm::perspective(m_Camera.fovRadians, static_cast<float>(m_ViewportSize.x) / static_cast<float>(m_ViewportSize.y), nearPlane, farPlane);
    }
 
 
+   ~Pikzelated() {
+      try {
+         Pikzel::PipelineCompiler::SaveWarmUpList(pipelineWarmUpList);
+      } catch (const std::exception& err) {
+         PKZL_LOG_WARN("{0}", err.what());
+      }
+   }
+
+
 protected:
 
    virtual void Update(Pikzel::DeltaTime deltaTime) override {
@@ -60,6 +75,31 @@ protected:
    }
 
 
+   // A dense scene for measuring the effect of mesh levels of detail.
+   // A grid of models stretching away from the camera, so that there are objects at many different distances.
+   void OnFileNewLODBenchmark() {
+      const int gridSize = 8;
+      const float spacing = 40.0f;
+
+      m_Scene = std::make_unique<Pikzel::Scene>();
+
+      auto model = Pikzel::AssetCache::LoadModelResource("sponza", "Assets/Models/Sponza/Sponza.gltf");
+
+      for (int i = 0; i < gridSize; ++i) {
+         for (int j = 0; j < gridSize; ++j) {
+            Pikzel::Object object = m_Scene->CreateObject();
+            m_Scene->AddComponent<Pikzel::Id>(object, static_cast<Pikzel::Id>((i * gridSize) + j));
+            m_Scene->AddComponent<Pikzel::Transform>(object, glm::translate(glm::identity<glm::mat4>(), {(i - (gridSize / 2)) * spacing, 0.0f, -j * spacing}));
+            m_Scene->AddComponent<Pikzel::Model>(object, model);
+            m_Scene->AddComponent<Pikzel::Occluder>(object);
+         }
+      }
+
+      m_Camera.position = {0.0f, 10.0f, 20.0f};
+      m_Camera.direction = glm::normalize(glm::vec3 {0.0f, -0.2f, -1.0f});
+   }
+
+
    void OnFileOpen() {
       auto path = Pikzel::OpenFileDialog("*.pkzl", "Pikzel Scene File (*.pkzl)");
       if (path.has_value()) {
@@ -93,11 +133,15 @@ protected:
 
    virtual void RenderBegin() override {
       PKZL_PROFILE_FUNCTION();
-      if(
-         (m_ViewportSize.x != m_Framebuffer->GetWidth()) ||
-         (m_ViewportSize.y != m_Framebuffer->GetHeight())
-      ) {
-         m_Framebuffer = Pikzel::RenderCore::CreateFramebuffer({.width = m_ViewportSize.x, .height = m_ViewportSize.y, .msaaNumSamples = 4, .clearColorValue = {1.0f, 1.0f, 1.0f, 1.0f}});
+      if (m_ViewportSize != m_RenderSize) {
+         // The framebuffer is over-allocated, so while the viewport is being resized it is usually big enough already, and the scene
+         // is just drawn into less (or more) of it
+         if (Pikzel::FramebufferPool::Resize(m_Framebuffer, m_ViewportSize.x, m_ViewportSize.y)) {
+            // A different framebuffer has been handed out, and the old one may be destroyed once it has gone unused for a while.
+            // The scene renderer's pipelines were created for the old one, so the renderer is recreated for the new one.
+            m_SceneRenderer = Pikzel::CreateSceneRenderer(m_Framebuffer->GetGraphicsContext());
+         }
+         m_RenderSize = m_ViewportSize;
          m_Camera.projection = glm::perspective(m_Camera.fovRadians, static_cast<float>(m_ViewportSize.x) / static_cast<float>(m_ViewportSize.y), nearPlane, farPlane);
       }
    }
@@ -126,8 +170,15 @@ protected:
 
       Pikzel::GraphicsContext& gc = m_Framebuffer->GetGraphicsContext();
       gc.BeginFrame();
+      gc.SetViewport({0, 0}, m_RenderSize);
       if (m_Scene) {
          PKZL_PROFILE_SCOPE("render scene");
+         m_SceneRenderer->SetViewportHeight(m_ViewportSize.y);
+         m_SceneRenderer->SetLODEnabled(m_IsLODEnabled);
+         m_SceneRenderer->SetLODErrorThreshold(m_LODErrorThreshold);
+         m_SceneRenderer->SetMeshletCulling(static_cast<Pikzel::SceneRenderer::MeshletCulling>(m_MeshletCulling));
+         m_SceneRenderer->SetOcclusionCullingEnabled(m_IsOcclusionCullingEnabled);
+         Pikzel::AssetCache::SetMemoryBudget(static_cast<uint64_t>(m_AssetBudgetMB) * 1024 * 1024);
          m_SceneRenderer->Render(gc, m_Camera, *m_Scene);
       }
       gc.EndFrame();
@@ -157,6 +208,9 @@ protected:
                if (ImGui::MenuItem("New...", "Ctrl+N")) {
                   OnFileNew();
                }
+               if (ImGui::MenuItem("New LOD Benchmark")) {
+                  OnFileNewLODBenchmark();
+               }
                if (ImGui::MenuItem("Open...", "Ctrl+O")) {
                   OnFileOpen();
                }
@@ -177,12 +231,52 @@ protected:
          {
             ImGui::Begin("Statistics");
 
-            // auto stats = Renderer2D::GetStats();
-            ImGui::Text("Draw Calls: XXX"); // % d", stats.DrawCalls);
-            ImGui::Text("Quads: XXX");      // % d", stats.QuadCount);
-            ImGui::Text("Vertices: XXX");   // % d", stats.GetTotalVertexCount());
-            ImGui::Text("Indices: XXX");    // % d", stats.GetTotalIndexCount());
+            const auto& stats = m_SceneRenderer->GetStats();
+            ImGui::Text("Draw Calls: %d", stats.DrawCalls);
+            ImGui::Text("Pipeline binds: %d, material binds: %d", stats.PipelineBinds, stats.MaterialBinds);
+            if (stats.DrawsSubstituted > 0) {
+               ImGui::Text("Draws waiting for their material: %d", stats.DrawsSubstituted);
+            }
+            ImGui::Text("Triangles: %llu", static_cast<unsigned long long>(stats.Triangles));
+            ImGui::Text("Triangle throughput: %.1f M/s", static_cast<float>(stats.Triangles) * io.Framerate / 1000000.0f);
+            ImGui::Text("Vertex data: %.1f MB/frame, index data: %.1f MB/frame", static_cast<float>(stats.VertexBytes) / (1024.0f * 1024.0f), static_cast<float>(stats.IndexBytes) / (1024.0f * 1024.0f));
+            ImGui::Text("(uncompressed would be %.1f MB/frame)", static_cast<float>(stats.UncompressedBytes) / (1024.0f * 1024.0f));
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+            ImGui::Separator();
+            ImGui::Checkbox("Level of detail", &m_IsLODEnabled);
+            ImGui::SliderFloat("LOD error (pixels)", &m_LODErrorThreshold, 0.25f, 16.0f);
+            for (size_t lod = 0; lod < stats.ObjectsPerLOD.size(); ++lod) {
+               ImGui::Text("LOD %zu: %d objects", lod, stats.ObjectsPerLOD[lod]);
+            }
+            ImGui::Combo("Meshlet culling", &m_MeshletCulling, "None\0CPU\0GPU\0");
+            if (m_MeshletCulling == static_cast<int>(Pikzel::SceneRenderer::MeshletCulling::CPU)) {
+               ImGui::Text("Meshlets: %d of %d visible", stats.MeshletsVisible, stats.Meshlets);
+            } else {
+               ImGui::Text("Meshlets: %d", stats.Meshlets);
+            }
+            ImGui::Checkbox("Occlusion culling", &m_IsOcclusionCullingEnabled);
+            if (m_IsOcclusionCullingEnabled) {
+               ImGui::Text("Draws occluded: %d, rasterizer %.3f ms", stats.DrawsOccluded, stats.OcclusionRasterizeMs);
+            }
+            ImGui::Text("Camera distance:");
+            for (const float distance : {20.0f, 80.0f, 160.0f, 320.0f}) {
+               ImGui::SameLine();
+               if (ImGui::Button(fmt::format("{}", distance).c_str())) {
+                  m_Camera.position = {0.0f, 10.0f, distance};
+                  m_Camera.direction = glm::normalize(glm::vec3 {0.0f, -0.2f, -1.0f});
+               }
+            }
+            ImGui::Separator();
+            const auto& residency = Pikzel::AssetCache::GetResidencyStats();
+            ImGui::SliderInt("Asset budget (MB, 0 = device)", &m_AssetBudgetMB, 0, 4096);
+            ImGui::Text("Assets: %.1f of %.1f MB", static_cast<float>(residency.ResidentBytes) / (1024.0f * 1024.0f), static_cast<float>(residency.Budget) / (1024.0f * 1024.0f));
+            ImGui::Text("Device: %.1f of %.1f MB", static_cast<float>(residency.DeviceUsage) / (1024.0f * 1024.0f), static_cast<float>(residency.DeviceBudget) / (1024.0f * 1024.0f));
+            ImGui::Text("Models: %d resident, %d evicted.  Textures: %d resident, %d evicted", residency.ModelsResident, residency.ModelsEvicted, residency.TexturesResident, residency.TexturesEvicted);
+            ImGui::Text("Evictions: %d, reloads: %d (this frame)", residency.Evictions, residency.Reloads);
+            const auto content = Pikzel::ContentCache::GetStats();
+            ImGui::Text("Shared: %d of %d resources, %.1f MB saved", content.SharedResources, content.Resources, static_cast<float>(content.BytesSaved) / (1024.0f * 1024.0f));
+            const auto framebuffers = Pikzel::FramebufferPool::GetStats();
+            ImGui::Text("Framebuffers: %d (%d in use), %.1f MB.  Created %d, reused %d", framebuffers.Framebuffers, framebuffers.InUse, static_cast<float>(framebuffers.Bytes) / (1024.0f * 1024.0f), framebuffers.Created, framebuffers.Reused);
             static float frameRates[90] = {};
             static int frameOffset = 0;
             static double refresh = ImGui::GetTime();
@@ -200,10 +294,13 @@ protected:
             ImVec2 viewportPanelSize = ImGui::GetContentRegionAvail();
             m_ViewportSize = {viewportPanelSize.x, viewportPanelSize.y};
             gc.SwapBuffers();
-            ImGui::Image(m_Framebuffer->GetImGuiColorTextureId(0), viewportPanelSize, ImVec2{0, 1}, ImVec2{1, 0});
+            const glm::vec2 uvScale = Pikzel::FramebufferPool::GetUVScale(*m_Framebuffer, m_RenderSize.x, m_RenderSize.y);
+            ImGui::Image(m_Framebuffer->GetImGuiColorTextureId(0), viewportPanelSize, ImVec2{0, uvScale.y}, ImVec2{uvScale.x, 0});
             ImGui::End();
          }
 
+         Pikzel::ImGuiEx::ShaderErrors();
+
          ImGui::End();
       }
       ImGui::PopStyleVar(3);
@@ -231,9 +328,15 @@ private:
 
    Pikzel::Input m_Input;
    glm::u32vec2 m_ViewportSize = {800, 600};
+   glm::u32vec2 m_RenderSize = {};        // part of m_Framebuffer that the scene is drawn into
    std::unique_ptr<Pikzel::Scene> m_Scene;
    std::unique_ptr<Pikzel::SceneRenderer> m_SceneRenderer;
-   std::unique_ptr<Pikzel::Framebuffer> m_Framebuffer;
+   std::shared_ptr<Pikzel::Framebuffer> m_Framebuffer;
+   float m_LODErrorThreshold = 1.0f;
+   bool m_IsLODEnabled = true;
+   int m_MeshletCulling = static_cast<int>(Pikzel::SceneRenderer::MeshletCulling::CPU);
+   bool m_IsOcclusionCullingEnabled = true;
+   int m_AssetBudgetMB = 0;
 
 };
 
@@ -0,0 +1,31 @@
+#include "Test.h"
+
+#include "Pikzel/Core/Core.h"
+
+namespace Pikzel::Test {
+
+   void Fail(const char* file, const int line, const char* expression) {
+      PKZL_LOG_ERROR("{0}({1}): check failed: {2}", file, line, expression);
+      ++GetFailureCount();
+   }
+
+}
+
+
+int main() {
+   Pikzel::Log::Init();
+
+   int failedTests = 0;
+   for (const auto& test : Pikzel::Test::GetTests()) {
+      const int failuresBefore = Pikzel::Test::GetFailureCount();
+      test.Function();
+      if (Pikzel::Test::GetFailureCount() != failuresBefore) {
+         PKZL_LOG_ERROR("FAILED: {0}", test.Name);
+         ++failedTests;
+      } else {
+         PKZL_LOG_INFO("passed: {0}", test.Name);
+      }
+   }
+   PKZL_LOG_INFO("{0} of {1} tests passed", Pikzel::Test::GetTests().size() - failedTests, Pikzel::Test::GetTests().size());
+   return failedTests == 0 ? 0 : 1;
+}
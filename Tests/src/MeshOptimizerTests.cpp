@@ -0,0 +1,129 @@
+#include "Test.h"
+
+#include "Pikzel/Scene/MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <set>
+
+namespace {
+
+   // Indices of an n x n grid of quads (two triangles each), with the triangles in a random order
+   std::vector<uint32_t> ShuffledGrid(const uint32_t n) {
+      std::vector<std::array<uint32_t, 3>> triangles;
+      for (uint32_t y = 0; y < n; ++y) {
+         for (uint32_t x = 0; x < n; ++x) {
+            const uint32_t v = y * (n + 1) + x;
+            triangles.push_back({v, v + 1, v + n + 2});
+            triangles.push_back({v, v + n + 2, v + n + 1});
+         }
+      }
+      std::shuffle(triangles.begin(), triangles.end(), std::mt19937 {42});
+
+      std::vector<uint32_t> indices;
+      for (const auto& triangle : triangles) {
+         indices.insert(indices.end(), triangle.begin(), triangle.end());
+      }
+      return indices;
+   }
+
+
+   // Triangles as sets of (rotation-independent) vertex triples, so that two index buffers can be compared regardless of triangle order
+   std::multiset<std::array<uint32_t, 3>> Triangles(const std::vector<uint32_t>& indices) {
+      std::multiset<std::array<uint32_t, 3>> triangles;
+      for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+         std::array<uint32_t, 3> triangle = {indices[i], indices[i + 1], indices[i + 2]};
+         std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+         triangles.insert(triangle);
+      }
+      return triangles;
+   }
+
+}
+
+
+PKZL_TEST(AnalyzeVertexCacheEmpty) {
+   const Pikzel::VertexCacheStats stats = Pikzel::AnalyzeVertexCache({}, 0);
+   PKZL_CHECK(stats.ACMR == 0.0f);
+   PKZL_CHECK(stats.ATVR == 0.0f);
+}
+
+
+PKZL_TEST(AnalyzeVertexCacheLessThanOneTriangle) {
+   // fewer than 3 indices used to divide by zero
+   const Pikzel::VertexCacheStats stats = Pikzel::AnalyzeVertexCache({0, 1}, 2);
+   PKZL_CHECK(stats.ACMR == 0.0f);
+   PKZL_CHECK(stats.ATVR == 0.0f);
+}
+
+
+PKZL_TEST(AnalyzeVertexCacheSingleTriangle) {
+   const Pikzel::VertexCacheStats stats = Pikzel::AnalyzeVertexCache({0, 1, 2}, 3);
+   PKZL_CHECK(stats.ACMR == 3.0f);
+   PKZL_CHECK(stats.ATVR == 1.0f);
+}
+
+
+PKZL_TEST(AnalyzeVertexCacheSharedVertices) {
+   // a quad: second triangle reuses two vertices of the first, which are still in the cache
+   const Pikzel::VertexCacheStats stats = Pikzel::AnalyzeVertexCache({0, 1, 2, 0, 2, 3}, 4);
+   PKZL_CHECK(stats.ACMR == 2.0f);
+   PKZL_CHECK(stats.ATVR == 1.0f);
+}
+
+
+PKZL_TEST(AnalyzeVertexCacheEviction) {
+   // with a cache of 3, the fourth vertex evicts the first, so re-using it misses again
+   const Pikzel::VertexCacheStats stats = Pikzel::AnalyzeVertexCache({0, 1, 2, 1, 2, 3, 3, 2, 0}, 4, 3);
+   PKZL_CHECK(stats.ACMR == 5.0f / 3.0f);
+   PKZL_CHECK(stats.ATVR == 5.0f / 4.0f);
+}
+
+
+PKZL_TEST(OptimizeVertexCacheKeepsTriangles) {
+   const uint32_t n = 16;
+   const size_t vertexCount = (n + 1) * (n + 1);
+   const std::vector<uint32_t> original = ShuffledGrid(n);
+   std::vector<uint32_t> indices = original;
+
+   const std::vector<size_t> clusters = Pikzel::OptimizeVertexCache(indices, vertexCount);
+
+   PKZL_CHECK(indices.size() == original.size());
+   PKZL_CHECK(Triangles(indices) == Triangles(original));
+
+   // clusters start at 0, are increasing, and fall on triangle boundaries
+   PKZL_CHECK(!clusters.empty() && clusters.front() == 0);
+   PKZL_CHECK(std::is_sorted(clusters.begin(), clusters.end()));
+   PKZL_CHECK(std::all_of(clusters.begin(), clusters.end(), [&](const size_t offset) { return (offset % 3 == 0) && (offset < indices.size()); }));
+}
+
+
+PKZL_TEST(OptimizeVertexCacheImprovesACMR) {
+   const uint32_t n = 16;
+   const size_t vertexCount = (n + 1) * (n + 1);
+   std::vector<uint32_t> indices = ShuffledGrid(n);
+
+   const Pikzel::VertexCacheStats before = Pikzel::AnalyzeVertexCache(indices, vertexCount);
+   Pikzel::OptimizeVertexCache(indices, vertexCount);
+   const Pikzel::VertexCacheStats after = Pikzel::AnalyzeVertexCache(indices, vertexCount);
+
+   // a randomly ordered grid is close to the worst case (3 misses per triangle).  A regular grid can get to about 0.5-0.8
+   PKZL_CHECK(before.ACMR > 2.0f);
+   PKZL_CHECK(after.ACMR < 1.0f);
+   PKZL_CHECK(after.ACMR < before.ACMR);
+}
+
+
+PKZL_TEST(OptimizeVertexFetchOrdersByFirstUse) {
+   std::vector<uint32_t> indices = {3, 1, 2, 2, 1, 0};
+   const std::vector<uint32_t> remap = Pikzel::OptimizeVertexFetch(indices, 5);
+
+   // first-use order was 3, 1, 2, 0.  Unused vertex 4 goes last
+   PKZL_CHECK((indices == std::vector<uint32_t> {0, 1, 2, 2, 1, 3}));
+   PKZL_CHECK((remap == std::vector<uint32_t> {3, 1, 2, 0, 4}));
+
+   std::vector<int> vertices = {10, 11, 12, 13, 14};
+   Pikzel::RemapVertices(vertices, remap);
+   PKZL_CHECK((vertices == std::vector<int> {13, 11, 12, 10, 14}));
+}
@@ -0,0 +1,112 @@
+#include "Test.h"
+
+#include "Pikzel/Scene/MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <utility>
+
+namespace {
+
+   // An n x n grid of quads on the unit square (z = 0), cut into two UV charts down the middle (x = 0.5, n must be even).
+   // Vertices on the cut are duplicated: the originals belong to the left chart, and the copies (with different UVs) to the right.
+   struct SeamedGrid {
+      std::vector<Pikzel::Mesh::Vertex> Vertices;
+      std::vector<uint32_t> Indices;
+      std::vector<bool> IsRight;   // which chart each vertex belongs to
+   };
+
+   SeamedGrid MakeSeamedGrid(const uint32_t n) {
+      SeamedGrid grid;
+      const glm::vec3 normal = {0.0f, 0.0f, 1.0f};
+      const glm::vec3 tangent = {1.0f, 0.0f, 0.0f};
+      std::vector<uint32_t> seamCopy(n + 1);
+      for (uint32_t y = 0; y <= n; ++y) {
+         for (uint32_t x = 0; x <= n; ++x) {
+            const glm::vec3 pos = {static_cast<float>(x) / static_cast<float>(n), static_cast<float>(y) / static_cast<float>(n), 0.0f};
+            grid.Vertices.emplace_back(pos, normal, tangent, glm::vec2 {pos.x, pos.y});
+            grid.IsRight.push_back(x > n / 2);
+         }
+      }
+      for (uint32_t y = 0; y <= n; ++y) {
+         seamCopy[y] = static_cast<uint32_t>(grid.Vertices.size());
+         const glm::vec3 pos = grid.Vertices[y * (n + 1) + (n / 2)].Pos;
+         grid.Vertices.emplace_back(pos, normal, tangent, glm::vec2 {pos.x + 1.0f, pos.y});
+         grid.IsRight.push_back(true);
+      }
+      const auto vertex = [&](const uint32_t x, const uint32_t y, const bool isRight) {
+         return ((x == n / 2) && isRight) ? seamCopy[y] : y * (n + 1) + x;
+      };
+      for (uint32_t y = 0; y < n; ++y) {
+         for (uint32_t x = 0; x < n; ++x) {
+            const bool isRight = x >= n / 2;
+            grid.Indices.insert(grid.Indices.end(), {vertex(x, y, isRight), vertex(x + 1, y, isRight), vertex(x + 1, y + 1, isRight)});
+            grid.Indices.insert(grid.Indices.end(), {vertex(x, y, isRight), vertex(x + 1, y + 1, isRight), vertex(x, y + 1, isRight)});
+         }
+      }
+      return grid;
+   }
+
+
+   float Area(const std::vector<Pikzel::Mesh::Vertex>& vertices, const std::vector<uint32_t>& indices) {
+      float area = 0.0f;
+      for (size_t i = 0; i < indices.size(); i += 3) {
+         const glm::vec3& p0 = vertices[indices[i]].Pos;
+         area += 0.5f * glm::cross(vertices[indices[i + 1]].Pos - p0, vertices[indices[i + 2]].Pos - p0).z;
+      }
+      return area;
+   }
+
+}
+
+
+PKZL_TEST(SimplifyMeshKeepsOutline) {
+   SeamedGrid grid = MakeSeamedGrid(16);
+   float error = 0.0f;
+   const std::vector<uint32_t> simplified = Pikzel::SimplifyMesh(grid.Vertices, grid.Indices, grid.Indices.size() / 4, 1.0f, error);
+
+   PKZL_CHECK(simplified.size() < grid.Indices.size());
+   PKZL_CHECK(simplified.size() % 3 == 0);
+
+   // a flat grid simplifies without error, and with its border kept (and no holes) it still covers the whole square
+   PKZL_CHECK(error < 1e-4f);
+   PKZL_CHECK(std::abs(Area(grid.Vertices, simplified) - 1.0f) < 1e-4f);
+}
+
+
+PKZL_TEST(SimplifyMeshSeamSimplifiesWithoutTearing) {
+   const uint32_t n = 16;
+   SeamedGrid grid = MakeSeamedGrid(n);
+   float error = 0.0f;
+   const std::vector<uint32_t> simplified = Pikzel::SimplifyMesh(grid.Vertices, grid.Indices, grid.Indices.size() / 8, 1.0f, error);
+
+   // each triangle stays within one chart (attributes from either side of the seam are never mixed)
+   bool isOneChart = true;
+   for (size_t i = 0; i < simplified.size(); i += 3) {
+      const bool isRight = grid.IsRight[simplified[i]];
+      isOneChart = isOneChart && (grid.IsRight[simplified[i + 1]] == isRight) && (grid.IsRight[simplified[i + 2]] == isRight);
+   }
+   PKZL_CHECK(isOneChart);
+
+   // the seam is simplified (some of its vertices have been collapsed along it), and both sides of it still meet exactly.
+   // i.e. edges that lie on the seam are the same on both sides
+   std::set<std::pair<float, float>> seamEdges[2];
+   std::set<float> seamVertices;
+   for (size_t i = 0; i < simplified.size(); i += 3) {
+      for (size_t j = 0; j < 3; ++j) {
+         const glm::vec3& p0 = grid.Vertices[simplified[i + j]].Pos;
+         const glm::vec3& p1 = grid.Vertices[simplified[i + ((j + 1) % 3)]].Pos;
+         if (p0.x == 0.5f) {
+            seamVertices.insert(p0.y);
+         }
+         if ((p0.x == 0.5f) && (p1.x == 0.5f)) {
+            seamEdges[grid.IsRight[simplified[i]] ? 1 : 0].insert({std::min(p0.y, p1.y), std::max(p0.y, p1.y)});
+         }
+      }
+   }
+   PKZL_CHECK(seamVertices.size() < n + 1);
+   PKZL_CHECK(!seamEdges[0].empty());
+   PKZL_CHECK(seamEdges[0] == seamEdges[1]);
+   PKZL_CHECK(std::abs(Area(grid.Vertices, simplified) - 1.0f) < 1e-4f);
+}
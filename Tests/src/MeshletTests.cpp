@@ -0,0 +1,167 @@
+#include "Test.h"
+
+#include "Pikzel/Scene/Meshlets.h"
+
+#include <algorithm>
+#include <array>
+#include <set>
+
+namespace {
+
+   // An n x n grid of quads (two triangles each) in the z = 0 plane, spanning [-size, size] in x and y, offset by offset.
+   // Triangles are wound counter-clockwise when seen from +z
+   struct Grid {
+      std::vector<glm::vec3> Positions;
+      std::vector<uint32_t> Indices;
+   };
+
+   Grid MakeGrid(const uint32_t n, const float size, const glm::vec3& offset = {0.0f, 0.0f, 0.0f}) {
+      Grid grid;
+      for (uint32_t y = 0; y <= n; ++y) {
+         for (uint32_t x = 0; x <= n; ++x) {
+            grid.Positions.push_back(glm::vec3 {
+               (2.0f * size * static_cast<float>(x) / static_cast<float>(n)) - size,
+               (2.0f * size * static_cast<float>(y) / static_cast<float>(n)) - size,
+               0.0f
+            } + offset);
+         }
+      }
+      for (uint32_t y = 0; y < n; ++y) {
+         for (uint32_t x = 0; x < n; ++x) {
+            const uint32_t v = y * (n + 1) + x;
+            grid.Indices.insert(grid.Indices.end(), {v, v + 1, v + n + 2});
+            grid.Indices.insert(grid.Indices.end(), {v, v + n + 2, v + n + 1});
+         }
+      }
+      return grid;
+   }
+
+
+   std::multiset<std::array<uint32_t, 3>> Triangles(const std::vector<uint32_t>& indices) {
+      std::multiset<std::array<uint32_t, 3>> triangles;
+      for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+         std::array<uint32_t, 3> triangle = {indices[i], indices[i + 1], indices[i + 2]};
+         std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+         triangles.insert(triangle);
+      }
+      return triangles;
+   }
+
+
+   std::vector<Pikzel::Meshlet> BuildMeshlets(Grid& grid) {
+      return Pikzel::BuildMeshlets(grid.Indices, grid.Positions.data(), grid.Positions.size(), sizeof(glm::vec3));
+   }
+
+}
+
+
+PKZL_TEST(BuildMeshletsEmpty) {
+   std::vector<uint32_t> indices;
+   const glm::vec3 position = {0.0f, 0.0f, 0.0f};
+   PKZL_CHECK(Pikzel::BuildMeshlets(indices, &position, 1, sizeof(glm::vec3)).empty());
+}
+
+
+PKZL_TEST(BuildMeshletsCoversMesh) {
+   Grid grid = MakeGrid(32, 1.0f);
+   const std::vector<uint32_t> original = grid.Indices;
+
+   const std::vector<Pikzel::Meshlet> meshlets = BuildMeshlets(grid);
+
+   // same triangles, and the meshlets are consecutive ranges that cover the whole index buffer
+   PKZL_CHECK(Triangles(grid.Indices) == Triangles(original));
+   PKZL_CHECK(meshlets.size() > 1);
+   uint32_t offset = 0;
+   for (const auto& meshlet : meshlets) {
+      PKZL_CHECK(meshlet.IndexOffset == offset);
+      offset += meshlet.IndexCount;
+   }
+   PKZL_CHECK(offset == grid.Indices.size());
+}
+
+
+PKZL_TEST(BuildMeshletsLimits) {
+   Grid grid = MakeGrid(32, 1.0f);
+   const std::vector<Pikzel::Meshlet> meshlets = BuildMeshlets(grid);
+
+   for (const auto& meshlet : meshlets) {
+      const std::set<uint32_t> vertices(grid.Indices.begin() + meshlet.IndexOffset, grid.Indices.begin() + meshlet.IndexOffset + meshlet.IndexCount);
+      PKZL_CHECK(meshlet.IndexCount > 0);
+      PKZL_CHECK(meshlet.IndexCount % 3 == 0);
+      PKZL_CHECK(meshlet.IndexCount / 3 <= Pikzel::MeshletMaxTriangles);
+      PKZL_CHECK(meshlet.VertexCount <= Pikzel::MeshletMaxVertices);
+      PKZL_CHECK(meshlet.VertexCount == vertices.size());
+   }
+}
+
+
+PKZL_TEST(BuildMeshletsBounds) {
+   Grid grid = MakeGrid(32, 1.0f);
+   const std::vector<Pikzel::Meshlet> meshlets = BuildMeshlets(grid);
+
+   for (const auto& meshlet : meshlets) {
+      // every vertex is inside the bounding sphere
+      const glm::vec3 centre = meshlet.Sphere;
+      for (uint32_t i = meshlet.IndexOffset; i < meshlet.IndexOffset + meshlet.IndexCount; ++i) {
+         PKZL_CHECK(glm::length(grid.Positions[grid.Indices[i]] - centre) <= meshlet.Sphere.w + 1e-5f);
+      }
+
+      // a flat meshlet's normal cone is just the face normal, with no spread
+      PKZL_CHECK(meshlet.Cone.z > 0.999f);
+      PKZL_CHECK(meshlet.Cone.w < 0.01f);
+   }
+}
+
+
+PKZL_TEST(CullMeshletsAllVisible) {
+   Grid grid = MakeGrid(32, 0.9f);
+   const std::vector<Pikzel::Meshlet> meshlets = BuildMeshlets(grid);
+
+   // identity mvp: the frustum is -1 <= x, y <= 1, and the camera is in front of the grid
+   std::vector<Pikzel::DrawIndexedIndirectCommand> commands;
+   const uint32_t numVisible = Pikzel::CullMeshlets(meshlets, glm::mat4 {1.0f}, {0.0f, 0.0f, 10.0f}, commands);
+
+   // all meshlets are adjacent in the index buffer, so they merge into a single draw of everything
+   PKZL_CHECK(numVisible == meshlets.size());
+   PKZL_CHECK(commands.size() == 1);
+   PKZL_CHECK(!commands.empty() && (commands.front().FirstIndex == 0) && (commands.front().IndexCount == grid.Indices.size()) && (commands.front().InstanceCount == 1));
+}
+
+
+PKZL_TEST(CullMeshletsOutsideFrustum) {
+   Grid grid = MakeGrid(32, 0.9f, {5.0f, 0.0f, 0.0f});
+   const std::vector<Pikzel::Meshlet> meshlets = BuildMeshlets(grid);
+
+   std::vector<Pikzel::DrawIndexedIndirectCommand> commands;
+   PKZL_CHECK(Pikzel::CullMeshlets(meshlets, glm::mat4 {1.0f}, {5.0f, 0.0f, 10.0f}, commands) == 0);
+   PKZL_CHECK(commands.empty());
+}
+
+
+PKZL_TEST(CullMeshletsBackFacing) {
+   Grid grid = MakeGrid(32, 0.9f);
+   const std::vector<Pikzel::Meshlet> meshlets = BuildMeshlets(grid);
+
+   // camera behind the grid sees only back faces
+   std::vector<Pikzel::DrawIndexedIndirectCommand> commands;
+   PKZL_CHECK(Pikzel::CullMeshlets(meshlets, glm::mat4 {1.0f}, {0.0f, 0.0f, -10.0f}, commands) == 0);
+   PKZL_CHECK(commands.empty());
+}
+
+
+PKZL_TEST(CullMeshletsPartlyVisible) {
+   // half of the grid is left of the frustum
+   Grid grid = MakeGrid(32, 1.0f, {-1.5f, 0.0f, 0.0f});
+   const std::vector<Pikzel::Meshlet> meshlets = BuildMeshlets(grid);
+
+   std::vector<Pikzel::DrawIndexedIndirectCommand> commands;
+   const uint32_t numVisible = Pikzel::CullMeshlets(meshlets, glm::mat4 {1.0f}, {-1.5f, 0.0f, 10.0f}, commands);
+   PKZL_CHECK(numVisible > 0);
+   PKZL_CHECK(numVisible < meshlets.size());
+
+   // commands that are appended to a non-empty list leave the earlier commands alone
+   std::vector<Pikzel::DrawIndexedIndirectCommand> appended = {{.IndexCount = 3, .InstanceCount = 1, .FirstIndex = 0, .VertexOffset = 0, .FirstInstance = 0}};
+   PKZL_CHECK(Pikzel::CullMeshlets(meshlets, glm::mat4 {1.0f}, {-1.5f, 0.0f, 10.0f}, appended) == numVisible);
+   PKZL_CHECK(appended.size() == commands.size() + 1);
+   PKZL_CHECK(appended.front().IndexCount == 3);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// A minimal test harness: enough to run a handful of engine unit tests without pulling in a test framework.
+//
+// PKZL_TEST(Name) { ... } defines and registers a test.
+// PKZL_CHECK(condition) records a failure (and carries on) if condition is false.
+
+namespace Pikzel::Test {
+
+   struct TestCase {
+      const char* Name;
+      std::function<void()> Function;
+   };
+
+   inline std::vector<TestCase>& GetTests() {
+      static std::vector<TestCase> tests;
+      return tests;
+   }
+
+   inline int& GetFailureCount() {
+      static int failures = 0;
+      return failures;
+   }
+
+   struct Registrar {
+      Registrar(const char* name, std::function<void()> function) {
+         GetTests().push_back({name, std::move(function)});
+      }
+   };
+
+   void Fail(const char* file, const int line, const char* expression);
+
+}
+
+#define PKZL_TEST(name)                                                          \
+   static void name();                                                           \
+   static const Pikzel::Test::Registrar name##Registrar {#name, name};          \
+   static void name()
+
+#define PKZL_CHECK(condition)                                                    \
+   do {                                                                          \
+      if (!(condition)) {                                                        \
+         Pikzel::Test::Fail(__FILE__, __LINE__, #condition);                     \
+      }                                                                          \
+   } while (false)